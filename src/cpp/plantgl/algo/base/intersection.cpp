@@ -31,8 +31,9 @@
 
 #include "intersection.h"
 #include "tesselator.h"
-#include "pointmanipulation.h"
-#include <plantgl/algo/grid/kdtree.h>
+#include <plantgl/algo/grid/aabbtree.h>
+#include <plantgl/tool/util_parallel.h>
+#include <algorithm>
 #include <plantgl/scenegraph/geometry/polyline.h>
 #include <plantgl/scenegraph/geometry/pointset.h>
 
@@ -281,103 +282,190 @@ IntersectionType  PGL(triangle_triangle_intersection)(const TOOLS(Vector3)& t11,
     return NoIntersection;
 }
 
-std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
-PGL(auto_intersection)(Point3ArrayPtr points, Index3ArrayPtr triangles)
+/* ----------------------------------------------------------------------- */
+
+// Result of the test of a pair of triangles.
+struct TrianglePairIntersection {
+    uint32_t first;
+    uint32_t second;
+    IntersectionType type;
+    Vector3 start;
+    Vector3 end;
+};
+
+typedef std::vector<TrianglePairIntersection> TrianglePairIntersectionList;
+
+// Returns whether x lies strictly inside the angular sector spanned by u1 and u2 around the normal n.
+inline bool strictly_in_sector(const Vector3& u1, const Vector3& u2, const Vector3& x, const Vector3& n)
+{
+    real_t orientation = dot(cross(u1, u2), n) > 0 ? 1 : -1;
+    return orientation * dot(cross(u1, x), n) > GEOM_EPSILON * norm(u1) * norm(x) * norm(n) &&
+           orientation * dot(cross(x, u2), n) > GEOM_EPSILON * norm(u2) * norm(x) * norm(n);
+}
+
+/*
+    Tests if two coplanar triangles which share points overlap. Two triangles sharing an edge overlap
+    if their opposite points are on the same side of the edge. Two triangles sharing a point overlap
+    if their angular sectors around this point overlap.
+*/
+bool coplanar_neighbors_overlap(const Point3ArrayPtr& points, const Index3& tr1, const Index3& tr2,
+                                const std::vector<uint32_t>& common_points)
 {
-#ifdef WITH_ANN
-    std::vector<std::pair<uint32_t,uint32_t> > intersectionpair;
-    GeometryArrayPtr intersectionresult(new GeometryArray());
-    Point3ArrayPtr centroids = centroids_of_groups(points, triangles);
-    real_t maxsize = 0;
-    Point3Array::const_iterator itorigin = centroids->begin();
-    for(Index3Array::const_iterator it = triangles->begin(); it != triangles->end(); ++it, ++itorigin ) 
-    {
-        real_t size = norm(*itorigin-points->getAt(it->getAt(0)));
-        if (maxsize < size) maxsize = size;
+    if (common_points.size() >= 3) return true;
+    const Vector3& c1 = points->getAt(common_points[0]);
+    Vector3 n = cross(points->getAt(tr1.getAt(1)) - points->getAt(tr1.getAt(0)), points->getAt(tr1.getAt(2)) - points->getAt(tr1.getAt(0)));
+    std::vector<Vector3> others1, others2;
+    for (uchar_t i = 0; i < 3; ++i) {
+        if (std::find(common_points.begin(), common_points.end(), tr1.getAt(i)) == common_points.end())
+            others1.push_back(points->getAt(tr1.getAt(i)) - c1);
+        if (std::find(common_points.begin(), common_points.end(), tr2.getAt(i)) == common_points.end())
+            others2.push_back(points->getAt(tr2.getAt(i)) - c1);
     }
+    if (common_points.size() == 2) {
+        Vector3 edge = points->getAt(common_points[1]) - c1;
+        return dot(cross(edge, others1[0]), n) * dot(cross(edge, others2[0]), n) > 0;
+    }
+    Vector3 bisector1 = direction(others1[0]) + direction(others1[1]);
+    Vector3 bisector2 = direction(others2[0]) + direction(others2[1]);
+    return strictly_in_sector(others1[0], others1[1], others2[0], n) ||
+           strictly_in_sector(others1[0], others1[1], others2[1], n) ||
+           strictly_in_sector(others1[0], others1[1], bisector2, n) ||
+           strictly_in_sector(others2[0], others2[1], others1[0], n) ||
+           strictly_in_sector(others2[0], others2[1], others1[1], n) ||
+           strictly_in_sector(others2[0], others2[1], bisector1, n);
+}
 
-    ANNKDTree3 kdtree(centroids);
-    IndexArrayPtr nbgs = kdtree.r_nearest_neighbors(2*maxsize);
-    Vector3 intersectionstart, intersectionend;
-
-    Index3Array::const_iterator ittr = triangles->begin();
-    size_t idtr = 0;
-    for (IndexArray::const_iterator itnbgs = nbgs->begin(); itnbgs != nbgs->end(); ++itnbgs, ++ittr, ++idtr)
-    {
-        for (Index::const_iterator itnbg = itnbgs->begin(); itnbg != itnbgs->end(); ++itnbg)
-        {
-            if (idtr < *itnbg){ // We want to compare only once every pair of triangles.
-                const Index3& nbg = triangles->getAt(*itnbg);
-                int intersection = triangle_triangle_intersection(points->getAt(ittr->getAt(0)), points->getAt(ittr->getAt(1)),points->getAt(ittr->getAt(2)),
-                                                                  points->getAt(nbg.getAt(0)), points->getAt(nbg.getAt(1)),points->getAt(nbg.getAt(2)),
-                                                                  intersectionstart, intersectionend);
-
-                if (intersection != NoIntersection){
-                    if (intersection == Intersection){
-                        std::vector<uint32_t> common_points;
-                        for(Index3::const_iterator ittrpt = ittr->begin(); ittrpt != ittr->end(); ++ittrpt )
-                            for (Index3::const_iterator itnbpt = nbg.begin(); itnbpt != nbg.end(); ++itnbpt )
-                                if (*ittrpt == *itnbpt) common_points.push_back(*ittrpt);
-
-                        int nbintersection = 2;
-                        if (norm(intersectionstart-intersectionend) < GEOM_EPSILON) {
-                            // it is actually one point which intersect
-                            nbintersection = 1;
-                        }
-
-                        /// We check here if it is not an edge or a vertex which is in common.
-                        /// We should not  care about such intersection in case of auto intersection 
-                        if (common_points.size() == 1 && nbintersection == 1){
-                            // We test if it is a common point
-                            if (norm(points->getAt(common_points[0]) - intersectionstart) < GEOM_EPSILON)
-                                continue;
-                            else {
-                                intersectionpair.push_back(std::pair<uint32_t,uint32_t>(idtr, *itnbg));
-                                intersectionresult->push_back(GeometryPtr(new PointSet(Point3ArrayPtr(new Point3Array(1,intersectionstart)))));
-                            }
-                        }
-
-                        if (common_points.size() == 2){
-                            // We test if it is a common edge
-                            if (nbintersection == 2){
-                                if ( norm(intersectionstart-points->getAt(common_points[0])) < GEOM_EPSILON ) {
-                                    if ( norm(intersectionend-points->getAt(common_points[1])) < GEOM_EPSILON ) 
-                                        continue;
-                                }
-                                else if ( norm(intersectionstart-points->getAt(common_points[1])) < GEOM_EPSILON ) {
-                                     if ( norm(intersectionend-points->getAt(common_points[0])) < GEOM_EPSILON ) 
-                                        continue;
-                                } 
-                            }
-                            // This case should not occur. We test if it is a common point
-                            else if (nbintersection == 1){
-                                if ( norm(intersectionstart-points->getAt(common_points[0])) < GEOM_EPSILON ||
-                                     norm(intersectionstart-points->getAt(common_points[1])) < GEOM_EPSILON )
-                                    continue;
-                            }                             
-                        }
-
-                        intersectionpair.push_back(std::pair<uint32_t,uint32_t>(idtr, *itnbg));
-                        intersectionresult->push_back(GeometryPtr(new Polyline(Point3ArrayPtr(new Point3Array(intersectionstart, intersectionend)))));
-                    }
-                    else { // coplanar
-                        intersectionpair.push_back(std::pair<uint32_t,uint32_t>(idtr, *itnbg));
-                        intersectionresult->push_back(GeometryPtr());
-
-                    }
+/*
+    Tests the intersection of two triangles of a same mesh.
+    Returns false if they do not intersect or if they only share a point or an edge.
+*/
+bool self_triangle_intersection(const Point3ArrayPtr& points, const Index3& tr1, const Index3& tr2,
+                                TrianglePairIntersection& result)
+{
+    const Vector3& t11 = points->getAt(tr1.getAt(0));
+    const Vector3& t12 = points->getAt(tr1.getAt(1));
+    const Vector3& t13 = points->getAt(tr1.getAt(2));
+    const Vector3& t21 = points->getAt(tr2.getAt(0));
+    const Vector3& t22 = points->getAt(tr2.getAt(1));
+    const Vector3& t23 = points->getAt(tr2.getAt(2));
+    result.type = triangle_triangle_intersection(t11, t12, t13, t21, t22, t23, result.start, result.end);
+    if (result.type == NoIntersection) return false;
+
+    std::vector<uint32_t> common_points;
+    for(Index3::const_iterator ittrpt = tr1.begin(); ittrpt != tr1.end(); ++ittrpt )
+        for (Index3::const_iterator itnbpt = tr2.begin(); itnbpt != tr2.end(); ++itnbpt )
+            if (*ittrpt == *itnbpt) common_points.push_back(*ittrpt);
+
+    if (result.type == CoPlanar) {
+        // coplanar neighbors always touch.
+        return common_points.empty() || coplanar_neighbors_overlap(points, tr1, tr2, common_points);
+    }
+
+    // it is actually one point which intersect
+    bool onepoint = norm(result.start-result.end) < GEOM_EPSILON;
+
+    /// We check here if it is not an edge or a vertex which is in common.
+    /// We should not  care about such intersection in case of auto intersection 
+    if (common_points.size() == 1 && onepoint){
+        // We test if it is a common point
+        if (norm(points->getAt(common_points[0]) - result.start) < GEOM_EPSILON)
+            return false;
+    }
+    else if (common_points.size() == 2){
+        // We test if it is a common edge
+        if (!onepoint){
+            const Vector3& c1 = points->getAt(common_points[0]);
+            const Vector3& c2 = points->getAt(common_points[1]);
+            if ((norm(result.start-c1) < GEOM_EPSILON && norm(result.end-c2) < GEOM_EPSILON) ||
+                (norm(result.start-c2) < GEOM_EPSILON && norm(result.end-c1) < GEOM_EPSILON))
+                return false;
+        }
+        // This case should not occur. We test if it is a common point
+        else if ( norm(result.start-points->getAt(common_points[0])) < GEOM_EPSILON ||
+                  norm(result.start-points->getAt(common_points[1])) < GEOM_EPSILON )
+            return false;
+    }
+    return true;
+}
 
+/*
+    Tests the candidate pairs of triangles in parallel. Pairs are processed by
+    blocks whose results are concatenated in order, so the result is deterministic.
+*/
+struct TrianglePairTester {
+    enum { BLOCK_SIZE = 4096 };
+
+    const AABBTree::ItemPairList& candidates;
+    const Point3ArrayPtr& points1;
+    const Index3ArrayPtr& triangles1;
+    const Point3ArrayPtr& points2;
+    const Index3ArrayPtr& triangles2;
+    bool self;
+    std::vector<TrianglePairIntersectionList> results;
+
+    TrianglePairTester(const AABBTree::ItemPairList& _candidates,
+                       const Point3ArrayPtr& _points1, const Index3ArrayPtr& _triangles1,
+                       const Point3ArrayPtr& _points2, const Index3ArrayPtr& _triangles2, bool _self) :
+        candidates(_candidates), points1(_points1), triangles1(_triangles1),
+        points2(_points2), triangles2(_triangles2), self(_self),
+        results((_candidates.size() + BLOCK_SIZE - 1) / BLOCK_SIZE) {}
+
+    void operator()(size_t firstblock, size_t lastblock) {
+        TrianglePairIntersection intersection;
+        for (size_t block = firstblock; block < lastblock; ++block) {
+            size_t last = std::min<size_t>(candidates.size(), (block + 1) * BLOCK_SIZE);
+            for (size_t c = block * BLOCK_SIZE; c < last; ++c) {
+                intersection.first = candidates[c].first;
+                intersection.second = candidates[c].second;
+                const Index3& tr1 = triangles1->getAt(intersection.first);
+                const Index3& tr2 = triangles2->getAt(intersection.second);
+                bool found;
+                if (self) found = self_triangle_intersection(points1, tr1, tr2, intersection);
+                else {
+                    intersection.type = triangle_triangle_intersection(points1->getAt(tr1.getAt(0)), points1->getAt(tr1.getAt(1)), points1->getAt(tr1.getAt(2)),
+                                                                       points2->getAt(tr2.getAt(0)), points2->getAt(tr2.getAt(1)), points2->getAt(tr2.getAt(2)),
+                                                                       intersection.start, intersection.end);
+                    found = (intersection.type != NoIntersection);
                 }
+                if (found) results[block].push_back(intersection);
             }
-
         }
     }
-    return std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> (intersectionpair, intersectionresult);
-#else
-    #ifdef _MSC_VER
-    #pragma message("function 'auto_intersection' disabled. ANN needed.")
-    #else
-    #warning "function 'auto_intersection' disabled. ANN needed"
-    #endif
-    return std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> ();
-#endif
+
+    std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> run() {
+        pgl_parallel_for(0, results.size(), *this, 1);
+        std::vector<std::pair<uint32_t,uint32_t> > intersectionpair;
+        GeometryArrayPtr intersectionresult(new GeometryArray());
+        for (std::vector<TrianglePairIntersectionList>::const_iterator itblock = results.begin(); itblock != results.end(); ++itblock)
+            for (TrianglePairIntersectionList::const_iterator it = itblock->begin(); it != itblock->end(); ++it) {
+                intersectionpair.push_back(std::pair<uint32_t,uint32_t>(it->first, it->second));
+                if (it->type == CoPlanar)
+                    intersectionresult->push_back(GeometryPtr());
+                else if (norm(it->start-it->end) < GEOM_EPSILON)
+                    intersectionresult->push_back(GeometryPtr(new PointSet(Point3ArrayPtr(new Point3Array(1,it->start)))));
+                else
+                    intersectionresult->push_back(GeometryPtr(new Polyline(Point3ArrayPtr(new Point3Array(it->start, it->end)))));
+            }
+        return std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> (intersectionpair, intersectionresult);
+    }
+};
+
+std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
+PGL(auto_intersection)(Point3ArrayPtr points, Index3ArrayPtr triangles)
+{
+    AABBTree tree(points, triangles);
+    AABBTree::ItemPairList candidates = tree.overlappingPairs();
+    TrianglePairTester tester(candidates, points, triangles, points, triangles, true);
+    return tester.run();
+}
+
+std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
+PGL(mesh_intersection)(Point3ArrayPtr points1, Index3ArrayPtr triangles1,
+                       Point3ArrayPtr points2, Index3ArrayPtr triangles2)
+{
+    AABBTree tree1(points1, triangles1);
+    AABBTree tree2(points2, triangles2);
+    AABBTree::ItemPairList candidates = tree1.overlappingPairs(tree2);
+    TrianglePairTester tester(candidates, points1, triangles1, points2, triangles2, false);
+    return tester.run();
 }
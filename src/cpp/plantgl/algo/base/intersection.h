@@ -86,9 +86,19 @@ ALGO_API IntersectionType triangle_triangle_intersection(const TOOLS(Vector3)& t
 
 
 
-std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
+/** Computes the intersections between the triangles of a mesh. Triangles which only share a point or an edge
+    are not considered as intersecting. Candidate pairs are found with an AABBTree of the triangles and tested in parallel.
+    Returns the sorted pairs of intersecting triangles and, for each pair, the intersection as a Polyline or a PointSet,
+    or a null geometry if the triangles are coplanar. */
+ALGO_API std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
 auto_intersection(Point3ArrayPtr points, Index3ArrayPtr triangles);
 
+/** Computes the intersections between the triangles of two meshes, such as different organs of a plant.
+    Returns the pairs (i,j) of intersecting triangles of the first and second mesh and their intersections, as auto_intersection. */
+ALGO_API std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> 
+mesh_intersection(Point3ArrayPtr points1, Index3ArrayPtr triangles1,
+                  Point3ArrayPtr points2, Index3ArrayPtr triangles2);
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
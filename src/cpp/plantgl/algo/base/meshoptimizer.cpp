@@ -0,0 +1,518 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "meshoptimizer.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <math.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const real_t MeshOptimizer::DEFAULT_WELD_TOLERANCE(GEOM_EPSILON);
+const uint_t MeshOptimizer::DEFAULT_CACHE_SIZE(32);
+
+#define NO_ID UINT32_MAX
+
+/* ----------------------------------------------------------------------- */
+
+/*
+   Flat representation of a mesh used by the optimizer. Faces are stored as
+   ranges of corners. Each attribute list is bound either to the points, to the
+   faces or to the corners through its own corner index list.
+*/
+struct OptimizedMesh {
+    enum Binding { NONE, PER_VERTEX, PER_FACE, PER_CORNER };
+
+    Point3ArrayPtr points;
+    Point3ArrayPtr normals;
+    Color4ArrayPtr colors;
+    Point2ArrayPtr texCoords;
+    Binding normalBinding;
+    Binding colorBinding;
+    Binding texCoordBinding;
+
+    std::vector<uint_t> offsets;
+    std::vector<uint_t> corners;
+    std::vector<uint_t> normalCorners;
+    std::vector<uint_t> colorCorners;
+    std::vector<uint_t> texCoordCorners;
+
+    inline uint_t nbFaces() const { return offsets.size() - 1; }
+    inline uint_t faceSize(uint_t f) const { return offsets[f+1] - offsets[f]; }
+
+    // Returns whether the points i and j have the same per vertex attributes.
+    bool sameAttributes(uint_t i, uint_t j, real_t sqtolerance) const {
+        if (normalBinding == PER_VERTEX && normSquared(normals->getAt(i) - normals->getAt(j)) > sqtolerance) return false;
+        if (texCoordBinding == PER_VERTEX && normSquared(texCoords->getAt(i) - texCoords->getAt(j)) > sqtolerance) return false;
+        if (colorBinding == PER_VERTEX && !(colors->getAt(i) == colors->getAt(j))) return false;
+        return true;
+    }
+};
+
+template<class IndexArrayType>
+void read_corners(const RCPtr<IndexArrayType>& indices, std::vector<uint_t>& corners)
+{
+    corners.clear();
+    for(typename IndexArrayType::const_iterator it = indices->begin(); it != indices->end(); ++it)
+        corners.insert(corners.end(), it->begin(), it->end());
+}
+
+inline OptimizedMesh::Binding get_binding(bool hasValues, bool hasIndices, bool perVertex)
+{
+    if (!hasValues) return OptimizedMesh::NONE;
+    if (hasIndices) return OptimizedMesh::PER_CORNER;
+    return (perVertex ? OptimizedMesh::PER_VERTEX : OptimizedMesh::PER_FACE);
+}
+
+template<class MeshType>
+void read_mesh(const MeshType& mesh, OptimizedMesh& result)
+{
+    result.points = mesh.getPointList();
+    result.normals = mesh.getNormalList();
+    result.colors = mesh.getColorList();
+    result.texCoords = mesh.getTexCoordList();
+    result.normalBinding = get_binding(is_valid_ptr(result.normals), is_valid_ptr(mesh.getNormalIndexList()), mesh.getNormalPerVertex());
+    result.colorBinding = get_binding(is_valid_ptr(result.colors), is_valid_ptr(mesh.getColorIndexList()), mesh.getColorPerVertex());
+    result.texCoordBinding = get_binding(is_valid_ptr(result.texCoords), is_valid_ptr(mesh.getTexCoordIndexList()), true);
+
+    result.offsets.resize(mesh.getIndexListSize()+1);
+    result.offsets[0] = 0;
+    for(uint_t f = 0; f < mesh.getIndexListSize(); ++f)
+        result.offsets[f+1] = result.offsets[f] + mesh.getFaceSize(f);
+
+    read_corners(mesh.getIndexList(), result.corners);
+    if (result.normalBinding == OptimizedMesh::PER_CORNER) read_corners(mesh.getNormalIndexList(), result.normalCorners);
+    if (result.colorBinding == OptimizedMesh::PER_CORNER) read_corners(mesh.getColorIndexList(), result.colorCorners);
+    if (result.texCoordBinding == OptimizedMesh::PER_CORNER) read_corners(mesh.getTexCoordIndexList(), result.texCoordCorners);
+}
+
+inline bool has_variable_face_size(const Index3Array&) { return false; }
+inline bool has_variable_face_size(const Index4Array&) { return false; }
+inline bool has_variable_face_size(const IndexArray&) { return true; }
+
+inline void make_face(Index3& face, const uint_t * corners, uint_t) { face = Index3(corners[0],corners[1],corners[2]); }
+inline void make_face(Index4& face, const uint_t * corners, uint_t) { face = Index4(corners[0],corners[1],corners[2],corners[3]); }
+inline void make_face(Index& face, const uint_t * corners, uint_t size) { face = Index(corners,corners+size); }
+
+template<class IndexArrayType>
+RCPtr<IndexArrayType> write_corners(const OptimizedMesh& mesh, const std::vector<uint_t>& corners)
+{
+    if (corners.empty()) return RCPtr<IndexArrayType>();
+    RCPtr<IndexArrayType> result(new IndexArrayType(mesh.nbFaces()));
+    for(uint_t f = 0; f < mesh.nbFaces(); ++f)
+        make_face(result->getAt(f), &corners[mesh.offsets[f]], mesh.faceSize(f));
+    return result;
+}
+
+template<class MeshType>
+RCPtr<MeshType> write_mesh(const MeshType& model, const OptimizedMesh& mesh)
+{
+    typedef typename MeshType::IndexArray IndexArrayType;
+    RCPtr<MeshType> result(new MeshType(mesh.points,
+                                        write_corners<IndexArrayType>(mesh, mesh.corners),
+                                        mesh.normals,
+                                        write_corners<IndexArrayType>(mesh, mesh.normalCorners),
+                                        mesh.colors,
+                                        write_corners<IndexArrayType>(mesh, mesh.colorCorners),
+                                        mesh.texCoords,
+                                        write_corners<IndexArrayType>(mesh, mesh.texCoordCorners),
+                                        model.getNormalPerVertex(),
+                                        model.getColorPerVertex(),
+                                        model.getCCW(),
+                                        model.getSolid(),
+                                        model.getSkeleton()));
+    result->setName(model.getName());
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+template<class ArrayPtr>
+ArrayPtr select_values(const ArrayPtr& values, const std::vector<uint_t>& selection)
+{
+    ArrayPtr result(new typename ArrayPtr::element_type(selection.size()));
+    for(uint_t i = 0; i < selection.size(); ++i)
+        result->setAt(i, values->getAt(selection[i]));
+    return result;
+}
+
+// Keeps the per vertex attributes of the points in selection.
+void select_vertices(OptimizedMesh& mesh, const std::vector<uint_t>& selection)
+{
+    mesh.points = select_values(mesh.points, selection);
+    if (mesh.normalBinding == OptimizedMesh::PER_VERTEX) mesh.normals = select_values(mesh.normals, selection);
+    if (mesh.colorBinding == OptimizedMesh::PER_VERTEX) mesh.colors = select_values(mesh.colors, selection);
+    if (mesh.texCoordBinding == OptimizedMesh::PER_VERTEX) mesh.texCoords = select_values(mesh.texCoords, selection);
+}
+
+// Keeps the faces in selection, in this order, with their attributes.
+void select_faces(OptimizedMesh& mesh, const std::vector<uint_t>& selection)
+{
+    std::vector<uint_t> offsets(1,0);
+    offsets.reserve(selection.size()+1);
+    std::vector<uint_t> corners, normalCorners, colorCorners, texCoordCorners;
+    corners.reserve(mesh.corners.size());
+    for(std::vector<uint_t>::const_iterator it = selection.begin(); it != selection.end(); ++it){
+        uint_t first = mesh.offsets[*it], last = mesh.offsets[*it+1];
+        corners.insert(corners.end(), mesh.corners.begin()+first, mesh.corners.begin()+last);
+        if (!mesh.normalCorners.empty()) normalCorners.insert(normalCorners.end(), mesh.normalCorners.begin()+first, mesh.normalCorners.begin()+last);
+        if (!mesh.colorCorners.empty()) colorCorners.insert(colorCorners.end(), mesh.colorCorners.begin()+first, mesh.colorCorners.begin()+last);
+        if (!mesh.texCoordCorners.empty()) texCoordCorners.insert(texCoordCorners.end(), mesh.texCoordCorners.begin()+first, mesh.texCoordCorners.begin()+last);
+        offsets.push_back(corners.size());
+    }
+    mesh.offsets.swap(offsets);
+    mesh.corners.swap(corners);
+    mesh.normalCorners.swap(normalCorners);
+    mesh.colorCorners.swap(colorCorners);
+    mesh.texCoordCorners.swap(texCoordCorners);
+    if (mesh.normalBinding == OptimizedMesh::PER_FACE) mesh.normals = select_values(mesh.normals, selection);
+    if (mesh.colorBinding == OptimizedMesh::PER_FACE) mesh.colors = select_values(mesh.colors, selection);
+}
+
+/* ----------------------------------------------------------------------- */
+
+inline uint64_t weld_cell_key(int64_t x, int64_t y, int64_t z)
+{
+    return uint64_t(x) * 73856093ULL ^ uint64_t(y) * 19349663ULL ^ uint64_t(z) * 83492791ULL;
+}
+
+/*
+   Merges the points closer than tolerance. Representatives of the welded points
+   are stored in a spatial hash of cells of 4 * tolerance. Only the neighbor cells
+   closer than tolerance to the point are visited. Collisions of the hash only
+   cost extra distance tests.
+*/
+uint_t weld_points(OptimizedMesh& mesh, real_t tolerance)
+{
+    const Point3Array& points = *mesh.points;
+    uint_t nbPoints = points.size();
+    real_t sqtolerance = tolerance * tolerance;
+    real_t cellsize = (tolerance > 0 ? 4 * tolerance : 1);
+
+    pgl_hash_map<uint64_t,uint_t> cells;
+    std::vector<uint_t> nextInCell(nbPoints, NO_ID);
+    std::vector<uint_t> remap(nbPoints, NO_ID);
+    std::vector<uint_t> representatives;
+
+    for(uint_t i = 0; i < nbPoints; ++i){
+        const Vector3& p = points.getAt(i);
+        int64_t cell[3], low[3], high[3];
+        for(int k = 0; k < 3; ++k){
+            cell[k] = (int64_t)floor(p[k] / cellsize);
+            low[k]  = (p[k] - tolerance < cell[k] * cellsize ? -1 : 0);
+            high[k] = (p[k] + tolerance >= (cell[k] + 1) * cellsize ? 1 : 0);
+        }
+        uint_t found = NO_ID;
+        for(int64_t dx = low[0]; dx <= high[0] && found == NO_ID; ++dx)
+          for(int64_t dy = low[1]; dy <= high[1] && found == NO_ID; ++dy)
+            for(int64_t dz = low[2]; dz <= high[2] && found == NO_ID; ++dz){
+                pgl_hash_map<uint64_t,uint_t>::const_iterator itcell = cells.find(weld_cell_key(cell[0]+dx,cell[1]+dy,cell[2]+dz));
+                if (itcell == cells.end()) continue;
+                for(uint_t r = itcell->second; r != NO_ID; r = nextInCell[r]){
+                    if (normSquared(points.getAt(r) - p) <= sqtolerance && mesh.sameAttributes(r,i,sqtolerance)) {
+                        found = r; break;
+                    }
+                }
+            }
+        if (found != NO_ID) remap[i] = remap[found];
+        else {
+            remap[i] = representatives.size();
+            representatives.push_back(i);
+            uint_t& head = cells.insert(std::pair<uint64_t,uint_t>(weld_cell_key(cell[0],cell[1],cell[2]),NO_ID)).first->second;
+            nextInCell[i] = head;
+            head = i;
+        }
+    }
+
+    if (representatives.size() == nbPoints) return 0;
+
+    for(std::vector<uint_t>::iterator it = mesh.corners.begin(); it != mesh.corners.end(); ++it)
+        *it = remap[*it];
+    select_vertices(mesh, representatives);
+    return nbPoints - representatives.size();
+}
+
+/*
+   Removes the faces with less than 3 distinct points and the triangles with a
+   null area. If variableSize, repeated consecutive points of a face are removed first.
+*/
+uint_t remove_degenerated_faces(OptimizedMesh& mesh, bool variableSize)
+{
+    if (variableSize) {
+        // compact the corners of each face in place
+        std::vector<uint_t> offsets(1,0);
+        offsets.reserve(mesh.offsets.size());
+        uint_t pos = 0;
+        for(uint_t f = 0; f < mesh.nbFaces(); ++f){
+            uint_t first = pos;
+            uint_t last = mesh.offsets[f+1];
+            for(uint_t c = mesh.offsets[f]; c < last; ++c){
+                if (pos > first && mesh.corners[c] == mesh.corners[pos-1]) continue;
+                mesh.corners[pos] = mesh.corners[c];
+                if (!mesh.normalCorners.empty()) mesh.normalCorners[pos] = mesh.normalCorners[c];
+                if (!mesh.colorCorners.empty()) mesh.colorCorners[pos] = mesh.colorCorners[c];
+                if (!mesh.texCoordCorners.empty()) mesh.texCoordCorners[pos] = mesh.texCoordCorners[c];
+                ++pos;
+            }
+            while (pos - first > 1 && mesh.corners[pos-1] == mesh.corners[first]) --pos;
+            offsets.push_back(pos);
+        }
+        mesh.offsets.swap(offsets);
+        mesh.corners.resize(pos);
+        if (!mesh.normalCorners.empty()) mesh.normalCorners.resize(pos);
+        if (!mesh.colorCorners.empty()) mesh.colorCorners.resize(pos);
+        if (!mesh.texCoordCorners.empty()) mesh.texCoordCorners.resize(pos);
+    }
+
+    std::vector<uint_t> kept;
+    kept.reserve(mesh.nbFaces());
+    for(uint_t f = 0; f < mesh.nbFaces(); ++f){
+        const uint_t * corners = &mesh.corners[0] + mesh.offsets[f];
+        uint_t size = mesh.faceSize(f);
+        uint_t nbDistinct = 0;
+        for(uint_t i = 0; i < size; ++i){
+            bool repeated = false;
+            for(uint_t j = 0; j < i && !repeated; ++j) repeated = (corners[i] == corners[j]);
+            if (!repeated) ++nbDistinct;
+        }
+        if (nbDistinct < 3) continue;
+        if (size == 3) {
+            const Vector3& a = mesh.points->getAt(corners[0]);
+            if (normSquared(cross(mesh.points->getAt(corners[1]) - a, mesh.points->getAt(corners[2]) - a)) == 0) continue;
+        }
+        kept.push_back(f);
+    }
+    uint_t nbRemoved = mesh.nbFaces() - kept.size();
+    if (nbRemoved > 0) select_faces(mesh, kept);
+    return nbRemoved;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/*
+   Face ordering of T. Forsyth, Linear-Speed Vertex Cache Optimisation.
+   Vertices are scored according to their position in a simulated LRU cache and
+   to the number of faces still using them. The next face is the best scored face
+   among the faces of the vertices in cache. Scores are updated incrementally.
+*/
+std::vector<uint_t> forsyth_face_order(const OptimizedMesh& mesh, uint_t cacheSize)
+{
+    const float CacheDecayPower = 1.5f;
+    const float LastFaceScore = 0.75f;
+    const float ValenceBoostScale = 2.0f;
+    const float ValenceBoostPower = 0.5f;
+    const uint_t LastFaceSize = 3;
+    const uint_t MaxValenceInTable = 64;
+
+    uint_t nbFaces = mesh.nbFaces();
+    uint_t nbPoints = mesh.points->size();
+    cacheSize = std::max<uint_t>(cacheSize, LastFaceSize + 1);
+
+    std::vector<float> cacheScore(cacheSize);
+    for(uint_t i = 0; i < cacheSize; ++i)
+        cacheScore[i] = (i < LastFaceSize ? LastFaceScore :
+                         pow(1.0f - float(i - LastFaceSize) / float(cacheSize - LastFaceSize), CacheDecayPower));
+    std::vector<float> valenceScore(MaxValenceInTable);
+    for(uint_t i = 1; i < MaxValenceInTable; ++i)
+        valenceScore[i] = ValenceBoostScale * pow(float(i), -ValenceBoostPower);
+
+    // faces around each point. The first remaining[v] are the faces not yet emitted.
+    std::vector<uint_t> vfOffsets(nbPoints+1, 0);
+    for(std::vector<uint_t>::const_iterator it = mesh.corners.begin(); it != mesh.corners.end(); ++it)
+        ++vfOffsets[*it+1];
+    for(uint_t v = 0; v < nbPoints; ++v) vfOffsets[v+1] += vfOffsets[v];
+    std::vector<uint_t> vfFaces(mesh.corners.size());
+    std::vector<uint_t> remaining(nbPoints, 0);
+    for(uint_t f = 0; f < nbFaces; ++f)
+        for(uint_t c = mesh.offsets[f]; c < mesh.offsets[f+1]; ++c){
+            uint_t v = mesh.corners[c];
+            vfFaces[vfOffsets[v] + remaining[v]++] = f;
+        }
+
+    std::vector<int> cachePosition(nbPoints, -1);
+    std::vector<float> vertexScore(nbPoints, 0);
+    std::vector<float> faceScore(nbFaces, 0);
+    std::vector<bool> emitted(nbFaces, false);
+
+    #define VERTEX_SCORE(v) (remaining[v] == 0 ? -1.0f : \
+            (cachePosition[v] < 0 ? 0.0f : cacheScore[cachePosition[v]]) + \
+            (remaining[v] < MaxValenceInTable ? valenceScore[remaining[v]] : ValenceBoostScale * pow(float(remaining[v]), -ValenceBoostPower)))
+
+    for(uint_t v = 0; v < nbPoints; ++v) vertexScore[v] = VERTEX_SCORE(v);
+    uint_t best = NO_ID;
+    float bestScore = -1;
+    for(uint_t f = 0; f < nbFaces; ++f){
+        for(uint_t c = mesh.offsets[f]; c < mesh.offsets[f+1]; ++c)
+            faceScore[f] += vertexScore[mesh.corners[c]];
+        if (faceScore[f] > bestScore) { bestScore = faceScore[f]; best = f; }
+    }
+
+    std::vector<uint_t> order;
+    order.reserve(nbFaces);
+    std::vector<uint_t> cache, newCache;
+    uint_t cursor = 0;
+
+    while(order.size() < nbFaces){
+        if (best == NO_ID) {
+            while(emitted[cursor]) ++cursor;
+            best = cursor;
+        }
+        uint_t face = best;
+        emitted[face] = true;
+        order.push_back(face);
+
+        newCache.clear();
+        for(uint_t c = mesh.offsets[face]; c < mesh.offsets[face+1]; ++c){
+            uint_t v = mesh.corners[c];
+            uint_t * faces = &vfFaces[vfOffsets[v]];
+            for(uint_t k = 0; k < remaining[v]; ++k)
+                if (faces[k] == face) { std::swap(faces[k], faces[remaining[v]-1]); --remaining[v]; break; }
+            if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) newCache.push_back(v);
+        }
+        for(std::vector<uint_t>::const_iterator it = cache.begin(); it != cache.end(); ++it)
+            if (std::find(newCache.begin(), newCache.end(), *it) == newCache.end()) newCache.push_back(*it);
+
+        for(uint_t i = 0; i < newCache.size(); ++i)
+            cachePosition[newCache[i]] = (i < cacheSize ? int(i) : -1);
+
+        best = NO_ID;
+        bestScore = -1;
+        for(uint_t i = 0; i < newCache.size(); ++i){
+            uint_t v = newCache[i];
+            float score = VERTEX_SCORE(v);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            const uint_t * faces = &vfFaces[vfOffsets[v]];
+            for(uint_t k = 0; k < remaining[v]; ++k){
+                float& fscore = faceScore[faces[k]];
+                fscore += delta;
+                if (i < cacheSize && fscore > bestScore) { bestScore = fscore; best = faces[k]; }
+            }
+        }
+        if (newCache.size() > cacheSize) newCache.resize(cacheSize);
+        cache.swap(newCache);
+    }
+    #undef VERTEX_SCORE
+    return order;
+}
+
+// Renumbers the points in the order of their first use. Returns the number of unused points.
+uint_t reorder_vertices(OptimizedMesh& mesh)
+{
+    uint_t nbPoints = mesh.points->size();
+    std::vector<uint_t> remap(nbPoints, NO_ID);
+    std::vector<uint_t> selection;
+    selection.reserve(nbPoints);
+    for(std::vector<uint_t>::iterator it = mesh.corners.begin(); it != mesh.corners.end(); ++it){
+        if (remap[*it] == NO_ID) { remap[*it] = selection.size(); selection.push_back(*it); }
+        *it = remap[*it];
+    }
+    select_vertices(mesh, selection);
+    return nbPoints - selection.size();
+}
+
+/* ----------------------------------------------------------------------- */
+
+MeshOptimizer::MeshOptimizer( real_t weldTolerance, uint_t cacheSize ) :
+    __weldTolerance(weldTolerance),
+    __cacheSize(cacheSize),
+    __weld(true),
+    __removeDegenerated(true),
+    __reorder(true),
+    __nbRemovedPoints(0),
+    __nbRemovedFaces(0)
+{
+}
+
+template<class MeshType>
+RCPtr<MeshType> MeshOptimizer::process( const MeshType& model )
+{
+    __nbRemovedPoints = 0;
+    __nbRemovedFaces = 0;
+    if (!model.getPointList() || !model.getIndexList()) return RCPtr<MeshType>();
+
+    OptimizedMesh mesh;
+    read_mesh(model, mesh);
+    bool variableSize = has_variable_face_size(*model.getIndexList());
+
+    if (__weld) __nbRemovedPoints += weld_points(mesh, __weldTolerance);
+    if (__removeDegenerated) __nbRemovedFaces += remove_degenerated_faces(mesh, variableSize);
+    if (mesh.nbFaces() == 0) return RCPtr<MeshType>();
+    if (__reorder) {
+        select_faces(mesh, forsyth_face_order(mesh, __cacheSize));
+        __nbRemovedPoints += reorder_vertices(mesh);
+    }
+
+    return write_mesh(model, mesh);
+}
+
+TriangleSetPtr MeshOptimizer::optimize( const TriangleSet& mesh )
+{ return process(mesh); }
+
+QuadSetPtr MeshOptimizer::optimize( const QuadSet& mesh )
+{ return process(mesh); }
+
+FaceSetPtr MeshOptimizer::optimize( const FaceSet& mesh )
+{ return process(mesh); }
+
+ExplicitModelPtr MeshOptimizer::optimize( const ExplicitModelPtr& mesh )
+{
+    TriangleSetPtr triangleset = dynamic_pointer_cast<TriangleSet>(mesh);
+    if (triangleset) return ExplicitModelPtr(optimize(*triangleset).get());
+    QuadSetPtr quadset = dynamic_pointer_cast<QuadSet>(mesh);
+    if (quadset) return ExplicitModelPtr(optimize(*quadset).get());
+    FaceSetPtr faceset = dynamic_pointer_cast<FaceSet>(mesh);
+    if (faceset) return ExplicitModelPtr(optimize(*faceset).get());
+    return ExplicitModelPtr();
+}
+
+real_t MeshOptimizer::averageCacheMissRatio( const MeshPtr& mesh, uint_t cacheSize )
+{
+    if (!mesh || mesh->getIndexListSize() == 0) return 0;
+    // a point is in the FIFO cache if less than cacheSize misses occured since its insertion.
+    std::vector<uint_t> insertion(mesh->getPointList()->size(), NO_ID);
+    uint_t nbMisses = 0;
+    for(uint_t f = 0; f < mesh->getIndexListSize(); ++f)
+        for(uint_t i = 0; i < mesh->getFaceSize(f); ++i){
+            uint_t v = mesh->getFacePointIndexAt(f,i);
+            if (insertion[v] == NO_ID || nbMisses - insertion[v] >= cacheSize)
+                insertion[v] = nbMisses++;
+        }
+    return real_t(nbMisses) / mesh->getIndexListSize();
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,152 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file meshoptimizer.h
+    \brief Welding, cleaning and reordering of meshes.
+*/
+
+#ifndef __algo_meshoptimizer_h__
+#define __algo_meshoptimizer_h__
+
+#include "../algo_config.h"
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/faceset.h>
+#include <plantgl/scenegraph/geometry/quadset.h>
+
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class MeshOptimizer
+   \brief An algorithm which produces an optimized copy of a TriangleSet, a QuadSet or a FaceSet.
+
+   The following steps are applied:
+   - points closer than the welding tolerance, and having the same per vertex
+     normal, color and texture coordinates, are merged. Points are searched using
+     a spatial hash, so the welding is linear in the number of points.
+   - degenerated faces (with less than 3 distinct points or, for triangles, a null area)
+     are removed. Repeated consecutive points of polygons of FaceSet are removed.
+   - faces are reordered to maximize the reuse of the post-transform vertex cache
+     (T. Forsyth, Linear-Speed Vertex Cache Optimisation).
+   - points are renumbered in the order of their first use by the faces, so that
+     vertex fetches are sequential. Unused points are removed.
+
+   Per face and per corner (i.e. indexed) attributes are kept along their faces.
+   A null pointer is returned if no valid face remains.
+*/
+
+class ALGO_API MeshOptimizer
+{
+
+public:
+
+    /// The default welding tolerance.
+    static const real_t DEFAULT_WELD_TOLERANCE;
+
+    /// The default size of the simulated vertex cache.
+    static const uint_t DEFAULT_CACHE_SIZE;
+
+    /// Constructor.
+    MeshOptimizer( real_t weldTolerance = DEFAULT_WELD_TOLERANCE,
+                   uint_t cacheSize = DEFAULT_CACHE_SIZE );
+
+    /// Destructor.
+    virtual ~MeshOptimizer( ) {}
+
+    /// Returns an optimized copy of \e mesh. Returns a null pointer if \e mesh is not a mesh.
+    ExplicitModelPtr optimize( const ExplicitModelPtr& mesh );
+
+    /// Returns an optimized copy of \e mesh.
+    TriangleSetPtr optimize( const TriangleSet& mesh );
+
+    /// Returns an optimized copy of \e mesh.
+    QuadSetPtr optimize( const QuadSet& mesh );
+
+    /// Returns an optimized copy of \e mesh.
+    FaceSetPtr optimize( const FaceSet& mesh );
+
+    /// Returns the welding tolerance. A null tolerance merges identical points only.
+    inline real_t getWeldTolerance( ) const { return __weldTolerance; }
+    inline void setWeldTolerance( real_t tolerance ) { __weldTolerance = tolerance; }
+
+    /// Returns the size of the vertex cache used to reorder faces.
+    inline uint_t getCacheSize( ) const { return __cacheSize; }
+    inline void setCacheSize( uint_t size ) { __cacheSize = size; }
+
+    /// Enables or disables each step of the optimization.
+    inline bool isWeldingEnabled( ) const { return __weld; }
+    inline void setWeldingEnabled( bool enabled ) { __weld = enabled; }
+
+    inline bool isDegeneratedRemovalEnabled( ) const { return __removeDegenerated; }
+    inline void setDegeneratedRemovalEnabled( bool enabled ) { __removeDegenerated = enabled; }
+
+    inline bool isReorderingEnabled( ) const { return __reorder; }
+    inline void setReorderingEnabled( bool enabled ) { __reorder = enabled; }
+
+    /// Returns the number of points removed by the last optimization.
+    inline uint_t getNbRemovedPoints( ) const { return __nbRemovedPoints; }
+
+    /// Returns the number of faces removed by the last optimization.
+    inline uint_t getNbRemovedFaces( ) const { return __nbRemovedFaces; }
+
+    /** Returns the average number of cache misses per face obtained when drawing
+        \e mesh with a FIFO vertex cache of size \e cacheSize. */
+    static real_t averageCacheMissRatio( const MeshPtr& mesh, uint_t cacheSize = DEFAULT_CACHE_SIZE );
+
+protected:
+
+    template<class MeshType>
+    RCPtr<MeshType> process( const MeshType& mesh );
+
+    real_t __weldTolerance;
+    uint_t __cacheSize;
+    bool __weld;
+    bool __removeDegenerated;
+    bool __reorder;
+
+    uint_t __nbRemovedPoints;
+    uint_t __nbRemovedFaces;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __algo_meshoptimizer_h__
+#endif
+
@@ -0,0 +1,650 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "meshsimplifier.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/scenegraph/container/colorarray.h>
+#include <algorithm>
+#include <queue>
+#include <float.h>
+#include <math.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const real_t MeshSimplifier::DEFAULT_BOUNDARY_WEIGHT(10);
+
+#define NO_ID UINT32_MAX
+
+// Weight of the squared distance of points to their original position, relatively to the
+// distance to the planes. It favors short edges in flat regions, where the quadrics vanish.
+#define POINT_WEIGHT 1e-6
+
+// Minimal cosine between the normals of a triangle before and after a collapse.
+#define MIN_NORMAL_COSINE 0.25
+
+/* ----------------------------------------------------------------------- */
+
+/*
+   Symmetric quadric Q(v) = vAv + 2bv + c accumulating squared distances to planes,
+   with the total weight of the faces which contributed to it.
+*/
+struct Quadric {
+    double a00, a01, a02, a11, a12, a22, b0, b1, b2, c, w;
+
+    Quadric() : a00(0), a01(0), a02(0), a11(0), a12(0), a22(0), b0(0), b1(0), b2(0), c(0), w(0) {}
+
+    // Quadric of the plane n.v + d = 0, with n normalized, scaled by weight.
+    Quadric(const Vector3& n, double d, double weight, double areaweight) :
+        a00(weight*n.x()*n.x()), a01(weight*n.x()*n.y()), a02(weight*n.x()*n.z()),
+        a11(weight*n.y()*n.y()), a12(weight*n.y()*n.z()), a22(weight*n.z()*n.z()),
+        b0(weight*d*n.x()), b1(weight*d*n.y()), b2(weight*d*n.z()), c(weight*d*d), w(areaweight) {}
+
+    // Quadric of the squared distance to the point p, scaled by weight.
+    Quadric(const Vector3& p, double weight) :
+        a00(weight), a01(0), a02(0), a11(weight), a12(0), a22(weight),
+        b0(-weight*p.x()), b1(-weight*p.y()), b2(-weight*p.z()), c(weight*normSquared(p)), w(0) {}
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2; c += q.c; w += q.w;
+        return *this;
+    }
+
+    Quadric operator+(const Quadric& q) const { Quadric r(*this); r += q; return r; }
+
+    double evaluate(const Vector3& v) const {
+        double x = v.x(), y = v.y(), z = v.z();
+        return x*(a00*x + 2*(a01*y + a02*z + b0)) + y*(a11*y + 2*(a12*z + b1)) + z*(a22*z + 2*b2) + c;
+    }
+
+    // Root mean square distance to the planes.
+    double error(const Vector3& v) const {
+        return sqrt(std::max(0.0, evaluate(v)) / std::max(w, DBL_MIN));
+    }
+
+    // Computes the point minimizing the quadric. Returns false if the system is ill conditioned.
+    bool optimum(Vector3& v) const {
+        double c00 = a11*a22 - a12*a12, c01 = a02*a12 - a01*a22, c02 = a01*a12 - a02*a11;
+        double det = a00*c00 + a01*c01 + a02*c02;
+        double scale = std::max(a00, std::max(a11, a22));
+        if (fabs(det) <= 1e-6 * scale * scale * scale) return false;
+        double c11 = a00*a22 - a02*a02, c12 = a01*a02 - a00*a12, c22 = a00*a11 - a01*a01;
+        v = Vector3(real_t(-(c00*b0 + c01*b1 + c02*b2) / det),
+                    real_t(-(c01*b0 + c11*b1 + c12*b2) / det),
+                    real_t(-(c02*b0 + c12*b1 + c22*b2) / det));
+        return true;
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+inline Vector2 interpolate(const Vector2& a, const Vector2& b, real_t t)
+{ return a + (b - a) * t; }
+
+inline Color4 interpolate(const Color4& a, const Color4& b, real_t t)
+{
+    Color4 result;
+    for (uchar_t i = 0; i < 4; ++i)
+        result[i] = uchar_t(floor(a[i] + (real_t(b[i]) - a[i]) * t + 0.5));
+    return result;
+}
+
+/*
+   An attribute bound to the points, either directly or through corner indices.
+   For indexed attributes, the points whose corners refer to different values are
+   on a seam and are locked.
+*/
+template<class ArrayType>
+struct PointAttribute {
+    typedef typename ArrayType::element_type Value;
+
+    RCPtr<ArrayType> values;
+    std::vector<uint_t> corners;
+    std::vector<Value> pointValues;
+
+    inline bool isValid() const { return is_valid_ptr(values); }
+    inline bool isIndexed() const { return !corners.empty(); }
+
+    // Initializes the attribute and marks the points on a seam in locked.
+    void init(const RCPtr<ArrayType>& _values, const Index3ArrayPtr& indices, uint_t nbPoints,
+              const std::vector<uint_t>& pointCorners, std::vector<bool>& locked) {
+        values = _values;
+        if (!indices) {
+            pointValues.assign(values->begin(), values->end());
+            return;
+        }
+        for (Index3Array::const_iterator it = indices->begin(); it != indices->end(); ++it)
+            corners.insert(corners.end(), it->begin(), it->end());
+        pointValues.resize(nbPoints);
+        std::vector<bool> seen(nbPoints, false);
+        for (uint_t c = 0; c < corners.size(); ++c) {
+            uint_t p = pointCorners[c];
+            const Value& value = values->getAt(corners[c]);
+            if (!seen[p]) { seen[p] = true; pointValues[p] = value; }
+            else if (!(pointValues[p] == value)) locked[p] = true;
+        }
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+/*
+   Working representation of the simplified triangle set.
+*/
+class QuadricDecimation {
+public:
+    enum { REMOVED = 1, LOCKED = 2, BOUNDARY = 4 };
+
+    struct Collapse {
+        float error;
+        uint_t kept;
+        uint_t removed;
+        uint_t stamp; // sum of the stamps of the two points when the collapse was evaluated
+
+        bool operator<(const Collapse& other) const { return error > other.error; }
+    };
+
+    std::vector<Vector3> points;
+    std::vector<uint_t> corners;
+    std::vector<bool> aliveFaces;
+    std::vector<std::vector<uint_t> > pointFaces;
+    std::vector<Quadric> quadrics;
+    std::vector<uchar_t> flags;
+    std::vector<uint_t> stamps;
+    uint_t nbFaces;
+
+    PointAttribute<Point2Array> texCoords;
+    PointAttribute<Color4Array> colors;
+
+    std::priority_queue<Collapse> queue;
+
+    // Scratch marks used to compute the neighborhood of points.
+    std::vector<uint_t> marks;
+    uint_t currentMark;
+    std::vector<uint_t> neighbors;
+
+    bool preserveBoundary;
+    real_t boundaryWeight;
+
+    QuadricDecimation(bool _preserveBoundary, real_t _boundaryWeight) :
+        nbFaces(0), currentMark(0), preserveBoundary(_preserveBoundary), boundaryWeight(_boundaryWeight) {}
+
+    inline bool isRemoved(uint_t p) const { return (flags[p] & REMOVED) != 0; }
+    inline bool isLocked(uint_t p) const { return (flags[p] & LOCKED) != 0; }
+    inline bool isBoundary(uint_t p) const { return (flags[p] & BOUNDARY) != 0; }
+
+    inline bool hasPoint(uint_t f, uint_t p) const {
+        const uint_t * face = &corners[3*f];
+        return face[0] == p || face[1] == p || face[2] == p;
+    }
+
+    inline Vector3 faceNormal(uint_t f) const {
+        const uint_t * face = &corners[3*f];
+        return cross(points[face[1]] - points[face[0]], points[face[2]] - points[face[0]]);
+    }
+
+    inline uint_t nextMark() {
+        if (currentMark >= UINT32_MAX - 2) { std::fill(marks.begin(), marks.end(), 0); currentMark = 0; }
+        return ++currentMark;
+    }
+
+    // Fills neighbors with the points sharing a face with p.
+    void computeNeighbors(uint_t p) {
+        uint_t mark = nextMark();
+        neighbors.clear();
+        const std::vector<uint_t>& faces = pointFaces[p];
+        for (std::vector<uint_t>::const_iterator it = faces.begin(); it != faces.end(); ++it)
+            for (uint_t i = 0; i < 3; ++i) {
+                uint_t q = corners[3 * *it + i];
+                if (q != p && marks[q] != mark) { marks[q] = mark; neighbors.push_back(q); }
+            }
+    }
+
+    void init(const TriangleSet& mesh);
+    void computeQuadrics();
+    bool orient(uint_t u, uint_t v, uint_t& kept, uint_t& removed) const;
+    double evaluate(uint_t kept, uint_t removed, Vector3& target, real_t& t) const;
+    void push(uint_t u, uint_t v);
+    bool isValid(uint_t kept, uint_t removed, const Vector3& target, uint_t& texCoordIndex, uint_t& colorIndex);
+    void apply(uint_t kept, uint_t removed, const Vector3& target, real_t t, uint_t texCoordIndex, uint_t colorIndex);
+    real_t run(uint_t targetNbFaces, real_t maxError);
+    TriangleSetPtr result(const TriangleSet& mesh, uint_t& nbPoints) const;
+};
+
+/* ----------------------------------------------------------------------- */
+
+void QuadricDecimation::init(const TriangleSet& mesh)
+{
+    points.assign(mesh.getPointList()->begin(), mesh.getPointList()->end());
+    uint_t nbPoints = points.size();
+    const Index3ArrayPtr& indices = mesh.getIndexList();
+    corners.reserve(3 * indices->size());
+    for (Index3Array::const_iterator it = indices->begin(); it != indices->end(); ++it)
+        corners.insert(corners.end(), it->begin(), it->end());
+
+    flags.assign(nbPoints, 0);
+    stamps.assign(nbPoints, 0);
+    marks.assign(nbPoints, 0);
+
+    std::vector<bool> locked(nbPoints, false);
+    if (mesh.getTexCoordList())
+        texCoords.init(mesh.getTexCoordList(), mesh.getTexCoordIndexList(), nbPoints, corners, locked);
+    if (mesh.getColorList() && (mesh.getColorIndexList() || mesh.getColorPerVertex()))
+        colors.init(mesh.getColorList(), mesh.getColorIndexList(), nbPoints, corners, locked);
+    for (uint_t p = 0; p < nbPoints; ++p) if (locked[p]) flags[p] |= LOCKED;
+
+    // faces with repeated points are dropped.
+    uint_t nbTotalFaces = indices->size();
+    aliveFaces.assign(nbTotalFaces, false);
+    std::vector<uint_t> valence(nbPoints, 0);
+    for (uint_t f = 0; f < nbTotalFaces; ++f) {
+        const uint_t * face = &corners[3*f];
+        if (face[0] == face[1] || face[1] == face[2] || face[2] == face[0]) continue;
+        aliveFaces[f] = true;
+        ++nbFaces;
+        for (uint_t i = 0; i < 3; ++i) ++valence[face[i]];
+    }
+    pointFaces.resize(nbPoints);
+    for (uint_t p = 0; p < nbPoints; ++p) pointFaces[p].reserve(valence[p]);
+    for (uint_t f = 0; f < nbTotalFaces; ++f)
+        if (aliveFaces[f])
+            for (uint_t i = 0; i < 3; ++i) pointFaces[corners[3*f+i]].push_back(f);
+
+    // points without faces are never considered.
+    for (uint_t p = 0; p < nbPoints; ++p) if (valence[p] == 0) flags[p] |= REMOVED;
+}
+
+void QuadricDecimation::computeQuadrics()
+{
+    uint_t nbPoints = points.size();
+    quadrics.assign(nbPoints, Quadric());
+    for (uint_t f = 0; f < aliveFaces.size(); ++f) {
+        if (!aliveFaces[f]) continue;
+        Vector3 normal = faceNormal(f);
+        real_t area = norm(normal);
+        if (area <= 0) continue;
+        normal /= area;
+        area /= 2;
+        Quadric q(normal, -dot(normal, points[corners[3*f]]), area, area);
+        for (uint_t i = 0; i < 3; ++i) quadrics[corners[3*f+i]] += q;
+    }
+    for (uint_t p = 0; p < nbPoints; ++p)
+        if (!isRemoved(p)) quadrics[p] += Quadric(points[p], POINT_WEIGHT * quadrics[p].w);
+
+    // Edges shared by one face are on the boundary, by more than two faces are non manifold.
+    std::vector<uint_t> counts(nbPoints, 0);
+    for (uint_t p = 0; p < nbPoints; ++p) {
+        if (isRemoved(p)) continue;
+        computeNeighbors(p);
+        const std::vector<uint_t>& faces = pointFaces[p];
+        for (std::vector<uint_t>::const_iterator it = faces.begin(); it != faces.end(); ++it)
+            for (uint_t i = 0; i < 3; ++i) ++counts[corners[3 * *it + i]];
+        for (std::vector<uint_t>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) {
+            if (counts[*it] == 1) flags[p] |= BOUNDARY;
+            else if (counts[*it] > 2) flags[p] |= LOCKED;
+        }
+        // boundary edges are constrained by planes orthogonal to their face.
+        for (std::vector<uint_t>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            const uint_t * face = &corners[3 * *it];
+            for (uint_t i = 0; i < 3; ++i) {
+                uint_t next = face[(i+1)%3];
+                if (face[i] != p || counts[next] != 1) continue;
+                Vector3 edge = points[next] - points[p];
+                Vector3 normal = cross(edge, faceNormal(*it));
+                real_t n = norm(normal);
+                if (n <= 0) continue;
+                normal /= n;
+                Quadric q(normal, -dot(normal, points[p]), boundaryWeight * normSquared(edge), 0);
+                quadrics[p] += q;
+                quadrics[next] += q;
+            }
+        }
+        for (std::vector<uint_t>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it) counts[*it] = 0;
+        counts[p] = 0;
+    }
+    if (preserveBoundary)
+        for (uint_t p = 0; p < nbPoints; ++p) if (isBoundary(p)) flags[p] |= LOCKED;
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Chooses which point of the edge (u,v) is kept. Returns false if the edge cannot be collapsed.
+bool QuadricDecimation::orient(uint_t u, uint_t v, uint_t& kept, uint_t& removed) const
+{
+    if (isLocked(u) && isLocked(v)) return false;
+    if (isLocked(v) || (isBoundary(v) && !isBoundary(u) && !isLocked(u))) { kept = v; removed = u; }
+    else { kept = u; removed = v; }
+    // a boundary point cannot be moved inside the surface.
+    return !isBoundary(removed) || isBoundary(kept);
+}
+
+// Computes the position of the kept point after the collapse and returns the error.
+double QuadricDecimation::evaluate(uint_t kept, uint_t removed, Vector3& target, real_t& t) const
+{
+    Quadric q = quadrics[kept] + quadrics[removed];
+    const Vector3& a = points[kept];
+    const Vector3& b = points[removed];
+    if (isLocked(kept) || (isBoundary(kept) && !isBoundary(removed))) {
+        target = a; t = 0;
+        return q.error(target);
+    }
+    Vector3 edge = b - a;
+    real_t length2 = normSquared(edge);
+
+    target = a; t = 0;
+    double error = q.error(a);
+    double e = q.error(b);
+    if (e < error) { error = e; target = b; t = 1; }
+    Vector3 middle = (a + b) / 2;
+    e = q.error(middle);
+    if (e < error) { error = e; target = middle; t = 0.5; }
+    Vector3 optimum;
+    // the optimum is discarded if it lies far from the edge.
+    if (q.optimum(optimum) && normSquared(optimum - middle) <= 4 * length2) {
+        e = q.error(optimum);
+        if (e < error) {
+            error = e;
+            target = optimum;
+            t = (length2 > 0 ? std::min<real_t>(1, std::max<real_t>(0, dot(optimum - a, edge) / length2)) : 0);
+        }
+    }
+    return error;
+}
+
+void QuadricDecimation::push(uint_t u, uint_t v)
+{
+    uint_t kept, removed;
+    if (!orient(u, v, kept, removed)) return;
+    Vector3 target; real_t t;
+    Collapse collapse;
+    collapse.error = float(evaluate(kept, removed, target, t));
+    collapse.kept = kept;
+    collapse.removed = removed;
+    collapse.stamp = stamps[kept] + stamps[removed];
+    queue.push(collapse);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/*
+   Checks that the collapse keeps the surface manifold (link condition) and does
+   not flip any triangle. Determines the corner indices of the kept point for the
+   indexed attributes.
+*/
+bool QuadricDecimation::isValid(uint_t kept, uint_t removed, const Vector3& target,
+                                uint_t& texCoordIndex, uint_t& colorIndex)
+{
+    uint_t mark = nextMark();
+    uint_t common = nextMark();
+    const std::vector<uint_t>& keptFaces = pointFaces[kept];
+    const std::vector<uint_t>& removedFaces = pointFaces[removed];
+    for (std::vector<uint_t>::const_iterator it = keptFaces.begin(); it != keptFaces.end(); ++it)
+        for (uint_t i = 0; i < 3; ++i) marks[corners[3 * *it + i]] = mark;
+
+    uint_t nbCommon = 0, nbShared = 0;
+    texCoordIndex = NO_ID; colorIndex = NO_ID;
+    for (std::vector<uint_t>::const_iterator it = removedFaces.begin(); it != removedFaces.end(); ++it) {
+        uint_t f = *it;
+        const uint_t * face = &corners[3*f];
+        for (uint_t i = 0; i < 3; ++i)
+            if (face[i] != kept && face[i] != removed && marks[face[i]] == mark) { marks[face[i]] = common; ++nbCommon; }
+        if (!hasPoint(f, kept)) continue;
+        ++nbShared;
+        for (uint_t i = 0; i < 3; ++i) {
+            if (face[i] != kept) continue;
+            // the corners of the kept point must agree on both sides of the edge.
+            if (texCoords.isIndexed()) {
+                if (texCoordIndex != NO_ID && texCoordIndex != texCoords.corners[3*f+i]) return false;
+                texCoordIndex = texCoords.corners[3*f+i];
+            }
+            if (colors.isIndexed()) {
+                if (colorIndex != NO_ID && colorIndex != colors.corners[3*f+i]) return false;
+                colorIndex = colors.corners[3*f+i];
+            }
+        }
+    }
+    // the only points adjacent to both must be the opposite points of the shared faces.
+    if (nbShared == 0 || nbCommon != nbShared) return false;
+    // a closed tetrahedron would collapse into two identical faces.
+    if (nbShared == 2 && keptFaces.size() == 3 && removedFaces.size() == 3) return false;
+    if (isBoundary(removed) && nbShared != 1) return false;
+
+    // triangles which are moved must not flip or degenerate.
+    for (uint_t k = 0; k < 2; ++k) {
+        uint_t moved = (k == 0 ? kept : removed);
+        const std::vector<uint_t>& faces = pointFaces[moved];
+        for (std::vector<uint_t>::const_iterator it = faces.begin(); it != faces.end(); ++it) {
+            if (k == 1 && hasPoint(*it, kept)) continue;
+            if (k == 0 && hasPoint(*it, removed)) continue;
+            const uint_t * face = &corners[3 * *it];
+            Vector3 p[3];
+            for (uint_t i = 0; i < 3; ++i) p[i] = (face[i] == moved ? target : points[face[i]]);
+            Vector3 before = faceNormal(*it);
+            Vector3 after = cross(p[1] - p[0], p[2] - p[0]);
+            real_t d = dot(before, after);
+            if (d <= 0 || d * d < MIN_NORMAL_COSINE * MIN_NORMAL_COSINE * normSquared(before) * normSquared(after)) return false;
+        }
+    }
+    return true;
+}
+
+void QuadricDecimation::apply(uint_t kept, uint_t removed, const Vector3& target, real_t t,
+                              uint_t texCoordIndex, uint_t colorIndex)
+{
+    std::vector<uint_t>& keptFaces = pointFaces[kept];
+    std::vector<uint_t>& removedFaces = pointFaces[removed];
+    for (std::vector<uint_t>::const_iterator it = removedFaces.begin(); it != removedFaces.end(); ++it) {
+        uint_t f = *it;
+        if (hasPoint(f, kept)) {
+            aliveFaces[f] = false;
+            --nbFaces;
+            // the collapsed face is also dropped from the faces of its third point.
+            for (uint_t c = 3*f; c < 3*f+3; ++c) {
+                if (corners[c] == kept || corners[c] == removed) continue;
+                std::vector<uint_t>& faces = pointFaces[corners[c]];
+                faces.erase(std::remove(faces.begin(), faces.end(), f), faces.end());
+            }
+            continue;
+        }
+        for (uint_t c = 3*f; c < 3*f+3; ++c) {
+            if (corners[c] != removed) continue;
+            corners[c] = kept;
+            if (texCoords.isIndexed()) texCoords.corners[c] = texCoordIndex;
+            if (colors.isIndexed()) colors.corners[c] = colorIndex;
+        }
+        keptFaces.push_back(f);
+    }
+    std::vector<uint_t>().swap(removedFaces);
+    std::vector<uint_t>::iterator last = keptFaces.begin();
+    for (std::vector<uint_t>::const_iterator it = keptFaces.begin(); it != keptFaces.end(); ++it)
+        if (aliveFaces[*it]) *last++ = *it;
+    keptFaces.erase(last, keptFaces.end());
+
+    points[kept] = target;
+    quadrics[kept] += quadrics[removed];
+    if (texCoords.isValid()) texCoords.pointValues[kept] = interpolate(texCoords.pointValues[kept], texCoords.pointValues[removed], t);
+    if (colors.isValid()) colors.pointValues[kept] = interpolate(colors.pointValues[kept], colors.pointValues[removed], t);
+    flags[removed] |= REMOVED;
+    ++stamps[kept];
+    ++stamps[removed];
+
+    computeNeighbors(kept);
+    for (std::vector<uint_t>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+        push(kept, *it);
+}
+
+real_t QuadricDecimation::run(uint_t targetNbFaces, real_t maxError)
+{
+    for (uint_t p = 0; p < points.size(); ++p) {
+        if (isRemoved(p)) continue;
+        computeNeighbors(p);
+        for (std::vector<uint_t>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+            if (p < *it) push(p, *it);
+    }
+
+    real_t maxReachedError = 0;
+    while (nbFaces > targetNbFaces && !queue.empty()) {
+        Collapse collapse = queue.top();
+        if (collapse.error > maxError) break;
+        queue.pop();
+        uint_t kept = collapse.kept, removed = collapse.removed;
+        if (isRemoved(kept) || isRemoved(removed) || collapse.stamp != stamps[kept] + stamps[removed]) continue;
+
+        Vector3 target; real_t t;
+        evaluate(kept, removed, target, t);
+        uint_t texCoordIndex, colorIndex;
+        if (!isValid(kept, removed, target, texCoordIndex, colorIndex)) continue;
+        apply(kept, removed, target, t, texCoordIndex, colorIndex);
+        maxReachedError = std::max<real_t>(maxReachedError, collapse.error);
+    }
+    return maxReachedError;
+}
+
+/* ----------------------------------------------------------------------- */
+
+template<class ArrayType>
+RCPtr<ArrayType> write_attribute(const PointAttribute<ArrayType>& attribute, const std::vector<uint_t>& selection,
+                                 const std::vector<uint_t>& pointCorners, const std::vector<bool>& aliveFaces,
+                                 const std::vector<uchar_t>& flags, Index3ArrayPtr& indices)
+{
+    if (!attribute.isIndexed()) {
+        RCPtr<ArrayType> result(new ArrayType(selection.size()));
+        for (uint_t i = 0; i < selection.size(); ++i) result->setAt(i, attribute.pointValues[selection[i]]);
+        return result;
+    }
+    // corners of unlocked points refer to the value of their point, other corners keep their value.
+    RCPtr<ArrayType> result(new ArrayType());
+    std::vector<uint_t> pointIds(flags.size(), NO_ID), valueIds(attribute.values->size(), NO_ID);
+    indices = Index3ArrayPtr(new Index3Array());
+    for (uint_t f = 0; f < aliveFaces.size(); ++f) {
+        if (!aliveFaces[f]) continue;
+        Index3 face;
+        for (uint_t i = 0; i < 3; ++i) {
+            uint_t p = pointCorners[3*f+i];
+            uint_t& id = ((flags[p] & QuadricDecimation::LOCKED) ? valueIds[attribute.corners[3*f+i]] : pointIds[p]);
+            if (id == NO_ID) {
+                id = result->size();
+                result->push_back((flags[p] & QuadricDecimation::LOCKED) ? attribute.values->getAt(attribute.corners[3*f+i]) : attribute.pointValues[p]);
+            }
+            face[i] = id;
+        }
+        indices->push_back(face);
+    }
+    return result;
+}
+
+TriangleSetPtr QuadricDecimation::result(const TriangleSet& mesh, uint_t& nbPoints) const
+{
+    if (nbFaces == 0) { nbPoints = 0; return TriangleSetPtr(); }
+    // points keep their relative order.
+    std::vector<bool> used(points.size(), false);
+    for (uint_t f = 0; f < aliveFaces.size(); ++f)
+        if (aliveFaces[f])
+            for (uint_t i = 0; i < 3; ++i) used[corners[3*f+i]] = true;
+    std::vector<uint_t> remap(points.size(), NO_ID), selection;
+    Point3ArrayPtr resultPoints(new Point3Array());
+    for (uint_t p = 0; p < points.size(); ++p)
+        if (used[p]) { remap[p] = selection.size(); selection.push_back(p); resultPoints->push_back(points[p]); }
+
+    Index3ArrayPtr resultIndices(new Index3Array());
+    resultIndices->reserve(nbFaces);
+    for (uint_t f = 0; f < aliveFaces.size(); ++f)
+        if (aliveFaces[f])
+            resultIndices->push_back(Index3(remap[corners[3*f]], remap[corners[3*f+1]], remap[corners[3*f+2]]));
+    nbPoints = selection.size();
+
+    Point2ArrayPtr resultTexCoords;
+    Index3ArrayPtr resultTexCoordIndices;
+    if (texCoords.isValid())
+        resultTexCoords = write_attribute(texCoords, selection, corners, aliveFaces, flags, resultTexCoordIndices);
+
+    Color4ArrayPtr resultColors;
+    Index3ArrayPtr resultColorIndices;
+    if (colors.isValid())
+        resultColors = write_attribute(colors, selection, corners, aliveFaces, flags, resultColorIndices);
+    else if (mesh.getColorList()) {
+        resultColors = Color4ArrayPtr(new Color4Array());
+        for (uint_t f = 0; f < aliveFaces.size(); ++f)
+            if (aliveFaces[f]) resultColors->push_back(mesh.getColorList()->getAt(f));
+    }
+
+    TriangleSetPtr result(new TriangleSet(resultPoints, resultIndices,
+                                          Point3ArrayPtr(), Index3ArrayPtr(),
+                                          resultColors, resultColorIndices,
+                                          resultTexCoords, resultTexCoordIndices,
+                                          mesh.getNormalPerVertex(),
+                                          mesh.getColorPerVertex(),
+                                          mesh.getCCW(),
+                                          mesh.getSolid(),
+                                          mesh.getSkeleton()));
+    result->setName(mesh.getName());
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+MeshSimplifier::MeshSimplifier( uint_t targetNbFaces, real_t maxError ) :
+    __targetNbFaces(targetNbFaces),
+    __maxError(maxError),
+    __preserveBoundary(false),
+    __boundaryWeight(DEFAULT_BOUNDARY_WEIGHT),
+    __nbRemovedPoints(0),
+    __nbRemovedFaces(0),
+    __error(0)
+{
+}
+
+TriangleSetPtr MeshSimplifier::simplify( const TriangleSet& mesh )
+{
+    __nbRemovedPoints = 0;
+    __nbRemovedFaces = 0;
+    __error = 0;
+    if (!mesh.getPointList() || !mesh.getIndexList()) return TriangleSetPtr();
+
+    QuadricDecimation decimation(__preserveBoundary, __boundaryWeight);
+    decimation.init(mesh);
+    decimation.computeQuadrics();
+    __error = decimation.run(__targetNbFaces, __maxError);
+
+    uint_t nbPoints = 0;
+    TriangleSetPtr result = decimation.result(mesh, nbPoints);
+    __nbRemovedPoints = mesh.getPointList()->size() - nbPoints;
+    __nbRemovedFaces = mesh.getIndexList()->size() - decimation.nbFaces;
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,132 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file meshsimplifier.h
+    \brief Quadric error edge collapse simplification of triangle sets.
+*/
+
+#ifndef __algo_meshsimplifier_h__
+#define __algo_meshsimplifier_h__
+
+#include "../algo_config.h"
+#include <plantgl/scenegraph/geometry/triangleset.h>
+
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class MeshSimplifier
+   \brief An algorithm which decimates a TriangleSet by successive edge collapses
+   (M. Garland and P. Heckbert, Surface Simplification Using Quadric Error Metrics).
+
+   Each point accumulates the area weighted quadrics of the planes of its faces.
+   The error of a collapse is the root mean square distance of the resulting point
+   to these planes. Collapses are applied by increasing error, using a priority queue
+   with lazy invalidation, until the number of triangles reaches the target or the
+   error exceeds the maximal error.
+
+   Collapses which would make the surface non manifold or flip a triangle are rejected.
+   Boundary edges are kept in place by additional weighted planes orthogonal to their face.
+   If the boundary is preserved, boundary points are never moved nor removed.
+   Texture coordinates and colors bound to the points are interpolated along collapsed edges.
+   Points on a seam of indexed texture coordinates or colors are kept unchanged.
+   Per face colors are kept along their faces. Normals are not kept and are computed again.
+*/
+
+class ALGO_API MeshSimplifier
+{
+
+public:
+
+    /// The default weight of the planes along boundary edges.
+    static const real_t DEFAULT_BOUNDARY_WEIGHT;
+
+    /// Constructor. A null target means that only the maximal error stops the simplification.
+    MeshSimplifier( uint_t targetNbFaces = 0,
+                    real_t maxError = REAL_MAX );
+
+    /// Destructor.
+    virtual ~MeshSimplifier( ) {}
+
+    /// Returns a simplified copy of \e mesh.
+    TriangleSetPtr simplify( const TriangleSet& mesh );
+
+    /// Returns the number of triangles to reach.
+    inline uint_t getTargetNbFaces( ) const { return __targetNbFaces; }
+    inline void setTargetNbFaces( uint_t nbfaces ) { __targetNbFaces = nbfaces; }
+
+    /// Returns the maximal error (a distance) allowed for a collapse.
+    inline real_t getMaxError( ) const { return __maxError; }
+    inline void setMaxError( real_t error ) { __maxError = error; }
+
+    /// Returns whether the boundary points are kept unchanged.
+    inline bool isBoundaryPreserved( ) const { return __preserveBoundary; }
+    inline void setBoundaryPreserved( bool enabled ) { __preserveBoundary = enabled; }
+
+    /// Returns the weight of the planes along boundary edges.
+    inline real_t getBoundaryWeight( ) const { return __boundaryWeight; }
+    inline void setBoundaryWeight( real_t weight ) { __boundaryWeight = weight; }
+
+    /// Returns the number of points removed by the last simplification.
+    inline uint_t getNbRemovedPoints( ) const { return __nbRemovedPoints; }
+
+    /// Returns the number of faces removed by the last simplification.
+    inline uint_t getNbRemovedFaces( ) const { return __nbRemovedFaces; }
+
+    /// Returns the largest error of the collapses of the last simplification.
+    inline real_t getError( ) const { return __error; }
+
+protected:
+
+    uint_t __targetNbFaces;
+    real_t __maxError;
+    bool __preserveBoundary;
+    real_t __boundaryWeight;
+
+    uint_t __nbRemovedPoints;
+    uint_t __nbRemovedFaces;
+    real_t __error;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __algo_meshsimplifier_h__
+#endif
+
@@ -35,6 +35,7 @@
 #include <plantgl/math/util_vector.h>
 #include <plantgl/scenegraph/container/indexarray_iterator.h>
 #include <plantgl/scenegraph/transformation/transformed.h>
+#include <plantgl/tool/util_parallel.h>
 #include <stdio.h>
 #include <algorithm>
 #include <stack>
@@ -894,6 +895,122 @@ PGL::pointset_covariance(const Point3ArrayPtr points,  const Index& group)
     return result;
 }
 
+/* ----------------------------------------------------------------------- */
+
+/// Covariance of the points of group centered on their barycenter.
+static void centered_covariance(const Point3ArrayPtr points, const Index& group, real_t cov[6])
+{
+    for (int i = 0; i < 6; ++i) cov[i] = 0;
+    if (group.empty()) return;
+    real_t cx = 0, cy = 0, cz = 0;
+    for (Index::const_iterator it = group.begin(); it != group.end(); ++it){
+        const Vector3& v = points->getAt(*it);
+        cx += v.x(); cy += v.y(); cz += v.z();
+    }
+    cx /= group.size(); cy /= group.size(); cz /= group.size();
+    for (Index::const_iterator it = group.begin(); it != group.end(); ++it){
+        const Vector3& v = points->getAt(*it);
+        real_t x = v.x() - cx, y = v.y() - cy, z = v.z() - cz;
+        cov[0] += x * x; cov[1] += x * y; cov[2] += x * z;
+        cov[3] += y * y; cov[4] += y * z; cov[5] += z * z;
+    }
+    for (int i = 0; i < 6; ++i) cov[i] /= group.size();
+}
+
+struct CovarianceComputer {
+    const Point3ArrayPtr points;
+    const IndexArrayPtr groups;
+    SymMatrix3Batch& result;
+
+    CovarianceComputer(const Point3ArrayPtr _points, const IndexArrayPtr _groups, SymMatrix3Batch& _result) :
+        points(_points), groups(_groups), result(_result) {}
+
+    void operator()(size_t first, size_t last) {
+        real_t cov[6];
+        for (size_t i = first; i < last; ++i){
+            centered_covariance(points, groups->getAt(i), cov);
+            result.xx[i] = cov[0]; result.xy[i] = cov[1]; result.xz[i] = cov[2];
+            result.yy[i] = cov[3]; result.yz[i] = cov[4]; result.zz[i] = cov[5];
+        }
+    }
+};
+
+SymMatrix3Batch
+PGL::pointsets_covariances(const Point3ArrayPtr points,  const IndexArrayPtr groups)
+{
+    SymMatrix3Batch result(groups->size());
+    CovarianceComputer computer(points, groups, result);
+    pgl_parallel_for(0, groups->size(), computer, 256);
+    return result;
+}
+
+/// Eigen vectors of the centered covariance of group. Columns are sorted by increasing eigen values.
+static Matrix3 pointset_eigen_vectors(const Point3ArrayPtr points, const Index& group)
+{
+    real_t cov[6];
+    centered_covariance(points, group, cov);
+    Vector3 values; Matrix3 vectors;
+    symmetric_eigen_decomposition(Matrix3(cov[0], cov[1], cov[2], cov[1], cov[3], cov[4], cov[2], cov[4], cov[5]), values, vectors);
+    return vectors;
+}
+
+Vector3 PGL::pointset_orientation(const Point3ArrayPtr points, const Index& group )
+{
+    if (group.size() < 2) return Vector3::ORIGIN;
+    return pointset_eigen_vectors(points, group).getColumn(2);
+}
+
+Vector3 PGL::pointset_normal(const Point3ArrayPtr points, const Index& group )
+{
+    if (group.size() < 3) return Vector3::ORIGIN;
+    return pointset_eigen_vectors(points, group).getColumn(0);
+}
+
+/// k-th eigen vectors of the covariances of groups having at least minsize points.
+static Point3ArrayPtr pointsets_eigen_vectors(const Point3ArrayPtr points, const IndexArrayPtr groups, uchar_t k, size_t minsize)
+{
+    Eigen3Batch eigen;
+    symmetric_eigen_decomposition(pointsets_covariances(points, groups), eigen);
+    Point3ArrayPtr result(new Point3Array(groups->size()));
+    for (size_t i = 0; i < groups->size(); ++i)
+        if (groups->getAt(i).size() >= minsize) result->setAt(i, eigen.getVector(i, k));
+    return result;
+}
+
+Point3ArrayPtr PGL::pointsets_orientations(const Point3ArrayPtr points, const IndexArrayPtr groups)
+{
+    return pointsets_eigen_vectors(points, groups, 2, 2);
+}
+
+Point3ArrayPtr PGL::pointsets_normals(const Point3ArrayPtr points, const IndexArrayPtr groups)
+{
+    return pointsets_eigen_vectors(points, groups, 0, 3);
+}
+
+RealArrayPtr PGL::pointsets_curvatures(const Point3ArrayPtr points, const IndexArrayPtr groups)
+{
+    Eigen3Batch eigen;
+    symmetric_eigen_decomposition(pointsets_covariances(points, groups), eigen, false);
+    RealArrayPtr result(new RealArray(groups->size()));
+    for (size_t i = 0; i < groups->size(); ++i){
+        real_t sum = eigen.values[0][i] + eigen.values[1][i] + eigen.values[2][i];
+        result->setAt(i, sum > 0 ? std::max<real_t>(0, eigen.values[0][i]) / sum : 0);
+    }
+    return result;
+}
+
+RealArrayPtr PGL::pointsets_linearities(const Point3ArrayPtr points, const IndexArrayPtr groups)
+{
+    Eigen3Batch eigen;
+    symmetric_eigen_decomposition(pointsets_covariances(points, groups), eigen, false);
+    RealArrayPtr result(new RealArray(groups->size()));
+    for (size_t i = 0; i < groups->size(); ++i){
+        real_t l2 = eigen.values[2][i];
+        result->setAt(i, l2 > 0 ? (l2 - eigen.values[1][i]) / l2 : 0);
+    }
+    return result;
+}
+
 
 
 real_t
@@ -2858,19 +2975,6 @@ PGL::pointset_angulardirections(const Point3ArrayPtr points, const TOOLS(Vector3
     return result;
 }
 
-Point3ArrayPtr PGL::pointsets_orientations(const Point3ArrayPtr points, const IndexArrayPtr groups)
-{
-    size_t nbPoints = points->size();
-    Point3ArrayPtr result(new Point3Array(nbPoints));
-
-    ProgressStatus st(nbPoints, "orientations computed for %.2f%% of points.");
-    IndexArray::const_iterator itNbrhd = groups->begin();
-    for(Point3Array::iterator itRes = result->begin(); itRes != result->end(); ++itRes, ++itNbrhd, ++st)
-        *itRes = pointset_orientation(points,*itNbrhd);
-
-    return result;
-}
-
 std::pair<uint32_t,real_t> 
 PGL::findClosestFromSubset(const TOOLS(Vector3)& origin, const Point3ArrayPtr points, const Index& group)
 {
@@ -39,6 +39,7 @@
 #include <plantgl/math/util_matrix.h>
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/algo/grid/regularpointgrid.h>
+#include <plantgl/algo/fitting/symmetriceigen.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 #include <plantgl/scenegraph/function/function.h>
 #include <plantgl/scenegraph/scene/scene.h>
@@ -233,6 +234,9 @@ pointset_max_radial_distance(  const TOOLS(Vector3)& origin,
 
 ALGO_API TOOLS(Matrix3) pointset_covariance(const Point3ArrayPtr points,  const Index& group = Index());
 
+/// Centered covariance matrices of each group of points.
+ALGO_API SymMatrix3Batch pointsets_covariances(const Point3ArrayPtr points,  const IndexArrayPtr groups);
+
 
 ALGO_API Index 
 get_sorted_element_order(const TOOLS(RealArrayPtr) distances);
@@ -282,6 +286,15 @@ pointset_normal(const Point3ArrayPtr points, const Index& group);
 ALGO_API Point3ArrayPtr 
 pointsets_normals(const Point3ArrayPtr points, const IndexArrayPtr groups);
 
+/** Surface variation of each group of points, i.e. l0/(l0+l1+l2) with l0 <= l1 <= l2 the eigen
+    values of the covariance of the group. It is 0 for planar and 1/3 for isotropic neighborhoods. */
+ALGO_API TOOLS(RealArrayPtr)
+pointsets_curvatures(const Point3ArrayPtr points, const IndexArrayPtr groups);
+
+/// Linearity (l2-l1)/l2 of each group of points. It is 1 for points on a line.
+ALGO_API TOOLS(RealArrayPtr)
+pointsets_linearities(const Point3ArrayPtr points, const IndexArrayPtr groups);
+
 
 ALGO_API Point3ArrayPtr 
 pointsets_orient_normals(const Point3ArrayPtr normals, const Point3ArrayPtr points, const IndexArrayPtr riemanian);
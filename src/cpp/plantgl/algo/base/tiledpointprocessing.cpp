@@ -0,0 +1,513 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include "tiledpointprocessing.h"
+#include "pointmanipulation.h"
+#include <plantgl/tool/util_parallel.h>
+#include <algorithm>
+#include <map>
+#include <math.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+PointTile::PointTile() : processor(NULL), cell(0), nbcore(0) { }
+
+bool PointTile::isCore( const Vector3& point ) const
+{
+  return processor->cellOf(point) == cell;
+}
+
+/* ----------------------------------------------------------------------- */
+
+PointTileKernel::PointTileKernel( real_t halo ) : __halo(halo) { }
+
+PointTileKernel::~PointTileKernel() { }
+
+bool PointTileKernel::begin( const TiledPointProcessor& ) { return true; }
+
+bool PointTileKernel::end( ) { return true; }
+
+/* ----------------------------------------------------------------------- */
+
+TiledPointProcessor::TiledPointProcessor( const std::string& fname, real_t tileSize ) :
+  __reader(fname),
+  __tileSize(tileSize),
+  __maxConcurrentTiles(pgl_thread_count()),
+  __valid(false)
+{
+  __dimensions[0] = __dimensions[1] = __dimensions[2] = 1;
+  if (!__reader.isValid() || !(tileSize > 0)) return;
+  const TiledPointCloud& index = __reader.index();
+
+  __firstIds.reserve(index.tiles.size());
+  uint64_t nbpoints = 0;
+  for (std::vector<TiledPointCloud::Tile>::const_iterator it = index.tiles.begin(); it != index.tiles.end(); ++it) {
+    __firstIds.push_back(nbpoints);
+    nbpoints += it->nbpoints;
+  }
+
+  Vector3 lower, upper;
+  index.getBoundingBox(lower, upper);
+  if (nbpoints == 0) { __valid = true; return; }
+  __origin = lower;
+  double nbcells = 1;
+  for (int k = 0; k < 3; ++k) {
+    double nb = std::max(1.0, ceil((double(upper[k]) - double(lower[k])) / tileSize));
+    if (nb > 1 << 20) return;
+    __dimensions[k] = uint_t(nb);
+    nbcells *= nb;
+  }
+  if (nbcells > 4294967295.0) return;
+
+  __valid = true;
+}
+
+uint_t TiledPointProcessor::cellOf( const Vector3& point ) const
+{
+  uint_t coord[3];
+  for (int k = 0; k < 3; ++k) {
+    double c = floor((double(point[k]) - double(__origin[k])) / __tileSize);
+    coord[k] = c <= 0 ? 0 : (c >= __dimensions[k] - 1 ? __dimensions[k] - 1 : uint_t(c));
+  }
+  return (coord[2] * __dimensions[1] + coord[1]) * __dimensions[0] + coord[0];
+}
+
+std::vector<uint_t> TiledPointProcessor::getCells( real_t halo ) const
+{
+  std::vector<uint_t> result;
+  if (!__valid) return result;
+  size_t nbcells = size_t(__dimensions[0]) * __dimensions[1] * __dimensions[2];
+  std::vector<bool> used(nbcells, false);
+  Vector3 margin(halo,halo,halo);
+  for (std::vector<TiledPointCloud::Tile>::const_iterator it = __reader.index().tiles.begin(); it != __reader.index().tiles.end(); ++it) {
+    if (it->nbpoints == 0) continue;
+    uint_t first = cellOf(it->lower - margin), last = cellOf(it->upper + margin);
+    uint_t fx = first % __dimensions[0], fy = (first / __dimensions[0]) % __dimensions[1], fz = first / (__dimensions[0] * __dimensions[1]);
+    uint_t lx = last % __dimensions[0], ly = (last / __dimensions[0]) % __dimensions[1], lz = last / (__dimensions[0] * __dimensions[1]);
+    for (uint_t z = fz; z <= lz; ++z)
+      for (uint_t y = fy; y <= ly; ++y)
+        for (uint_t x = fx; x <= lx; ++x)
+          used[(size_t(z) * __dimensions[1] + y) * __dimensions[0] + x] = true;
+  }
+  for (size_t c = 0; c < nbcells; ++c)
+    if (used[c]) result.push_back(uint_t(c));
+  return result;
+}
+
+void TiledPointProcessor::getCellBox( uint_t cell, Vector3& lower, Vector3& upper ) const
+{
+  uint_t coord[3] = { cell % __dimensions[0], (cell / __dimensions[0]) % __dimensions[1], cell / (__dimensions[0] * __dimensions[1]) };
+  for (int k = 0; k < 3; ++k) {
+    lower[k] = __origin[k] + coord[k] * __tileSize;
+    upper[k] = lower[k] + __tileSize;
+  }
+}
+
+bool TiledPointProcessor::loadTile( uint_t cell, real_t halo, PointTile& tile ) const
+{
+  tile.processor = this;
+  tile.cell = cell;
+  getCellBox(cell, tile.lower, tile.upper);
+  // The cells on the border of the grid also contain the points on its upper faces.
+  Vector3 lower = tile.lower - Vector3(halo,halo,halo);
+  Vector3 upper = tile.upper + Vector3(halo,halo,halo);
+
+  uint_t channels = __reader.index().channels;
+  PointCloud core(channels), border(channels);
+  std::vector<uint64_t> borderIds;
+  tile.ids.clear();
+  std::vector<uint_t> tiles = __reader.index().findTiles(lower, upper);
+  for (std::vector<uint_t>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+    PointCloud part;
+    if (!__reader.readTile(*it, part)) return false;
+    const Point3Array& points = *part.points;
+    for (size_t i = 0; i < points.size(); ++i) {
+      const Vector3& p = points.getAt(i);
+      if (cellOf(p) == cell) {
+        core.append(part, i);
+        tile.ids.push_back(__firstIds[*it] + i);
+      }
+      else if (p.x() >= lower.x() && p.y() >= lower.y() && p.z() >= lower.z() &&
+               p.x() <= upper.x() && p.y() <= upper.y() && p.z() <= upper.z()) {
+        border.append(part, i);
+        borderIds.push_back(__firstIds[*it] + i);
+      }
+    }
+  }
+  tile.nbcore = core.size();
+  core.append(border);
+  tile.cloud = core;
+  tile.ids.insert(tile.ids.end(), borderIds.begin(), borderIds.end());
+  return true;
+}
+
+/// Loads and processes in parallel a range of tiles.
+struct TileRunner {
+  TileRunner(const TiledPointProcessor& _processor, const PointTileKernel& _kernel,
+             const std::vector<uint_t>& _cells, size_t _first, size_t _last) :
+    processor(_processor), kernel(_kernel), cells(_cells), first(_first),
+    tiles(_last - _first), results(_last - _first), errors(_last - _first, 0) { }
+
+  void operator()(size_t begin, size_t end) {
+    for (size_t t = begin; t < end; ++t) {
+      if (!processor.loadTile(cells[first + t], kernel.getHalo(), tiles[t])) errors[t] = 1;
+      else if (tiles[t].cloud.size() > 0 && !kernel.process(tiles[t], results[t])) errors[t] = 1;
+    }
+  }
+
+  const TiledPointProcessor& processor;
+  const PointTileKernel& kernel;
+  const std::vector<uint_t>& cells;
+  size_t first;
+  std::vector<PointTile> tiles;
+  std::vector<PointTileResult> results;
+  std::vector<char> errors;
+};
+
+bool TiledPointProcessor::process( PointTileKernel& kernel ) const
+{
+  if (!__valid || !kernel.begin(*this)) return false;
+  // A cell without points may have to process the points of its halo.
+  std::vector<uint_t> cells = getCells(kernel.getHalo());
+  size_t wave = std::max<size_t>(1, __maxConcurrentTiles);
+  for (size_t first = 0; first < cells.size(); first += wave) {
+    size_t last = std::min(cells.size(), first + wave);
+    TileRunner runner(*this, kernel, cells, first, last);
+    pgl_parallel_for(0, last - first, runner, 1);
+    for (size_t t = 0; t < last - first; ++t) {
+      if (runner.errors[t]) return false;
+      if (runner.tiles[t].cloud.size() > 0 && !kernel.merge(runner.tiles[t], runner.results[t])) return false;
+    }
+  }
+  return kernel.end();
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// The positions in the tile of the points at less than \e radius of each core point, sorted.
+static IndexArrayPtr ball_neighborhoods(const PointTile& tile, real_t radius)
+{
+  typedef PointRefGrid<Point3Array> LocalPointGrid;
+  typedef LocalPointGrid::PointIndexList PointIndexList;
+  const Point3ArrayPtr& points = tile.cloud.points;
+  LocalPointGrid grid(radius, points);
+  IndexArrayPtr result(new IndexArray(tile.nbcore));
+  for (size_t i = 0; i < tile.nbcore; ++i) {
+    PointIndexList neighbors = grid.query_ball_point(points->getAt(i), radius);
+    std::sort(neighbors.begin(), neighbors.end());
+    result->setAt(i, Index(neighbors.begin(), neighbors.end()));
+  }
+  return result;
+}
+
+/// The core points of \e tile with the attributes of \e channels.
+static PointCloud core_points(const PointTile& tile, uint_t channels)
+{
+  PointCloud result(channels);
+  for (size_t i = 0; i < tile.nbcore; ++i) result.append(tile.cloud, i);
+  return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+RNeighborhoodTileKernel::RNeighborhoodTileKernel( real_t radius ) :
+  PointTileKernel(radius), __radius(radius) { }
+
+bool RNeighborhoodTileKernel::begin( const TiledPointProcessor& processor )
+{
+  uint64_t nbpoints = processor.getReader().index().size();
+  if (nbpoints > 4294967295ULL) return false;
+  __neighborhoods = IndexArrayPtr(new IndexArray(size_t(nbpoints)));
+  return true;
+}
+
+bool RNeighborhoodTileKernel::process( const PointTile& tile, PointTileResult& result ) const
+{
+  result.groups = ball_neighborhoods(tile, __radius);
+  for (IndexArray::iterator it = result.groups->begin(); it != result.groups->end(); ++it) {
+    for (Index::iterator itn = it->begin(); itn != it->end(); ++itn) *itn = uint32_t(tile.ids[*itn]);
+    std::sort(it->begin(), it->end());
+  }
+  return true;
+}
+
+bool RNeighborhoodTileKernel::merge( const PointTile& tile, PointTileResult& result )
+{
+  for (size_t i = 0; i < tile.nbcore; ++i)
+    __neighborhoods->setAt(uint32_t(tile.ids[i]), result.groups->getAt(i));
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+NormalTileKernel::NormalTileKernel( real_t radius, TiledPointCloudWriter * output ) :
+  PointTileKernel(radius), __radius(radius), __output(output) { }
+
+bool NormalTileKernel::begin( const TiledPointProcessor& processor )
+{
+  if (__output) return (__output->index().channels & PointCloud::NormalChannel) != 0;
+  __normals = Point3ArrayPtr(new Point3Array(processor.getReader().index().size()));
+  return true;
+}
+
+bool NormalTileKernel::process( const PointTile& tile, PointTileResult& result ) const
+{
+  Point3ArrayPtr normals = pointsets_normals(tile.cloud.points, ball_neighborhoods(tile, __radius));
+  if (__output) result.cloud = core_points(tile, __output->index().channels & ~PointCloud::NormalChannel);
+  result.cloud.normals = normals;
+  return true;
+}
+
+bool NormalTileKernel::merge( const PointTile& tile, PointTileResult& result )
+{
+  if (__output) return __output->add(result.cloud);
+  for (size_t i = 0; i < tile.nbcore; ++i)
+    __normals->setAt(uint32_t(tile.ids[i]), result.cloud.normals->getAt(i));
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+DensityTileKernel::DensityTileKernel( real_t radius, TiledPointCloudWriter * output ) :
+  PointTileKernel(radius), __radius(radius), __output(output) { }
+
+bool DensityTileKernel::begin( const TiledPointProcessor& processor )
+{
+  if (__output) return (__output->index().channels & PointCloud::IntensityChannel) != 0;
+  __densities = RealArrayPtr(new RealArray(processor.getReader().index().size()));
+  return true;
+}
+
+bool DensityTileKernel::process( const PointTile& tile, PointTileResult& result ) const
+{
+  IndexArrayPtr neighborhoods = ball_neighborhoods(tile, __radius);
+  RealArrayPtr densities(new RealArray(tile.nbcore));
+  for (size_t i = 0; i < tile.nbcore; ++i)
+    densities->setAt(i, neighborhoods->getAt(i).size() / (__radius * __radius));
+  if (__output) result.cloud = core_points(tile, __output->index().channels & ~PointCloud::IntensityChannel);
+  result.cloud.intensities = densities;
+  return true;
+}
+
+bool DensityTileKernel::merge( const PointTile& tile, PointTileResult& result )
+{
+  if (__output) return __output->add(result.cloud);
+  for (size_t i = 0; i < tile.nbcore; ++i)
+    __densities->setAt(uint32_t(tile.ids[i]), result.cloud.intensities->getAt(i));
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+VoxelDownsamplingTileKernel::VoxelDownsamplingTileKernel( real_t voxelSize, TiledPointCloudWriter * output ) :
+  PointTileKernel(voxelSize), __voxelSize(voxelSize), __output(output) { }
+
+bool VoxelDownsamplingTileKernel::begin( const TiledPointProcessor& processor )
+{
+  __points = PointCloud(processor.getReader().index().channels & PointCloud::ColorChannel);
+  return __voxelSize > 0;
+}
+
+/// The coordinates of a voxel.
+struct VoxelKey {
+  VoxelKey(int64_t _x, int64_t _y, int64_t _z) : x(_x), y(_y), z(_z) { }
+  bool operator<(const VoxelKey& other) const {
+    return x < other.x || (x == other.x && (y < other.y || (y == other.y && z < other.z)));
+  }
+  int64_t x, y, z;
+};
+
+/// The sums of the points of a voxel.
+struct VoxelSum {
+  VoxelSum() : nb(0) { color[0] = color[1] = color[2] = color[3] = 0; }
+  Vector3 point;
+  double color[4];
+  size_t nb;
+};
+
+bool VoxelDownsamplingTileKernel::process( const PointTile& tile, PointTileResult& result ) const
+{
+  std::map<VoxelKey, VoxelSum> voxels;
+  const Point3Array& points = *tile.cloud.points;
+  for (size_t i = 0; i < points.size(); ++i) {
+    const Vector3& p = points.getAt(i);
+    VoxelKey key(int64_t(floor(p.x() / __voxelSize)), int64_t(floor(p.y() / __voxelSize)), int64_t(floor(p.z() / __voxelSize)));
+    if (i >= tile.nbcore && voxels.find(key) == voxels.end()) {
+      // Halo points only count for the voxels computed by the tile.
+      Vector3 corner(key.x * __voxelSize, key.y * __voxelSize, key.z * __voxelSize);
+      if (!tile.isCore(corner)) continue;
+    }
+    VoxelSum& voxel = voxels[key];
+    voxel.point += p;
+    if (tile.cloud.colors)
+      for (int c = 0; c < 4; ++c) voxel.color[c] += tile.cloud.colors->getAt(i).getAt(c);
+    ++voxel.nb;
+  }
+  uint_t channels = __output ? __output->index().channels : __points.channels();
+  result.cloud = PointCloud(channels);
+  for (std::map<VoxelKey, VoxelSum>::const_iterator it = voxels.begin(); it != voxels.end(); ++it) {
+    Vector3 corner(it->first.x * __voxelSize, it->first.y * __voxelSize, it->first.z * __voxelSize);
+    if (!tile.isCore(corner)) continue;
+    const VoxelSum& voxel = it->second;
+    result.cloud.points->push_back(voxel.point / real_t(voxel.nb));
+    if (result.cloud.colors) {
+      Color4 color;
+      for (int c = 0; c < 4; ++c) color.getAt(c) = uchar_t(floor(voxel.color[c] / voxel.nb + 0.5));
+      result.cloud.colors->push_back(color);
+    }
+    if (result.cloud.normals) result.cloud.normals->push_back(Vector3::ORIGIN);
+    if (result.cloud.intensities) result.cloud.intensities->push_back(0);
+    if (result.cloud.classifications) result.cloud.classifications->push_back(0);
+  }
+  return true;
+}
+
+bool VoxelDownsamplingTileKernel::merge( const PointTile&, PointTileResult& result )
+{
+  if (__output) return __output->add(result.cloud);
+  __points.append(result.cloud);
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+SkeletonTileKernel::SkeletonTileKernel( real_t binsize, uint32_t k, real_t halo ) :
+  PointTileKernel(halo), __binsize(binsize), __k(k) { }
+
+bool SkeletonTileKernel::begin( const TiledPointProcessor& )
+{
+  __nodes = Point3ArrayPtr(new Point3Array());
+  __parents = Uint32Array1Ptr(new Uint32Array1());
+#if defined(WITH_ANN) || defined(WITH_CGAL)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool SkeletonTileKernel::process( const PointTile& tile, PointTileResult& result ) const
+{
+  const Point3Array& points = *tile.cloud.points;
+  if (tile.nbcore == 0 || points.size() <= __k) return true;
+  uint32_t root = 0;
+  for (uint32_t i = 1; i < tile.nbcore; ++i)
+    if (points.getAt(i).z() < points.getAt(root).z()) root = i;
+  Uint32Array1Ptr parents;
+  IndexArrayPtr components;
+  Point3ArrayPtr nodes = skeleton_from_distance_to_root_clusters(tile.cloud.points, root, __binsize, __k, parents, components, true);
+  if (!nodes || !parents) return false;
+
+  // Only the nodes in the cell of the tile are kept.
+  std::vector<uint32_t> position(nodes->size(), uint32_t(-1));
+  result.cloud = PointCloud(0);
+  for (uint32_t i = 0; i < nodes->size(); ++i)
+    if (tile.isCore(nodes->getAt(i))) {
+      position[i] = result.cloud.points->size();
+      result.cloud.points->push_back(nodes->getAt(i));
+    }
+  result.parents = Uint32Array1Ptr(new Uint32Array1());
+  for (uint32_t i = 0; i < nodes->size(); ++i)
+    if (position[i] != uint32_t(-1)) {
+      uint32_t parent = position[parents->getAt(i)];
+      result.parents->push_back(parent == uint32_t(-1) ? position[i] : parent);
+    }
+  return true;
+}
+
+bool SkeletonTileKernel::merge( const PointTile&, PointTileResult& result )
+{
+  if (!result.cloud.points) return true;
+  uint32_t offset = __nodes->size();
+  __nodes->insert(__nodes->end(), result.cloud.points->begin(), result.cloud.points->end());
+  for (Uint32Array1::const_iterator it = result.parents->begin(); it != result.parents->end(); ++it)
+    __parents->push_back(*it + offset);
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+IndexArrayPtr
+PGL::tiled_r_neighborhoods(const std::string& fname, real_t tilesize, real_t radius)
+{
+  TiledPointProcessor processor(fname, tilesize);
+  RNeighborhoodTileKernel kernel(radius);
+  if (!processor.process(kernel)) return IndexArrayPtr();
+  return kernel.getNeighborhoods();
+}
+
+Point3ArrayPtr
+PGL::tiled_pointsets_normals(const std::string& fname, real_t tilesize, real_t radius)
+{
+  TiledPointProcessor processor(fname, tilesize);
+  NormalTileKernel kernel(radius);
+  if (!processor.process(kernel)) return Point3ArrayPtr();
+  return kernel.getNormals();
+}
+
+RealArrayPtr
+PGL::tiled_densities_from_r_neighborhood(const std::string& fname, real_t tilesize, real_t radius)
+{
+  TiledPointProcessor processor(fname, tilesize);
+  DensityTileKernel kernel(radius);
+  if (!processor.process(kernel)) return RealArrayPtr();
+  return kernel.getDensities();
+}
+
+bool
+PGL::tiled_voxel_downsampling(const std::string& fname, const std::string& output, real_t tilesize, real_t voxelsize)
+{
+  TiledPointProcessor processor(fname, tilesize);
+  if (!processor.isValid()) return false;
+  const TiledPointCloud& index = processor.getReader().index();
+  TiledPointCloudWriter writer(output, index.channels & PointCloud::ColorChannel, tilesize, index.precision);
+  VoxelDownsamplingTileKernel kernel(voxelsize, &writer);
+  bool result = processor.process(kernel);
+  return writer.close() && result;
+}
+
+Point3ArrayPtr
+PGL::tiled_skeleton_from_distance_to_root_clusters(const std::string& fname, real_t tilesize, real_t halo,
+                                                   real_t binsize, uint32_t k, Uint32Array1Ptr& parents)
+{
+  TiledPointProcessor processor(fname, tilesize);
+  SkeletonTileKernel kernel(binsize, k, halo);
+  if (!processor.process(kernel)) return Point3ArrayPtr();
+  parents = kernel.getParents();
+  return kernel.getNodes();
+}
+
+/* ----------------------------------------------------------------------- */
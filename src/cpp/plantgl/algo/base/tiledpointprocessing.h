@@ -0,0 +1,329 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file tiledpointprocessing.h
+    \brief Out-of-core processing of the point clouds stored in tiled point cloud files.
+*/
+
+#ifndef __tiledpointprocessing_h__
+#define __tiledpointprocessing_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/algo/codec/tiledpointcloud.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+class TiledPointProcessor;
+
+/**
+   \struct PointTile
+   \brief The points of a processing tile: the points of its cell, called core
+   points, followed by the points of its halo. The id of a point is its position
+   in the file, i.e. in the result of TiledPointCloudReader::read.
+*/
+struct ALGO_API PointTile {
+  /// The processor that loaded the tile.
+  const TiledPointProcessor * processor;
+  /// The cell of the tile and its box.
+  uint_t cell;
+  TOOLS(Vector3) lower;
+  TOOLS(Vector3) upper;
+  /// The core points followed by the halo points.
+  PointCloud cloud;
+  /// The number of core points.
+  size_t nbcore;
+  /// The ids of the points.
+  std::vector<uint64_t> ids;
+
+  PointTile();
+
+  /// Returns whether \e point is in the cell of the tile.
+  bool isCore( const TOOLS(Vector3)& point ) const;
+};
+
+/**
+   \struct PointTileResult
+   \brief The result of a kernel on a tile. Its meaning depends on the kernel.
+*/
+struct ALGO_API PointTileResult {
+  PointCloud cloud;
+  IndexArrayPtr groups;
+  TOOLS(Uint32Array1Ptr) parents;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class PointTileKernel
+   \brief A computation done tile by tile by a TiledPointProcessor.
+   process is called concurrently on different tiles and must be thread safe.
+   merge is called from a single thread on the tiles in the order of their cells.
+*/
+class ALGO_API PointTileKernel {
+public:
+
+  /// Constructs a kernel needing the points at less than \e halo of a cell.
+  PointTileKernel( real_t halo );
+
+  virtual ~PointTileKernel();
+
+  real_t getHalo() const { return __halo; }
+
+  /// Called before the processing of the tiles.
+  virtual bool begin( const TiledPointProcessor& processor );
+
+  /// Computes the result of \e tile.
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const = 0;
+
+  /// Merges the result of \e tile.
+  virtual bool merge( const PointTile& tile, PointTileResult& result ) = 0;
+
+  /// Called after the processing of the tiles.
+  virtual bool end( );
+
+protected:
+  real_t __halo;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class TiledPointProcessor
+   \brief Runs kernels on the point cloud of a TPC file without loading it in memory.
+
+   The bounding box of the file is partitioned in cubic cells of size \e tileSize.
+   Each cell gives a tile made of its points and of the points at less than the
+   halo of the kernel, loaded from the tiles of the file intersecting the box of
+   the cell extended by the halo. At most \e maxConcurrentTiles tiles are in memory
+   at once. They are processed in parallel and merged in the order of the cells so
+   that results do not depend on the number of threads. A processing tile should
+   be larger than the tiles of the file, which are decoded once per processing
+   tile that they intersect.
+*/
+class ALGO_API TiledPointProcessor {
+public:
+
+  /// Opens \e fname, partitioned in cells of size \e tileSize.
+  TiledPointProcessor( const std::string& fname, real_t tileSize );
+
+  bool isValid() const { return __valid; }
+
+  /// Returns the reader of the file.
+  const TiledPointCloudReader& getReader() const { return __reader; }
+
+  real_t getTileSize() const { return __tileSize; }
+
+  void setMaxConcurrentTiles( size_t nb ) { __maxConcurrentTiles = nb; }
+  size_t getMaxConcurrentTiles( ) const { return __maxConcurrentTiles; }
+
+  /// Returns the cells whose box extended by \e halo intersects a tile of the file.
+  std::vector<uint_t> getCells( real_t halo = 0 ) const;
+
+  /// Returns the cell of \e point.
+  uint_t cellOf( const TOOLS(Vector3)& point ) const;
+
+  /// Returns the box of \e cell.
+  void getCellBox( uint_t cell, TOOLS(Vector3)& lower, TOOLS(Vector3)& upper ) const;
+
+  /// Loads in \e tile the points of \e cell and of its halo of size \e halo.
+  bool loadTile( uint_t cell, real_t halo, PointTile& tile ) const;
+
+  /// Runs \e kernel on all the tiles.
+  bool process( PointTileKernel& kernel ) const;
+
+protected:
+
+  TiledPointCloudReader __reader;
+  real_t __tileSize;
+  TOOLS(Vector3) __origin;
+  uint_t __dimensions[3];
+  std::vector<uint64_t> __firstIds;
+  size_t __maxConcurrentTiles;
+  bool __valid;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class RNeighborhoodTileKernel
+   \brief Computes the ids of the points at less than \e radius of each point.
+*/
+class ALGO_API RNeighborhoodTileKernel : public PointTileKernel {
+public:
+  RNeighborhoodTileKernel( real_t radius );
+
+  virtual bool begin( const TiledPointProcessor& processor );
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const;
+  virtual bool merge( const PointTile& tile, PointTileResult& result );
+
+  /// The neighborhoods, by point id.
+  IndexArrayPtr getNeighborhoods() const { return __neighborhoods; }
+
+protected:
+  real_t __radius;
+  IndexArrayPtr __neighborhoods;
+};
+
+/**
+   \class NormalTileKernel
+   \brief Computes the normal of each point from the points at less than \e radius,
+   as pointsets_normals. The points are written with their normals in \e output
+   if given and the normals are kept in memory otherwise.
+*/
+class ALGO_API NormalTileKernel : public PointTileKernel {
+public:
+  NormalTileKernel( real_t radius, TiledPointCloudWriter * output = NULL );
+
+  virtual bool begin( const TiledPointProcessor& processor );
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const;
+  virtual bool merge( const PointTile& tile, PointTileResult& result );
+
+  /// The normals, by point id.
+  Point3ArrayPtr getNormals() const { return __normals; }
+
+protected:
+  real_t __radius;
+  TiledPointCloudWriter * __output;
+  Point3ArrayPtr __normals;
+};
+
+/**
+   \class DensityTileKernel
+   \brief Computes the density of each point from the points at less than \e radius,
+   as densities_from_r_neighborhood. The points are written with their densities as
+   intensities in \e output if given and the densities are kept in memory otherwise.
+*/
+class ALGO_API DensityTileKernel : public PointTileKernel {
+public:
+  DensityTileKernel( real_t radius, TiledPointCloudWriter * output = NULL );
+
+  virtual bool begin( const TiledPointProcessor& processor );
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const;
+  virtual bool merge( const PointTile& tile, PointTileResult& result );
+
+  /// The densities, by point id.
+  TOOLS(RealArrayPtr) getDensities() const { return __densities; }
+
+protected:
+  real_t __radius;
+  TiledPointCloudWriter * __output;
+  TOOLS(RealArrayPtr) __densities;
+};
+
+/**
+   \class VoxelDownsamplingTileKernel
+   \brief Replaces the points of each voxel of size \e voxelSize of a grid anchored
+   at the origin by their centroid, with their mean color. A voxel is computed by the
+   tile containing its lower corner. The centroids are written in \e output if given
+   and kept in memory otherwise.
+*/
+class ALGO_API VoxelDownsamplingTileKernel : public PointTileKernel {
+public:
+  VoxelDownsamplingTileKernel( real_t voxelSize, TiledPointCloudWriter * output = NULL );
+
+  virtual bool begin( const TiledPointProcessor& processor );
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const;
+  virtual bool merge( const PointTile& tile, PointTileResult& result );
+
+  /// The centroids, in the order of the tiles and of the voxels.
+  const PointCloud& getPoints() const { return __points; }
+
+protected:
+  real_t __voxelSize;
+  TiledPointCloudWriter * __output;
+  PointCloud __points;
+};
+
+/**
+   \class SkeletonTileKernel
+   \brief Computes in each tile the skeleton of skeleton_from_distance_to_root_clusters
+   with the lowest point of the tile as root. The nodes of a tile are the centroids
+   of its clusters inside its cell. A node whose parent belongs to another tile is a
+   root, so that the result is a forest. Needs ANN or CGAL.
+*/
+class ALGO_API SkeletonTileKernel : public PointTileKernel {
+public:
+  SkeletonTileKernel( real_t binsize, uint32_t k, real_t halo );
+
+  virtual bool begin( const TiledPointProcessor& processor );
+  virtual bool process( const PointTile& tile, PointTileResult& result ) const;
+  virtual bool merge( const PointTile& tile, PointTileResult& result );
+
+  Point3ArrayPtr getNodes() const { return __nodes; }
+  TOOLS(Uint32Array1Ptr) getParents() const { return __parents; }
+
+protected:
+  real_t __binsize;
+  uint32_t __k;
+  Point3ArrayPtr __nodes;
+  TOOLS(Uint32Array1Ptr) __parents;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Ball neighborhoods of radius \e radius of the points of the file \e fname, processed by tiles of size \e tilesize.
+ALGO_API IndexArrayPtr
+tiled_r_neighborhoods(const std::string& fname, real_t tilesize, real_t radius);
+
+/// Normals of the points of the file \e fname from their ball neighborhoods of radius \e radius.
+ALGO_API Point3ArrayPtr
+tiled_pointsets_normals(const std::string& fname, real_t tilesize, real_t radius);
+
+/// Densities of the points of the file \e fname from their ball neighborhoods of radius \e radius.
+ALGO_API TOOLS(RealArrayPtr)
+tiled_densities_from_r_neighborhood(const std::string& fname, real_t tilesize, real_t radius);
+
+/// Downsamples the points of the file \e fname by voxels of size \e voxelsize and writes them in \e output.
+ALGO_API bool
+tiled_voxel_downsampling(const std::string& fname, const std::string& output, real_t tilesize, real_t voxelsize);
+
+/// Skeleton forest of the points of the file \e fname computed tile by tile. See SkeletonTileKernel.
+ALGO_API Point3ArrayPtr
+tiled_skeleton_from_distance_to_root_clusters(const std::string& fname, real_t tilesize, real_t halo,
+                                              real_t binsize, uint32_t k, TOOLS(Uint32Array1Ptr)& parents);
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __tiledpointprocessing_h__
+#endif
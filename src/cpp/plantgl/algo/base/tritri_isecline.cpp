@@ -587,6 +587,7 @@ int tri_tri_intersect_with_isectline(real_t V0[3],real_t V1[3],real_t V2[3],
   real_t up0,up1,up2;
   real_t b,c,max;
   real_t tmp,diff[3];
+  real_t eps;
   int smallest1,smallest2;
   
   /* compute plane equation of triangle(V0,V1,V2) */
@@ -596,6 +597,10 @@ int tri_tri_intersect_with_isectline(real_t V0[3],real_t V1[3],real_t V2[3],
   d1=-DOT(N1,V0);
   /* plane equation 1: N1.X+d1=0 */
 
+  /* the coplanarity threshold is relative to the size of the triangle, */
+  /* otherwise all the points close to small triangles are in their plane */
+  eps=EPSILON*sqrt(DOT(N1,N1)*(DOT(E1,E1) > DOT(E2,E2) ? DOT(E1,E1) : DOT(E2,E2)));
+
   /* put U0,U1,U2 into plane equation 1 to compute signed distances to the plane*/
   du0=DOT(N1,U0)+d1;
   du1=DOT(N1,U1)+d1;
@@ -603,9 +608,9 @@ int tri_tri_intersect_with_isectline(real_t V0[3],real_t V1[3],real_t V2[3],
 
   /* coplanarity robustness check */
 #if USE_EPSILON_TEST==TRUE
-  if(fabs(du0)<EPSILON) du0=0.0;
-  if(fabs(du1)<EPSILON) du1=0.0;
-  if(fabs(du2)<EPSILON) du2=0.0;
+  if(fabs(du0)<eps) du0=0.0;
+  if(fabs(du1)<eps) du1=0.0;
+  if(fabs(du2)<eps) du2=0.0;
 #endif
   du0du1=du0*du1;
   du0du2=du0*du2;
@@ -619,6 +624,7 @@ int tri_tri_intersect_with_isectline(real_t V0[3],real_t V1[3],real_t V2[3],
   CROSS(N2,E1,E2);
   d2=-DOT(N2,U0);
   /* plane equation 2: N2.X+d2=0 */
+  eps=EPSILON*sqrt(DOT(N2,N2)*(DOT(E1,E1) > DOT(E2,E2) ? DOT(E1,E1) : DOT(E2,E2)));
 
   /* put V0,V1,V2 into plane equation 2 */
   dv0=DOT(N2,V0)+d2;
@@ -626,9 +632,9 @@ int tri_tri_intersect_with_isectline(real_t V0[3],real_t V1[3],real_t V2[3],
   dv2=DOT(N2,V2)+d2;
 
 #if USE_EPSILON_TEST==TRUE
-  if(fabs(dv0)<EPSILON) dv0=0.0;
-  if(fabs(dv1)<EPSILON) dv1=0.0;
-  if(fabs(dv2)<EPSILON) dv2=0.0;
+  if(fabs(dv0)<eps) dv0=0.0;
+  if(fabs(dv1)<eps) dv1=0.0;
+  if(fabs(dv2)<eps) dv2=0.0;
 #endif
 
   dv0dv1=dv0*dv1;
@@ -0,0 +1,149 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+#include "binaryindex.h"
+#include <plantgl/tool/util_hashset.h>
+#include <string.h>
+
+#ifdef WITH_LZ4
+#include <lz4.h>
+#endif
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const size_t BinaryIndex::ALIGNMENT(64);
+
+const std::string BinaryIndex::TAG("!IDX");
+
+const uint32_t BinaryBuffer::INLINE(0xFFFFFFFF);
+
+/* ----------------------------------------------------------------------- */
+
+std::vector<uint_t> BinaryIndex::findShapes( const std::vector<uint_t>& ids ) const
+{
+  pgl_hash_set_uint32 idset(ids.begin(), ids.end());
+  std::vector<uint_t> result;
+  for (uint_t i = 0; i < shapes.size(); ++i)
+    if (idset.find(shapes[i].id) != idset.end()) result.push_back(i);
+  return result;
+}
+
+std::vector<uint_t> BinaryIndex::findShapes( const Vector3& lower, const Vector3& upper ) const
+{
+  std::vector<uint_t> result;
+  for (uint_t i = 0; i < shapes.size(); ++i) {
+    const ShapeEntry& s = shapes[i];
+    if (s.lower.x() <= upper.x() && s.upper.x() >= lower.x() &&
+        s.lower.y() <= upper.y() && s.upper.y() >= lower.y() &&
+        s.lower.z() <= upper.z() && s.upper.z() >= lower.z())
+      result.push_back(i);
+  }
+  return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool BinaryIndex::isSupported( Compression compression )
+{
+  switch (compression) {
+    case NoCompression: return true;
+#ifdef WITH_LZ4
+    case LZ4Compression: return true;
+#endif
+#ifdef WITH_ZSTD
+    case ZstdCompression: return true;
+#endif
+    default: return false;
+  }
+}
+
+bool BinaryIndex::compress( Compression compression, const char * data, size_t size, std::string& result )
+{
+  switch (compression) {
+    case NoCompression:
+      result.assign(data, size);
+      return true;
+#ifdef WITH_LZ4
+    case LZ4Compression: {
+      if (size > (size_t)LZ4_MAX_INPUT_SIZE) return false;
+      result.resize(LZ4_compressBound((int)size));
+      int packed = LZ4_compress_default(data, &result[0], (int)size, (int)result.size());
+      if (packed <= 0) return false;
+      result.resize(packed);
+      return true;
+    }
+#endif
+#ifdef WITH_ZSTD
+    case ZstdCompression: {
+      result.resize(ZSTD_compressBound(size));
+      size_t packed = ZSTD_compress(&result[0], result.size(), data, size, 3);
+      if (ZSTD_isError(packed)) return false;
+      result.resize(packed);
+      return true;
+    }
+#endif
+    default:
+      return false;
+  }
+}
+
+bool BinaryIndex::decompress( Compression compression, const char * data, size_t size, char * result, size_t rawsize )
+{
+  switch (compression) {
+    case NoCompression:
+      if (size != rawsize) return false;
+      memcpy(result, data, size);
+      return true;
+#ifdef WITH_LZ4
+    case LZ4Compression:
+      return LZ4_decompress_safe(data, result, (int)size, (int)rawsize) == (int)rawsize;
+#endif
+#ifdef WITH_ZSTD
+    case ZstdCompression:
+      return ZSTD_decompress(result, rawsize, data, size) == rawsize;
+#endif
+    default:
+      return false;
+  }
+}
+
+/* ----------------------------------------------------------------------- */
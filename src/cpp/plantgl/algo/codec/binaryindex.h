@@ -0,0 +1,200 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+/*! \file binaryindex.h
+    \brief Index of the shapes of an indexed (chunked) BGEOM file.
+*/
+
+#ifndef __binaryindex_h__
+#define __binaryindex_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/math/util_vector.h>
+#include <plantgl/tool/rcobject.h>
+#include <string>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_BEGIN_NAMESPACE
+class RealArray;
+TOOLS_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+class Point2Array;
+class Point3Array;
+class Point4Array;
+class Color4Array;
+class Index3Array;
+class Index4Array;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class BinaryIndex
+   \brief The index stored at the end of an indexed BGEOM file.
+
+   The shapes of an indexed file are stored in chunks, each chunk being
+   independently readable and possibly compressed. The index gives for each
+   chunk its position in the file and for each shape its chunk, its position
+   in the uncompressed chunk, its bounding box and its number of triangles.
+*/
+class CODEC_API BinaryIndex {
+public:
+
+  /// The compression of a chunk.
+  enum Compression { NoCompression = 0, LZ4Compression = 1, ZstdCompression = 2 };
+
+  /// Alignment in bytes of the chunks in the file and of the array payloads in a chunk.
+  static const size_t ALIGNMENT;
+
+  /// Tag ending an indexed file.
+  static const std::string TAG;
+
+  /// A chunk of shapes.
+  struct Chunk {
+    /// Position of the chunk in the file.
+    uint64_t offset;
+    /// Size of the chunk in the file.
+    uint64_t size;
+    /// Size of the uncompressed chunk.
+    uint64_t rawsize;
+    /// Compression of the chunk.
+    uchar_t compression;
+    /// Position in the index of the first shape of the chunk.
+    uint_t first;
+    /// Number of shapes of the chunk.
+    uint_t nbshapes;
+  };
+
+  /// A shape entry.
+  struct ShapeEntry {
+    /// Id of the shape.
+    uint_t id;
+    /// Chunk containing the shape.
+    uint_t chunk;
+    /// Position of the shape in the uncompressed chunk.
+    uint64_t offset;
+    /// Bounding box of the shape. Lower is greater than upper if the shape has no extent.
+    TOOLS(Vector3) lower;
+    TOOLS(Vector3) upper;
+    /// Number of triangles of the tesselation of the shape.
+    uint_t triangles;
+  };
+
+  std::vector<Chunk> chunks;
+
+  std::vector<ShapeEntry> shapes;
+
+  /// Returns the positions in the index of the shapes whose id is in \e ids.
+  std::vector<uint_t> findShapes( const std::vector<uint_t>& ids ) const;
+
+  /// Returns the positions in the index of the shapes whose bounding box intersects [\e lower, \e upper].
+  std::vector<uint_t> findShapes( const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper ) const;
+
+  /// Returns whether \e compression is available in this build.
+  static bool isSupported( Compression compression );
+
+  /// Compresses \e size bytes of \e data in \e result. Returns false if it fails.
+  static bool compress( Compression compression, const char * data, size_t size, std::string& result );
+
+  /// Decompresses \e size bytes of \e data in the \e rawsize bytes of \e result. Returns false if it fails.
+  static bool decompress( Compression compression, const char * data, size_t size, char * result, size_t rawsize );
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/** \struct BinaryAlignedArray
+    \brief Tells whether the payload of an array of type \e Array is aligned in an
+    indexed file. These are the arrays that BinaryParser decodes in bulk. */
+template<class Array>
+struct BinaryAlignedArray { static const bool value = false; };
+
+template<> struct BinaryAlignedArray<TOOLS(RealArray)> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Point2Array> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Point3Array> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Point4Array> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Color4Array> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Index3Array> { static const bool value = true; };
+template<> struct BinaryAlignedArray<Index4Array> { static const bool value = true; };
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \struct BinaryBuffer
+   \brief The payload of an array stored out of a binary stream.
+
+   When a list of buffers is given to BinaryPrinter, the large aligned arrays
+   are not copied in the stream. Their memory is referred to by a buffer and
+   the stream only contains the position of the buffer in the list. The same
+   list must be given to BinaryParser to read the stream back. The components
+   of the vectors of the point arrays are packed in a buffer of reals since
+   the vectors have a virtual table.
+*/
+struct CODEC_API BinaryBuffer {
+
+  /// Position written in the stream for an array stored in the stream.
+  static const uint32_t INLINE;
+
+  BinaryBuffer(const char * _data = NULL, size_t _size = 0,
+               const TOOLS(RefCountObjectPtr)& _owner = TOOLS(RefCountObjectPtr)()) :
+    data(_data), size(_size), owner(_owner) {}
+
+  /// The payload.
+  const char * data;
+  /// Size in bytes of the payload.
+  size_t size;
+  /// The object owning the payload, if any.
+  TOOLS(RefCountObjectPtr) owner;
+};
+
+typedef std::vector<BinaryBuffer> BinaryBufferList;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __binaryindex_h__
+#endif
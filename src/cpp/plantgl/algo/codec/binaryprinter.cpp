@@ -34,6 +34,8 @@
 
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
+#include <plantgl/tool/util_endian.h>
 #include <plantgl/tool/util_enviro.h>
 
 
@@ -47,6 +49,8 @@
 #include <plantgl/pgl_container.h>
 
 #include <plantgl/algo/base/statisticcomputer.h>
+#include <plantgl/algo/base/tesselator.h>
+#include <plantgl/algo/base/bboxcomputer.h>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -130,6 +134,12 @@ bool TokenCode::setStatistic(const StatisticComputer& a){
 }
 
 
+void TokenCode::setCounts(uint_t nb){
+    for(uchar_t i = 2; i < __code.size() ; i++ ){
+        __code[i].second = nb;
+    }
+}
+
 vector<uint_t> TokenCode::getCounts(){
     vector<uint_t> counts((unsigned int)45,0);
     for(pgl_hash_map<uchar_t,pair<string,uint_t> >::iterator _it = __code.begin();
@@ -238,7 +248,7 @@ leofstream& TokenCode::printAll(leofstream& stream){
 
 /* ----------------------------------------------------------------------- */
 
-string TokenCode::readCurrentToken(leifstream& stream){
+string TokenCode::readCurrentToken(lemmapstream& stream){
     if(stream.eof())return string("EOF");
     uchar_t c;
     stream >> c;
@@ -254,7 +264,7 @@ string TokenCode::readCurrentToken(leifstream& stream){
 
 /* ----------------------------------------------------------------------- */
 
-bool TokenCode::initTokens(leifstream& stream,ostream & output){
+bool TokenCode::initTokens(lemmapstream& stream,ostream & output){
   uint_t size;
   char c;
   stream >> c;
@@ -319,7 +329,7 @@ leofstream& operator<<( leofstream& stream, TokenCode& c ){
 
 #define GEOM_PRINT_BEGIN(type,obj) \
   if (!obj->unique()) { \
-    if (! __cache.insert(obj->SceneObject::getId()).second) { \
+    if (! cache(obj,obj->SceneObject::getId())) { \
       DEBUG_INFO(TokReference,obj->getName(),obj->SceneObject::getId()) \
       printType(TokReference); \
       writeUint32(obj->SceneObject::getId()); \
@@ -449,6 +459,10 @@ void BinaryPrinter::write(const Matrix4& val) {
         writeReal(*it);
 }
 
+void BinaryPrinter::write(const GeometryPtr& val) {
+    GEOM_PRINT_GEOMETRY(val);
+}
+
 #define GEOM_PRINT_TRANSFO4(obj) { \
     Matrix4 m= obj->getMatrix(); \
     for( uchar_t _itVec= 0; _itVec < 4; ++_itVec ){	\
@@ -487,13 +501,25 @@ void BinaryPrinter::write(const Matrix4& val) {
 
 const float BinaryPrinter::BINARY_FORMAT_VERSION(2.5f);
 
+const float BinaryPrinter::INDEXED_FORMAT_VERSION(3.0f);
+
+const size_t BinaryPrinter::DEFAULT_CHUNK_SIZE(1 << 20);
+
+const size_t BinaryPrinter::DEFAULT_BUFFER_SIZE(1 << 12);
+
 /* ----------------------------------------------------------------------- */
 
 
-BinaryPrinter::BinaryPrinter( leofstream& outputStream  ) :
+BinaryPrinter::BinaryPrinter( leofstream& outputStream, float version ) :
   Printer(outputStream.getStream(),outputStream.getStream(),outputStream.getStream()),
   __outputStream(outputStream),
-  __tokens(BINARY_FORMAT_VERSION){
+  __tokens(version),
+  __index(NULL),
+  __tesselator(NULL),
+  __bboxComputer(NULL),
+  __sizePos(0),
+  __buffers(NULL),
+  __minBufferSize(DEFAULT_BUFFER_SIZE){
 }
 
 BinaryPrinter::~BinaryPrinter( ) {
@@ -525,6 +551,10 @@ void BinaryPrinter::writeUint32(uint_t var)
 { __outputStream << var; }
 // #endif
 
+/// write an uint64_t value from stream as two uint32
+void BinaryPrinter::writeUint64(uint64_t var)
+{ writeUint32(uint_t(var & 0xffffffff)); writeUint32(uint_t(var >> 32)); }
+
   /// write an int32_t value from stream
 void BinaryPrinter::writeInt32(int_t var)
 /*#if __WORDSIZE == 64
@@ -553,17 +583,68 @@ void BinaryPrinter::writeString(const std::string& var)
 void BinaryPrinter::writeFile(const std::string& var)
 { __outputStream << '!' << var.c_str() << '!';  }
 
+bool BinaryPrinter::writeBuffer(const void * data, size_t size, const RefCountObject * owner)
+{
+  // The memory of an array is its little endian binary representation only on little endian hosts.
+#if !PGL_BIG_ENDIAN
+  if (size >= __minBufferSize) {
+    writeUint32(__buffers->size());
+    __buffers->push_back(BinaryBuffer((const char *)data, size, RefCountObjectPtr(const_cast<RefCountObject *>(owner))));
+    return true;
+  }
+#endif
+  writeUint32(BinaryBuffer::INLINE);
+  return false;
+}
+
+/// Pack the \e dim components of the vectors of \e array in a buffer of reals.
+template<class Array>
+inline bool write_vector_buffer(BinaryPrinter& printer, const Array& array, uchar_t dim, size_t minsize)
+{
+  size_t size = array.size() * dim * sizeof(real_t);
+  // The small arrays are kept in the stream without being packed.
+  if (size < minsize) return printer.writeBuffer(NULL, size, NULL);
+  RealArrayPtr packed(new RealArray(array.size() * dim));
+  RealArray::iterator itpacked = packed->begin();
+  for (typename Array::const_iterator it = array.begin(); it != array.end(); ++it, itpacked += dim)
+    std::copy(&it->getAt(0), &it->getAt(0) + dim, itpacked);
+  return printer.writeBuffer(&*packed->begin(), size, packed.get());
+}
+
+bool BinaryPrinter::writeArrayBuffer(const Point2Array& array)
+{ return write_vector_buffer(*this, array, 2, __minBufferSize); }
+
+bool BinaryPrinter::writeArrayBuffer(const Point3Array& array)
+{ return write_vector_buffer(*this, array, 3, __minBufferSize); }
+
+bool BinaryPrinter::writeArrayBuffer(const Point4Array& array)
+{ return write_vector_buffer(*this, array, 4, __minBufferSize); }
+
+void BinaryPrinter::setOutOfBandBuffers(BinaryBufferList * buffers, size_t minSize)
+{
+  __buffers = buffers;
+  __minBufferSize = minSize;
+}
+
+void BinaryPrinter::writePadding(size_t alignment)
+{
+  size_t pos = (size_t)__outputStream.getStream().tellp();
+  size_t padding = (alignment - pos % alignment) % alignment;
+  if (padding > 0) {
+    std::vector<char> zeros(padding, 0);
+    __outputStream.write(&zeros[0], padding);
+  }
+}
+
 
 /* ----------------------------------------------------------------------- */
 bool BinaryPrinter::print(ScenePtr scene,string filename,const char * comment){
     leofstream stream(filename.c_str());
     if(!stream)return false;
     else {
-	    string cwd = get_cwd();
-		chg_dir(get_dirname(filename));
         BinaryPrinter _bp(stream);
+        _bp.setDirectory(get_dirname(absolute_filename(filename)));
         _bp.print(scene,comment);
-		chg_dir(cwd);
         return true;
     }
 }
@@ -583,13 +664,170 @@ bool BinaryPrinter::print(ScenePtr scene,const char * comment){
     return scene->apply(*this);
 }
 
+bool BinaryPrinter::printObject(SceneObjectPtr object,const char * comment){
+    if(!object) return false;
+    header(comment);
+    StatisticComputer _sc;
+    object->apply(_sc);
+    __tokens.setStatistic(_sc);
+    __tokens.printAll(__outputStream );
+    writeUint32(1);
+    return object->apply(*this);
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool BinaryPrinter::begin(const char * comment){
+    if(!Printer::begin(comment)) return false;
+    __tokens.setCounts(1);
+    __tokens.printAll(__outputStream);
+    // The number of shapes is written at the end of the stream.
+    __sizePos = __outputStream.getStream().tellp();
+    writeUint32(0);
+    return __outputStream.getStream().good();
+}
+
+bool BinaryPrinter::end(){
+    if(!isStreaming()) return false;
+    ostream& stream = __outputStream.getStream();
+    streampos endPos = stream.tellp();
+    stream.seekp(__sizePos);
+    writeUint32(__streamedShapes);
+    stream.seekp(endPos);
+    return Printer::end();
+}
+
+/* ----------------------------------------------------------------------- */
+
+static bool INDEXED_BY_DEFAULT = false;
+
+bool BinaryPrinter::isIndexedByDefault(){
+    return INDEXED_BY_DEFAULT;
+}
+
+void BinaryPrinter::setIndexedByDefault(bool indexed){
+    INDEXED_BY_DEFAULT = indexed;
+}
+
+bool BinaryPrinter::printIndexed(ScenePtr scene,string filename,const char * comment,
+                                 BinaryIndex::Compression compression, size_t chunkSize){
+    leofstream stream(filename.c_str());
+    if(!stream)return false;
+    else {
+        // The file names are made relative to the directory of the file without changing the current directory.
+        BinaryPrinter _bp(stream,INDEXED_FORMAT_VERSION);
+        _bp.setDirectory(get_dirname(absolute_filename(filename)));
+        return _bp.printIndexed(scene,comment,compression,chunkSize);
+    }
+}
+
+bool BinaryPrinter::printIndexed(ScenePtr scene, const char * comment,
+                                 BinaryIndex::Compression compression, size_t chunkSize){
+    if(!BinaryIndex::isSupported(compression)){
+        cerr << "Compression " << int(compression) << " not available. Chunks are not compressed." << endl;
+        compression = BinaryIndex::NoCompression;
+    }
+    header(comment);
+    StatisticComputer _sc;
+    scene->apply(_sc);
+    __tokens.setStatistic(_sc);
+    __tokens.printAll(__outputStream );
+    writeUint32(scene->size());
+
+    BinaryIndex index;
+    Tesselator tesselator;
+    BBoxComputer bboxComputer(tesselator);
+    bool result = true;
+    Scene::const_iterator _it = scene->begin();
+    while(_it != scene->end()){
+        // Each chunk is printed by its own printer so that it does not refer to objects of other chunks.
+        leomstream chunkStream;
+        BinaryPrinter _bp(chunkStream,__tokens.getVersion());
+        _bp.__index = &index;
+        _bp.__tesselator = &tesselator;
+        _bp.__bboxComputer = &bboxComputer;
+        _bp.__directory = __directory;
+
+        BinaryIndex::Chunk chunk;
+        chunk.first = index.shapes.size();
+        for(; _it != scene->end() && chunkStream.size() < chunkSize; ++_it)
+            if(!(*_it)->apply(_bp)) result = false;
+        chunk.nbshapes = index.shapes.size() - chunk.first;
+
+        string data = chunkStream.str();
+        chunk.rawsize = data.size();
+        chunk.compression = BinaryIndex::NoCompression;
+        string packed;
+        if(compression != BinaryIndex::NoCompression &&
+           BinaryIndex::compress(compression,data.data(),data.size(),packed) && packed.size() < data.size()){
+            chunk.compression = compression;
+            data.swap(packed);
+        }
+        chunk.size = data.size();
+
+        writePadding(BinaryIndex::ALIGNMENT);
+        chunk.offset = (uint64_t)__outputStream.getStream().tellp();
+        __outputStream.write(data.data(),data.size());
+        index.chunks.push_back(chunk);
+    }
+
+    writePadding(BinaryIndex::ALIGNMENT);
+    uint64_t indexPos = (uint64_t)__outputStream.getStream().tellp();
+    printIndex(index);
+    writeUint64(indexPos);
+    __outputStream << BinaryIndex::TAG;
+    return result;
+}
+
+void BinaryPrinter::indexShape(uint64_t pos, uint_t id, const GeometryPtr& geometry){
+    BinaryIndex::ShapeEntry entry;
+    entry.id = id;
+    entry.chunk = __index->chunks.size();
+    entry.offset = pos;
+    entry.lower = Vector3(REAL_MAX,REAL_MAX,REAL_MAX);
+    entry.upper = -entry.lower;
+    entry.triangles = 0;
+    if(geometry){
+        if(geometry->apply(*__bboxComputer) && __bboxComputer->getBoundingBox()){
+            entry.lower = __bboxComputer->getBoundingBox()->getLowerLeftCorner();
+            entry.upper = __bboxComputer->getBoundingBox()->getUpperRightCorner();
+        }
+        if(geometry->apply(*__tesselator) && __tesselator->getTriangulation())
+            entry.triangles = __tesselator->getTriangulation()->getIndexListSize();
+    }
+    __index->shapes.push_back(entry);
+}
+
+void BinaryPrinter::printIndex(const BinaryIndex& index){
+    __outputStream << '!';
+    writeUint32(index.chunks.size());
+    for(vector<BinaryIndex::Chunk>::const_iterator _it = index.chunks.begin(); _it != index.chunks.end(); ++_it){
+        writeUint64(_it->offset);
+        writeUint64(_it->size);
+        writeUint64(_it->rawsize);
+        writeUchar(_it->compression);
+        writeUint32(_it->first);
+        writeUint32(_it->nbshapes);
+    }
+    writeUint32(index.shapes.size());
+    for(vector<BinaryIndex::ShapeEntry>::const_iterator _it = index.shapes.begin(); _it != index.shapes.end(); ++_it){
+        writeUint32(_it->id);
+        writeUint32(_it->chunk);
+        writeUint64(_it->offset);
+        write(_it->lower);
+        write(_it->upper);
+        writeUint32(_it->triangles);
+    }
+    __outputStream << '!';
+}
+
 
 
 /* ----------------------------------------------------------------------- */
 
 bool BinaryPrinter::header(const char * comment){
     __outputStream << string("!bGEOM");
-    __outputStream << float(BINARY_FORMAT_VERSION) << char(13) << char(10);
+    __outputStream << float(__tokens.getVersion()) << char(13) << char(10);
   if(__tokens.getVersion() >= 1.6f){
 #ifdef PGL_USE_DOUBLE
 	uchar_t precision = 64 ;
@@ -617,11 +855,16 @@ void BinaryPrinter::printType(const string& _string){
 /* ----------------------------------------------------------------------- */
 void 
 BinaryPrinter::printFile(const std::string& FileName){
-	writeFile(getCanonicalFilename(FileName));
+	writeFile(getCanonicalFilename(FileName,__directory.empty() ? get_cwd() : __directory));
 }
 
 std::string 
 BinaryPrinter::getCanonicalFilename(const std::string& FileName){
+  return getCanonicalFilename(FileName,get_cwd());
+}
+
+std::string 
+BinaryPrinter::getCanonicalFilename(const std::string& FileName, const std::string& directory){
   if(FileName.empty()){
 	return "";
   }
@@ -632,7 +875,7 @@ BinaryPrinter::getCanonicalFilename(const std::string& FileName){
 	  return f;
   }
   string pref1 = pref;
-  string cwd = short_dirname(get_cwd());
+  string cwd = short_dirname(directory);
   if(cwd.empty() || cwd == "."){
 	  return f;	
   }
@@ -687,6 +930,7 @@ bool BinaryPrinter::process(Shape * Shape){
 
 
     DEBUG_INFO("Shape",Shape->getName(),Shape->SceneObject::getId());
+    uint64_t pos = (__index ? (uint64_t)__outputStream.getStream().tellp() : 0);
     printType("Shape");
     writeString(Shape->getName());
     writeUint32(Shape->id);
@@ -694,6 +938,7 @@ bool BinaryPrinter::process(Shape * Shape){
         writeUint32(Shape->parentId);
     Shape->geometry->apply(*this);
     Shape->appearance->apply(*this);
+    if(__index) indexShape(pos,Shape->id,Shape->geometry);
 
     return true;
 }
@@ -730,12 +975,16 @@ bool BinaryPrinter::process(Inline * geomInline){
         ShapePtr shape = dynamic_pointer_cast<Shape>(*_it);
         if(shape){
 		  DEBUG_INFO("Shape",shape->getName(),shape->SceneObject::getId());
+          uint64_t pos = (__index ? (uint64_t)__outputStream.getStream().tellp() : 0);
           printType("Shape");
           writeString(shape->getName());
 		  writeUint32(shape->id);
+          if(__tokens.getVersion() >= 1.9f)
+              writeUint32(shape->parentId);
           _s->getGeometry() = shape->getGeometry();
           _transf->apply(*this);
           shape->appearance->apply(*this);
+          if(__index) indexShape(pos,shape->id,_transf);
         }
         else {
 
@@ -42,6 +42,7 @@
 #define __actn_binaryprinter_h__
 
 #include "printer.h"
+#include "binaryindex.h"
 #include <plantgl/tool/rcobject.h>
 
 #include <plantgl/tool/util_hashmap.h>
@@ -50,7 +51,7 @@
 #include <vector>
 
 TOOLS_BEGIN_NAMESPACE
-class leifstream;
+class lemmapstream;
 class leofstream;
 TOOLS_END_NAMESPACE
 
@@ -61,8 +62,14 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 class StatisticComputer;
+class Tesselator;
+class BBoxComputer;
 class Scene;
 typedef RCPtr<Scene> ScenePtr;
+class Geometry;
+typedef RCPtr<Geometry> GeometryPtr;
+class SceneObject;
+typedef RCPtr<SceneObject> SceneObjectPtr;
 
 
 /* ----------------------------------------------------------------------- */
@@ -88,17 +95,20 @@ public:
   /// Add statistic for faster parsing.
   bool setStatistic(const StatisticComputer& a);
 
+  /// Set the number of element of each class to \e nb, so that all the tokens are printed.
+  void setCounts(uint_t nb);
+
   /// print the token \e token  on \e stream. ex :  printToken(stream,Token(Reference));.
   TOOLS(leofstream)& printCurrentToken(TOOLS(leofstream)& stream,std::string token);
 
   /// read \e stream and return current token.
-  std::string readCurrentToken(TOOLS(leifstream)& stream);
+  std::string readCurrentToken(TOOLS(lemmapstream)& stream);
 
   /// print all the token on \e stream.
   TOOLS(leofstream)& printAll(TOOLS(leofstream)& stream);
 
   /// read token on \e stream. return if it works.
-  bool initTokens(TOOLS(leifstream)& stream,std::ostream & output);
+  bool initTokens(TOOLS(lemmapstream)& stream,std::ostream & output);
 
   /// print the local Token.
   friend CODEC_API TOOLS(leofstream)& operator<<( TOOLS(leofstream)& stream, TokenCode& c );
@@ -139,8 +149,17 @@ public:
   /// The Version Number of Geom Binary Format.
   static const float BINARY_FORMAT_VERSION;
 
+  /// The Version Number of the indexed Geom Binary Format.
+  static const float INDEXED_FORMAT_VERSION;
+
+  /// The default size of the chunks of an indexed file.
+  static const size_t DEFAULT_CHUNK_SIZE;
+
+  /// The default minimal size of the arrays stored out of the stream.
+  static const size_t DEFAULT_BUFFER_SIZE;
+
   /** Constructs a Printer with the output streams \e outputStream. */
-  BinaryPrinter( TOOLS(leofstream)& outputStream );
+  BinaryPrinter( TOOLS(leofstream)& outputStream, float version = BINARY_FORMAT_VERSION );
 
   /// Destructor
   virtual ~BinaryPrinter( );
@@ -148,9 +167,38 @@ public:
   /// Print \e scene in \e filename in binary format.
   virtual bool print(ScenePtr scene, const char * comment = NULL);
 
+  /** Print \e scene in indexed binary format. Shapes are grouped in chunks of
+      about \e chunkSize bytes, compressed with \e compression if available,
+      and indexed at the end of the file. */
+  virtual bool printIndexed(ScenePtr scene, const char * comment = NULL,
+                            BinaryIndex::Compression compression = BinaryIndex::NoCompression,
+                            size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+  /// Print \e object alone in binary format. The sub-objects it shares are printed once.
+  virtual bool printObject(SceneObjectPtr object, const char * comment = NULL);
+
+  /** Arrays of at least \e minSize bytes are appended to \e buffers instead of being
+      printed in the stream. The buffers refer to the memory of the arrays.
+      If \e buffers is NULL, all the arrays are printed in the stream. */
+  void setOutOfBandBuffers(BinaryBufferList * buffers, size_t minSize = DEFAULT_BUFFER_SIZE);
+
   /// Print header of GEOM binary File.
   virtual bool header(const char * comment = NULL);
 
+  /// @name Streaming
+  //@{
+
+  /** Begins a stream of shapes. All the tokens are declared since the
+      content of the stream is not known. */
+  virtual bool begin(const char * comment = NULL);
+
+  using Printer::add;
+
+  /// Ends the stream of shapes and writes the number of shapes in the header.
+  virtual bool end();
+
+  //@}
+
   /// @name Pre and Post Processing
   //@{
 
@@ -273,11 +321,28 @@ public:
 
   void printFile(const std::string&);
 
+  /** Set the directory of the printed file. The file names are printed relatively to it.
+      The current directory is used if it is empty. */
+  void setDirectory(const std::string& directory) { __directory = directory; }
+
   static std::string getCanonicalFilename(const std::string&);
 
+  /// Return \e FileName relatively to \e directory or to the PlantGL directory if possible.
+  static std::string getCanonicalFilename(const std::string& FileName, const std::string& directory);
+
   /// Print the scene \e scene in the file \e filename in binary format.
   static bool print(ScenePtr scene,std::string filename,const char * comment = NULL);
 
+  /// Print the scene \e scene in the file \e filename in indexed binary format.
+  static bool printIndexed(ScenePtr scene,std::string filename,const char * comment = NULL,
+                           BinaryIndex::Compression compression = BinaryIndex::NoCompression,
+                           size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+  /** Whether the BGEOM codec writes the indexed format (version 3.0). The versions of PlantGL
+      prior to it cannot read this format, so the codec writes the version 2.5 by default. */
+  static bool isIndexedByDefault();
+  static void setIndexedByDefault(bool indexed);
+
 //private :
 
 
@@ -290,6 +355,9 @@ public:
   void writeUint32(uint_t var);
   inline void write(uint_t var) { writeUint32(var); }
 
+  /// write an uint64_t value from stream
+  void writeUint64(uint64_t var);
+
   /// write an uint_t value from stream
   void writeInt32(int_t var);
   inline void write(int_t var) { writeInt32(var); }
@@ -324,11 +392,16 @@ public:
   void write(const TOOLS(Matrix2)& var);
   void write(const TOOLS(Matrix3)& var);
   void write(const TOOLS(Matrix4)& var);
+  void write(const GeometryPtr& var);
 
   template<class Array>
   void writeArray(const Array& array){
     uint_t _sizei = array.size();
     writeUint32(_sizei);
+    if (_sizei > 0 && BinaryAlignedArray<Array>::value) {
+      if (__buffers && writeArrayBuffer(array)) return;
+      if (__index) writePadding(BinaryIndex::ALIGNMENT);
+    }
     for (typename Array::const_iterator it = array.begin(); it != array.end(); ++it) { 
       write(*it);
     };
@@ -358,16 +431,59 @@ public:
       writeMatrix(array);
   }
 
+  /// write zeros up to the next position multiple of \e alignment.
+  void writePadding(size_t alignment);
+
+  /** write the position of the out of band buffer of the \e size bytes of \e data,
+      or BinaryBuffer::INLINE if they must be printed in the stream. Return whether they are out of band. */
+  bool writeBuffer(const void * data, size_t size, const TOOLS(RefCountObject) * owner);
+
+  /// write the out of band buffer of the elements of \e array. Return whether it is out of band.
+  template<class Array>
+  bool writeArrayBuffer(const Array& array)
+  { return writeBuffer(&*array.begin(), array.size() * sizeof(typename Array::element_type), &array); }
+
+  /** The vectors have a virtual table, so their components are packed in
+      a buffer of reals that can be read by another process. */
+  bool writeArrayBuffer(const Point2Array& array);
+  bool writeArrayBuffer(const Point3Array& array);
+  bool writeArrayBuffer(const Point4Array& array);
+
 protected:
   /// Return a Token Number for the string \e _string.
   void printType(const std::string& _string);
 
+  /// Add to the index the shape of id \e id starting at \e pos in the current chunk.
+  void indexShape(uint64_t pos, uint_t id, const GeometryPtr& geometry);
+
+  /// Print the index of an indexed file.
+  void printIndex(const BinaryIndex& index);
+
   /// Binary output stream.
   TOOLS(leofstream)& __outputStream;
 
   /// The tokens codes.
   TokenCode __tokens;
 
+  /// The index filled when printing a chunk of an indexed file, NULL otherwise.
+  BinaryIndex * __index;
+
+  /// Computers of the bounding boxes and triangle counts of the index.
+  Tesselator * __tesselator;
+  BBoxComputer * __bboxComputer;
+
+  /// Position of the number of shapes in the header of a stream.
+  std::streampos __sizePos;
+
+  /// The out of band buffers, NULL if all the arrays are printed in the stream.
+  BinaryBufferList * __buffers;
+
+  /// Minimal size of the out of band buffers.
+  size_t __minBufferSize;
+
+  /// The directory of the printed file, or empty for the current directory.
+  std::string __directory;
+
 };
 
 
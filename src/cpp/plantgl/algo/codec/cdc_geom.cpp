@@ -82,7 +82,9 @@ TOOLS_USING_NAMESPACE
 #endif
 
 #include "scne_binaryparser.h"
+#include "scne_arrayscanner.h"
 #include <plantgl/tool/readline.h>
+#include <plantgl/tool/mmapstream.h>
 
 using namespace std;
 
@@ -144,10 +146,13 @@ ScenePtr GeomCodec::read(const std::string& fname)
   } */
 #ifdef WITH_BISONFLEX
   else {
-    ifstream _file(fname.c_str());
+    // The large arrays of the memory mapped file are parsed in bulk before the lexer runs.
+    MemoryMappedFile _file(fname);
+    GeomArrayScanner _arrays(_file.data(),_file.isValid() ? _file.size() : 0);
+    std::istream _stream(&_arrays);
 	SceneObjectSymbolTable table;
 	ScenePtr scene(new Scene());
-	bool b = geom_read(_file,table,scene,fname);
+	bool b = geom_read(_stream,table,scene,fname);
     if(!b) return ScenePtr();
 	else {
 		if(scene && !scene->empty()) return scene;
@@ -162,7 +167,9 @@ bool GeomCodec::write(const std::string& fname,const ScenePtr&	scene)
 	std::string ext = get_suffix(fname);
 	ext = toUpper(ext);
 	if(ext == "BGEOM"){
-		BinaryPrinter::print(scene,fname,"File Generated with PlantGL.");
+		if(BinaryPrinter::isIndexedByDefault())
+			BinaryPrinter::printIndexed(scene,fname,"File Generated with PlantGL.");
+		else BinaryPrinter::print(scene,fname,"File Generated with PlantGL.");
         return true;
 	}
 	else{
@@ -205,7 +212,10 @@ ScenePtr BGeomCodec::read(const std::string& fname)
 
 bool BGeomCodec::write(const std::string& fname,const ScenePtr&	scene)
 {
-    BinaryPrinter::print(scene,fname,"File Generated with PlantGL.");
+    // The indexed format (version 3.0) is written only if requested: older readers cannot read it.
+    if(BinaryPrinter::isIndexedByDefault())
+        BinaryPrinter::printIndexed(scene,fname,"File Generated with PlantGL.");
+    else BinaryPrinter::print(scene,fname,"File Generated with PlantGL.");
     return true;
 }
 /* ----------------------------------------------------------------------- */
@@ -0,0 +1,652 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "cdc_gltf.h"
+
+#include <plantgl/algo/base/discretizer.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/colorarray.h>
+#include <plantgl/scenegraph/container/geometryarray2.h>
+#include <plantgl/scenegraph/geometry/mesh.h>
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/scenegraph/geometry/group.h>
+#include <plantgl/scenegraph/transformation/mattransformed.h>
+#include <plantgl/scenegraph/appearance/material.h>
+#include <plantgl/scenegraph/appearance/texture.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/util_string.h>
+#include <plantgl/tool/dirnames.h>
+#include <plantgl/tool/errormsg.h>
+#include <math.h>
+#include <sstream>
+#include <string.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// glTF component types, buffer targets and primitive modes.
+enum { GLTF_BYTE = 5120, GLTF_UNSIGNED_BYTE = 5121, GLTF_SHORT = 5122,
+       GLTF_UNSIGNED_SHORT = 5123, GLTF_UNSIGNED_INT = 5125, GLTF_FLOAT = 5126 };
+enum { GLTF_ARRAY_BUFFER = 34962, GLTF_ELEMENT_ARRAY_BUFFER = 34963 };
+enum { GLTF_POINTS = 0, GLTF_LINE_STRIP = 3, GLTF_TRIANGLES = 4 };
+
+/// Returns \e value as a JSON number.
+static std::string gltfReal(double value)
+{
+    if (!(value == value) || value > 1e300 || value < -1e300) value = 0;
+    char buffer[32];
+    sprintf(buffer, "%.9g", value);
+    return buffer;
+}
+
+/// Returns \e text as a JSON string.
+static std::string gltfString(const std::string& text)
+{
+    std::string result("\"");
+    for (std::string::const_iterator c = text.begin(); c != text.end(); ++c) {
+        if (*c == '"' || *c == '\\') { result += '\\'; result += *c; }
+        else if ((unsigned char)*c < 0x20) { char buffer[8]; sprintf(buffer, "\\u%04x", (unsigned char)*c); result += buffer; }
+        else result += *c;
+    }
+    return result + '"';
+}
+
+/// Returns the elements of \e values as a JSON array.
+static std::string gltfArray(const std::vector<std::string>& values)
+{
+    std::string result("[");
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i) result += ',';
+        result += values[i];
+    }
+    return result + ']';
+}
+
+/// Returns \e matrix as a JSON array in column major order.
+static std::string gltfMatrix(const Matrix4& matrix)
+{
+    std::string result("[");
+    for (uchar_t c = 0; c < 4; ++c)
+        for (uchar_t r = 0; r < 4; ++r) {
+            if (c || r) result += ',';
+            result += gltfReal(matrix(r, c));
+        }
+    return result + ']';
+}
+
+static inline int16_t gltfQuantize16(real_t value)
+{ return int16_t(floor(std::max<real_t>(-1, std::min<real_t>(1, value)) * 32767 + 0.5)); }
+
+static inline int8_t gltfQuantize8(real_t value)
+{ return int8_t(floor(std::max<real_t>(-1, std::min<real_t>(1, value)) * 127 + 0.5)); }
+
+static inline uint8_t gltfColor(real_t value)
+{ return uint8_t(floor(std::max<real_t>(0, std::min<real_t>(1, value)) * 255 + 0.5)); }
+
+static bool gltfWriteUint32(FILE * file, uint32_t value)
+{
+    unsigned char bytes[4] = { uchar_t(value), uchar_t(value >> 8), uchar_t(value >> 16), uchar_t(value >> 24) };
+    return fwrite(bytes, 1, 4, file) == 4;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// The vertices of a primitive, with one index per vertex for all attributes.
+struct GltfVertices {
+    std::vector<Vector3> points;
+    std::vector<Vector3> normals;
+    std::vector<Vector2> texCoords;
+    std::vector<Color4> colors;
+    std::vector<uint32_t> indices;
+};
+
+/** Fills \e vertices with the triangulated faces of \e mesh. When the
+    attributes use the indices of the points, the points are kept as vertices,
+    otherwise each corner of the faces gives a vertex. */
+static void gltfTriangulate(const Mesh& mesh, const Point3ArrayPtr& computedNormals, GltfVertices& vertices)
+{
+    const Point3ArrayPtr& points = mesh.getPointList();
+    const Point3ArrayPtr& normalList = (computedNormals ? computedNormals : mesh.getNormalList());
+    const bool normalPerVertex = (computedNormals ? true : mesh.getNormalPerVertex());
+    const Point2ArrayPtr& texCoords = mesh.getTexCoordList();
+    const Color4ArrayPtr& colors = mesh.getColorList();
+    const bool hasNormals = normalList && !normalList->empty();
+    const bool hasTexCoords = texCoords && !texCoords->empty();
+    const bool hasColors = colors && !colors->empty();
+
+    bool shared = (!hasNormals || normalPerVertex) && (!hasColors || mesh.getColorPerVertex());
+    for (uint_t i = 0; shared && i < mesh.getIndexListSize(); ++i)
+        for (uint_t j = 0; shared && j < mesh.getFaceSize(i); ++j) {
+            uint_t p = mesh.getFacePointIndexAt(i, j);
+            if ((hasNormals && !computedNormals && mesh.getFaceNormalIndexAt(i, j) != p) ||
+                (hasTexCoords && mesh.getFaceTexCoordIndexAt(i, j) != p) ||
+                (hasColors && mesh.getFaceColorIndexAt(i, j) != p)) shared = false;
+        }
+
+    const bool ccw = mesh.getCCW();
+    if (shared) {
+        vertices.points.assign(points->begin(), points->end());
+        if (hasNormals) vertices.normals.assign(normalList->begin(), normalList->end());
+        if (hasTexCoords) vertices.texCoords.assign(texCoords->begin(), texCoords->end());
+        if (hasColors) vertices.colors.assign(colors->begin(), colors->end());
+    }
+    for (uint_t i = 0; i < mesh.getIndexListSize(); ++i) {
+        uint_t size = mesh.getFaceSize(i);
+        if (size < 3) continue;
+        uint32_t first = uint32_t(vertices.points.size());
+        if (!shared) {
+            for (uint_t j = 0; j < size; ++j) {
+                vertices.points.push_back(mesh.getFacePointAt(i, j));
+                if (hasNormals) vertices.normals.push_back(normalList->getAt(normalPerVertex ? mesh.getFaceNormalIndexAt(i, j) : i));
+                if (hasTexCoords) vertices.texCoords.push_back(texCoords->getAt(mesh.getFaceTexCoordIndexAt(i, j)));
+                if (hasColors) vertices.colors.push_back(colors->getAt(mesh.getColorPerVertex() ? mesh.getFaceColorIndexAt(i, j) : i));
+            }
+        }
+        for (uint_t j = 1; j + 1 < size; ++j) {
+            uint_t corners[3] = { 0, (ccw ? j : j + 1), (ccw ? j + 1 : j) };
+            for (int k = 0; k < 3; ++k)
+                vertices.indices.push_back(shared ? mesh.getFacePointIndexAt(i, corners[k]) : first + corners[k]);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+
+GltfWriter::GltfWriter(const std::string& fname) :
+    __fname(fname), __binary(toUpper(get_suffix(fname)) == "GLB"),
+    __bin(NULL), __binSize(0), __failed(false), __discretizer(new Discretizer()),
+    __releaseThreshold(256)
+{
+    if (__binary) __binName = fname + ".tmp";
+    else {
+        std::string name = get_filename(fname);
+        size_t dot = name.find_last_of('.');
+        __binName = (dot == std::string::npos ? name : name.substr(0, dot)) + ".bin";
+        if (fname.find_last_of("/\\") != std::string::npos) __binName = cat_dir_file(get_dirname(fname), __binName);
+    }
+    __bin = fopen(__binName.c_str(), "wb");
+}
+
+GltfWriter::~GltfWriter()
+{
+    if (__bin) close();
+    delete __discretizer;
+}
+
+size_t GltfWriter::writeBuffer(const void * data, size_t size)
+{
+    static const char padding[4] = { 0, 0, 0, 0 };
+    size_t offset = __binSize;
+    writeFile(__bin, data, size, __binName);
+    __binSize += size;
+    if (__binSize % 4) {
+        writeFile(__bin, padding, 4 - __binSize % 4, __binName);
+        __binSize += 4 - __binSize % 4;
+    }
+    return offset;
+}
+
+bool GltfWriter::writeFile(FILE * file, const void * data, size_t size, const std::string& fname)
+{
+    if (size == 0 || fwrite(data, 1, size, file) == size) return true;
+    if (!__failed) pglErrorEx(PGLERRORMSG(C_FILE_WRITE_ERR_s), fname.c_str());
+    __failed = true;
+    return false;
+}
+
+void GltfWriter::releaseCache()
+{
+    for (std::map<size_t, std::pair<AppearancePtr,int> >::iterator it = __materialCache.begin(); it != __materialCache.end(); ) {
+        if (it->second.first->use_count() == 1) __materialCache.erase(it++);
+        else ++it;
+    }
+    // A mesh is also forgotten with its appearance.
+    for (std::map<std::pair<size_t,size_t>, GltfMesh>::iterator it = __meshCache.begin(); it != __meshCache.end(); ) {
+        if (it->second.geometry->use_count() == 1 ||
+            (it->first.second != 0 && __materialCache.find(it->first.second) == __materialCache.end())) __meshCache.erase(it++);
+        else ++it;
+    }
+    for (std::map<size_t, std::pair<ImageTexturePtr,int> >::iterator it = __textureCache.begin(); it != __textureCache.end(); ) {
+        if (it->second.first->use_count() == 1) __textureCache.erase(it++);
+        else ++it;
+    }
+    // The caches are scanned when their size doubles, so that adding a shape takes a constant time on average.
+    __releaseThreshold = std::max<size_t>(256, 2 * (__meshCache.size() + __materialCache.size() + __textureCache.size()));
+}
+
+int GltfWriter::bufferView(size_t offset, size_t length, size_t stride, int target)
+{
+    std::stringstream view;
+    view << "{\"buffer\":0,\"byteOffset\":" << offset << ",\"byteLength\":" << length;
+    if (stride) view << ",\"byteStride\":" << stride;
+    if (target) view << ",\"target\":" << target;
+    view << '}';
+    __bufferViews.push_back(view.str());
+    return int(__bufferViews.size() - 1);
+}
+
+int GltfWriter::accessor(int view, size_t offset, int component, bool normalized, size_t count,
+                         const char * type, const std::string& bounds)
+{
+    std::stringstream accessor;
+    accessor << "{\"bufferView\":" << view << ",\"byteOffset\":" << offset << ",\"componentType\":" << component;
+    if (normalized) accessor << ",\"normalized\":true";
+    accessor << ",\"count\":" << count << ",\"type\":\"" << type << '"' << bounds << '}';
+    __accessors.push_back(accessor.str());
+    return int(__accessors.size() - 1);
+}
+
+int GltfWriter::texture(const ImageTexturePtr& image)
+{
+    std::map<size_t, std::pair<ImageTexturePtr,int> >::const_iterator cached = __textureCache.find(image->getId());
+    if (cached != __textureCache.end()) return cached->second.second;
+
+    const std::string& filename = image->getFilename();
+    std::string suffix = toUpper(get_suffix(filename));
+    std::string mimeType = (suffix == "PNG" ? "image/png" : (suffix == "JPG" || suffix == "JPEG" ? "image/jpeg" : ""));
+    std::stringstream result;
+    std::vector<char> content;
+    if (__binary && !mimeType.empty()) {
+        FILE * file = fopen(filename.c_str(), "rb");
+        if (file) {
+            char buffer[1 << 16];
+            size_t nb;
+            while ((nb = fread(buffer, 1, sizeof(buffer), file)) > 0) content.insert(content.end(), buffer, buffer + nb);
+            fclose(file);
+        }
+    }
+    if (!content.empty()) {
+        int view = bufferView(writeBuffer(&content[0], content.size()), content.size(), 0, 0);
+        result << "{\"bufferView\":" << view << ",\"mimeType\":\"" << mimeType << "\"}";
+    }
+    else result << "{\"uri\":" << gltfString(filename) << '}';
+    __images.push_back(result.str());
+
+    std::stringstream sampler;
+    sampler << "{\"wrapS\":" << (image->getRepeatS() ? 10497 : 33071)
+            << ",\"wrapT\":" << (image->getRepeatT() ? 10497 : 33071) << '}';
+    __samplers.push_back(sampler.str());
+
+    std::stringstream texture;
+    texture << "{\"source\":" << __images.size() - 1 << ",\"sampler\":" << __samplers.size() - 1 << '}';
+    __textures.push_back(texture.str());
+    __textureCache[image->getId()] = std::make_pair(image, int(__textures.size() - 1));
+    return int(__textures.size() - 1);
+}
+
+int GltfWriter::material(const AppearancePtr& appearance)
+{
+    if (!appearance) return -1;
+    std::map<size_t, std::pair<AppearancePtr,int> >::const_iterator cached = __materialCache.find(appearance->getId());
+    if (cached != __materialCache.end()) return cached->second.second;
+
+    MaterialPtr mat = dynamic_pointer_cast<Material>(appearance);
+    Texture2DPtr tex = dynamic_pointer_cast<Texture2D>(appearance);
+    if (!mat && !tex) { __materialCache[appearance->getId()] = std::make_pair(appearance, -1); return -1; }
+
+    std::stringstream result;
+    result << '{';
+    if (appearance->isNamed()) result << "\"name\":" << gltfString(appearance->getName()) << ',';
+    real_t r, g, b, alpha, roughness = 1;
+    int textureIndex = -1;
+    if (mat) {
+        Color3 diffuse = mat->getDiffuseColor();
+        r = diffuse.getRedClamped(); g = diffuse.getGreenClamped(); b = diffuse.getBlueClamped();
+        alpha = 1 - mat->getTransparency();
+        roughness = 1 - mat->getShininess();
+    }
+    else {
+        const Color4& color = tex->getBaseColor();
+        r = color.getRedClamped(); g = color.getGreenClamped(); b = color.getBlueClamped();
+        alpha = 1 - color.getAlphaClamped();
+        if (tex->getImage() && !tex->getImage()->getFilename().empty()) textureIndex = texture(tex->getImage());
+    }
+    result << "\"pbrMetallicRoughness\":{\"baseColorFactor\":[" << gltfReal(r) << ',' << gltfReal(g) << ','
+           << gltfReal(b) << ',' << gltfReal(alpha) << "],\"metallicFactor\":0,\"roughnessFactor\":" << gltfReal(roughness);
+    if (textureIndex >= 0) result << ",\"baseColorTexture\":{\"index\":" << textureIndex << '}';
+    result << '}';
+    if (mat) {
+        const Color3& emission = mat->getEmission();
+        if (emission != Color3::BLACK)
+            result << ",\"emissiveFactor\":[" << gltfReal(emission.getRedClamped()) << ','
+                   << gltfReal(emission.getGreenClamped()) << ',' << gltfReal(emission.getBlueClamped()) << ']';
+    }
+    if (alpha < 1) result << ",\"alphaMode\":\"BLEND\"";
+    result << ",\"doubleSided\":true}";
+    __materials.push_back(result.str());
+    __materialCache[appearance->getId()] = std::make_pair(appearance, int(__materials.size() - 1));
+    return int(__materials.size() - 1);
+}
+
+bool GltfWriter::primitive(const ExplicitModelPtr& model, int material, std::string& result, Matrix4& dequantization)
+{
+    GltfVertices vertices;
+    int mode = GLTF_TRIANGLES;
+    MeshPtr mesh = dynamic_pointer_cast<Mesh>(model);
+    if (mesh) {
+        Point3ArrayPtr normals;
+        if (!mesh->hasNormalList()) normals = mesh->computeNormalPerVertex();
+        gltfTriangulate(*mesh, normals, vertices);
+        if (vertices.indices.empty()) return false;
+    }
+    else {
+        const Point3ArrayPtr& points = model->getPointList();
+        vertices.points.assign(points->begin(), points->end());
+        if (model->hasColorList() && model->getColorList()->size() == points->size())
+            vertices.colors.assign(model->getColorList()->begin(), model->getColorList()->end());
+        mode = (dynamic_pointer_cast<Polyline>(model) ? GLTF_LINE_STRIP : GLTF_POINTS);
+    }
+    const size_t nbVertices = vertices.points.size();
+    if (nbVertices == 0) return false;
+
+    // Positions are quantized in the bounding cube of the vertices.
+    Vector3 lower = vertices.points[0], upper = vertices.points[0];
+    for (size_t i = 1; i < nbVertices; ++i) {
+        lower = Min(lower, vertices.points[i]);
+        upper = Max(upper, vertices.points[i]);
+    }
+    Vector3 center = (lower + upper) / 2;
+    real_t extent = std::max(std::max(upper.x() - lower.x(), upper.y() - lower.y()), upper.z() - lower.z()) / 2;
+    if (extent <= 0) extent = 1;
+    dequantization = Matrix4::translation(center);
+    for (uchar_t i = 0; i < 3; ++i) dequantization(i, i) = extent;
+
+    bool quantizedTexCoords = true;
+    for (size_t i = 0; i < vertices.texCoords.size() && quantizedTexCoords; ++i)
+        quantizedTexCoords = vertices.texCoords[i].x() >= 0 && vertices.texCoords[i].x() <= 1 &&
+                             vertices.texCoords[i].y() >= 0 && vertices.texCoords[i].y() <= 1;
+
+    const size_t normalOffset = 8;
+    const size_t texCoordOffset = normalOffset + (vertices.normals.empty() ? 0 : 4);
+    const size_t colorOffset = texCoordOffset + (vertices.texCoords.empty() ? 0 : (quantizedTexCoords ? 4 : 8));
+    const size_t stride = colorOffset + (vertices.colors.empty() ? 0 : 4);
+
+    std::vector<char> data(nbVertices * stride, 0);
+    int16_t lowerBound[3] = { 32767, 32767, 32767 }, upperBound[3] = { -32767, -32767, -32767 };
+    for (size_t i = 0; i < nbVertices; ++i) {
+        char * vertex = &data[i * stride];
+        Vector3 p = (vertices.points[i] - center) / extent;
+        int16_t position[3] = { gltfQuantize16(p.x()), gltfQuantize16(p.y()), gltfQuantize16(p.z()) };
+        for (int k = 0; k < 3; ++k) {
+            lowerBound[k] = std::min(lowerBound[k], position[k]);
+            upperBound[k] = std::max(upperBound[k], position[k]);
+        }
+        memcpy(vertex, position, sizeof(position));
+        if (!vertices.normals.empty()) {
+            Vector3 n = vertices.normals[i];
+            real_t length = norm(n);
+            if (length > 0) n /= length;
+            int8_t normal[3] = { gltfQuantize8(n.x()), gltfQuantize8(n.y()), gltfQuantize8(n.z()) };
+            memcpy(vertex + normalOffset, normal, sizeof(normal));
+        }
+        if (!vertices.texCoords.empty()) {
+            const Vector2& t = vertices.texCoords[i];
+            if (quantizedTexCoords) {
+                uint16_t texCoord[2] = { uint16_t(floor(t.x() * 65535 + 0.5)), uint16_t(floor(t.y() * 65535 + 0.5)) };
+                memcpy(vertex + texCoordOffset, texCoord, sizeof(texCoord));
+            }
+            else {
+                float texCoord[2] = { float(t.x()), float(t.y()) };
+                memcpy(vertex + texCoordOffset, texCoord, sizeof(texCoord));
+            }
+        }
+        if (!vertices.colors.empty()) {
+            const Color4& c = vertices.colors[i];
+            uint8_t color[4] = { c.getRed(), c.getGreen(), c.getBlue(), uint8_t(255 - c.getAlpha()) };
+            memcpy(vertex + colorOffset, color, sizeof(color));
+        }
+    }
+    int vertexView = bufferView(writeBuffer(&data[0], data.size()), data.size(), stride, GLTF_ARRAY_BUFFER);
+
+    std::stringstream bounds;
+    bounds << ",\"min\":[" << lowerBound[0] << ',' << lowerBound[1] << ',' << lowerBound[2]
+           << "],\"max\":[" << upperBound[0] << ',' << upperBound[1] << ',' << upperBound[2] << ']';
+    std::stringstream attributes;
+    attributes << "{\"POSITION\":" << accessor(vertexView, 0, GLTF_SHORT, true, nbVertices, "VEC3", bounds.str());
+    if (!vertices.normals.empty())
+        attributes << ",\"NORMAL\":" << accessor(vertexView, normalOffset, GLTF_BYTE, true, nbVertices, "VEC3");
+    if (!vertices.texCoords.empty())
+        attributes << ",\"TEXCOORD_0\":" << accessor(vertexView, texCoordOffset, quantizedTexCoords ? GLTF_UNSIGNED_SHORT : GLTF_FLOAT,
+                                                     quantizedTexCoords, nbVertices, "VEC2");
+    if (!vertices.colors.empty())
+        attributes << ",\"COLOR_0\":" << accessor(vertexView, colorOffset, GLTF_UNSIGNED_BYTE, true, nbVertices, "VEC4");
+    attributes << '}';
+
+    std::stringstream primitive;
+    primitive << "{\"attributes\":" << attributes.str() << ",\"mode\":" << mode;
+    if (!vertices.indices.empty()) {
+        int indexAccessor;
+        const size_t nbIndices = vertices.indices.size();
+        if (nbVertices < 65535) {
+            std::vector<uint16_t> indices(vertices.indices.begin(), vertices.indices.end());
+            int view = bufferView(writeBuffer(&indices[0], nbIndices * 2), nbIndices * 2, 0, GLTF_ELEMENT_ARRAY_BUFFER);
+            indexAccessor = accessor(view, 0, GLTF_UNSIGNED_SHORT, false, nbIndices, "SCALAR");
+        }
+        else {
+            int view = bufferView(writeBuffer(&vertices.indices[0], nbIndices * 4), nbIndices * 4, 0, GLTF_ELEMENT_ARRAY_BUFFER);
+            indexAccessor = accessor(view, 0, GLTF_UNSIGNED_INT, false, nbIndices, "SCALAR");
+        }
+        primitive << ",\"indices\":" << indexAccessor;
+    }
+    if (material >= 0) primitive << ",\"material\":" << material;
+    primitive << '}';
+    result = primitive.str();
+    return true;
+}
+
+const GltfWriter::GltfMesh * GltfWriter::mesh(const GeometryPtr& geometry, const AppearancePtr& appearance)
+{
+    // The material is cached first: it keeps the appearance of the key alive.
+    int materialIndex = material(appearance);
+    std::pair<size_t,size_t> key(geometry->getId(), appearance ? appearance->getId() : 0);
+    std::map<std::pair<size_t,size_t>, GltfMesh>::const_iterator cached = __meshCache.find(key);
+    if (cached != __meshCache.end()) return cached->second.index >= 0 ? &cached->second : NULL;
+
+    GltfMesh result;
+    result.index = -1;
+    result.geometry = geometry;
+    std::string description;
+    if (geometry->apply(*__discretizer)) {
+        ExplicitModelPtr model = __discretizer->getDiscretization();
+        if (model && model->getPointList() && primitive(model, materialIndex, description, result.dequantization)) {
+            std::stringstream mesh;
+            mesh << '{';
+            if (geometry->isNamed()) mesh << "\"name\":" << gltfString(geometry->getName()) << ',';
+            mesh << "\"primitives\":[" << description << "]}";
+            __meshes.push_back(mesh.str());
+            result.index = int(__meshes.size() - 1);
+        }
+    }
+    const GltfMesh& inserted = __meshCache[key] = result;
+    return inserted.index >= 0 ? &inserted : NULL;
+}
+
+void GltfWriter::instantiate(const GeometryPtr& geometry, const Matrix4& matrix,
+                             const AppearancePtr& appearance, const std::string& name)
+{
+    if (!geometry) return;
+    GroupPtr group = dynamic_pointer_cast<Group>(geometry);
+    if (group) {
+        for (GeometryArray::const_iterator it = group->getGeometryList()->begin(); it != group->getGeometryList()->end(); ++it)
+            instantiate(*it, matrix, appearance, name);
+        return;
+    }
+    MatrixTransformedPtr transformed = dynamic_pointer_cast<MatrixTransformed>(geometry);
+    if (transformed) {
+        Matrix4TransformationPtr transformation = dynamic_pointer_cast<Matrix4Transformation>(transformed->getTransformation());
+        if (transformation) {
+            instantiate(transformed->getGeometry(), matrix * transformation->getMatrix(), appearance, name);
+            return;
+        }
+    }
+    const GltfMesh * instance = mesh(geometry, appearance);
+    if (!instance) return;
+    std::stringstream node;
+    node << '{';
+    if (!name.empty()) node << "\"name\":" << gltfString(name) << ',';
+    node << "\"mesh\":" << instance->index << ",\"matrix\":" << gltfMatrix(matrix * instance->dequantization) << '}';
+    __nodes.push_back(node.str());
+}
+
+void GltfWriter::add(const ShapePtr& shape)
+{
+    if (!__bin || !shape || !shape->getGeometry()) return;
+    instantiate(shape->getGeometry(), Matrix4(), shape->getAppearance(), shape->isNamed() ? shape->getName() : std::string());
+    if (__meshCache.size() + __materialCache.size() + __textureCache.size() > __releaseThreshold) releaseCache();
+}
+
+void GltfWriter::add(const ScenePtr& scene)
+{
+    if (!scene) return;
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it)
+        add(dynamic_pointer_cast<Shape>(*it));
+}
+
+bool GltfWriter::close()
+{
+    if (!__bin) return false;
+    if (fclose(__bin) != 0 && !__failed) {
+        pglErrorEx(PGLERRORMSG(C_FILE_WRITE_ERR_s), __binName.c_str());
+        __failed = true;
+    }
+    __bin = NULL;
+    __meshCache.clear();
+    __materialCache.clear();
+    __textureCache.clear();
+    if (__failed) {
+        remove(__binName.c_str());
+        return false;
+    }
+
+    // The root node turns the z up axis of PlantGL into the y up axis of glTF.
+    std::vector<std::string> children;
+    for (size_t i = 0; i < __nodes.size(); ++i) children.push_back(number(i));
+    std::stringstream root;
+    root << "{\"name\":\"PlantGL\",\"rotation\":[-0.707106781,0,0,0.707106781]";
+    if (!children.empty()) root << ",\"children\":" << gltfArray(children);
+    root << '}';
+    __nodes.push_back(root.str());
+
+    std::stringstream json;
+    json << "{\"asset\":{\"version\":\"2.0\",\"generator\":\"PlantGL\"}";
+    json << ",\"extensionsUsed\":[\"KHR_mesh_quantization\"],\"extensionsRequired\":[\"KHR_mesh_quantization\"]";
+    json << ",\"scene\":0,\"scenes\":[{\"nodes\":[" << __nodes.size() - 1 << "]}]";
+    json << ",\"nodes\":" << gltfArray(__nodes);
+    if (!__meshes.empty()) json << ",\"meshes\":" << gltfArray(__meshes);
+    if (!__materials.empty()) json << ",\"materials\":" << gltfArray(__materials);
+    if (!__textures.empty()) json << ",\"textures\":" << gltfArray(__textures)
+                                  << ",\"images\":" << gltfArray(__images)
+                                  << ",\"samplers\":" << gltfArray(__samplers);
+    if (!__accessors.empty()) json << ",\"accessors\":" << gltfArray(__accessors);
+    if (!__bufferViews.empty()) json << ",\"bufferViews\":" << gltfArray(__bufferViews);
+    if (__binSize > 0) {
+        json << ",\"buffers\":[{";
+        if (!__binary) json << "\"uri\":" << gltfString(get_filename(__binName)) << ',';
+        json << "\"byteLength\":" << __binSize << "}]";
+    }
+    json << '}';
+    std::string content = json.str();
+
+    if (!__binary) {
+        if (__binSize == 0) remove(__binName.c_str());
+        FILE * file = fopen(__fname.c_str(), "wb");
+        if (!file) return false;
+        writeFile(file, content.data(), content.size(), __fname);
+        if (fclose(file) != 0 && !__failed) {
+            pglErrorEx(PGLERRORMSG(C_FILE_WRITE_ERR_s), __fname.c_str());
+            __failed = true;
+        }
+        return !__failed;
+    }
+
+    // Binary glTF: header, JSON chunk and binary chunk copied from the temporary buffer file.
+    while (content.size() % 4) content += ' ';
+    FILE * file = fopen(__fname.c_str(), "wb");
+    FILE * bin = fopen(__binName.c_str(), "rb");
+    if (!file || !bin) {
+        if (file) fclose(file);
+        if (bin) fclose(bin);
+        remove(__binName.c_str());
+        return false;
+    }
+    size_t length = 12 + 8 + content.size() + (__binSize > 0 ? 8 + __binSize : 0);
+    bool ok = gltfWriteUint32(file, 0x46546C67) && gltfWriteUint32(file, 2) &&
+              gltfWriteUint32(file, uint32_t(length)) && gltfWriteUint32(file, uint32_t(content.size())) &&
+              gltfWriteUint32(file, 0x4E4F534A) && fwrite(content.data(), 1, content.size(), file) == content.size();
+    if (ok && __binSize > 0) {
+        ok = gltfWriteUint32(file, uint32_t(__binSize)) && gltfWriteUint32(file, 0x004E4942);
+        char buffer[1 << 16];
+        size_t nb, copied = 0;
+        while (ok && (nb = fread(buffer, 1, sizeof(buffer), bin)) > 0) {
+            ok = fwrite(buffer, 1, nb, file) == nb;
+            copied += nb;
+        }
+        ok = ok && copied == __binSize;
+    }
+    fclose(bin);
+    if (fclose(file) != 0) ok = false;
+    remove(__binName.c_str());
+    if (!ok) pglErrorEx(PGLERRORMSG(C_FILE_WRITE_ERR_s), __fname.c_str());
+    return ok;
+}
+
+/* ----------------------------------------------------------------------- */
+
+GltfCodec::GltfCodec() : SceneCodec("GLTF", Write ) {
+}
+
+SceneFormatList GltfCodec::formats() const
+{
+	SceneFormat _format;
+	_format.name = "GLTF";
+	_format.suffixes.push_back("glb");
+	_format.suffixes.push_back("gltf");
+	_format.comment = "The Khronos glTF 2.0 format, binary or with a separated buffer.";
+	SceneFormatList _formats;
+	_formats.push_back(_format);
+	return _formats;
+}
+
+bool GltfCodec::write(const std::string& fname,const ScenePtr& scene)
+{
+	GltfWriter writer(fname);
+	if (!writer.isValid()) return false;
+	writer.add(scene);
+	return writer.close();
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,185 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file cdc_gltf.h
+    \brief Definition of the glTF codec and of its streaming writer.
+*/
+
+#ifndef __cdc_gltf_h__
+#define __cdc_gltf_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/scene/factory.h>
+#include <plantgl/math/util_matrix.h>
+#include <map>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+class Shape;
+typedef RCPtr<Shape> ShapePtr;
+class Geometry;
+typedef RCPtr<Geometry> GeometryPtr;
+class Appearance;
+typedef RCPtr<Appearance> AppearancePtr;
+class ExplicitModel;
+typedef RCPtr<ExplicitModel> ExplicitModelPtr;
+class ImageTexture;
+typedef RCPtr<ImageTexture> ImageTexturePtr;
+class Discretizer;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GltfWriter
+   \brief Writes shapes in a glTF 2.0 file, binary (\c .glb) or with a
+   separated \c .bin buffer (\c .gltf).
+   The vertex data of each shape are written to disk when the shape is added,
+   so only the JSON description is kept in memory. A geometry shared by
+   several shapes, directly or through matrix transformations, is written
+   once as a mesh instantiated by several nodes. Vertices are interleaved and
+   quantized with \c KHR_mesh_quantization: positions on 16 bits (the
+   dequantization is folded into the node matrices), normals on 8 bits,
+   texture coordinates on 16 bits when they are in [0,1] and colors on 8 bits.
+   Materials are converted to PBR metallic roughness parameters.
+   The written meshes, materials and textures are forgotten once the writer
+   holds their last reference: they cannot be shared by the next shapes.
+*/
+class CODEC_API GltfWriter {
+public:
+
+  /// Opens the glTF file \e fname. The file is binary if its suffix is \c glb.
+  GltfWriter(const std::string& fname);
+
+  /// Destructor. Closes the file if needed.
+  ~GltfWriter();
+
+  /// Returns whether the file could be opened.
+  bool isValid() const { return __bin != NULL; }
+
+  /// Adds the shapes of \e scene.
+  void add(const ScenePtr& scene);
+
+  /// Adds \e shape.
+  void add(const ShapePtr& shape);
+
+  /// Writes the description of the scene and closes the file.
+  bool close();
+
+protected:
+
+  /// A mesh already written and the matrix dequantizing its positions.
+  /// The geometry is kept so that its address is not reused while it is cached,
+  /// its appearance is kept by the material cache.
+  struct GltfMesh {
+    int index;
+    TOOLS(Matrix4) dequantization;
+    GeometryPtr geometry;
+  };
+
+  void instantiate(const GeometryPtr& geometry, const TOOLS(Matrix4)& matrix,
+                   const AppearancePtr& appearance, const std::string& name);
+  const GltfMesh * mesh(const GeometryPtr& geometry, const AppearancePtr& appearance);
+  bool primitive(const ExplicitModelPtr& model, int material, std::string& result, TOOLS(Matrix4)& dequantization);
+  int material(const AppearancePtr& appearance);
+  int texture(const ImageTexturePtr& image);
+
+  /// Forgets the cached objects that are no longer referenced outside the writer.
+  void releaseCache();
+
+  size_t writeBuffer(const void * data, size_t size);
+  bool writeFile(FILE * file, const void * data, size_t size, const std::string& fname);
+  int bufferView(size_t offset, size_t length, size_t stride, int target);
+  int accessor(int view, size_t offset, int component, bool normalized, size_t count,
+               const char * type, const std::string& bounds = std::string());
+
+  std::string __fname;
+  bool __binary;
+  std::string __binName;
+  FILE * __bin;
+  size_t __binSize;
+  bool __failed;
+  Discretizer * __discretizer;
+
+  std::vector<std::string> __nodes;
+  std::vector<std::string> __meshes;
+  std::vector<std::string> __accessors;
+  std::vector<std::string> __bufferViews;
+  std::vector<std::string> __materials;
+  std::vector<std::string> __textures;
+  std::vector<std::string> __images;
+  std::vector<std::string> __samplers;
+
+  std::map<std::pair<size_t,size_t>, GltfMesh> __meshCache;
+  std::map<size_t, std::pair<AppearancePtr,int> > __materialCache;
+  std::map<size_t, std::pair<ImageTexturePtr,int> > __textureCache;
+  size_t __releaseThreshold;
+
+private:
+
+  GltfWriter( const GltfWriter& );
+  GltfWriter& operator=( const GltfWriter& );
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GltfCodec
+   \brief Writes the glTF 2.0 format, as a binary \c .glb file or as a \c .gltf
+   file with its \c .bin buffer. See GltfWriter.
+*/
+class CODEC_API GltfCodec : public SceneCodec {
+public:
+	GltfCodec();
+
+	virtual SceneFormatList formats() const;
+
+	virtual bool write(const std::string& fname,const ScenePtr& scene);
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#endif
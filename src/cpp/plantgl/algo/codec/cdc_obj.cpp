@@ -0,0 +1,770 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "cdc_obj.h"
+
+#include <plantgl/algo/base/discretizer.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/scenegraph/container/geometryarray2.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/quadset.h>
+#include <plantgl/scenegraph/geometry/faceset.h>
+#include <plantgl/scenegraph/geometry/polyline.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/scenegraph/geometry/group.h>
+#include <plantgl/scenegraph/appearance/material.h>
+#include <plantgl/scenegraph/appearance/texture.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/mmapstream.h>
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/util_string.h>
+#include <plantgl/tool/dirnames.h>
+#include <fstream>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+static const uint_t OBJ_NOINDEX = UINT32_MAX;
+
+/// Approximative size of the chunks of lines parsed in parallel.
+static const size_t OBJ_CHUNK_SIZE = 1 << 20;
+
+/// Returns the directory of \e fname, or an empty string if it has none.
+static std::string objDirectory(const std::string& fname)
+{
+    if (fname.find_last_of("/\\") == std::string::npos) return std::string();
+    return get_dirname(fname);
+}
+
+/// Returns \e name with its blanks replaced, so that it is a single obj token.
+static std::string objName(const std::string& name)
+{
+    std::string result(name);
+    for (std::string::iterator it = result.begin(); it != result.end(); ++it)
+        if (isspace(*it)) *it = '_';
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// A change of group, material or material library before the element \e element of a chunk.
+struct ObjEvent {
+    enum Type { Group, UseMaterial, Library };
+    Type type;
+    size_t element;
+    std::string name;
+};
+
+/// A chunk of lines of an obj file and the elements parsed from it.
+struct ObjChunk {
+    const char * begin;
+    const char * end;
+
+    /// Number of vertices, normals and texture coordinates in the chunk and before it.
+    size_t nbVertices, nbNormals, nbTexCoords;
+    size_t firstVertex, firstNormal, firstTexCoord;
+
+    /// Type ('f', 'l' or 'p') and number of vertices of each element.
+    std::vector<char> types;
+    std::vector<uint_t> sizes;
+
+    /// Indices of the vertex, normal and texture coordinates of each corner of the elements.
+    std::vector<uint_t> vertices, normals, texCoords;
+
+    std::vector<ObjEvent> events;
+    std::string error;
+};
+
+/// The elements with the same group and material.
+struct ObjPart {
+    std::string group;
+    std::string material;
+
+    /// Ranges [first,last) of elements of a chunk, and the index of the first corner of the range.
+    struct Run { size_t chunk, first, last, corner; };
+    std::vector<Run> runs;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Returns the keyword starting a line, or an empty string.
+static inline std::string objKeyword(const char *& p, const char * eol)
+{
+    while (p < eol && isBlank(*p)) ++p;
+    const char * start = p;
+    while (p < eol && !isBlank(*p)) ++p;
+    return std::string(start, p);
+}
+
+/// Returns the remaining of a line without its surrounding blanks.
+static inline std::string objArgument(const char * p, const char * eol)
+{
+    while (p < eol && isBlank(*p)) ++p;
+    while (eol > p && isBlank(*(eol-1))) --eol;
+    return std::string(p, eol);
+}
+
+/// Counts the vertices, normals and texture coordinates of the chunks.
+struct ObjCounter {
+    std::vector<ObjChunk>& chunks;
+
+    ObjCounter(std::vector<ObjChunk>& _chunks) : chunks(_chunks) { }
+
+    void operator()(size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) {
+            ObjChunk& chunk = chunks[c];
+            chunk.nbVertices = chunk.nbNormals = chunk.nbTexCoords = 0;
+            for (const char * p = chunk.begin; p < chunk.end; ) {
+                while (p < chunk.end && isBlank(*p)) ++p;
+                if (p + 1 < chunk.end && p[0] == 'v') {
+                    if (isBlank(p[1])) ++chunk.nbVertices;
+                    else if (p + 2 < chunk.end && isBlank(p[2])) {
+                        if (p[1] == 'n') ++chunk.nbNormals;
+                        else if (p[1] == 't') ++chunk.nbTexCoords;
+                    }
+                }
+                const char * eol = (const char *)memchr(p, '\n', chunk.end - p);
+                p = eol ? eol + 1 : chunk.end;
+            }
+        }
+    }
+};
+
+/// Parses the chunks, once the number of vertices, normals and texture coordinates before each one is known.
+struct ObjParser {
+    std::vector<ObjChunk>& chunks;
+    Point3Array& vertices;
+    Point3Array& normals;
+    Point2Array& texCoords;
+
+    ObjParser(std::vector<ObjChunk>& _chunks, Point3Array& _vertices, Point3Array& _normals, Point2Array& _texCoords) :
+        chunks(_chunks), vertices(_vertices), normals(_normals), texCoords(_texCoords) { }
+
+    /// Resolves the 1-based or relative obj index \e value, with \e current elements defined so far among \e total.
+    static bool resolve(long value, size_t current, size_t total, uint_t& index) {
+        long result = value > 0 ? value - 1 : long(current) + value;
+        if (value == 0 || result < 0 || size_t(result) >= total) return false;
+        index = uint_t(result);
+        return true;
+    }
+
+    /// Parses the elements of the line [p,eol) of chunk \e chunk. Returns false if it is not valid.
+    bool parseElement(ObjChunk& chunk, char type, const char * p, const char * eol, size_t v, size_t n, size_t t) {
+        uint_t size = 0;
+        while (true) {
+            while (p < eol && isBlank(*p)) ++p;
+            if (p == eol) break;
+            long vi = 0, ti = 0, ni = 0;
+            if (!(p = parseInt(p, eol, vi))) return false;
+            if (p < eol && *p == '/') {
+                ++p;
+                if (p < eol && *p == '/') p = parseInt(p + 1, eol, ni);
+                else {
+                    p = parseInt(p, eol, ti);
+                    if (p && p < eol && *p == '/') p = parseInt(p + 1, eol, ni);
+                }
+                if (!p) return false;
+            }
+            if (p < eol && !isBlank(*p)) return false;
+            uint_t index;
+            if (!resolve(vi, v, vertices.size(), index)) return false;
+            chunk.vertices.push_back(index);
+            if (ni == 0) index = OBJ_NOINDEX;
+            else if (!resolve(ni, n, normals.size(), index)) return false;
+            chunk.normals.push_back(index);
+            if (ti == 0) index = OBJ_NOINDEX;
+            else if (!resolve(ti, t, texCoords.size(), index)) return false;
+            chunk.texCoords.push_back(index);
+            ++size;
+        }
+        if (size == 0) return false;
+        chunk.types.push_back(type);
+        chunk.sizes.push_back(size);
+        return true;
+    }
+
+    void parse(ObjChunk& chunk) {
+        size_t v = chunk.firstVertex, n = chunk.firstNormal, t = chunk.firstTexCoord;
+        size_t line = 0;
+        for (const char * p = chunk.begin; p < chunk.end; ++line) {
+            const char * eol = (const char *)memchr(p, '\n', chunk.end - p);
+            if (!eol) eol = chunk.end;
+            std::string keyword = objKeyword(p, eol);
+            bool ok = true;
+            if (keyword == "v") {
+                double x = 0, y = 0, z = 0;
+                ok = (p = parseReal(p, eol, x)) && (p = parseReal(p, eol, y)) && (p = parseReal(p, eol, z));
+                if (ok) vertices.setAt(v++, Vector3(x, y, z));
+            }
+            else if (keyword == "vn") {
+                double x = 0, y = 0, z = 0;
+                ok = (p = parseReal(p, eol, x)) && (p = parseReal(p, eol, y)) && (p = parseReal(p, eol, z));
+                if (ok) {
+                    // Obj normals may not be unit vectors.
+                    Vector3 normal(x, y, z);
+                    normal.normalize();
+                    normals.setAt(n++, normal);
+                }
+            }
+            else if (keyword == "vt") {
+                double x = 0, y = 0;
+                ok = (p = parseReal(p, eol, x));
+                if (ok) parseReal(p, eol, y);
+                if (ok) texCoords.setAt(t++, Vector2(x, y));
+            }
+            else if (keyword == "f" || keyword == "l" || keyword == "p")
+                ok = parseElement(chunk, keyword[0], p, eol, v, n, t);
+            else if (keyword == "g" || keyword == "o" || keyword == "usemtl" || keyword == "mtllib") {
+                ObjEvent event;
+                event.type = (keyword == "usemtl" ? ObjEvent::UseMaterial : (keyword == "mtllib" ? ObjEvent::Library : ObjEvent::Group));
+                event.element = chunk.types.size();
+                event.name = objArgument(p, eol);
+                if (event.type != ObjEvent::Library) event.name = objName(event.name);
+                chunk.events.push_back(event);
+            }
+            if (!ok) {
+                chunk.error = "Invalid line '" + objArgument(p - keyword.size(), eol) + "'.";
+                return;
+            }
+            p = eol + 1;
+        }
+    }
+
+    void operator()(size_t first, size_t last) {
+        for (size_t c = first; c < last; ++c) parse(chunks[c]);
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+template<class IndexType> struct ObjIndex;
+
+template<> struct ObjIndex<Index3> {
+    static Index3 make(const uint_t * i, uint_t) { return Index3(i[0], i[1], i[2]); }
+};
+
+template<> struct ObjIndex<Index4> {
+    static Index4 make(const uint_t * i, uint_t) { return Index4(i[0], i[1], i[2], i[3]); }
+};
+
+template<> struct ObjIndex<Index> {
+    static Index make(const uint_t * i, uint_t size) {
+        Index result(size);
+        for (uint_t j = 0; j < size; ++j) result.setAt(j, i[j]);
+        return result;
+    }
+};
+
+/// Builds a mesh with the faces of sizes \e sizes and indices \e vertices, \e normals and \e texCoords.
+template<class MeshType, class IndexArrayType>
+static GeometryPtr objMesh(const Point3ArrayPtr& points, const std::vector<uint_t>& sizes, const std::vector<uint_t>& vertices,
+                           const Point3ArrayPtr& normalList, const std::vector<uint_t>& normals,
+                           const Point2ArrayPtr& texCoordList, const std::vector<uint_t>& texCoords)
+{
+    typedef typename IndexArrayType::element_type IndexType;
+    RCPtr<IndexArrayType> indices(new IndexArrayType(sizes.size()));
+    RCPtr<IndexArrayType> normalIndices(normalList ? new IndexArrayType(sizes.size()) : NULL);
+    RCPtr<IndexArrayType> texCoordIndices(texCoordList ? new IndexArrayType(sizes.size()) : NULL);
+    size_t corner = 0;
+    for (size_t i = 0; i < sizes.size(); corner += sizes[i], ++i) {
+        indices->setAt(i, ObjIndex<IndexType>::make(&vertices[corner], sizes[i]));
+        if (normalList) normalIndices->setAt(i, ObjIndex<IndexType>::make(&normals[corner], sizes[i]));
+        if (texCoordList) texCoordIndices->setAt(i, ObjIndex<IndexType>::make(&texCoords[corner], sizes[i]));
+    }
+    return GeometryPtr(new MeshType(points, indices, normalList, normalIndices, Color4ArrayPtr(), RCPtr<IndexArrayType>(),
+                                    texCoordList, texCoordIndices, true, false, true, false));
+}
+
+/// Reads an obj file.
+class ObjReader {
+public:
+    ObjReader(const std::string& fname) : __fname(fname), __file(fname) { }
+
+    ScenePtr read();
+
+protected:
+    void readMaterials(const std::string& fname);
+    AppearancePtr material(const std::string& name);
+    GeometryPtr geometry(const ObjPart& part, uint_t stamp);
+
+    /// Returns the new index of \e index for the part \e stamp, adding its value to \e result if needed.
+    template<class Array>
+    static uint_t remap(uint_t index, uint_t stamp, std::vector<uint_t>& stamps, std::vector<uint_t>& indices,
+                        const Array& values, RCPtr<Array>& result) {
+        if (stamps[index] != stamp) {
+            stamps[index] = stamp;
+            indices[index] = result->size();
+            result->push_back(values.getAt(index));
+        }
+        return indices[index];
+    }
+
+    std::string __fname;
+    MemoryMappedFile __file;
+    std::vector<ObjChunk> __chunks;
+    Point3Array __vertices;
+    Point3Array __normals;
+    Point2Array __texCoords;
+    std::vector<uint_t> __vertexStamps, __vertexIndices;
+    std::vector<uint_t> __normalStamps, __normalIndices;
+    std::vector<uint_t> __texCoordStamps, __texCoordIndices;
+    std::map<std::string, AppearancePtr> __materials;
+};
+
+void ObjReader::readMaterials(const std::string& fname)
+{
+    std::string dir = objDirectory(__fname);
+    std::string path = dir.empty() ? fname : cat_dir_file(dir, fname);
+    std::ifstream stream(path.c_str());
+    if (!stream) {
+        std::cerr << "Cannot open material file '" << path << "'." << std::endl;
+        return;
+    }
+
+    std::string name, line, texture;
+    Color3 ambient(0, 0, 0), diffuse(Material::DEFAULT_AMBIENT), specular(Material::DEFAULT_SPECULAR), emission(Material::DEFAULT_EMISSION);
+    real_t shininess = Material::DEFAULT_SHININESS, transparency = Material::DEFAULT_TRANSPARENCY;
+    bool hasAmbient = false;
+    while (true) {
+        bool ok = !std::getline(stream, line).fail();
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+        if ((!ok || keyword == "newmtl") && !name.empty()) {
+            // PlantGL materials have an ambient color and a diffuse factor of it.
+            real_t ambientSum = ambient.getRed() + ambient.getGreen() + ambient.getBlue();
+            real_t diffuseSum = diffuse.getRed() + diffuse.getGreen() + diffuse.getBlue();
+            if (!hasAmbient || ambientSum == 0) ambient = diffuse;
+            real_t factor = (hasAmbient && ambientSum > 0 ? diffuseSum / ambientSum : 1);
+            MaterialPtr mat(new Material(name, ambient, factor, specular, emission, shininess, transparency));
+            if (texture.empty()) __materials[name] = AppearancePtr(mat);
+            else {
+                std::string image = (dir.empty() || texture[0] == '/' ? texture : cat_dir_file(dir, texture));
+                __materials[name] = AppearancePtr(new Texture2D(name, ImageTexturePtr(new ImageTexture(image)), Texture2D::DEFAULT_TRANSFORMATION,
+                                                                Color4(diffuse, uchar_t(transparency * 255))));
+            }
+        }
+        if (!ok) break;
+        if (keyword == "newmtl") {
+            name = objName(objArgument(line.c_str() + line.find("newmtl") + 6, line.c_str() + line.size()));
+            ambient = Color3(0, 0, 0); diffuse = Material::DEFAULT_AMBIENT; specular = Material::DEFAULT_SPECULAR; emission = Material::DEFAULT_EMISSION;
+            shininess = Material::DEFAULT_SHININESS; transparency = Material::DEFAULT_TRANSPARENCY;
+            hasAmbient = false;
+            texture.clear();
+        }
+        else if (keyword == "Ka" || keyword == "Kd" || keyword == "Ks" || keyword == "Ke") {
+            real_t r = 0, g = 0, b = 0;
+            tokens >> r >> g >> b;
+            Color3 color(uchar_t(std::min<real_t>(1, std::max<real_t>(0, r)) * 255 + 0.5),
+                         uchar_t(std::min<real_t>(1, std::max<real_t>(0, g)) * 255 + 0.5),
+                         uchar_t(std::min<real_t>(1, std::max<real_t>(0, b)) * 255 + 0.5));
+            if (keyword == "Ka") { ambient = color; hasAmbient = true; }
+            else if (keyword == "Kd") diffuse = color;
+            else if (keyword == "Ks") specular = color;
+            else emission = color;
+        }
+        else if (keyword == "Ns") { real_t ns = 0; tokens >> ns; shininess = std::min<real_t>(1, std::max<real_t>(0, ns / 1000)); }
+        else if (keyword == "d") { real_t d = 1; tokens >> d; transparency = 1 - d; }
+        else if (keyword == "Tr") { tokens >> transparency; }
+        else if (keyword == "map_Kd") {
+            std::string argument = objArgument(line.c_str() + line.find("map_Kd") + 6, line.c_str() + line.size());
+            // Keep the file name, the last argument after the options.
+            size_t pos = argument.find_last_of(" \t");
+            texture = (pos == std::string::npos ? argument : argument.substr(pos + 1));
+        }
+    }
+}
+
+AppearancePtr ObjReader::material(const std::string& name)
+{
+    if (name.empty()) return Material::DEFAULT_MATERIAL;
+    std::map<std::string, AppearancePtr>::iterator it = __materials.find(name);
+    if (it != __materials.end()) return it->second;
+    AppearancePtr result(new Material(name));
+    __materials[name] = result;
+    return result;
+}
+
+GeometryPtr ObjReader::geometry(const ObjPart& part, uint_t stamp)
+{
+    // Checks the kind of faces and the attributes available on all of them.
+    size_t nbFaces = 0;
+    bool triangles = true, quads = true, hasNormals = true, hasTexCoords = true;
+    for (std::vector<ObjPart::Run>::const_iterator run = part.runs.begin(); run != part.runs.end(); ++run) {
+        const ObjChunk& chunk = __chunks[run->chunk];
+        size_t corner = run->corner;
+        for (size_t e = run->first; e < run->last; corner += chunk.sizes[e], ++e) {
+            if (chunk.types[e] != 'f') continue;
+            ++nbFaces;
+            if (chunk.sizes[e] != 3) triangles = false;
+            if (chunk.sizes[e] != 4) quads = false;
+            for (size_t j = corner; j < corner + chunk.sizes[e]; ++j) {
+                if (chunk.normals[j] == OBJ_NOINDEX) hasNormals = false;
+                if (chunk.texCoords[j] == OBJ_NOINDEX) hasTexCoords = false;
+            }
+        }
+    }
+
+    Point3ArrayPtr points(new Point3Array());
+    Point3ArrayPtr normalList(hasNormals && nbFaces > 0 ? new Point3Array() : NULL);
+    Point2ArrayPtr texCoordList(hasTexCoords && nbFaces > 0 ? new Point2Array() : NULL);
+    std::vector<uint_t> sizes, vertices, normals, texCoords;
+    sizes.reserve(nbFaces);
+    std::vector<GeometryPtr> others;
+    Point3ArrayPtr pointSet;
+
+    for (std::vector<ObjPart::Run>::const_iterator run = part.runs.begin(); run != part.runs.end(); ++run) {
+        const ObjChunk& chunk = __chunks[run->chunk];
+        size_t corner = run->corner;
+        for (size_t e = run->first; e < run->last; corner += chunk.sizes[e], ++e) {
+            uint_t size = chunk.sizes[e];
+            if (chunk.types[e] == 'f') {
+                sizes.push_back(size);
+                for (size_t j = corner; j < corner + size; ++j) {
+                    vertices.push_back(remap(chunk.vertices[j], stamp, __vertexStamps, __vertexIndices, __vertices, points));
+                    if (normalList) normals.push_back(remap(chunk.normals[j], stamp, __normalStamps, __normalIndices, __normals, normalList));
+                    if (texCoordList) texCoords.push_back(remap(chunk.texCoords[j], stamp, __texCoordStamps, __texCoordIndices, __texCoords, texCoordList));
+                }
+            }
+            else {
+                if (chunk.types[e] == 'p' && !pointSet) pointSet = Point3ArrayPtr(new Point3Array());
+                Point3ArrayPtr elementPoints = (chunk.types[e] == 'p' ? pointSet : Point3ArrayPtr(new Point3Array(size)));
+                for (size_t j = corner; j < corner + size; ++j) {
+                    if (chunk.types[e] == 'p') elementPoints->push_back(__vertices.getAt(chunk.vertices[j]));
+                    else elementPoints->setAt(j - corner, __vertices.getAt(chunk.vertices[j]));
+                }
+                if (chunk.types[e] == 'l') others.push_back(GeometryPtr(new Polyline(elementPoints)));
+            }
+        }
+    }
+
+    GeometryPtr mesh;
+    if (nbFaces > 0) {
+        if (triangles) mesh = objMesh<TriangleSet, Index3Array>(points, sizes, vertices, normalList, normals, texCoordList, texCoords);
+        else if (quads) mesh = objMesh<QuadSet, Index4Array>(points, sizes, vertices, normalList, normals, texCoordList, texCoords);
+        else mesh = objMesh<FaceSet, IndexArray>(points, sizes, vertices, normalList, normals, texCoordList, texCoords);
+        others.insert(others.begin(), mesh);
+    }
+    if (pointSet) others.push_back(GeometryPtr(new PointSet(pointSet)));
+    if (others.empty()) return GeometryPtr();
+    if (others.size() == 1) return others[0];
+    return GeometryPtr(new Group(GeometryArrayPtr(new GeometryArray(others.begin(), others.end()))));
+}
+
+ScenePtr ObjReader::read()
+{
+    if (!__file.isValid()) return ScenePtr();
+
+    // Cuts the file in chunks of lines.
+    const char * data = __file.data();
+    const char * end = data + __file.size();
+    while (data < end) {
+        ObjChunk chunk;
+        chunk.begin = data;
+        chunk.end = (size_t(end - data) > OBJ_CHUNK_SIZE ? data + OBJ_CHUNK_SIZE : end);
+        if (chunk.end < end) {
+            const char * eol = (const char *)memchr(chunk.end, '\n', end - chunk.end);
+            chunk.end = eol ? eol + 1 : end;
+        }
+        data = chunk.end;
+        __chunks.push_back(chunk);
+    }
+
+    ObjCounter counter(__chunks);
+    pgl_parallel_for(0, __chunks.size(), counter, 1);
+    size_t nbVertices = 0, nbNormals = 0, nbTexCoords = 0;
+    for (std::vector<ObjChunk>::iterator chunk = __chunks.begin(); chunk != __chunks.end(); ++chunk) {
+        chunk->firstVertex = nbVertices; nbVertices += chunk->nbVertices;
+        chunk->firstNormal = nbNormals; nbNormals += chunk->nbNormals;
+        chunk->firstTexCoord = nbTexCoords; nbTexCoords += chunk->nbTexCoords;
+    }
+    __vertices = Point3Array(nbVertices);
+    __normals = Point3Array(nbNormals);
+    __texCoords = Point2Array(nbTexCoords);
+
+    ObjParser parser(__chunks, __vertices, __normals, __texCoords);
+    pgl_parallel_for(0, __chunks.size(), parser, 1);
+    for (std::vector<ObjChunk>::const_iterator chunk = __chunks.begin(); chunk != __chunks.end(); ++chunk)
+        if (!chunk->error.empty()) {
+            std::cerr << "Error while reading '" << __fname << "': " << chunk->error << std::endl;
+            return ScenePtr();
+        }
+
+    // Gathers the elements by group and material, in their order of appearance.
+    std::vector<ObjPart> parts;
+    std::map<std::pair<std::string, std::string>, size_t> partIndices;
+    std::string currentGroup, currentMaterial;
+    for (size_t c = 0; c < __chunks.size(); ++c) {
+        const ObjChunk& chunk = __chunks[c];
+        size_t first = 0, corner = 0;
+        for (size_t ev = 0; ev <= chunk.events.size(); ++ev) {
+            size_t last = (ev < chunk.events.size() ? chunk.events[ev].element : chunk.types.size());
+            if (last > first) {
+                std::pair<std::string, std::string> key(currentGroup, currentMaterial);
+                std::map<std::pair<std::string, std::string>, size_t>::iterator it = partIndices.find(key);
+                if (it == partIndices.end()) {
+                    it = partIndices.insert(std::make_pair(key, parts.size())).first;
+                    parts.push_back(ObjPart());
+                    parts.back().group = currentGroup;
+                    parts.back().material = currentMaterial;
+                }
+                ObjPart::Run run = { c, first, last, corner };
+                parts[it->second].runs.push_back(run);
+                for (size_t e = first; e < last; ++e) corner += chunk.sizes[e];
+                first = last;
+            }
+            if (ev == chunk.events.size()) break;
+            const ObjEvent& event = chunk.events[ev];
+            if (event.type == ObjEvent::Group) currentGroup = event.name;
+            else if (event.type == ObjEvent::UseMaterial) currentMaterial = event.name;
+            else readMaterials(event.name);
+        }
+    }
+
+    __vertexStamps.assign(nbVertices, OBJ_NOINDEX); __vertexIndices.resize(nbVertices);
+    __normalStamps.assign(nbNormals, OBJ_NOINDEX); __normalIndices.resize(nbNormals);
+    __texCoordStamps.assign(nbTexCoords, OBJ_NOINDEX); __texCoordIndices.resize(nbTexCoords);
+    ScenePtr scene(new Scene());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        GeometryPtr geom = geometry(parts[i], uint_t(i));
+        if (!geom) continue;
+        if (parts[i].group.empty()) scene->add(Shape3DPtr(new Shape(geom, material(parts[i].material))));
+        else scene->add(Shape3DPtr(new Shape(parts[i].group, geom, material(parts[i].material))));
+    }
+    return scene;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Writes an obj file through a large buffer.
+class ObjWriter {
+public:
+    ObjWriter(FILE * file) : __file(file), __size(0) { __buffer.resize(1 << 22); }
+    ~ObjWriter() { flush(); }
+
+    void flush() {
+        if (__size > 0) fwrite(&__buffer[0], 1, __size, __file);
+        __size = 0;
+    }
+
+    void reserve(size_t size) { if (__size + size > __buffer.size()) flush(); }
+
+    ObjWriter& operator<<(const char * text) { return write(text, strlen(text)); }
+    ObjWriter& operator<<(const std::string& text) { return write(text.c_str(), text.size()); }
+    ObjWriter& operator<<(char c) { reserve(1); __buffer[__size++] = c; return *this; }
+
+    ObjWriter& operator<<(size_t value) {
+        char digits[24];
+        size_t nb = 0;
+        do { digits[nb++] = char('0' + value % 10); value /= 10; } while (value > 0);
+        reserve(nb);
+        while (nb > 0) __buffer[__size++] = digits[--nb];
+        return *this;
+    }
+
+    ObjWriter& operator<<(real_t value) {
+        reserve(32);
+        __size += snprintf(&__buffer[__size], 32, "%.9g", double(value));
+        return *this;
+    }
+
+    ObjWriter& write(const char * text, size_t size) {
+        if (size > __buffer.size()) { flush(); fwrite(text, 1, size, __file); return *this; }
+        reserve(size);
+        memcpy(&__buffer[__size], text, size);
+        __size += size;
+        return *this;
+    }
+
+protected:
+    FILE * __file;
+    std::vector<char> __buffer;
+    size_t __size;
+};
+
+static void objWriteMaterial(std::ofstream& stream, const std::string& name, const AppearancePtr& appearance)
+{
+    stream << "newmtl " << name << "\n";
+    MaterialPtr mat = dynamic_pointer_cast<Material>(appearance);
+    Texture2DPtr texture = dynamic_pointer_cast<Texture2D>(appearance);
+    if (mat) {
+        Color3 diffuse = mat->getDiffuseColor();
+        stream << "\tKa " << mat->getAmbient().getRedClamped() << ' ' << mat->getAmbient().getGreenClamped() << ' ' << mat->getAmbient().getBlueClamped() << "\n";
+        stream << "\tKd " << diffuse.getRedClamped() << ' ' << diffuse.getGreenClamped() << ' ' << diffuse.getBlueClamped() << "\n";
+        stream << "\tKs " << mat->getSpecular().getRedClamped() << ' ' << mat->getSpecular().getGreenClamped() << ' ' << mat->getSpecular().getBlueClamped() << "\n";
+        stream << "\tKe " << mat->getEmission().getRedClamped() << ' ' << mat->getEmission().getGreenClamped() << ' ' << mat->getEmission().getBlueClamped() << "\n";
+        stream << "\tNs " << mat->getShininess() * 1000 << "\n";
+        stream << "\td " << 1 - mat->getTransparency() << "\n";
+    }
+    else if (texture) {
+        Color4 color = texture->getBaseColor();
+        stream << "\tKd " << color.getRedClamped() << ' ' << color.getGreenClamped() << ' ' << color.getBlueClamped() << "\n";
+        stream << "\td " << 1 - color.getAlphaClamped() << "\n";
+        if (texture->getImage()) stream << "\tmap_Kd " << texture->getImage()->getFilename() << "\n";
+    }
+    stream << "\tillum 2\n";
+}
+
+/// Writes the vertices and elements of \e model, numbering its vertices after the ones already written.
+static void objWriteModel(ObjWriter& writer, const ExplicitModelPtr& model, size_t& nbVertices, size_t& nbNormals, size_t& nbTexCoords)
+{
+    const Point3ArrayPtr& points = model->getPointList();
+    for (Point3Array::const_iterator p = points->begin(); p != points->end(); ++p)
+        writer << "v " << p->x() << ' ' << p->y() << ' ' << p->z() << '\n';
+
+    MeshPtr mesh = dynamic_pointer_cast<Mesh>(model);
+    if (mesh) {
+        bool normals = mesh->getNormalList() && mesh->getNormalPerVertex();
+        bool texCoords = mesh->getTexCoordList();
+        if (normals)
+            for (Point3Array::const_iterator n = mesh->getNormalList()->begin(); n != mesh->getNormalList()->end(); ++n)
+                writer << "vn " << n->x() << ' ' << n->y() << ' ' << n->z() << '\n';
+        if (texCoords)
+            for (Point2Array::const_iterator t = mesh->getTexCoordList()->begin(); t != mesh->getTexCoordList()->end(); ++t)
+                writer << "vt " << t->x() << ' ' << t->y() << '\n';
+        bool ccw = mesh->getCCW();
+        for (uint_t i = 0; i < mesh->getIndexListSize(); ++i) {
+            writer << 'f';
+            uint_t size = mesh->getFaceSize(i);
+            for (uint_t k = 0; k < size; ++k) {
+                uint_t j = (ccw ? k : size - 1 - k);
+                writer << ' ' << nbVertices + mesh->getFacePointIndexAt(i, j) + 1;
+                if (texCoords) writer << '/' << nbTexCoords + mesh->getFaceTexCoordIndexAt(i, j) + 1;
+                if (normals) writer << (texCoords ? "/" : "//") << nbNormals + mesh->getFaceNormalIndexAt(i, j) + 1;
+            }
+            writer << '\n';
+        }
+        if (normals) nbNormals += mesh->getNormalList()->size();
+        if (texCoords) nbTexCoords += mesh->getTexCoordList()->size();
+    }
+    else {
+        writer << (dynamic_pointer_cast<Polyline>(model) ? 'l' : 'p');
+        for (size_t i = 0; i < points->size(); ++i) writer << ' ' << nbVertices + i + 1;
+        writer << '\n';
+    }
+    nbVertices += points->size();
+}
+
+/// Appends the discretizations of \e geometry to \e models. Groups give a discretization by element.
+static void objDiscretize(const GeometryPtr& geometry, Discretizer& discretizer, std::vector<ExplicitModelPtr>& models)
+{
+    GroupPtr group = dynamic_pointer_cast<Group>(geometry);
+    if (group) {
+        for (GeometryArray::const_iterator it = group->getGeometryList()->begin(); it != group->getGeometryList()->end(); ++it)
+            objDiscretize(*it, discretizer, models);
+    }
+    else if (geometry->apply(discretizer)) {
+        ExplicitModelPtr model = discretizer.getDiscretization();
+        if (model && model->getPointList() && !model->getPointList()->empty()) models.push_back(model);
+    }
+}
+
+static bool objWrite(const std::string& fname, const ScenePtr& scene)
+{
+    FILE * file = fopen(fname.c_str(), "wb");
+    if (!file) return false;
+    std::string mtlname = get_filename(fname);
+    size_t dot = mtlname.find_last_of('.');
+    mtlname = (dot == std::string::npos ? mtlname : mtlname.substr(0, dot)) + ".mtl";
+    std::string dir = objDirectory(fname);
+    std::ofstream mtl((dir.empty() ? mtlname : cat_dir_file(dir, mtlname)).c_str());
+
+    ObjWriter writer(file);
+    writer << "# File generated by PlantGL\n" << "mtllib " << mtlname << "\n";
+    mtl << "# File generated by PlantGL\n";
+
+    Discretizer discretizer;
+    std::map<size_t, std::string> materials;
+    size_t nbVertices = 0, nbNormals = 0, nbTexCoords = 0;
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it) {
+        ShapePtr shape = dynamic_pointer_cast<Shape>(*it);
+        if (!shape || !shape->getGeometry()) continue;
+        std::vector<ExplicitModelPtr> models;
+        objDiscretize(shape->getGeometry(), discretizer, models);
+        if (models.empty()) continue;
+
+        std::string material;
+        AppearancePtr appearance = shape->getAppearance();
+        if (appearance) {
+            std::map<size_t, std::string>::const_iterator m = materials.find(appearance->getId());
+            if (m != materials.end()) material = m->second;
+            else {
+                material = objName(appearance->isNamed() ? appearance->getName() : "APP_" + number(appearance->getId()));
+                materials[appearance->getId()] = material;
+                objWriteMaterial(mtl, material, appearance);
+            }
+        }
+        writer << "g " << objName(shape->isNamed() ? shape->getName() : "SHAPE_" + number(shape->getId())) << "\n";
+        if (!material.empty()) writer << "usemtl " << material << "\n";
+
+        for (std::vector<ExplicitModelPtr>::const_iterator model = models.begin(); model != models.end(); ++model)
+            objWriteModel(writer, *model, nbVertices, nbNormals, nbTexCoords);
+    }
+    writer.flush();
+    fclose(file);
+    return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+ObjCodec::ObjCodec() : SceneCodec("OBJ", ReadWrite ) {
+}
+
+SceneFormatList ObjCodec::formats() const
+{
+	SceneFormat _format;
+	_format.name = "OBJ";
+	_format.suffixes.push_back("obj");
+	_format.comment = "The Wavefront Obj file format.";
+	SceneFormatList _formats;
+	_formats.push_back(_format);
+	return _formats;
+}
+
+ScenePtr ObjCodec::read(const std::string& fname)
+{
+	ObjReader reader(fname);
+	return reader.read();
+}
+
+bool ObjCodec::write(const std::string& fname,const ScenePtr& scene)
+{
+	return objWrite(fname,scene);
+}
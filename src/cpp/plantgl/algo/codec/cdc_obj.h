@@ -0,0 +1,77 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file cdc_obj.h
+    \brief Definition of the obj codec.
+*/
+
+#ifndef __cdc_obj_h__
+#define __cdc_obj_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/scene/factory.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ObjCodec
+   \brief Reads and writes the Wavefront Obj format and its Mtl material files.
+   The file is memory mapped and cut in chunks of lines that are parsed in
+   parallel. Each group (\c g or \c o) and material (\c usemtl) gives a Shape
+   with the corresponding Material. Faces give a TriangleSet, a QuadSet or a
+   FaceSet, lines Polylines and points a PointSet.
+*/
+class CODEC_API ObjCodec : public SceneCodec {
+public:
+	ObjCodec();
+
+	virtual SceneFormatList formats() const;
+
+	virtual ScenePtr read(const std::string& fname);
+
+	virtual bool write(const std::string& fname,const ScenePtr& scene);
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,547 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "cdc_ply.h"
+#include "plyprinter.h"
+
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/colorarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/tool/mmapstream.h>
+#include <plantgl/tool/util_endian.h>
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/util_string.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sstream>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// The types of the values of a ply file.
+enum PlyType { PlyNoType, PlyInt8, PlyUInt8, PlyInt16, PlyUInt16, PlyInt32, PlyUInt32, PlyFloat32, PlyFloat64 };
+
+static PlyType plyType(const std::string& name)
+{
+    if (name == "char" || name == "int8") return PlyInt8;
+    if (name == "uchar" || name == "uint8") return PlyUInt8;
+    if (name == "short" || name == "int16") return PlyInt16;
+    if (name == "ushort" || name == "uint16") return PlyUInt16;
+    if (name == "int" || name == "int32") return PlyInt32;
+    if (name == "uint" || name == "uint32") return PlyUInt32;
+    if (name == "float" || name == "float32") return PlyFloat32;
+    if (name == "double" || name == "float64") return PlyFloat64;
+    return PlyNoType;
+}
+
+static inline size_t plyTypeSize(PlyType type)
+{
+    static const size_t sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[type];
+}
+
+template<class T>
+static inline double plyCast(const char * data)
+{
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return double(value);
+}
+
+/// Returns the value of type \e type at \e data. Its bytes are reversed if \e swap.
+static inline double plyValue(const char * data, PlyType type, bool swap)
+{
+    char buffer[8];
+    if (swap) {
+        size_t size = plyTypeSize(type);
+        for (size_t i = 0; i < size; ++i) buffer[i] = data[size-1-i];
+        data = buffer;
+    }
+    switch (type) {
+        case PlyInt8: return plyCast<signed char>(data);
+        case PlyUInt8: return plyCast<unsigned char>(data);
+        case PlyInt16: return plyCast<short>(data);
+        case PlyUInt16: return plyCast<unsigned short>(data);
+        case PlyInt32: return plyCast<int>(data);
+        case PlyUInt32: return plyCast<unsigned int>(data);
+        case PlyFloat32: return plyCast<float>(data);
+        case PlyFloat64: return plyCast<double>(data);
+        default: return 0;
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// A property of an element of a ply file.
+struct PlyProperty {
+    std::string name;
+    PlyType type;
+    /// Type of the number of values of a list property, PlyNoType otherwise.
+    PlyType countType;
+};
+
+/// An element of a ply file.
+struct PlyElement {
+    std::string name;
+    size_t count;
+    std::vector<PlyProperty> properties;
+
+    int find(const std::string& pname) const {
+        for (size_t i = 0; i < properties.size(); ++i)
+            if (properties[i].name == pname) return int(i);
+        return -1;
+    }
+
+    /// Returns the size of an element in binary format, or 0 if it contains lists.
+    size_t stride() const {
+        size_t result = 0;
+        for (std::vector<PlyProperty>::const_iterator it = properties.begin(); it != properties.end(); ++it) {
+            if (it->countType != PlyNoType) return 0;
+            result += plyTypeSize(it->type);
+        }
+        return result;
+    }
+};
+
+/// The vertex properties read.
+struct PlyVertexLayout {
+    int x, y, z, nx, ny, nz, red, green, blue, alpha;
+    bool floatColor;
+
+    PlyVertexLayout(const PlyElement& vertex) {
+        x = vertex.find("x"); y = vertex.find("y"); z = vertex.find("z");
+        nx = vertex.find("nx"); ny = vertex.find("ny"); nz = vertex.find("nz");
+        red = vertex.find("red"); green = vertex.find("green"); blue = vertex.find("blue");
+        if (red < 0) { red = vertex.find("diffuse_red"); green = vertex.find("diffuse_green"); blue = vertex.find("diffuse_blue"); }
+        alpha = vertex.find("alpha");
+        floatColor = red >= 0 && (vertex.properties[red].type == PlyFloat32 || vertex.properties[red].type == PlyFloat64);
+    }
+
+    bool hasNormals() const { return nx >= 0 && ny >= 0 && nz >= 0; }
+    bool hasColors() const { return red >= 0 && green >= 0 && blue >= 0; }
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Reads a ply file.
+class PlyReader {
+public:
+    enum Format { Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+    PlyReader(const std::string& fname) :
+        __file(fname), __data(NULL), __end(NULL), __format(Ascii), __swap(false) { }
+
+    ScenePtr read();
+
+    /// Number of lines of ascii elements decoded in one task.
+    static const size_t BLOCK_SIZE = 16384;
+
+protected:
+    bool readHeader();
+    bool readBinaryElement(const PlyElement& element);
+    bool readAsciiElement(const PlyElement& element);
+    bool isVertex(const PlyElement& element) const { return element.name == "vertex"; }
+    bool isFace(const PlyElement& element) const { return element.name == "face" && faceIndices(element) >= 0; }
+    int faceIndices(const PlyElement& element) const {
+        int result = element.find("vertex_indices");
+        if (result < 0) result = element.find("vertex_index");
+        if (result >= 0 && element.properties[result].countType == PlyNoType) result = -1;
+        return result;
+    }
+
+    /// Sets the vertex \e i from the values of its scalar properties.
+    void setVertex(size_t i, const double * values, const PlyVertexLayout& layout);
+
+    /// Adds the triangles of the polygon \e polygon of \e nb vertices in \e triangles. Returns false if an index is not valid.
+    bool addPolygon(const uint_t * polygon, size_t nb, std::vector<Index3>& triangles) const;
+
+    MemoryMappedFile __file;
+    const char * __data;
+    const char * __end;
+    Format __format;
+    bool __swap;
+    std::vector<PlyElement> __elements;
+
+    Point3ArrayPtr __points;
+    Point3ArrayPtr __normals;
+    Color4ArrayPtr __colors;
+    std::vector<Index3> __triangles;
+    size_t __nbVertices;
+
+    friend struct PlyVertexDecoder;
+    friend struct PlyAsciiDecoder;
+};
+
+/* ----------------------------------------------------------------------- */
+
+bool PlyReader::readHeader()
+{
+    const char * p = __file.data();
+    const char * end = p + __file.size();
+    bool first = true;
+    bool hasFormat = false;
+    while (p < end) {
+        const char * eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol) break;
+        std::string line(p, eol);
+        p = eol + 1;
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+        if (first) {
+            if (keyword != "ply") return false;
+            first = false;
+        }
+        else if (keyword == "format") {
+            std::string format;
+            tokens >> format;
+            if (format == "ascii") __format = Ascii;
+            else if (format == "binary_little_endian") __format = BinaryLittleEndian;
+            else if (format == "binary_big_endian") __format = BinaryBigEndian;
+            else { std::cerr << "Unknown ply format '" << format << "'." << std::endl; return false; }
+            hasFormat = true;
+        }
+        else if (keyword == "element") {
+            PlyElement element;
+            element.count = 0;
+            tokens >> element.name >> element.count;
+            if (!tokens) return false;
+            __elements.push_back(element);
+        }
+        else if (keyword == "property") {
+            if (__elements.empty()) return false;
+            PlyProperty property;
+            std::string type;
+            tokens >> type;
+            property.countType = PlyNoType;
+            if (type == "list") {
+                tokens >> type;
+                property.countType = plyType(type);
+                if (property.countType == PlyNoType) return false;
+                tokens >> type;
+            }
+            property.type = plyType(type);
+            tokens >> property.name;
+            if (property.type == PlyNoType || !tokens) {
+                std::cerr << "Unknown ply property type '" << type << "'." << std::endl;
+                return false;
+            }
+            __elements.back().properties.push_back(property);
+        }
+        else if (keyword == "end_header") {
+            __data = p;
+            __end = end;
+            break;
+        }
+    }
+    if (!__data || !hasFormat) return false;
+#if PGL_BIG_ENDIAN
+    __swap = (__format == BinaryLittleEndian);
+#else
+    __swap = (__format == BinaryBigEndian);
+#endif
+    return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void PlyReader::setVertex(size_t i, const double * values, const PlyVertexLayout& layout)
+{
+    Vector3& point = __points->getAt(i);
+    point.x() = layout.x >= 0 ? values[layout.x] : 0;
+    point.y() = layout.y >= 0 ? values[layout.y] : 0;
+    point.z() = layout.z >= 0 ? values[layout.z] : 0;
+    if (__normals) __normals->setAt(i, Vector3(values[layout.nx], values[layout.ny], values[layout.nz]));
+    if (__colors) {
+        real_t scale = layout.floatColor ? 255 : 1;
+        // Alpha in ply is an opacity while it is a transparency in PlantGL.
+        __colors->setAt(i, Color4(uchar_t(values[layout.red] * scale),
+                                  uchar_t(values[layout.green] * scale),
+                                  uchar_t(values[layout.blue] * scale),
+                                  layout.alpha >= 0 ? uchar_t(255 - values[layout.alpha] * scale) : 0));
+    }
+}
+
+bool PlyReader::addPolygon(const uint_t * polygon, size_t nb, std::vector<Index3>& triangles) const
+{
+    for (size_t i = 0; i < nb; ++i)
+        if (polygon[i] >= __nbVertices) return false;
+    for (size_t i = 2; i < nb; ++i)
+        triangles.push_back(Index3(polygon[0], polygon[i-1], polygon[i]));
+    return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Decodes vertices of fixed size in binary format.
+struct PlyVertexDecoder {
+    PlyReader& reader;
+    const PlyElement& element;
+    const char * data;
+    size_t stride;
+    PlyVertexLayout layout;
+    std::vector<size_t> offsets;
+
+    PlyVertexDecoder(PlyReader& _reader, const PlyElement& _element, const char * _data) :
+        reader(_reader), element(_element), data(_data), stride(_element.stride()), layout(_element)
+    {
+        size_t offset = 0;
+        for (std::vector<PlyProperty>::const_iterator it = element.properties.begin(); it != element.properties.end(); ++it) {
+            offsets.push_back(offset);
+            offset += plyTypeSize(it->type);
+        }
+    }
+
+    void operator()(size_t first, size_t last) {
+        std::vector<double> values(element.properties.size(), 0.0);
+        for (size_t i = first; i < last; ++i) {
+            const char * vertex = data + i * stride;
+            for (size_t k = 0; k < values.size(); ++k)
+                values[k] = plyValue(vertex + offsets[k], element.properties[k].type, reader.__swap);
+            reader.setVertex(i, &values[0], layout);
+        }
+    }
+};
+
+/// Decodes blocks of lines of an element in ascii format.
+struct PlyAsciiDecoder {
+    PlyReader& reader;
+    const PlyElement& element;
+    const std::vector<const char *>& blocks;
+    PlyVertexLayout layout;
+    int indices;
+    std::vector<std::vector<Index3> > triangles;
+    std::vector<char> errors;
+
+    PlyAsciiDecoder(PlyReader& _reader, const PlyElement& _element, const std::vector<const char *>& _blocks) :
+        reader(_reader), element(_element), blocks(_blocks), layout(_element),
+        indices(_reader.isFace(_element) ? _reader.faceIndices(_element) : -1),
+        triangles(indices >= 0 ? _blocks.size() - 1 : 0),
+        errors(_blocks.size() - 1, 0) { }
+
+    void operator()(size_t first, size_t last) {
+        std::vector<double> values(element.properties.size(), 0.0);
+        std::vector<uint_t> polygon;
+        for (size_t b = first; b < last; ++b) {
+            const char * p = blocks[b];
+            size_t i = b * PlyReader::BLOCK_SIZE;
+            for (; p < blocks[b+1]; ++i) {
+                const char * eol = (const char *)memchr(p, '\n', blocks[b+1] - p);
+                if (!eol) eol = blocks[b+1];
+                for (size_t k = 0; k < element.properties.size() && p; ++k) {
+                    const PlyProperty& property = element.properties[k];
+                    if (property.countType == PlyNoType) { p = parseReal(p, eol, values[k]); continue; }
+                    double count;
+                    p = parseReal(p, eol, count);
+                    if (!p || count < 0) { p = NULL; break; }
+                    size_t nb = size_t(count);
+                    if (int(k) == indices) polygon.resize(nb);
+                    for (size_t j = 0; j < nb && p; ++j) {
+                        double value;
+                        p = parseReal(p, eol, value);
+                        if (int(k) == indices) polygon[j] = (value < 0 ? uint_t(-1) : uint_t(value));
+                    }
+                }
+                if (!p) { errors[b] = 1; break; }
+                if (indices >= 0) {
+                    if (!reader.addPolygon(polygon.empty() ? NULL : &polygon[0], polygon.size(), triangles[b])) { errors[b] = 1; break; }
+                }
+                else if (reader.isVertex(element)) reader.setVertex(i, &values[0], layout);
+                p = eol + 1;
+            }
+        }
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+bool PlyReader::readBinaryElement(const PlyElement& element)
+{
+    size_t stride = element.stride();
+    if (stride > 0) {
+        if (element.count > size_t(__end - __data) / stride) return false;
+        if (isVertex(element)) {
+            PlyVertexDecoder decoder(*this, element, __data);
+            pgl_parallel_for(0, element.count, decoder, 65536);
+        }
+        __data += element.count * stride;
+        return true;
+    }
+
+    bool vertex = isVertex(element);
+    int indices = isFace(element) ? faceIndices(element) : -1;
+    PlyVertexLayout layout(element);
+    std::vector<double> values(element.properties.size(), 0.0);
+    std::vector<uint_t> polygon;
+
+    // Usual faces with only a list of indices with less than 256 vertices.
+    if (indices == 0 && element.properties.size() == 1 && element.properties[0].countType == PlyUInt8 &&
+        (element.properties[0].type == PlyInt32 || element.properties[0].type == PlyUInt32) && !__swap) {
+        for (size_t i = 0; i < element.count; ++i) {
+            if (__data >= __end) return false;
+            size_t nb = (uchar_t)*__data;
+            if (size_t(__end - __data) < 1 + 4 * nb) return false;
+            polygon.resize(nb);
+            if (nb > 0) memcpy(&polygon[0], __data + 1, 4 * nb);
+            __data += 1 + 4 * nb;
+            if (!addPolygon(polygon.empty() ? NULL : &polygon[0], nb, __triangles)) return false;
+        }
+        return true;
+    }
+
+    for (size_t i = 0; i < element.count; ++i) {
+        for (size_t k = 0; k < element.properties.size(); ++k) {
+            const PlyProperty& property = element.properties[k];
+            if (property.countType == PlyNoType) {
+                if (size_t(__end - __data) < plyTypeSize(property.type)) return false;
+                values[k] = plyValue(__data, property.type, __swap);
+                __data += plyTypeSize(property.type);
+                continue;
+            }
+            if (size_t(__end - __data) < plyTypeSize(property.countType)) return false;
+            double count = plyValue(__data, property.countType, __swap);
+            __data += plyTypeSize(property.countType);
+            if (count < 0) return false;
+            size_t nb = size_t(count);
+            size_t size = plyTypeSize(property.type);
+            if (size_t(__end - __data) / size < nb) return false;
+            if (int(k) == indices) {
+                polygon.resize(nb);
+                for (size_t j = 0; j < nb; ++j) {
+                    double value = plyValue(__data + j * size, property.type, __swap);
+                    polygon[j] = (value < 0 ? uint_t(-1) : uint_t(value));
+                }
+            }
+            __data += nb * size;
+        }
+        if (indices >= 0) {
+            if (!addPolygon(polygon.empty() ? NULL : &polygon[0], polygon.size(), __triangles)) return false;
+        }
+        else if (vertex) setVertex(i, &values[0], layout);
+    }
+    return true;
+}
+
+bool PlyReader::readAsciiElement(const PlyElement& element)
+{
+    // Find the beginning of each block of lines, then decode the blocks in parallel.
+    std::vector<const char *> blocks;
+    for (size_t i = 0; i < element.count; ++i) {
+        if (i % BLOCK_SIZE == 0) blocks.push_back(__data);
+        if (__data >= __end) return false;
+        const char * eol = (const char *)memchr(__data, '\n', __end - __data);
+        __data = eol ? eol + 1 : __end;
+    }
+    if (!isVertex(element) && !isFace(element)) return true;
+    blocks.push_back(__data);
+
+    PlyAsciiDecoder decoder(*this, element, blocks);
+    pgl_parallel_for(0, blocks.size() - 1, decoder, 1);
+    for (size_t b = 0; b < decoder.errors.size(); ++b)
+        if (decoder.errors[b]) return false;
+    for (size_t b = 0; b < decoder.triangles.size(); ++b)
+        __triangles.insert(__triangles.end(), decoder.triangles[b].begin(), decoder.triangles[b].end());
+    return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+ScenePtr PlyReader::read()
+{
+    if (!__file.isValid() || !readHeader()) return ScenePtr();
+
+    __nbVertices = 0;
+    for (std::vector<PlyElement>::const_iterator it = __elements.begin(); it != __elements.end(); ++it) {
+        if (!isVertex(*it)) continue;
+        PlyVertexLayout layout(*it);
+        __nbVertices = it->count;
+        __points = Point3ArrayPtr(new Point3Array(__nbVertices));
+        if (layout.hasNormals()) __normals = Point3ArrayPtr(new Point3Array(__nbVertices));
+        if (layout.hasColors()) __colors = Color4ArrayPtr(new Color4Array(__nbVertices));
+        break;
+    }
+    if (!__points) return ScenePtr();
+
+    for (std::vector<PlyElement>::const_iterator it = __elements.begin(); it != __elements.end(); ++it) {
+        bool ok = (__format == Ascii ? readAsciiElement(*it) : readBinaryElement(*it));
+        if (!ok) {
+            std::cerr << "Error while reading ply element '" << it->name << "'." << std::endl;
+            return ScenePtr();
+        }
+    }
+
+    GeometryPtr geometry;
+    if (!__triangles.empty()) {
+        TriangleSetPtr mesh(new TriangleSet(__points, Index3ArrayPtr(new Index3Array(__triangles.begin(), __triangles.end()))));
+        if (__normals) { mesh->getNormalList() = __normals; mesh->getNormalPerVertex() = true; }
+        if (__colors) { mesh->getColorList() = __colors; mesh->getColorPerVertex() = true; }
+        geometry = GeometryPtr(mesh);
+    }
+    else geometry = GeometryPtr(new PointSet(__points, __colors));
+    ScenePtr scene(new Scene());
+    scene->add(Shape3DPtr(new Shape(geometry)));
+    return scene;
+}
+
+/* ----------------------------------------------------------------------- */
+
+PlyCodec::PlyCodec() : SceneCodec("PLY", ReadWrite ) {
+}
+
+SceneFormatList PlyCodec::formats() const
+{
+	SceneFormat _format;
+	_format.name = "PLY";
+	_format.suffixes.push_back("ply");
+	_format.comment = "The Stanford polygon file format.";
+	SceneFormatList _formats;
+	_formats.push_back(_format);
+	return _formats;
+}
+
+ScenePtr PlyCodec::read(const std::string& fname)
+{
+	PlyReader reader(fname);
+	return reader.read();
+}
+
+bool PlyCodec::write(const std::string& fname,const ScenePtr& scene)
+{
+	return PlyPrinter::print(scene,fname,"File Generated with PlantGL.",PlyPrinter::ply_binary_little_endian);
+}
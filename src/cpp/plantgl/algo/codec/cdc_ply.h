@@ -0,0 +1,78 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file cdc_ply.h
+    \brief Definition of the ply codec.
+*/
+
+#ifndef __cdc_ply_h__
+#define __cdc_ply_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/scene/factory.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class PlyCodec
+   \brief Reads and writes the Ply format, in ascii, binary little endian and
+   binary big endian encodings.
+   The file is memory mapped. Fixed size binary vertices and ascii lines are
+   decoded in parallel. A file with faces gives a TriangleSet, with its polygons
+   triangulated, and a PointSet otherwise. Vertex colors and normals are kept.
+*/
+
+class CODEC_API PlyCodec : public SceneCodec {
+public:
+	PlyCodec();
+
+	virtual SceneFormatList formats() const;
+
+	virtual ScenePtr read(const std::string& fname);
+
+	virtual bool write(const std::string& fname,const ScenePtr& scene);
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#endif
@@ -0,0 +1,102 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "cdc_tpc.h"
+#include "tiledpointcloud.h"
+
+#include <plantgl/algo/base/discretizer.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+TpcCodec::TpcCodec() : SceneCodec("TPC", ReadWrite ) {
+}
+
+SceneFormatList TpcCodec::formats() const
+{
+	SceneFormat _format;
+	_format.name = "TPC";
+	_format.suffixes.push_back("tpc");
+	_format.comment = "The PlantGL tiled and compressed point cloud format.";
+	SceneFormatList _formats;
+	_formats.push_back(_format);
+	return _formats;
+}
+
+ScenePtr TpcCodec::read(const std::string& fname)
+{
+	TiledPointCloudReader reader(fname);
+	PointCloud cloud;
+	if (!reader.isValid() || !reader.read(cloud)) return ScenePtr();
+	ScenePtr scene(new Scene());
+	scene->add(Shape3DPtr(new Shape(GeometryPtr(new PointSet(cloud.points, cloud.colors)))));
+	return scene;
+}
+
+bool TpcCodec::write(const std::string& fname,const ScenePtr& scene)
+{
+	Discretizer d;
+	std::vector<PointSetPtr> pointsets;
+	bool hasColors = true;
+	for (Scene::iterator it = scene->begin(); it != scene->end(); ++it)
+	{
+		if ((*it)->apply(d))
+		{
+			PointSetPtr pointset = dynamic_pointer_cast<PointSet>(d.getDiscretization());
+			if (pointset && pointset->getPointList())
+			{
+				pointsets.push_back(pointset);
+				if (!pointset->hasColorList()) hasColors = false;
+			}
+		}
+	}
+	if (pointsets.empty()) return false;
+
+	PointCloud cloud(hasColors ? PointCloud::ColorChannel : 0);
+	for (std::vector<PointSetPtr>::const_iterator it = pointsets.begin(); it != pointsets.end(); ++it)
+	{
+		PointCloud part;
+		part.points = (*it)->getPointList();
+		if (hasColors) part.colors = (*it)->getColorList();
+		if (!part.isValid()) return false;
+		cloud.append(part);
+	}
+	return TiledPointCloudWriter::write(fname, cloud);
+}
+
+/* ----------------------------------------------------------------------- */
@@ -39,6 +39,10 @@
 #include "cdc_vgstar.h"
 #include "cdc_pov.h"
 #include "cdc_vrml.h"
+#include "cdc_ply.h"
+#include "cdc_obj.h"
+#include "cdc_gltf.h"
+#include "cdc_tpc.h"
 #include <plantgl/scenegraph/scene/factory.h>
 
 /* ----------------------------------------------------------------------- */
@@ -62,6 +66,10 @@ void installCodecs(){
 		SceneFactory::get().registerCodec(SceneCodecPtr(new VgStarCodec()));
 		SceneFactory::get().registerCodec(SceneCodecPtr(new PovCodec()));
 		SceneFactory::get().registerCodec(SceneCodecPtr(new VrmlCodec()));
+		SceneFactory::get().registerCodec(SceneCodecPtr(new PlyCodec()));
+		SceneFactory::get().registerCodec(SceneCodecPtr(new ObjCodec()));
+		SceneFactory::get().registerCodec(SceneCodecPtr(new GltfCodec()));
+		SceneFactory::get().registerCodec(SceneCodecPtr(new TpcCodec()));
 	}
 }
 
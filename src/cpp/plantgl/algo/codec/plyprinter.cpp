@@ -46,6 +46,8 @@
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 
+#include <cstdio>
+
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
 
@@ -103,6 +105,40 @@ using namespace std;
 
 /* ----------------------------------------------------------------------- */
 
+/// A stream buffer writing in a temporary file, removed when closed.
+class FileSpoolBuffer : public std::streambuf {
+public:
+  FileSpoolBuffer() : __file(tmpfile()) { }
+
+  virtual ~FileSpoolBuffer() { if (__file) fclose(__file); }
+
+  bool isValid() const { return __file != NULL; }
+
+  /// Copies the content of the file in \e stream.
+  bool copyTo(std::ostream& stream) {
+    if (!__file || fflush(__file) != 0) return false;
+    rewind(__file);
+    char block[65536];
+    size_t nb;
+    while ((nb = fread(block, 1, sizeof(block), __file)) > 0) stream.write(block, nb);
+    return !ferror(__file) && stream.good();
+  }
+
+protected:
+  virtual int_type overflow(int_type c) {
+    if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+    return fputc(traits_type::to_char_type(c), __file) == EOF ? traits_type::eof() : c;
+  }
+
+  virtual std::streamsize xsputn(const char * s, std::streamsize n) {
+    return fwrite(s, 1, n, __file);
+  }
+
+  FILE * __file;
+};
+
+/* ----------------------------------------------------------------------- */
+
 
 PlyPrinter::PlyPrinter( ostream& stream , Discretizer& discretizer) :
   Printer(stream,stream,stream),
@@ -113,12 +149,16 @@ PlyPrinter::PlyPrinter( ostream& stream , Discretizer& discretizer) :
   __red(160),
   __green(160),
   __blue(160),
-  __index(0)
+  __index(0),
+  __faceSpool(NULL),
+  __vertexPos(0),
+  __facePos(0)
 {
 }
 
 PlyPrinter::~PlyPrinter()
 {
+  delete __faceSpool;
 }
 
 #define stream __geomStream
@@ -150,19 +190,82 @@ PlyPrinter::header( const char * comment ){
 #endif
   stream << endl;
   if(comment)stream << "comment " << comment << endl;
-  stream << "element vertex " << __vertex << endl; /// number of vertex
+  stream << "element vertex ";
+  __vertexPos = stream.tellp();
+  stream << headerCount(__vertex) << endl; /// number of vertex
   stream << "property float x" << endl; /// vertex coordinates
   stream << "property float y" << endl;
   stream << "property float z" << endl;
   stream << "property uchar diffuse_red" << endl; /// vertex color
   stream << "property uchar diffuse_green" << endl;
   stream << "property uchar diffuse_blue" << endl;
-  stream << "element face " << __face << endl;/// number of face
+  stream << "element face ";
+  __facePos = stream.tellp();
+  stream << headerCount(__face) << endl;/// number of face
   stream << "property list uchar int vertex_indices " << endl; /// number of vertices for each face
   stream << "end_header" << endl;
   return true;
 }
 
+string
+PlyPrinter::headerCount( uint_t nb ) const {
+  string result = number(nb);
+  if(isStreaming() && result.size() < 10) result = string(10 - result.size(),'0') + result;
+  return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool
+PlyPrinter::begin( const char * comment ){
+  __vertex = 0;
+  __face = 0;
+  __index = 0;
+  FileSpoolBuffer * spool = new FileSpoolBuffer();
+  if(!spool->isValid()){
+    delete spool;
+    return false;
+  }
+  delete __faceSpool;
+  __faceSpool = spool;
+  return Printer::begin(comment);
+}
+
+bool
+PlyPrinter::add( const Shape3DPtr& shape ){
+  if(!isStreaming() || !shape) return false;
+  __pass = 1;
+  bool result = shape->apply(*this);
+  if(result){
+    __pass = 2;
+    result = shape->apply(*this);
+    // The faces are written after all the vertices.
+    streambuf * buffer = stream.rdbuf(__faceSpool);
+    __pass = 3;
+    result = shape->apply(*this) && result;
+    stream.rdbuf(buffer);
+  }
+  // Released geometries may give their id to new ones.
+  __discretizer.clear();
+  if(result) ++__streamedShapes;
+  return result;
+}
+
+bool
+PlyPrinter::end( ){
+  if(!isStreaming()) return false;
+  bool result = static_cast<FileSpoolBuffer *>(__faceSpool)->copyTo(stream);
+  delete __faceSpool;
+  __faceSpool = NULL;
+  streampos endPos = stream.tellp();
+  stream.seekp(__vertexPos);
+  stream << headerCount(__vertex);
+  stream.seekp(__facePos);
+  stream << headerCount(__face);
+  stream.seekp(endPos);
+  return Printer::end() && result;
+}
+
 /* ----------------------------------------------------------------------- */
 
 
@@ -794,7 +897,10 @@ PlyBinaryPrinter::header( const char * comment ){
     header += string("comment ") + comment;
     header += '\n';
   }
-  header += "element vertex " + number(__vertex);
+  streampos start = __geomStream.tellp();
+  header += "element vertex ";
+  __vertexPos = start + streamoff(header.size());
+  header += headerCount(__vertex);
   header += '\n';
   header += "property float x";
   header += '\n';
@@ -809,7 +915,8 @@ PlyBinaryPrinter::header( const char * comment ){
   header += "property uchar diffuse_blue";
   header += '\n';
   header += "element face ";
-  header += number(__face);
+  __facePos = start + streamoff(header.size());
+  header += headerCount(__face);
   header += '\n';
   header += "property list uchar int vertex_indices";
   header += '\n';
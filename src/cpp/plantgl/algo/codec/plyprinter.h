@@ -106,6 +106,24 @@ public :
   /// Add comment in the header of the outpu file.
   virtual bool header(const char * comment = NULL);
 
+  /// @name Streaming
+  //@{
+
+  /** Begins a stream of shapes. The numbers of vertices and faces of the header
+      are written at the end of the stream. The output stream must be seekable. */
+  virtual bool begin(const char * comment = NULL);
+
+  /** Writes the vertices of \e shape. Its faces are kept in a temporary file
+      until the end of the stream. */
+  virtual bool add(const Shape3DPtr& shape);
+
+  using Printer::add;
+
+  /// Ends the stream of shapes.
+  virtual bool end();
+
+  //@}
+
   /// Return whether the output is in binary format or not.
   virtual bool isBinary() const {
     return false;
@@ -399,6 +417,15 @@ protected :
   /// index of point.
   uint_t __index;
 
+  /// Return the number \e nb as written in the header. It has a fixed width when streaming.
+  std::string headerCount(uint_t nb) const;
+
+  /// Temporary storage of the faces of a stream.
+  std::streambuf * __faceSpool;
+
+  /// Positions of the numbers of vertices and faces in the header of a stream.
+  std::streampos __vertexPos;
+  std::streampos __facePos;
 
 };
 
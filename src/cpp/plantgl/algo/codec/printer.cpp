@@ -43,6 +43,7 @@
 #include <plantgl/tool/dirnames.h>
 #include <time.h>
 #include <iostream>
+#include <algorithm>
 
 #include <plantgl/pgl_appearance.h>
 #include <plantgl/pgl_geometry.h>
@@ -72,7 +73,7 @@ using namespace std;
 
 #define GEOM_PRINT_BEGIN(stream,type,obj) \
   if (obj->isNamed()) { \
-    if (! __cache.insert(obj->getId()).second) { \
+    if (! cache(obj,obj->getId())) { \
       stream << obj->getName().c_str() << endl; \
       return true; \
     }; \
@@ -287,7 +288,10 @@ Printer::Printer( ) :
   __geomStream(cout),
   __matStream(cout),
   __cache(),
-  __indent() {
+  __indent(),
+  __streaming(false),
+  __streamedShapes(0),
+  __streamedLimit(1024) {
 }
 
 Printer::Printer( ostream& stream  ) :
@@ -296,7 +300,10 @@ Printer::Printer( ostream& stream  ) :
   __geomStream(stream),
   __matStream(stream),
   __cache(),
-  __indent() {
+  __indent(),
+  __streaming(false),
+  __streamedShapes(0),
+  __streamedLimit(1024) {
 }
 
 Printer::Printer( ostream& shapeStream, ostream& geomStream, ostream& matStream ) :
@@ -305,7 +312,10 @@ Printer::Printer( ostream& shapeStream, ostream& geomStream, ostream& matStream
   __geomStream(geomStream),
   __matStream(matStream),
   __cache(),
-  __indent() {
+  __indent(),
+  __streaming(false),
+  __streamedShapes(0),
+  __streamedLimit(1024) {
 }
 
 Printer::~Printer( ) {
@@ -350,6 +360,59 @@ bool Printer::header(ostream & _ostream,const char * filename,const char * comme
   return true;
 }
 
+bool Printer::begin(const char * comment){
+  clear();
+  __streamed.clear();
+  __streaming = true;
+  __streamedShapes = 0;
+  return header(comment);
+}
+
+bool Printer::add(const Shape3DPtr& shape){
+  if (!__streaming || !shape) return false;
+  bool result = shape->apply(*this);
+  if (result) ++__streamedShapes;
+  releaseCache();
+  return result;
+}
+
+bool Printer::add(const ShapePtr& shape){
+  return add(Shape3DPtr(shape.get()));
+}
+
+bool Printer::end(){
+  if (!__streaming) return false;
+  __streaming = false;
+  clear();
+  __streamed.clear();
+  __shapeStream.flush();
+  __geomStream.flush();
+  __matStream.flush();
+  return __shapeStream.good() && __geomStream.good() && __matStream.good();
+}
+
+bool Printer::cache(SceneObject * obj, size_t id){
+  if (!__cache.insert(id).second) return false;
+  if (__streaming) __streamed.push_back(std::pair<size_t,SceneObjectPtr>(id,SceneObjectPtr(obj)));
+  return true;
+}
+
+void Printer::releaseCache(){
+  if (__streamed.size() < __streamedLimit) return;
+  // An object only referenced by the cache will not be written again.
+  // Its address, and thus its id, may then be given to a new object.
+  std::vector<std::pair<size_t,SceneObjectPtr> >::iterator _last = __streamed.begin();
+  for (std::vector<std::pair<size_t,SceneObjectPtr> >::iterator _it = __streamed.begin(); _it != __streamed.end(); ++_it) {
+    if (_it->second->unique()) __cache.erase(_it->first);
+    else {
+      if (_last != _it) *_last = *_it;
+      ++_last;
+    }
+  }
+  __streamed.erase(_last,__streamed.end());
+  __streamedLimit = std::max<size_t>(1024, 2 * __streamed.size());
+}
+
 bool Printer::isPrinted(SceneObjectPtr obj){
   if (!obj->isNamed()) return false;
   return !( (__cache.find(obj->getId())) == (__cache.end()));
@@ -382,7 +445,9 @@ bool Printer::process(Shape * Shape){
     if( Shape->geometry ){
         if ( (__cache.find(Shape->geometry->getId())) == (__cache.end())) {
             if(!Shape->geometry->isNamed()){
-                Shape->geometry->setName("Geometry_"+number(Shape->geometry->getId()));
+                // When streaming, the id of a released object may be reused.
+                Shape->geometry->setName("Geometry_"+number(Shape->geometry->getId())+
+                                         (__streaming ? "_"+number(__streamedShapes) : std::string("")));
             }
             __geomStream << __indent;
             Shape->geometry->apply(*this);
@@ -393,7 +458,8 @@ bool Printer::process(Shape * Shape){
     if(Shape->appearance){
       if ( (__cache.find(Shape->appearance->getId())) == (__cache.end())) {
 	  if(!Shape->appearance->isNamed()){
-		Shape->geometry->setName("Appearance_"+number(Shape->appearance->getId()));
+		Shape->appearance->setName("Appearance_"+number(Shape->appearance->getId())+
+		                           (__streaming ? "_"+number(__streamedShapes) : std::string("")));
 	  }
         __matStream << __indent;
         Shape->appearance->apply(*this);
@@ -48,6 +48,7 @@
 #include <plantgl/scenegraph/core/action.h>
 
 #include <string>
+#include <vector>
 #include <iostream>
 
 /* ----------------------------------------------------------------------- */
@@ -56,6 +57,10 @@ PGL_BEGIN_NAMESPACE
 
 class SceneObject;
 typedef RCPtr<SceneObject> SceneObjectPtr;
+class Shape3D;
+typedef RCPtr<Shape3D> Shape3DPtr;
+class Shape;
+typedef RCPtr<Shape> ShapePtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -100,6 +105,28 @@ public:
   /// Add comment in the header of the output file.
   virtual bool header(std::ostream & _ostream,const char * filename = NULL,const char * comment = NULL);
 
+  /** @name Streaming
+      Shapes can be written one at a time without building a Scene. Objects
+      shared by several shapes are written once for the whole stream. */
+  //@{
+
+  /// Begins a stream of shapes and writes the header with \e comment.
+  virtual bool begin(const char * comment = NULL);
+
+  /// Writes \e shape, and the objects it uses that are not yet written.
+  virtual bool add(const Shape3DPtr& shape);
+
+  /// Writes \e shape, and the objects it uses that are not yet written.
+  bool add(const ShapePtr& shape);
+
+  /// Ends the stream of shapes.
+  virtual bool end();
+
+  /// Returns whether a stream of shapes is begun.
+  bool isStreaming() const { return __streaming; }
+
+  //@}
+
 
   /// @name Shape
   //@{
@@ -223,12 +250,31 @@ protected:
   /// The output stream for the objects of type of Material.
   std::ostream& __matStream;
 
+  /** Inserts \e obj of id \e id in the cache. Returns false if it was already printed.
+      When streaming, \e obj is kept so that its id cannot be reused by another object. */
+  bool cache(SceneObject * obj, size_t id);
+
+  /// Removes from the cache the objects streamed that are no more used outside of \e self.
+  void releaseCache();
+
   /// The cache where to store the already printed objects
   pgl_hash_set_uint32 __cache;
 
   /// The ident used to perform a pretty print.
   std::string __indent;
 
+  /// Whether a stream of shapes is begun.
+  bool __streaming;
+
+  /// The number of shapes written in the stream.
+  size_t __streamedShapes;
+
+  /// The objects written in the stream with their id.
+  std::vector<std::pair<size_t,SceneObjectPtr> > __streamed;
+
+  /// The number of objects streamed above which the cache is released.
+  size_t __streamedLimit;
+
 };
 
 
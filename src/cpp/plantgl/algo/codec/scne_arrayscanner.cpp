@@ -0,0 +1,352 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "scne_arrayscanner.h"
+#include <plantgl/tool/util_parallel.h>
+#include <plantgl/tool/util_string.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const size_t GeomArrayScanner::MIN_LITERAL_SIZE = 1024;
+const char GeomArrayScanner::PLACEHOLDER = '\x01';
+
+/// Size in bytes of the parts of a literal parsed by a same task.
+static const size_t CHUNK_SIZE = 1 << 16;
+
+static inline bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+static inline bool isNumberChar(char c)
+{ return isDigit(c) || c == '.' || c == '-' || c == '+' || c == 'e' || c == 'E'; }
+
+static inline const char * skipSpaces(const char * p, const char * end)
+{ while (p < end && isSpace(*p)) ++p; return p; }
+
+/* ----------------------------------------------------------------------- */
+
+/// A literal of the text which looks like a list of vectors or of indices.
+struct GeomLiteral {
+    GeomArrayScanner::ArrayType type;
+    /// The literal, from its opening to after its closing bracket.
+    const char * begin;
+    const char * end;
+    size_t count;
+    size_t lines;
+    /// Start of the first element of each chunk and index of this element.
+    std::vector<const char *> chunks;
+    std::vector<size_t> firsts;
+};
+
+/** Checks the structure of the literal starting at the bracket \e p. Only the
+    characters are checked here, the numbers are checked when parsing.
+    Returns the end of the literal, or NULL if it is not a list of vectors or of indices. */
+static const char * scanLiteral(const char * p, const char * end, GeomLiteral& literal)
+{
+    literal.begin = p;
+    literal.count = 0;
+    literal.lines = 0;
+    literal.chunks.clear();
+    literal.firsts.clear();
+    const char * q = skipSpaces(p + 1, end);
+    if (q == end || (*q != '<' && *q != '[')) return NULL;
+    const char open = *q;
+    const char close = (open == '<' ? '>' : ']');
+    size_t arity = 1;
+    bool inside = false;
+    const char * chunk = NULL;
+    for (q = p + 1; q < end; ++q) {
+        const char c = *q;
+        if (c == '\n') ++literal.lines;
+        if (isSpace(c)) continue;
+        if (inside) {
+            if (c == close) inside = false;
+            else if (c == ',') { if (literal.count == 1) ++arity; }
+            else if (open == '<' ? !isNumberChar(c) : !isDigit(c)) return NULL;
+        }
+        else if (c == open) {
+            inside = true;
+            if (!chunk || size_t(q - chunk) >= CHUNK_SIZE) {
+                chunk = q;
+                literal.chunks.push_back(q);
+                literal.firsts.push_back(literal.count);
+            }
+            ++literal.count;
+        }
+        else if (c == ']') break;
+        else if (c != ',') return NULL;
+    }
+    if (q == end || inside) return NULL;
+    literal.end = q + 1;
+    if (open == '[') literal.type = GeomArrayScanner::IndexType;
+    else if (arity == 2) literal.type = GeomArrayScanner::Point2Type;
+    else if (arity == 3) literal.type = GeomArrayScanner::Point3Type;
+    else if (arity == 4) literal.type = GeomArrayScanner::Point4Type;
+    else return NULL;
+    return literal.end;
+}
+
+/// Returns the end of the line of \e p, or of the following lines as long as they end with '\'.
+static const char * skipDefinition(const char * p, const char * end)
+{
+    while (p < end) {
+        const char * eol = (const char *)memchr(p, '\n', end - p);
+        if (!eol) return end;
+        bool continued = (eol > p && *(eol - 1) == '\\');
+        p = eol + 1;
+        if (!continued) return p;
+    }
+    return p;
+}
+
+/// Finds the literals of at least MIN_LITERAL_SIZE bytes outside comments, strings and macros.
+static void findLiterals(const char * p, const char * end, std::vector<GeomLiteral>& literals)
+{
+    GeomLiteral literal;
+    while (p < end) {
+        const char c = *p;
+        if (c == '[') {
+            const char * next = scanLiteral(p, end, literal);
+            if (!next) ++p;
+            else {
+                if (size_t(next - p) >= GeomArrayScanner::MIN_LITERAL_SIZE) literals.push_back(literal);
+                p = next;
+            }
+        }
+        else if (c == '#') {
+            const char * eol = (const char *)memchr(p, '\n', end - p);
+            p = (eol ? eol : end);
+        }
+        else if (c == '(' && p + 1 < end && p[1] == '#') {
+            for (p += 2; p + 1 < end && !(p[0] == '#' && p[1] == ')'); ++p) ;
+            p = (p + 1 < end ? p + 2 : end);
+        }
+        else if (c == '"') {
+            const char * q = p + 1;
+            while (q < end && *q != '"' && *q != '\t' && *q != '\n') ++q;
+            p = (q < end && *q == '"' ? q + 1 : p + 1);
+        }
+        else if (c == ':') {
+            const char * q = p + 1;
+            while (q < end && ((*q >= 'a' && *q <= 'z') || (*q >= 'A' && *q <= 'Z'))) ++q;
+            std::string directive(p + 1, q);
+            if (!directive.empty()) directive[0] = char(tolower(directive[0]));
+            if (directive == "def" || directive == "define") p = skipDefinition(q, end);
+            else if (directive == "include" || directive == "echo" || directive == "undef" ||
+                     directive == "ifdef" || directive == "ifndef") {
+                const char * eol = (const char *)memchr(q, '\n', end - q);
+                p = (eol ? eol : end);
+            }
+            else p = q;
+        }
+        else ++p;
+    }
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Parses the chunks of the literals. A literal with an invalid chunk is left to the lexer.
+struct GeomLiteralParser {
+
+    GeomLiteralParser(const std::vector<GeomLiteral>& _literals) :
+        literals(_literals), points2(_literals.size()), points3(_literals.size()),
+        points4(_literals.size()), indices(_literals.size())
+    {
+        for (size_t i = 0; i < literals.size(); ++i) {
+            const GeomLiteral& literal = literals[i];
+            switch (literal.type) {
+                case GeomArrayScanner::Point2Type: points2[i] = Point2ArrayPtr(new Point2Array(literal.count)); break;
+                case GeomArrayScanner::Point3Type: points3[i] = Point3ArrayPtr(new Point3Array(literal.count)); break;
+                case GeomArrayScanner::Point4Type: points4[i] = Point4ArrayPtr(new Point4Array(literal.count)); break;
+                case GeomArrayScanner::IndexType: indices[i] = IndexArrayPtr(new IndexArray(literal.count)); break;
+            }
+            for (size_t j = 0; j < literal.chunks.size(); ++j) tasks.push_back(std::pair<size_t,size_t>(i, j));
+        }
+        valid.resize(tasks.size(), 1);
+    }
+
+    void operator()(size_t first, size_t last) {
+        std::vector<uint_t> values;
+        for (size_t t = first; t < last; ++t) {
+            const GeomLiteral& literal = literals[tasks[t].first];
+            size_t chunk = tasks[t].second;
+            size_t element = literal.firsts[chunk];
+            size_t lastElement = (chunk + 1 < literal.chunks.size() ? literal.firsts[chunk + 1] : literal.count);
+            const char * next = (chunk + 1 < literal.chunks.size() ? literal.chunks[chunk + 1] : literal.end - 1);
+            const char * p = literal.chunks[chunk];
+            for (; p && element < lastElement; ++element) {
+                if (literal.type == GeomArrayScanner::IndexType) p = parseIndex(p, next, values, tasks[t].first, element);
+                else p = parseVector(p, next, literal.type, tasks[t].first, element);
+                if (p && element + 1 < lastElement) {
+                    p = skipSpaces(p, next);
+                    p = (p < next && *p == ',' ? skipSpaces(p + 1, next) : NULL);
+                }
+            }
+            if (p) {
+                p = skipSpaces(p, next);
+                if (chunk + 1 < literal.chunks.size()) p = (p < next && *p == ',' ? skipSpaces(p + 1, next) : NULL);
+            }
+            valid[t] = (p == next);
+        }
+    }
+
+    /// Parses the vector at \e p, i.e. reals separated by commas between '<' and '>'.
+    const char * parseVector(const char * p, const char * end, GeomArrayScanner::ArrayType type, size_t id, size_t element) {
+        const size_t arity = (type == GeomArrayScanner::Point2Type ? 2 : (type == GeomArrayScanner::Point3Type ? 3 : 4));
+        real_t coords[4];
+        if (p == end || *p != '<') return NULL;
+        ++p;
+        for (size_t i = 0; i < arity; ++i) {
+            double value;
+            p = parseRealPrefix(skipSpaces(p, end), end, value);
+            if (!p) return NULL;
+            coords[i] = real_t(value);
+            p = skipSpaces(p, end);
+            if (p == end || *p != (i + 1 < arity ? ',' : '>')) return NULL;
+            ++p;
+        }
+        switch (type) {
+            case GeomArrayScanner::Point2Type: points2[id]->setAt(element, Vector2(coords[0], coords[1])); break;
+            case GeomArrayScanner::Point3Type: points3[id]->setAt(element, Vector3(coords[0], coords[1], coords[2])); break;
+            default: points4[id]->setAt(element, Vector4(coords[0], coords[1], coords[2], coords[3])); break;
+        }
+        return p;
+    }
+
+    /// Parses the index at \e p, i.e. unsigned integers separated by commas between '[' and ']'.
+    const char * parseIndex(const char * p, const char * end, std::vector<uint_t>& values, size_t id, size_t element) {
+        if (p == end || *p != '[') return NULL;
+        values.clear();
+        for (++p; ; ++p) {
+            p = skipSpaces(p, end);
+            if (p == end || !isDigit(*p)) return NULL;
+            uint_t value = 0;
+            for (; p < end && isDigit(*p); ++p) value = value * 10 + uint_t(*p - '0');
+            values.push_back(value);
+            p = skipSpaces(p, end);
+            if (p == end) return NULL;
+            if (*p == ']') break;
+            if (*p != ',') return NULL;
+        }
+        indices[id]->setAt(element, Index(values.begin(), values.end()));
+        return p + 1;
+    }
+
+    const std::vector<GeomLiteral>& literals;
+    std::vector<Point2ArrayPtr> points2;
+    std::vector<Point3ArrayPtr> points3;
+    std::vector<Point4ArrayPtr> points4;
+    std::vector<IndexArrayPtr> indices;
+    /// Literal and chunk of each task.
+    std::vector<std::pair<size_t,size_t> > tasks;
+    std::vector<char> valid;
+};
+
+/* ----------------------------------------------------------------------- */
+
+GeomArrayScanner::GeomArrayScanner(const char * data, size_t size) :
+    std::streambuf(), __current(0)
+{
+    const char * end = data + size;
+    std::vector<GeomLiteral> literals;
+    findLiterals(data, end, literals);
+
+    GeomLiteralParser parser(literals);
+    pgl_parallel_for(0, parser.tasks.size(), parser, 1);
+
+    std::vector<char> valid(literals.size(), 1);
+    for (size_t t = 0; t < parser.tasks.size(); ++t)
+        if (!parser.valid[t]) valid[parser.tasks[t].first] = 0;
+
+    std::vector<const GeomLiteral *> replaced;
+    for (size_t i = 0; i < literals.size(); ++i) {
+        if (!valid[i]) continue;
+        Array array;
+        array.type = literals[i].type;
+        array.points2 = parser.points2[i];
+        array.points3 = parser.points3[i];
+        array.points4 = parser.points4[i];
+        array.indices = parser.indices[i];
+        char id[32];
+        sprintf(id, "%c%lu%c", PLACEHOLDER, (unsigned long)__arrays.size(), PLACEHOLDER);
+        __placeholders.push_back(std::string(id) + std::string(literals[i].lines, '\n'));
+        __arrays.push_back(array);
+        replaced.push_back(&literals[i]);
+    }
+
+    const char * p = data;
+    for (size_t i = 0; i < replaced.size(); ++i) {
+        Segment text = { p, replaced[i]->begin };
+        Segment placeholder = { __placeholders[i].data(), __placeholders[i].data() + __placeholders[i].size() };
+        __segments.push_back(text);
+        __segments.push_back(placeholder);
+        p = replaced[i]->end;
+    }
+    Segment text = { p, end };
+    __segments.push_back(text);
+    setg(NULL, NULL, NULL);
+}
+
+GeomArrayScanner::~GeomArrayScanner()
+{
+}
+
+size_t GeomArrayScanner::getId(const char * text) const
+{
+    if (!text || *text != PLACEHOLDER) return size();
+    char * last = NULL;
+    unsigned long id = strtoul(text + 1, &last, 10);
+    if (last == text + 1 || *last != PLACEHOLDER || id >= size()) return size();
+    return size_t(id);
+}
+
+GeomArrayScanner::int_type GeomArrayScanner::underflow()
+{
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+    while (__current < __segments.size()) {
+        const Segment& segment = __segments[__current++];
+        if (segment.begin != segment.end) {
+            char * begin = const_cast<char *>(segment.begin);
+            setg(begin, begin, const_cast<char *>(segment.end));
+            return traits_type::to_int_type(*gptr());
+        }
+    }
+    return traits_type::eof();
+}
+
+/* ----------------------------------------------------------------------- */
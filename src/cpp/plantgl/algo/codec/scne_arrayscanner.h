@@ -0,0 +1,150 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file scne_arrayscanner.h
+    \brief Definition of GeomArrayScanner, the bulk reader of the large array literals of GEOM files.
+*/
+
+#ifndef __scne_arrayscanner_h__
+#define __scne_arrayscanner_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "codec_config.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GeomArrayScanner
+   \brief A stream buffer on the text of a GEOM file in which the large
+   numeric array literals are parsed in bulk before the lexer runs.
+   Lists of vectors such as <tt>[ <1,2,3>, <4,5,6> ]</tt> and lists of
+   indices such as <tt>[ [0,1,2], [2,3,0] ]</tt> made only of plain numbers
+   are parsed directly from the text, the largest ones in parallel. Each of
+   them is replaced in the stream by a placeholder (followed by as many end
+   of lines as the literal, to keep the line numbers) that the lexer turns
+   into a single token holding the parsed array. Comments, strings and macro
+   definitions are left untouched, as well as any literal that does not
+   strictly follow this form.
+*/
+class CODEC_API GeomArrayScanner : public std::streambuf {
+
+public:
+
+  /// The types of the arrays parsed in bulk.
+  enum ArrayType { Point2Type, Point3Type, Point4Type, IndexType };
+
+  /// Size in bytes of the smallest literal parsed in bulk.
+  static const size_t MIN_LITERAL_SIZE;
+
+  /// Character delimiting the placeholders of the arrays in the stream.
+  static const char PLACEHOLDER;
+
+  /** Scans the \e size bytes of the GEOM text \e data and parses its large array literals.
+      The data are not copied and must outlive the scanner. */
+  GeomArrayScanner(const char * data, size_t size);
+
+  /// Destructor.
+  virtual ~GeomArrayScanner();
+
+  /// Returns the number of arrays parsed in bulk.
+  size_t size() const { return __arrays.size(); }
+
+  /// Returns the type of the array \e id.
+  ArrayType getType(size_t id) const { return __arrays[id].type; }
+
+  /// Returns the array \e id if it is a list of 2D vectors.
+  const Point2ArrayPtr& getPoint2Array(size_t id) const { return __arrays[id].points2; }
+
+  /// Returns the array \e id if it is a list of 3D vectors.
+  const Point3ArrayPtr& getPoint3Array(size_t id) const { return __arrays[id].points3; }
+
+  /// Returns the array \e id if it is a list of 4D vectors.
+  const Point4ArrayPtr& getPoint4Array(size_t id) const { return __arrays[id].points4; }
+
+  /// Returns the array \e id if it is a list of indices.
+  const IndexArrayPtr& getIndexArray(size_t id) const { return __arrays[id].indices; }
+
+  /** Returns the id of the array whose placeholder is \e text, or size() if
+      \e text is not a valid placeholder. */
+  size_t getId(const char * text) const;
+
+protected:
+
+  /// Gives to the stream the next segment of text or placeholder.
+  virtual int_type underflow();
+
+  /// An array parsed in bulk.
+  struct Array {
+    ArrayType type;
+    Point2ArrayPtr points2;
+    Point3ArrayPtr points3;
+    Point4ArrayPtr points4;
+    IndexArrayPtr indices;
+  };
+
+  /// A part of the stream, either a segment of the text or a placeholder.
+  struct Segment {
+    const char * begin;
+    const char * end;
+  };
+
+  std::vector<Array> __arrays;
+  std::vector<std::string> __placeholders;
+  std::vector<Segment> __segments;
+  size_t __current;
+
+private:
+
+  GeomArrayScanner( const GeomArrayScanner& );
+  GeomArrayScanner& operator=( const GeomArrayScanner& );
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __scne_arrayscanner_h__
+#endif
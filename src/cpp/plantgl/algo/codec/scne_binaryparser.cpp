@@ -44,8 +44,10 @@
 #include <plantgl/scenegraph/core/pgl_messages.h>
 #include <plantgl/tool/timer.h>
 #include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/util_enviro.h>
+#include <plantgl/tool/util_mutex.h>
 
 #include "scne_parser.h"
 
@@ -106,8 +108,12 @@ bool PGL(isParserVerbose)()
         __result->setName(_name); \
         count_name++; \
     } \
-    if (_ident != 0) \
-        __referencetable.insert(_ident, __result); \
+    if (_ident != 0) { \
+        /* Objects shared by several chunks of an indexed file are read once per chunk. Keep the first one. */ \
+        Cache<SceneObjectPtr >::Iterator _it = __referencetable.find(_ident); \
+        if (_it != __referencetable.end() && is_valid_ptr(_it->second)) __result = _it->second; \
+        else __referencetable.insert(_ident, __result); \
+    } \
     return  true; \
   } \
   else { \
@@ -125,8 +131,10 @@ bool PGL(isParserVerbose)()
     uint_t _sizej = readUint32(); \
     if (_sizej > 0){ \
       obj = type##Ptr (new type(_sizej)); \
-      for (type::iterator _it = obj->begin();_it != obj->end() && !stream->eof(); _it++) { \
-      *_it = read##primitive(); \
+      if (!readArrayData(*obj)) { \
+        for (type::iterator _it = obj->begin();_it != obj->end() && !stream->eof(); _it++) { \
+        *_it = read##primitive(); \
+        }; \
       }; \
     }; \
   };
@@ -279,7 +287,12 @@ BinaryParser::BinaryParser(ostream& output,int max_errors) :
     __currents(45,uint_t(0)),
     __result(),
     __assigntime(0),
-    __double_precision(false){
+    __double_precision(false),
+    __index(),
+    __indexed(false),
+    __buffers(NULL),
+    __inmemory(false),
+    __directory(){
     for(uint_t i=0;i<45;i++)__mem[i]=NULL;
 }
 
@@ -330,6 +343,10 @@ bool BinaryParser::readBool()
 uint32_t BinaryParser::readUint32()
 { uint32_t val;  *stream >> val; return val; }
 
+/// read an uint64_t value stored as two uint32
+uint64_t BinaryParser::readUint64()
+{ uint64_t low = readUint32(); uint64_t high = readUint32(); return low | (high << 32); }
+
 /// read an uint_t value from stream
 int32_t BinaryParser::readInt32()
 { int32_t val;  *stream >> val; return val; }
@@ -398,6 +415,10 @@ std::string BinaryParser::readFile()
         if(suffix[0] != '\\' && suffix[0] != '/')val += '/';
         val += suffix;
    }
+   // relative filenames are resolved from the directory of the parsed file.
+   else if(!val.empty() && !__directory.empty() && val[0] != '/' && val[0] != '\\' &&
+           !(val.size() > 1 && val[1] == ':'))
+        val = cat_dir_file(__directory,val);
   }
   else __outputStream << "Filename wrong format." << endl;
   return val;
@@ -452,13 +473,137 @@ Index BinaryParser::readIndex()
 {
   uint_t size = readUint32();
   Index val(size);
-  for(Index::iterator it = val.begin(); it != val.end(); ++it)
-      *it = readUint32();
+  if (size > 0) stream->readValues(&*val.begin(), size);
   return val;
 }
 
 /* ----------------------------------------------------------------------- */
 
+void BinaryParser::alignArrayData()
+{
+  if (__indexed) stream->align(BinaryIndex::ALIGNMENT);
+}
+
+bool BinaryParser::readBuffer(const char *& data, size_t size)
+{
+  data = NULL;
+  if (!__buffers) return false;
+  uint32_t id = readUint32();
+  if (id == BinaryBuffer::INLINE) return false;
+  if (id < __buffers->size() && (*__buffers)[id].size == size)
+    data = (*__buffers)[id].data;
+  else {
+    __outputStream << "*** PARSER: Out of band buffer " << id << " not valid." << endl;
+    __errors_count++;
+  }
+  return true;
+}
+
+bool BinaryParser::readBuffer(void * data, size_t size)
+{
+  const char * buffer;
+  if (!readBuffer(buffer, size)) return false;
+  if (buffer) memcpy(data, buffer, size);
+  return true;
+}
+
+/// Copy the reals of the vectors of array from an out of band buffer where they are packed.
+template<class Array>
+inline void unpack_vectors(const char * data, Array& array, uchar_t dim)
+{
+    for (typename Array::iterator it = array.begin(); it != array.end(); ++it, data += dim * sizeof(real_t))
+        memcpy(&it->getAt(0), data, dim * sizeof(real_t));
+}
+
+/// Decode the reals of the vectors of array directly from the file.
+template<class Array>
+inline void read_vectors(lemmapstream& stream, Array& array, uchar_t dim, bool doubleprecision)
+{
+    for (typename Array::iterator it = array.begin(); it != array.end(); ++it)
+        stream.readReals(&it->getAt(0), dim, doubleprecision);
+}
+
+bool BinaryParser::readArrayData(RealArray& array)
+{
+  if (!array.empty() && !readBuffer(&*array.begin(), array.size() * sizeof(real_t))) {
+    alignArrayData();
+    stream->readReals(&*array.begin(), array.size(), __double_precision);
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Point2Array& array)
+{
+  const char * buffer;
+  if (array.empty()) return true;
+  if (readBuffer(buffer, array.size() * 2 * sizeof(real_t))) {
+    if (buffer) unpack_vectors(buffer, array, 2);
+  }
+  else {
+    alignArrayData();
+    read_vectors(*stream, array, 2, __double_precision);
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Point3Array& array)
+{
+  const char * buffer;
+  if (array.empty()) return true;
+  if (readBuffer(buffer, array.size() * 3 * sizeof(real_t))) {
+    if (buffer) unpack_vectors(buffer, array, 3);
+  }
+  else {
+    alignArrayData();
+    read_vectors(*stream, array, 3, __double_precision);
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Point4Array& array)
+{
+  const char * buffer;
+  if (array.empty()) return true;
+  if (readBuffer(buffer, array.size() * 4 * sizeof(real_t))) {
+    if (buffer) unpack_vectors(buffer, array, 4);
+  }
+  else {
+    alignArrayData();
+    read_vectors(*stream, array, 4, __double_precision);
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Color4Array& array)
+{
+  // Color4 and Index3/4 are plain tuples and are stored contiguously.
+  if (!array.empty() && !readBuffer(&*array.begin(), array.size() * sizeof(Color4))) {
+    alignArrayData();
+    stream->readValues(&array.begin()->getAt(0), 4 * array.size());
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Index3Array& array)
+{
+  if (!array.empty() && !readBuffer(&*array.begin(), array.size() * sizeof(Index3))) {
+    alignArrayData();
+    stream->readValues(&array.begin()->getAt(0), 3 * array.size());
+  }
+  return true;
+}
+
+bool BinaryParser::readArrayData(Index4Array& array)
+{
+  if (!array.empty() && !readBuffer(&*array.begin(), array.size() * sizeof(Index4))) {
+    alignArrayData();
+    stream->readValues(&array.begin()->getAt(0), 4 * array.size());
+  }
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
 const string& BinaryParser::getComment() const {
   return __comment;
 }
@@ -505,8 +650,8 @@ bool BinaryParser::readHeader(){
 #ifdef GEOM_DEBUG
   printf("File version : %f\n",_version);
 #endif
-  if(_version > BinaryPrinter::BINARY_FORMAT_VERSION){
-      __outputStream << "*** ERROR: Binary Format Version invalid  (File=" << _version << ";Current=" << BinaryPrinter::BINARY_FORMAT_VERSION << "). Upgrade."<< endl;
+  if(_version > BinaryPrinter::INDEXED_FORMAT_VERSION){
+      __outputStream << "*** ERROR: Binary Format Version invalid  (File=" << _version << ";Current=" << BinaryPrinter::INDEXED_FORMAT_VERSION << "). Upgrade."<< endl;
       return false;
   }
   if(__tokens)delete __tokens;
@@ -617,13 +762,14 @@ bool BinaryParser::readSceneHeader(){
 /* ----------------------------------------------------------------------- */
 bool BinaryParser::open(const std::string& filename)
 {
-    stream = new leifstream(filename.c_str());
+    stream = new lemmapstream(filename.c_str());
     if(!*stream){
         pglErrorEx(PGLERRORMSG(C_FILE_OPEN_ERR_s),filename.c_str());
         delete stream;
         stream = 0;
         return false;
     }
+    __directory = get_dirname(absolute_filename(filename));
     return true;
 }
 
@@ -646,11 +792,65 @@ bool BinaryParser::eof()
     else return true;
 }
 
+/* ----------------------------------------------------------------------- */
+
+/// Loads the shapes of an indexed file on first access, one chunk at a time.
+class BinaryChunkLoader : public Scene::Loader {
+public:
+    BinaryChunkLoader(const std::string& filename) :
+        Scene::Loader(),
+        __parser(std::cerr),
+        __valid(false)
+    { __valid = __parser.openIndexed(filename); }
+
+    virtual ~BinaryChunkLoader() { __parser.close(); }
+
+    bool isValid() const { return __valid; }
+
+    uint_t size() const { return __parser.getIndex().shapes.size(); }
+
+    virtual bool load(Scene& scene, uint_t i) {
+        __mutex.lock();
+        const BinaryIndex& index = __parser.getIndex();
+        if (i < index.shapes.size() && !scene.isLoaded(i)) {
+            uint_t chunkid = index.shapes[i].chunk;
+            const BinaryIndex::Chunk& chunk = index.chunks[chunkid];
+            uint_t end = chunk.first + chunk.nbshapes;
+            // The parser resolves the referenced files from the directory of the file.
+            __parser.readChunk(chunkid, end - 1);
+            // All the shapes of the chunk have been read. Give them to the scene.
+            ScenePtr shapes = __parser.getScene();
+            for (uint_t k = chunk.first; k < end; ++k) {
+                if (k < scene.size() && !scene.isLoaded(k)) scene.setAt(k, shapes->getAt(k));
+                shapes->setAt(k, Shape3DPtr());
+            }
+        }
+        __mutex.unlock();
+        return i < scene.size() && scene.isLoaded(i);
+    }
+
+protected:
+    BinaryParser __parser;
+    bool __valid;
+    PglMutex __mutex;
+};
+
+/* ----------------------------------------------------------------------- */
+
 /// The parsing function.
 bool BinaryParser::parse(const string& filename){
     if(!open(filename)) return false;
     if(!readHeader())return false;
     if(!readSceneHeader())return false;
+    if(isIndexed()){
+        close();
+        BinaryChunkLoader * loader = new BinaryChunkLoader(filename);
+        Scene::LoaderPtr loaderptr(loader);
+        if(!loader->isValid()) return false;
+        __scene = ScenePtr(new Scene(loader->size()));
+        __scene->setLoader(loaderptr);
+        return true;
+    }
 	PglErrorStream::Binder psb(__outputStream);
     string p = get_cwd();
     chg_dir(get_dirname(filename));
@@ -674,12 +874,195 @@ bool BinaryParser::parse(const string& filename){
     return true;
 }
 
+bool BinaryParser::parse(const char * data, size_t size, const BinaryBufferList * buffers){
+    lemmapstream input(data, size);
+    stream = &input;
+    __buffers = buffers;
+    __inmemory = true;
+    bool result = readHeader() && readSceneHeader() && !isIndexed();
+    if(result){
+        PglErrorStream::Binder psb(__outputStream);
+        __errors_count = 0;
+        shape_nb = 0;
+        // The stream contains the number of root objects announced in its header.
+        uint_t nbobjects = __scene->size();
+        for(uint_t i = 0; i < nbobjects && !stream->eof() && __errors_count == 0; ++i)
+            readNext();
+        if(__roots > 0) __scene->resize(__roots);
+        else __scene = ScenePtr(new Scene);
+        result = (__errors_count == 0 && !stream->eof());
+    }
+    __buffers = NULL;
+    __inmemory = false;
+    stream = 0;
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool BinaryParser::isIndexed() const {
+    return __tokens && __tokens->getVersion() >= BinaryPrinter::INDEXED_FORMAT_VERSION;
+}
+
+bool BinaryParser::readShapeIndex(){
+    size_t trailer = 8 + BinaryIndex::TAG.size();
+    size_t pos = stream->tell();
+    if(stream->size() < pos + trailer){
+        __outputStream << "*** ERROR: Index of binary file not found." << endl;
+        return false;
+    }
+    stream->seek(stream->size() - trailer);
+    uint64_t indexPos = readUint64();
+    char tag[5];
+    stream->read(tag,4);
+    tag[4] = '\0';
+    if(BinaryIndex::TAG != tag || indexPos < pos || indexPos >= stream->size() - trailer){
+        __outputStream << "*** ERROR: Index of binary file not found." << endl;
+        stream->seek(pos);
+        return false;
+    }
+    stream->seek(indexPos);
+    bool valid = (readChar() == '!');
+    uint_t nbchunks = readUint32();
+    // A chunk entry takes 33 bytes. Check the count before allocating.
+    if(nbchunks > stream->remaining() / 33) valid = false;
+    if(valid){
+        __index.chunks.resize(nbchunks);
+        for(vector<BinaryIndex::Chunk>::iterator _it = __index.chunks.begin(); _it != __index.chunks.end(); ++_it){
+            _it->offset = readUint64();
+            _it->size = readUint64();
+            _it->rawsize = readUint64();
+            _it->compression = readUchar();
+            _it->first = readUint32();
+            _it->nbshapes = readUint32();
+            if(_it->offset + _it->size > indexPos) valid = false;
+        }
+    }
+    uint_t nbshapes = readUint32();
+    // A shape entry takes at least 44 bytes.
+    if(nbshapes > stream->remaining() / 44) valid = false;
+    if(valid){
+        __index.shapes.resize(nbshapes);
+        for(vector<BinaryIndex::ShapeEntry>::iterator _it = __index.shapes.begin(); _it != __index.shapes.end(); ++_it){
+            _it->id = readUint32();
+            _it->chunk = readUint32();
+            _it->offset = readUint64();
+            _it->lower = readVector3();
+            _it->upper = readVector3();
+            _it->triangles = readUint32();
+            if(_it->chunk >= nbchunks) valid = false;
+        }
+        for(vector<BinaryIndex::Chunk>::const_iterator _it = __index.chunks.begin(); _it != __index.chunks.end(); ++_it)
+            if(_it->first + _it->nbshapes > nbshapes) valid = false;
+    }
+    valid = valid && readChar() == '!' && !stream->eof();
+    stream->seek(pos);
+    if(!valid){
+        __outputStream << "*** ERROR: Index of binary file not valid." << endl;
+        __index = BinaryIndex();
+        return false;
+    }
+    __scene = ScenePtr(new Scene(nbshapes));
+    return true;
+}
+
+bool BinaryParser::readChunk(uint_t chunkid, uint_t last){
+    if(!stream || chunkid >= __index.chunks.size()) return false;
+    const BinaryIndex::Chunk& chunk = __index.chunks[chunkid];
+    const char * data = stream->data() + chunk.offset;
+    vector<char> buffer;
+    if(chunk.compression != BinaryIndex::NoCompression){
+        // Keep the array payloads aligned in the decompressed chunk.
+        buffer.resize(chunk.rawsize + BinaryIndex::ALIGNMENT);
+        char * raw = &buffer[0] + (BinaryIndex::ALIGNMENT - (size_t)&buffer[0] % BinaryIndex::ALIGNMENT) % BinaryIndex::ALIGNMENT;
+        BinaryIndex::Compression compression = BinaryIndex::Compression(chunk.compression);
+        if(!BinaryIndex::decompress(compression, data, chunk.size, raw, chunk.rawsize)){
+            __outputStream << "*** ERROR: Cannot decompress chunk " << chunkid
+                           << (BinaryIndex::isSupported(compression) ? "." : " (compression not available).") << endl;
+            return false;
+        }
+        data = raw;
+    }
+    else if(chunk.size != chunk.rawsize){
+        __outputStream << "*** ERROR: Chunk " << chunkid << " not valid." << endl;
+        return false;
+    }
+
+    lemmapstream chunkStream(data, chunk.rawsize);
+    lemmapstream * fileStream = stream;
+    stream = &chunkStream;
+    __indexed = true;
+    __errors_count = 0;
+    uint_t end = std::min<uint_t>(last + 1, chunk.first + chunk.nbshapes);
+    for(uint_t i = chunk.first; i < end && __errors_count != __max_errors; ++i){
+        // Shapes may refer to objects of the previous shapes of the chunk, so they are all read in order.
+        if(!stream->seek(__index.shapes[i].offset)) { __errors_count++; continue; }
+        __roots = i;
+        readNext();
+    }
+    __indexed = false;
+    stream = fileStream;
+    return __errors_count == 0;
+}
+
+bool BinaryParser::openIndexed(const std::string& filename){
+    if(!open(filename)) return false;
+    if(!readHeader() || !readSceneHeader()) { close(); return false; }
+    if(!isIndexed()){
+        __outputStream << "*** ERROR: " << filename << " is not an indexed binary file." << endl;
+        close();
+        return false;
+    }
+    if(!readShapeIndex()) { close(); return false; }
+    return true;
+}
+
+bool BinaryParser::readShapes(const std::vector<uint_t>& positions){
+    uint_t nbshapes = __index.shapes.size();
+    bool result = true;
+    vector<uint_t>::const_iterator _it = positions.begin();
+    while(_it != positions.end()){
+        if(*_it >= nbshapes) { result = false; ++_it; continue; }
+        // Read the chunk up to the last shape requested in it.
+        uint_t chunk = __index.shapes[*_it].chunk;
+        vector<uint_t>::const_iterator _last = _it;
+        while(_last + 1 != positions.end() && *(_last + 1) < nbshapes && __index.shapes[*(_last + 1)].chunk == chunk)
+            ++_last;
+        if(!readChunk(chunk, *_last)) result = false;
+        _it = _last + 1;
+    }
+    ScenePtr scene(new Scene());
+    for(_it = positions.begin(); _it != positions.end(); ++_it)
+        if(*_it < nbshapes && __scene->isLoaded(*_it)) scene->add(__scene->getAt(*_it));
+    __scene = scene;
+    close();
+    return result;
+}
+
+bool BinaryParser::parseShapes(const std::string& filename, const std::vector<uint_t>& positions){
+    if(!openIndexed(filename)) return false;
+    PglErrorStream::Binder psb(__outputStream);
+    return readShapes(positions);
+}
+
+bool BinaryParser::parseShapesWithIds(const std::string& filename, const std::vector<uint_t>& ids){
+    if(!openIndexed(filename)) return false;
+    PglErrorStream::Binder psb(__outputStream);
+    return readShapes(__index.findShapes(ids));
+}
+
+bool BinaryParser::parseShapesInBox(const std::string& filename, const Vector3& lower, const Vector3& upper){
+    if(!openIndexed(filename)) return false;
+    PglErrorStream::Binder psb(__outputStream);
+    return readShapes(__index.findShapes(lower, upper));
+}
+
 /* ----------------------------------------------------------------------- */
 
 bool BinaryParser::readNext(){
   string _classname = __tokens->readCurrentToken(*stream);
 #ifdef GEOM_DEBUG
-  uint_t pos =  stream->getStream().tellg();
+  uint_t pos =  stream->tell();
   --pos;
   cerr << "Found " << _classname << " at pos : " << pos << std::endl;
   __outputStream << "Found " << _classname << " at pos : " << pos << std::endl;
@@ -805,8 +1188,8 @@ bool BinaryParser::readShape(){
                  __scene->add(sh);
             __roots++;
         }
-        if(isParserVerbose())
-          if(__roots % 50 == 0 || __roots == __scene->size())
+        if(isParserVerbose() && !__indexed && !__inmemory)
+          if(__scene->size() > 0 && (__roots % 50 == 0 || __roots == __scene->size()))
 			 printf("\x0d Already parsed : %i %% shapes.", 100*__roots / __scene->size());
         return true;
     }
@@ -47,6 +47,7 @@
 #include <vector>
 #include <iostream>
 #include "codec_config.h"
+#include "binaryindex.h"
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/math/util_math.h>
 #include <plantgl/math/util_vector.h>
@@ -58,7 +59,8 @@
 /* ----------------------------------------------------------------------- */
 
 TOOLS_BEGIN_NAMESPACE
-class leifstream;
+class lemmapstream;
+class RealArray;
 TOOLS_END_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
@@ -81,6 +83,10 @@ typedef RCPtr<SceneObject> SceneObjectPtr;
 class Scene;
 typedef RCPtr<Scene> ScenePtr;
 class TokenCode;
+class Point2Array;
+class Point3Array;
+class Point4Array;
+class Color4Array;
 
 /* ----------------------------------------------------------------------- */
 
@@ -113,9 +119,14 @@ public:
   /// Destructor
   virtual ~BinaryParser( );
 
-  /// The parsing function.
+  /** The parsing function.
+      The shapes of an indexed file are not read: the scene loads them on first access. */
   virtual bool parse(const std::string& filename);
 
+  /** Parses the \e size bytes of \e data printed by BinaryPrinter.
+      The arrays printed out of band are read from \e buffers. */
+  virtual bool parse(const char * data, size_t size, const BinaryBufferList * buffers = NULL);
+
   /// open the file.
   bool open(const std::string& filename);
   bool close();
@@ -127,6 +138,9 @@ public:
   /// return the scene.
   const ScenePtr getScene() const;
 
+  /// return the last object read, i.e. the object of a stream printed with BinaryPrinter::printObject.
+  const SceneObjectPtr& getResult() const { return __result; }
+
   /// Test if \e filename is a binary filename.
   static bool isAGeomBinaryFile(const std::string& filename);
 
@@ -142,6 +156,36 @@ public:
   /// read tokens of GEOM binary File.
   virtual bool readNext();
 
+  /// @name Indexed files
+  //@{
+
+  /// Returns whether the file is an indexed binary file.
+  bool isIndexed() const;
+
+  /// read the index at the end of an indexed file.
+  bool readShapeIndex();
+
+  /// return the index of an indexed file.
+  const BinaryIndex& getIndex() const { return __index; }
+
+  /** read the shapes of the chunk \e chunk, up to the shape at position \e last in the index.
+      Shapes are set in the scene at their position in the index. */
+  bool readChunk(uint_t chunk, uint_t last);
+
+  /// Parses only the shapes of \e filename at the positions \e positions (in increasing order) of the index.
+  bool parseShapes(const std::string& filename, const std::vector<uint_t>& positions);
+
+  /// Parses only the shapes of \e filename whose ids are in \e ids.
+  bool parseShapesWithIds(const std::string& filename, const std::vector<uint_t>& ids);
+
+  /// Parses only the shapes of \e filename whose bounding box intersects [\e lower, \e upper].
+  bool parseShapesInBox(const std::string& filename, const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper);
+
+  /// Opens \e filename and reads its header and its index.
+  bool openIndexed(const std::string& filename);
+
+  //@}
+
 
 
   /// @name Shape
@@ -308,6 +352,9 @@ public:
   /// read an uint_t value from stream
   uint32_t readUint32();
 
+  /// read an uint64_t value from stream
+  uint64_t readUint64();
+
   /// read an int_t value from stream
   int32_t readInt32();
 
@@ -362,14 +409,31 @@ public:
   template<class T>
   T read();
 
+  /** @name Bulk array reading
+      Decode at once the \e array.size() elements of \e array from the file.
+      Return false if the type of array cannot be read in bulk. */
+  //@{
+  bool readArrayData(TOOLS(RealArray)& array);
+  bool readArrayData(Point2Array& array);
+  bool readArrayData(Point3Array& array);
+  bool readArrayData(Point4Array& array);
+  bool readArrayData(Color4Array& array);
+  bool readArrayData(Index3Array& array);
+  bool readArrayData(Index4Array& array);
+
+  template <class Array>
+  bool readArrayData(Array& array) { return false; }
+  //@}
+
 
   template <class Array>
   RCPtr<Array> readArray() {
       uint32_t _sizei = readUint32();
       RCPtr<Array> result(new Array(_sizei));
-      uint32_t pid = 0;
-      for(typename Array::iterator it = result->begin(); it != result->end(); ++it, ++pid){
-          *it = read<typename Array::element_type>();
+      if (!readArrayData(*result)) {
+          for(typename Array::iterator it = result->begin(); it != result->end(); ++it){
+              *it = read<typename Array::element_type>();
+          }
       }
       return result;
   }
@@ -412,7 +476,7 @@ public:
   std::ostream& __outputStream;
 
   /// Input binary stream.
-  TOOLS(leifstream) * stream;
+  TOOLS(lemmapstream) * stream;
 
   /// The tokens codes.
   TokenCode * __tokens;
@@ -445,6 +509,34 @@ public:
 
   bool __double_precision;
 
+  /// The index of an indexed file.
+  BinaryIndex __index;
+
+  /// Whether a chunk of an indexed file is being parsed.
+  bool __indexed;
+
+  /// Skip the padding before the data of an array in a chunk of an indexed file.
+  void alignArrayData();
+
+  /** Set \e data to the \e size bytes of an array in its out of band buffer if any, or to NULL if the buffer is not valid.
+      Return false if the array is in the stream. */
+  bool readBuffer(const char *& data, size_t size);
+
+  /// Copy the \e size bytes of an array from its out of band buffer if any. Return false if the array is in the stream.
+  bool readBuffer(void * data, size_t size);
+
+  /// The out of band buffers of the stream, NULL if all the arrays are in the stream.
+  const BinaryBufferList * __buffers;
+
+  /// Whether the data is parsed from memory. The progress of the parsing is then not reported.
+  bool __inmemory;
+
+  /// The absolute directory of the opened file, from which the relative filenames it contains are resolved.
+  std::string __directory;
+
+  /// Reads the shapes at \e positions of the index of the opened file and closes it.
+  bool readShapes(const std::vector<uint_t>& positions);
+
 };
 
 template<>
@@ -329,6 +329,72 @@ void parser_build_object(RCPtr<GeomType> *& shape, std::string * name, GeomBuild
     else result = NULL; \
   }
 
+/*  ---------------------------------------------------------------------- */
+
+/* The arrays parsed in bulk by GeomArrayScanner are given by the lexer as
+   pointers to array pointers. */
+
+#define GEOM_PARSER_ADD_MATRIX_ARRAY(matrix,row,result) { \
+    if ((matrix) && !(matrix->empty())) { \
+      matrix->pushRow((*row)->begin(),(*row)->end()); \
+      result = matrix; \
+    } \
+    else { \
+      if (matrix) delete matrix; \
+      result = NULL; \
+    } \
+    delete row; \
+  }
+
+#define GEOM_PARSER_INIT_MATRIX_ARRAY(type,first,result) { \
+    result = new type((*first)->begin(),(*first)->end(),(*first)->size()); \
+    delete first; \
+  }
+
+/// Converts vectors parsed in bulk into colors. Returns NULL if a component is not an integer in [0,255].
+static Color4ArrayPtr * toColor4Array(Point4ArrayPtr * points)
+{
+  Color4ArrayPtr result(new Color4Array((*points)->size()));
+  for (uint_t i = 0; i < (*points)->size() && result; ++i) {
+    const Vector4& v = (*points)->getAt(i);
+    for (uint_t j = 0; j < 4; ++j)
+      if (v[j] < 0 || v[j] > 255 || v[j] != floor(v[j])) { result = Color4ArrayPtr(); break; }
+    if (result) result->setAt(i,Color4(uchar_t(v[0]),uchar_t(v[1]),uchar_t(v[2]),uchar_t(v[3])));
+  }
+  delete points;
+  return result ? new Color4ArrayPtr(result) : NULL;
+}
+
+/// Converts indices parsed in bulk into indices of size N. Returns NULL if an index has another size.
+template<class IndexNArray, class IndexN, uint_t N>
+static RCPtr<IndexNArray> * toIndexNArray(IndexArrayPtr * indices)
+{
+  RCPtr<IndexNArray> result(new IndexNArray((*indices)->size()));
+  for (uint_t i = 0; i < (*indices)->size(); ++i) {
+    const Index& index = (*indices)->getAt(i);
+    if (index.size() != N) { result = RCPtr<IndexNArray>(); break; }
+    IndexN value;
+    for (uint_t j = 0; j < N; ++j) value.getAt(j) = index[j];
+    result->setAt(i,value);
+  }
+  delete indices;
+  return result ? new RCPtr<IndexNArray>(result) : NULL;
+}
+
+/// Converts rows of integers parsed in bulk into a matrix of reals. Returns NULL if the rows have different sizes.
+static RealArray2Ptr * toRealMatrix(IndexArrayPtr * rows)
+{
+  uint_t nbcols = (*rows)->empty() ? 0 : (*rows)->getAt(0).size();
+  RealArray2Ptr result(new RealArray2((*rows)->size(),nbcols));
+  for (uint_t i = 0; i < (*rows)->size(); ++i) {
+    const Index& row = (*rows)->getAt(i);
+    if (row.size() != nbcols) { result = RealArray2Ptr(); break; }
+    for (uint_t j = 0; j < nbcols; ++j) result->setAt(i,j,real_t(row[j]));
+  }
+  delete rows;
+  return result ? new RealArray2Ptr(result) : NULL;
+}
+
 #define GEOM_PARSER_BUILD_TRANSFO(_type, shape, builder) \
   GEOM_ASSERT(builder); \
   _type##Ptr _shape(builder->build()); \
@@ -491,6 +557,12 @@ void parser_build_object(RCPtr<GeomType> *& shape, std::string * name, GeomBuild
 %token <string_t>      TokName
 %token <string_t>      TokFile
 
+/* large numeric arrays parsed in bulk before the lexer (see GeomArrayScanner) */
+%token <vector2_a>     TokPoint2Array
+%token <vector3_a>     TokPoint3Array
+%token <vector4_a>     TokPoint4Array
+%token <index_a>       TokIndexArray
+
 %token TokShape
 %token TokInline
 
@@ -2659,6 +2731,9 @@ Index:
 Color4Array:
    '[' Color4List ']' {
      GEOM_PARSER_CREATE_ARRAY(Color4Array,$2,$$);
+   }
+ | TokPoint4Array {
+     $$ = toColor4Array($1);
    };
 
 Color4List:
@@ -2672,6 +2747,9 @@ Color4List:
 IndexArray:
    '[' IndexList ']' {
      GEOM_PARSER_CREATE_ARRAY(IndexArray,$2,$$);
+   }
+ | TokIndexArray {
+     $$ = $1;
    };
 
 IndexList:
@@ -2701,6 +2779,9 @@ Index3:
 Index3Array:
    '[' Index3List ']' {
      GEOM_PARSER_CREATE_ARRAY(Index3Array,$2,$$);
+   }
+ | TokIndexArray {
+     $$ = toIndexNArray<Index3Array,Index3,3>($1);
    };
 
 Index3List:
@@ -2732,6 +2813,9 @@ Index4:
 Index4Array:
    '[' Index4List ']' {
      GEOM_PARSER_CREATE_ARRAY(Index4Array,$2,$$);
+   }
+ | TokIndexArray {
+     $$ = toIndexNArray<Index4Array,Index4,4>($1);
    };
 
 Index4List:
@@ -2775,6 +2859,9 @@ Filename :
 Point2Array:
    '[' Vector2List ']' {
      GEOM_PARSER_CREATE_ARRAY(Point2Array,$2,$$);
+   }
+ | TokPoint2Array {
+     $$ = $1;
    };
 
 /*
@@ -2795,14 +2882,23 @@ Point2Matrix:
 Point3Array:
    '[' Vector3List ']' {
      GEOM_PARSER_CREATE_ARRAY(Point3Array,$2,$$);
+   }
+ | TokPoint3Array {
+     $$ = $1;
    };
 
 Point3ArrayList:
    Point3ArrayList ',' '[' Vector3List ']' {
      GEOM_PARSER_ADD_MATRIX($1,$4,$$);
    }
+   |  Point3ArrayList ',' TokPoint3Array {
+     GEOM_PARSER_ADD_MATRIX_ARRAY($1,$3,$$);
+   }
    |  '[' Vector3List ']' {
      GEOM_PARSER_INIT_MATRIX(Point3Matrix,$2,$$);
+   }
+   |  TokPoint3Array {
+     GEOM_PARSER_INIT_MATRIX_ARRAY(Point3Matrix,$1,$$);
    };
 
 Point3Matrix:
@@ -2813,14 +2909,23 @@ Point3Matrix:
 Point4Array:
    '[' Vector4List ']' {
      GEOM_PARSER_CREATE_ARRAY(Point4Array,$2,$$);
+   }
+ | TokPoint4Array {
+     $$ = $1;
    };
 
 Point4ArrayList:
    Point4ArrayList ','  '[' Vector4List ']' {
      GEOM_PARSER_ADD_MATRIX($1,$4,$$);
    }
+   | Point4ArrayList ',' TokPoint4Array {
+     GEOM_PARSER_ADD_MATRIX_ARRAY($1,$3,$$);
+   }
    | '[' Vector4List ']' {
      GEOM_PARSER_INIT_MATRIX(Point4Matrix,$2,$$);
+   }
+   | TokPoint4Array {
+     GEOM_PARSER_INIT_MATRIX_ARRAY(Point4Matrix,$1,$$);
    };
 
 Point4Matrix:
@@ -2881,6 +2986,9 @@ RealArrayList:
 RealMatrix:
    '[' RealArrayList ']' {
      GEOM_PARSER_CREATE_MATRIX(RealArray2,$2,$$);
+   }
+ | TokIndexArray {
+     $$ = toRealMatrix($1);
    };
 
 Integer :
@@ -0,0 +1,707 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include "tiledpointcloud.h"
+#include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
+#include <plantgl/tool/util_endian.h>
+#include <plantgl/tool/util_parallel.h>
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+PointCloud::PointCloud() { }
+
+PointCloud::PointCloud(uint_t channels, size_t size) :
+  points(new Point3Array(size))
+{
+  if (channels & ColorChannel) colors = Color4ArrayPtr(new Color4Array(size));
+  if (channels & NormalChannel) normals = Point3ArrayPtr(new Point3Array(size));
+  if (channels & IntensityChannel) intensities = RealArrayPtr(new RealArray(size));
+  if (channels & ClassificationChannel) classifications = Uint32Array1Ptr(new Uint32Array1(size));
+}
+
+uint_t PointCloud::channels() const
+{
+  uint_t result = 0;
+  if (colors) result |= ColorChannel;
+  if (normals) result |= NormalChannel;
+  if (intensities) result |= IntensityChannel;
+  if (classifications) result |= ClassificationChannel;
+  return result;
+}
+
+bool PointCloud::isValid() const
+{
+  if (!points) return false;
+  size_t nb = points->size();
+  return (!colors || colors->size() == nb) && (!normals || normals->size() == nb) &&
+         (!intensities || intensities->size() == nb) && (!classifications || classifications->size() == nb);
+}
+
+void PointCloud::append(const PointCloud& other, size_t i)
+{
+  points->push_back(other.points->getAt(i));
+  if (colors) colors->push_back(other.colors->getAt(i));
+  if (normals) normals->push_back(other.normals->getAt(i));
+  if (intensities) intensities->push_back(other.intensities->getAt(i));
+  if (classifications) classifications->push_back(other.classifications->getAt(i));
+}
+
+void PointCloud::append(const PointCloud& other)
+{
+  points->insert(points->end(), other.points->begin(), other.points->end());
+  if (colors) colors->insert(colors->end(), other.colors->begin(), other.colors->end());
+  if (normals) normals->insert(normals->end(), other.normals->begin(), other.normals->end());
+  if (intensities) intensities->insert(intensities->end(), other.intensities->begin(), other.intensities->end());
+  if (classifications) classifications->insert(classifications->end(), other.classifications->begin(), other.classifications->end());
+}
+
+/* ----------------------------------------------------------------------- */
+
+const std::string TiledPointCloud::TAG("!TPC");
+
+const uint_t TiledPointCloud::VERSION(1);
+
+TiledPointCloud::TiledPointCloud() :
+  channels(0), precision(TiledPointCloudWriter::DEFAULT_PRECISION) { }
+
+uint64_t TiledPointCloud::size() const
+{
+  uint64_t result = 0;
+  for (std::vector<Tile>::const_iterator it = tiles.begin(); it != tiles.end(); ++it)
+    result += it->nbpoints;
+  return result;
+}
+
+void TiledPointCloud::getBoundingBox( Vector3& lower, Vector3& upper ) const
+{
+  lower = Vector3(REAL_MAX,REAL_MAX,REAL_MAX);
+  upper = -lower;
+  for (std::vector<Tile>::const_iterator it = tiles.begin(); it != tiles.end(); ++it) {
+    lower = Min(lower, it->lower);
+    upper = Max(upper, it->upper);
+  }
+}
+
+std::vector<uint_t> TiledPointCloud::findTiles( const Vector3& lower, const Vector3& upper ) const
+{
+  std::vector<uint_t> result;
+  for (uint_t i = 0; i < tiles.size(); ++i) {
+    const Tile& t = tiles[i];
+    if (t.lower.x() <= upper.x() && t.upper.x() >= lower.x() &&
+        t.lower.y() <= upper.y() && t.upper.y() >= lower.y() &&
+        t.lower.z() <= upper.z() && t.upper.z() >= lower.z())
+      result.push_back(i);
+  }
+  return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+static inline void putVarint(std::string& data, uint64_t value)
+{
+  while (value >= 0x80) { data.push_back(char(value | 0x80)); value >>= 7; }
+  data.push_back(char(value));
+}
+
+static inline bool getVarint(const char *& data, const char * end, uint64_t& value)
+{
+  value = 0;
+  for (int shift = 0; data < end && shift < 64; shift += 7) {
+    uchar_t byte = uchar_t(*data++);
+    value |= uint64_t(byte & 0x7f) << shift;
+    if (!(byte & 0x80)) return true;
+  }
+  return false;
+}
+
+static inline uint64_t zigzag(int64_t value) { return (uint64_t(value) << 1) ^ uint64_t(value >> 63); }
+
+static inline int64_t unzigzag(uint64_t value) { return int64_t(value >> 1) ^ -int64_t(value & 1); }
+
+template<class T>
+static inline void putValue(std::string& data, T value)
+{
+  char bytes[sizeof(T)];
+#if PGL_BIG_ENDIAN
+  flipBytes((const char *)&value, bytes, sizeof(T));
+#else
+  memcpy(bytes, &value, sizeof(T));
+#endif
+  data.append(bytes, sizeof(T));
+}
+
+template<class T>
+static inline T getValue(const char * data)
+{
+  T value;
+#if PGL_BIG_ENDIAN
+  flipBytes(data, (char *)&value, sizeof(T));
+#else
+  memcpy(&value, data, sizeof(T));
+#endif
+  return value;
+}
+
+/// Interleaves the 21 lower bits of \e x, \e y and \e z.
+static inline uint64_t mortonCode(uint64_t x, uint64_t y, uint64_t z)
+{
+  uint64_t result = 0;
+  for (int b = 0; b < 21; ++b)
+    result |= (((x >> b) & 1) << (3 * b)) | (((y >> b) & 1) << (3 * b + 1)) | (((z >> b) & 1) << (3 * b + 2));
+  return result;
+}
+
+/// Encodes the points [\e first, \e last) of \e cloud in \e data and fills the description of \e tile.
+static bool encodeTile(const PointCloud& cloud, size_t first, size_t last, uint_t channels, double precision,
+                       BinaryIndex::Compression compression, std::string& data, TiledPointCloud::Tile& tile)
+{
+  size_t nb = last - first;
+  const Point3Array& points = *cloud.points;
+  Vector3 lower(REAL_MAX,REAL_MAX,REAL_MAX);
+  Vector3 upper = -lower;
+  for (size_t i = first; i < last; ++i) {
+    lower = Min(lower, points.getAt(i));
+    upper = Max(upper, points.getAt(i));
+  }
+  if (nb == 0) lower = upper = Vector3(0,0,0);
+
+  // Coordinates are quantized relative to the lower corner of the tile.
+  uint64_t maxq = 0;
+  for (int k = 0; k < 3; ++k) {
+    double span = floor((double(upper[k]) - double(lower[k])) / precision + 0.5);
+    if (!(span < 4294967295.0)) return false;
+    maxq = std::max(maxq, uint64_t(span));
+  }
+  std::vector<uint32_t> q(3 * nb);
+  for (size_t i = 0; i < nb; ++i) {
+    const Vector3& p = points.getAt(first + i);
+    for (int k = 0; k < 3; ++k)
+      q[3 * i + k] = uint32_t(floor((double(p[k]) - double(lower[k])) / precision + 0.5));
+  }
+
+  // Points are sorted in Morton order so that successive points are close.
+  int shift = 0;
+  while ((maxq >> shift) >= (uint64_t(1) << 21)) ++shift;
+  std::vector<std::pair<uint64_t, uint_t> > order(nb);
+  for (size_t i = 0; i < nb; ++i)
+    order[i] = std::pair<uint64_t, uint_t>(mortonCode(q[3 * i] >> shift, q[3 * i + 1] >> shift, q[3 * i + 2] >> shift), uint_t(i));
+  std::sort(order.begin(), order.end());
+
+  data.clear();
+  data.reserve(nb * 6);
+  uint32_t previous[3] = { 0, 0, 0 };
+  for (size_t j = 0; j < nb; ++j) {
+    const uint32_t * v = &q[3 * order[j].second];
+    for (int k = 0; k < 3; ++k) {
+      putVarint(data, zigzag(int64_t(v[k]) - int64_t(previous[k])));
+      previous[k] = v[k];
+    }
+  }
+  if (channels & PointCloud::ColorChannel) {
+    const Color4Array& colors = *cloud.colors;
+    for (int c = 0; c < 4; ++c)
+      for (size_t j = 0; j < nb; ++j)
+        data.push_back(char(colors.getAt(first + order[j].second).getAt(c)));
+  }
+  if (channels & PointCloud::NormalChannel) {
+    const Point3Array& normals = *cloud.normals;
+    for (int k = 0; k < 3; ++k)
+      for (size_t j = 0; j < nb; ++j) {
+        real_t n = std::max<real_t>(-1, std::min<real_t>(1, normals.getAt(first + order[j].second)[k]));
+        putValue<int16_t>(data, int16_t(floor(n * 32767 + 0.5)));
+      }
+  }
+  if (channels & PointCloud::IntensityChannel) {
+    const RealArray& intensities = *cloud.intensities;
+    for (size_t j = 0; j < nb; ++j)
+      putValue<float>(data, float(intensities.getAt(first + order[j].second)));
+  }
+  if (channels & PointCloud::ClassificationChannel) {
+    const Uint32Array1& classifications = *cloud.classifications;
+    for (size_t j = 0; j < nb; ++j)
+      putVarint(data, classifications.getAt(first + order[j].second));
+  }
+
+  tile.nbpoints = uint_t(nb);
+  tile.lower = lower;
+  tile.upper = lower;
+  for (int k = 0; k < 3; ++k)
+    tile.upper[k] = real_t(double(lower[k]) + floor((double(upper[k]) - double(lower[k])) / precision + 0.5) * precision);
+  tile.rawsize = data.size();
+  tile.compression = BinaryIndex::NoCompression;
+  std::string packed;
+  if (compression != BinaryIndex::NoCompression &&
+      BinaryIndex::compress(compression, data.data(), data.size(), packed) && packed.size() < data.size()) {
+    tile.compression = compression;
+    data.swap(packed);
+  }
+  tile.size = data.size();
+  return true;
+}
+
+/// Decodes the tile \e tile stored at \e data in \e result.
+static bool decodeTile(const char * data, const TiledPointCloud::Tile& tile, uint_t channels, double precision,
+                       PointCloud& result)
+{
+  std::vector<char> buffer;
+  const char * current = data;
+  if (tile.compression != BinaryIndex::NoCompression) {
+    if (tile.rawsize == 0) return false;
+    buffer.resize(tile.rawsize);
+    if (!BinaryIndex::decompress(BinaryIndex::Compression(tile.compression), data, tile.size, &buffer[0], tile.rawsize))
+      return false;
+    current = &buffer[0];
+  }
+  else if (tile.size != tile.rawsize) return false;
+  const char * end = current + tile.rawsize;
+
+  size_t nb = tile.nbpoints;
+  result = PointCloud(channels, nb);
+  Point3Array::iterator points = result.points->begin();
+  int64_t q[3] = { 0, 0, 0 };
+  for (size_t i = 0; i < nb; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      uint64_t delta;
+      if (!getVarint(current, end, delta)) return false;
+      q[k] += unzigzag(delta);
+      points[i][k] = real_t(double(tile.lower[k]) + q[k] * precision);
+    }
+  }
+  if (channels & PointCloud::ColorChannel) {
+    if (size_t(end - current) < 4 * nb) return false;
+    Color4Array::iterator colors = result.colors->begin();
+    for (int c = 0; c < 4; ++c)
+      for (size_t i = 0; i < nb; ++i)
+        colors[i].getAt(c) = uchar_t(*current++);
+  }
+  if (channels & PointCloud::NormalChannel) {
+    if (size_t(end - current) < 6 * nb) return false;
+    Point3Array::iterator normals = result.normals->begin();
+    for (int k = 0; k < 3; ++k)
+      for (size_t i = 0; i < nb; ++i, current += 2)
+        normals[i][k] = real_t(getValue<int16_t>(current)) / 32767;
+  }
+  if (channels & PointCloud::IntensityChannel) {
+    if (size_t(end - current) < 4 * nb) return false;
+    RealArray::iterator intensities = result.intensities->begin();
+    for (size_t i = 0; i < nb; ++i, current += 4)
+      intensities[i] = real_t(getValue<float>(current));
+  }
+  if (channels & PointCloud::ClassificationChannel) {
+    Uint32Array1::iterator classifications = result.classifications->begin();
+    for (size_t i = 0; i < nb; ++i) {
+      uint64_t value;
+      if (!getVarint(current, end, value)) return false;
+      classifications[i] = uint32_t(value);
+    }
+  }
+  return current == end;
+}
+
+/* ----------------------------------------------------------------------- */
+
+const double TiledPointCloudWriter::DEFAULT_PRECISION(0.001);
+
+const uint_t TiledPointCloudWriter::DEFAULT_MAX_TILE_POINTS(1 << 18);
+
+const size_t TiledPointCloudWriter::DEFAULT_MAX_PENDING_POINTS(1 << 23);
+
+/// Packs the coordinates of the grid cell in 21 bits each. Far away cells may share a key.
+static inline uint64_t cellKey(const Vector3& p, real_t tileSize)
+{
+  uint64_t key = 0;
+  for (int k = 0; k < 3; ++k)
+    key = (key << 21) | (uint64_t(int64_t(floor(p[k] / tileSize)) + (1 << 20)) & 0x1fffff);
+  return key;
+}
+
+TiledPointCloudWriter::TiledPointCloudWriter( const std::string& fname, uint_t channels,
+                                              real_t tileSize, double precision,
+                                              BinaryIndex::Compression compression ) :
+  __stream(new leofstream(fname)),
+  __compression(compression),
+  __tileSize(tileSize),
+  __maxTilePoints(DEFAULT_MAX_TILE_POINTS),
+  __maxPendingPoints(DEFAULT_MAX_PENDING_POINTS),
+  __pendingPoints(0),
+  __valid(true)
+{
+  __index.channels = channels;
+  __index.precision = precision;
+  if (!BinaryIndex::isSupported(__compression)) {
+    if (BinaryIndex::isSupported(BinaryIndex::ZstdCompression)) __compression = BinaryIndex::ZstdCompression;
+    else if (BinaryIndex::isSupported(BinaryIndex::LZ4Compression)) __compression = BinaryIndex::LZ4Compression;
+    else __compression = BinaryIndex::NoCompression;
+  }
+  if (!*__stream || !(tileSize > 0) || !(precision > 0)) { __valid = false; return; }
+  *__stream << TiledPointCloud::TAG;
+  *__stream << TiledPointCloud::VERSION << channels << precision;
+}
+
+TiledPointCloudWriter::~TiledPointCloudWriter()
+{
+  close();
+}
+
+bool TiledPointCloudWriter::isValid() const
+{
+  return __valid && __stream && *__stream;
+}
+
+bool TiledPointCloudWriter::add( const PointCloud& cloud )
+{
+  if (!isValid()) return false;
+  if (!cloud.isValid() || (cloud.channels() & __index.channels) != __index.channels) return false;
+  const Point3Array& points = *cloud.points;
+  for (size_t i = 0; i < points.size(); ++i) {
+    PointCloud& cell = __cells[cellKey(points.getAt(i), __tileSize)];
+    if (!cell.points) cell = PointCloud(__index.channels);
+    cell.append(cloud, i);
+    if (++__pendingPoints >= __maxPendingPoints && !flush(__maxPendingPoints / 2)) return false;
+  }
+  return flush(__maxPendingPoints);
+}
+
+bool TiledPointCloudWriter::addTile( const PointCloud& cloud )
+{
+  if (!isValid()) return false;
+  if (!cloud.isValid() || (cloud.channels() & __index.channels) != __index.channels) return false;
+  std::vector<std::string> data(1);
+  std::vector<TiledPointCloud::Tile> tiles(1);
+  if (!encodeTile(cloud, 0, cloud.size(), __index.channels, __index.precision, __compression, data[0], tiles[0]))
+    return (__valid = false);
+  return writeTiles(data, tiles);
+}
+
+/// Encodes in parallel the ranges of points of the pending cells.
+struct TileEncoder {
+  struct Range { const PointCloud * cloud; size_t first; size_t last; };
+
+  TileEncoder(uint_t _channels, double _precision, BinaryIndex::Compression _compression) :
+    channels(_channels), precision(_precision), compression(_compression) { }
+
+  void operator()(size_t first, size_t last) {
+    for (size_t r = first; r < last; ++r)
+      errors[r] = !encodeTile(*ranges[r].cloud, ranges[r].first, ranges[r].last, channels, precision, compression, data[r], tiles[r]);
+  }
+
+  uint_t channels;
+  double precision;
+  BinaryIndex::Compression compression;
+  std::vector<Range> ranges;
+  std::vector<std::string> data;
+  std::vector<TiledPointCloud::Tile> tiles;
+  std::vector<char> errors;
+};
+
+bool TiledPointCloudWriter::flush( size_t keep )
+{
+  // The full cells are written, then the largest ones until at most keep points are pending.
+  std::vector<std::pair<size_t, uint64_t> > cells;
+  std::vector<uint64_t> written;
+  for (std::map<uint64_t, PointCloud>::const_iterator it = __cells.begin(); it != __cells.end(); ++it) {
+    if (it->second.size() >= __maxTilePoints) written.push_back(it->first);
+    else cells.push_back(std::pair<size_t, uint64_t>(it->second.size(), it->first));
+  }
+  size_t pending = __pendingPoints;
+  for (std::vector<uint64_t>::const_iterator it = written.begin(); it != written.end(); ++it)
+    pending -= __cells[*it].size();
+  std::sort(cells.begin(), cells.end());
+  for (std::vector<std::pair<size_t, uint64_t> >::reverse_iterator it = cells.rbegin(); it != cells.rend() && pending > keep; ++it) {
+    written.push_back(it->second);
+    pending -= it->first;
+  }
+  std::sort(written.begin(), written.end());
+
+  TileEncoder encoder(__index.channels, __index.precision, __compression);
+  for (std::vector<uint64_t>::const_iterator it = written.begin(); it != written.end(); ++it) {
+    const PointCloud& cell = __cells[*it];
+    size_t nb = cell.size();
+    for (size_t first = 0; first < nb; first += __maxTilePoints) {
+      TileEncoder::Range range = { &cell, first, std::min(nb, first + __maxTilePoints) };
+      encoder.ranges.push_back(range);
+    }
+  }
+  __pendingPoints = pending;
+  if (encoder.ranges.empty()) return true;
+  encoder.data.resize(encoder.ranges.size());
+  encoder.tiles.resize(encoder.ranges.size());
+  encoder.errors.resize(encoder.ranges.size(), 0);
+  pgl_parallel_for(0, encoder.ranges.size(), encoder, 1);
+  for (std::vector<uint64_t>::const_iterator it = written.begin(); it != written.end(); ++it)
+    __cells.erase(*it);
+  if (std::find(encoder.errors.begin(), encoder.errors.end(), 1) != encoder.errors.end())
+    return (__valid = false);
+  return writeTiles(encoder.data, encoder.tiles);
+}
+
+static void writePadding(leofstream& stream, size_t alignment)
+{
+  size_t pos = (size_t)stream.getStream().tellp();
+  size_t padding = (alignment - pos % alignment) % alignment;
+  if (padding > 0) {
+    std::vector<char> zeros(padding, 0);
+    stream.write(&zeros[0], padding);
+  }
+}
+
+static inline void writeUint64(leofstream& stream, uint64_t value)
+{
+  stream << uint_t(value & 0xffffffff) << uint_t(value >> 32);
+}
+
+bool TiledPointCloudWriter::writeTiles( const std::vector<std::string>& data, const std::vector<TiledPointCloud::Tile>& tiles )
+{
+  for (size_t i = 0; i < data.size(); ++i) {
+    writePadding(*__stream, BinaryIndex::ALIGNMENT);
+    TiledPointCloud::Tile tile = tiles[i];
+    tile.offset = (uint64_t)__stream->getStream().tellp();
+    __stream->write(data[i].data(), data[i].size());
+    __index.tiles.push_back(tile);
+  }
+  if (!*__stream) __valid = false;
+  return __valid;
+}
+
+bool TiledPointCloudWriter::close()
+{
+  if (!__stream) return __valid;
+  if (isValid()) flush(0);
+  if (isValid()) {
+    writePadding(*__stream, BinaryIndex::ALIGNMENT);
+    uint64_t indexPos = (uint64_t)__stream->getStream().tellp();
+    *__stream << uint_t(__index.tiles.size());
+    for (std::vector<TiledPointCloud::Tile>::const_iterator it = __index.tiles.begin(); it != __index.tiles.end(); ++it) {
+      writeUint64(*__stream, it->offset);
+      writeUint64(*__stream, it->size);
+      writeUint64(*__stream, it->rawsize);
+      *__stream << it->compression << it->nbpoints;
+      for (int k = 0; k < 3; ++k) *__stream << double(it->lower[k]);
+      for (int k = 0; k < 3; ++k) *__stream << double(it->upper[k]);
+    }
+    writeUint64(*__stream, indexPos);
+    *__stream << TiledPointCloud::TAG;
+    if (!*__stream) __valid = false;
+  }
+  delete __stream;
+  __stream = NULL;
+  __cells.clear();
+  __pendingPoints = 0;
+  return __valid;
+}
+
+bool TiledPointCloudWriter::write( const std::string& fname, const PointCloud& cloud,
+                                   real_t tileSize, double precision,
+                                   BinaryIndex::Compression compression )
+{
+  if (!cloud.isValid()) return false;
+  size_t nb = cloud.size();
+  Vector3 lower(0,0,0), upper(0,0,0);
+  if (nb > 0) {
+    lower = upper = cloud.points->getAt(0);
+    for (Point3Array::const_iterator it = cloud.points->begin(); it != cloud.points->end(); ++it) {
+      lower = Min(lower, *it);
+      upper = Max(upper, *it);
+    }
+  }
+  Vector3 extent = upper - lower;
+  real_t maxextent = std::max(extent.x(), std::max(extent.y(), extent.z()));
+  if (!(precision > 0)) precision = maxextent > 0 ? maxextent * 1e-6 : DEFAULT_PRECISION;
+  if (!(tileSize > 0)) {
+    // Tiles of about DEFAULT_MAX_TILE_POINTS / 4 points for a cloud spread on the horizontal plane.
+    double ratio = double(DEFAULT_MAX_TILE_POINTS / 4) / std::max<size_t>(1, nb);
+    double area = double(extent.x()) * extent.y();
+    if (area > 0) tileSize = real_t(sqrt(area * ratio));
+    else tileSize = real_t(maxextent * ratio);
+    // Keeps the cell coordinates on 21 bits.
+    tileSize = std::max<real_t>(tileSize, maxextent / (1 << 19));
+    if (!(tileSize > 0)) tileSize = 1;
+  }
+  TiledPointCloudWriter writer(fname, cloud.channels(), tileSize, precision, compression);
+  writer.setMaxPendingPoints(std::max<size_t>(nb, 1));
+  bool result = writer.add(cloud);
+  return writer.close() && result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+TiledPointCloudReader::TiledPointCloudReader( const std::string& fname ) :
+  __file(new MemoryMappedFile(fname)),
+  __valid(false)
+{
+  if (!__file->isValid()) return;
+  const size_t tagsize = TiledPointCloud::TAG.size();
+  const size_t headersize = tagsize + 2 * sizeof(uint_t) + sizeof(double);
+  if (__file->size() < headersize + tagsize + 8) return;
+  const char * data = __file->data();
+  size_t size = __file->size();
+  if (memcmp(data, TiledPointCloud::TAG.data(), tagsize) != 0 ||
+      memcmp(data + size - tagsize, TiledPointCloud::TAG.data(), tagsize) != 0) return;
+
+  lemmapstream stream(data, size);
+  stream.seek(tagsize);
+  uint_t version = 0;
+  stream >> version >> __index.channels >> __index.precision;
+  if (version > TiledPointCloud::VERSION || !(__index.precision > 0)) return;
+
+  uint_t low = 0, high = 0;
+  stream.seek(size - tagsize - 8);
+  stream >> low >> high;
+  if (!stream.seek(uint64_t(low) | (uint64_t(high) << 32))) return;
+
+  uint_t nbtiles = 0;
+  stream >> nbtiles;
+  if (!stream || nbtiles > stream.remaining() / 77) return;
+  __index.tiles.resize(nbtiles);
+  for (std::vector<TiledPointCloud::Tile>::iterator it = __index.tiles.begin(); it != __index.tiles.end(); ++it) {
+    stream >> low >> high; it->offset = uint64_t(low) | (uint64_t(high) << 32);
+    stream >> low >> high; it->size = uint64_t(low) | (uint64_t(high) << 32);
+    stream >> low >> high; it->rawsize = uint64_t(low) | (uint64_t(high) << 32);
+    stream >> it->compression >> it->nbpoints;
+    double value;
+    for (int k = 0; k < 3; ++k) { stream >> value; it->lower[k] = real_t(value); }
+    for (int k = 0; k < 3; ++k) { stream >> value; it->upper[k] = real_t(value); }
+    if (it->offset > size || it->size > size - it->offset) return;
+  }
+  __valid = bool(stream);
+}
+
+TiledPointCloudReader::~TiledPointCloudReader()
+{
+  delete __file;
+}
+
+/// Decodes in parallel tiles of a file, keeping only the points of a box if any.
+struct TileDecoder {
+  TileDecoder(const char * _data, const TiledPointCloud& _index, const std::vector<uint_t>& _tiles,
+              const Vector3 * _lower = NULL, const Vector3 * _upper = NULL) :
+    data(_data), index(_index), tiles(_tiles), lower(_lower), upper(_upper),
+    parts(_tiles.size()), errors(_tiles.size(), 0) { }
+
+  bool inside(const Vector3& p) const {
+    return p.x() >= lower->x() && p.y() >= lower->y() && p.z() >= lower->z() &&
+           p.x() <= upper->x() && p.y() <= upper->y() && p.z() <= upper->z();
+  }
+
+  void operator()(size_t first, size_t last) {
+    for (size_t t = first; t < last; ++t) {
+      const TiledPointCloud::Tile& tile = index.tiles[tiles[t]];
+      if (!decodeTile(data + tile.offset, tile, index.channels, index.precision, parts[t])) { errors[t] = 1; continue; }
+      if (!lower || (inside(tile.lower) && inside(tile.upper))) continue;
+      PointCloud selection(index.channels);
+      const Point3Array& points = *parts[t].points;
+      for (size_t i = 0; i < points.size(); ++i)
+        if (inside(points.getAt(i))) selection.append(parts[t], i);
+      parts[t] = selection;
+    }
+  }
+
+  const char * data;
+  const TiledPointCloud& index;
+  const std::vector<uint_t>& tiles;
+  const Vector3 * lower;
+  const Vector3 * upper;
+  std::vector<PointCloud> parts;
+  std::vector<char> errors;
+};
+
+static bool mergeTiles(TileDecoder& decoder, uint_t channels, PointCloud& result)
+{
+  pgl_parallel_for(0, decoder.tiles.size(), decoder, 1);
+  if (std::find(decoder.errors.begin(), decoder.errors.end(), 1) != decoder.errors.end()) return false;
+  size_t nb = 0;
+  for (std::vector<PointCloud>::const_iterator it = decoder.parts.begin(); it != decoder.parts.end(); ++it)
+    nb += it->size();
+  result = PointCloud(channels);
+  result.points->reserve(nb);
+  if (result.colors) result.colors->reserve(nb);
+  if (result.normals) result.normals->reserve(nb);
+  if (result.intensities) result.intensities->reserve(nb);
+  if (result.classifications) result.classifications->reserve(nb);
+  for (std::vector<PointCloud>::iterator it = decoder.parts.begin(); it != decoder.parts.end(); ++it) {
+    result.append(*it);
+    *it = PointCloud();
+  }
+  return true;
+}
+
+bool TiledPointCloudReader::readTile( uint_t tile, PointCloud& result ) const
+{
+  if (!__valid || tile >= __index.tiles.size()) return false;
+  const TiledPointCloud::Tile& t = __index.tiles[tile];
+  return decodeTile(__file->data() + t.offset, t, __index.channels, __index.precision, result);
+}
+
+bool TiledPointCloudReader::readTiles( const std::vector<uint_t>& tiles, PointCloud& result ) const
+{
+  if (!__valid) return false;
+  for (std::vector<uint_t>::const_iterator it = tiles.begin(); it != tiles.end(); ++it)
+    if (*it >= __index.tiles.size()) return false;
+  TileDecoder decoder(__file->data(), __index, tiles);
+  return mergeTiles(decoder, __index.channels, result);
+}
+
+bool TiledPointCloudReader::read( PointCloud& result ) const
+{
+  std::vector<uint_t> tiles(__index.tiles.size());
+  for (uint_t i = 0; i < tiles.size(); ++i) tiles[i] = i;
+  return readTiles(tiles, result);
+}
+
+bool TiledPointCloudReader::read( const Vector3& lower, const Vector3& upper, PointCloud& result ) const
+{
+  if (!__valid) return false;
+  std::vector<uint_t> tiles = __index.findTiles(lower, upper);
+  TileDecoder decoder(__file->data(), __index, tiles, &lower, &upper);
+  return mergeTiles(decoder, __index.channels, result);
+}
+
+bool TiledPointCloudReader::read( const Vector3& lower, const Vector3& upper,
+                                  Point3ArrayPtr& points, Color4ArrayPtr& colors ) const
+{
+  PointCloud result;
+  if (!read(lower, upper, result)) return false;
+  points = result.points;
+  colors = result.colors;
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,305 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file tiledpointcloud.h
+    \brief Reader and writer of the tiled point cloud format (TPC).
+*/
+
+#ifndef __tiledpointcloud_h__
+#define __tiledpointcloud_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "binaryindex.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/colorarray.h>
+#include <plantgl/tool/util_array.h>
+#include <map>
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_BEGIN_NAMESPACE
+class MemoryMappedFile;
+class leofstream;
+TOOLS_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \struct PointCloud
+   \brief The points of a cloud with their optional attributes.
+   An attribute array is either null or of the size of the points.
+*/
+struct CODEC_API PointCloud {
+
+  /// The optional attributes of the points.
+  enum Channel { ColorChannel = 1, NormalChannel = 2, IntensityChannel = 4, ClassificationChannel = 8 };
+
+  Point3ArrayPtr points;
+  Color4ArrayPtr colors;
+  Point3ArrayPtr normals;
+  TOOLS(RealArrayPtr) intensities;
+  TOOLS(Uint32Array1Ptr) classifications;
+
+  /// Constructs an empty cloud without attributes.
+  PointCloud();
+
+  /// Constructs a cloud of \e size points with the attributes of \e channels.
+  PointCloud(uint_t channels, size_t size = 0);
+
+  /// Returns the number of points.
+  size_t size() const { return points ? points->size() : 0; }
+
+  /// Returns the attributes of the cloud as a combination of Channel.
+  uint_t channels() const;
+
+  /// Returns whether the points are set and the attribute arrays have their size.
+  bool isValid() const;
+
+  /// Appends the point \e i of \e other with the attributes of \e self.
+  void append(const PointCloud& other, size_t i);
+
+  /// Appends the points of \e other with the attributes of \e self.
+  void append(const PointCloud& other);
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class TiledPointCloud
+   \brief The index of a tiled point cloud file.
+
+   The points of a TPC file are stored in tiles, each tile being independently
+   readable and possibly compressed. The coordinates of a tile are quantized
+   with the precision of the file relative to the lower corner of the tile,
+   sorted in Morton order and delta encoded as variable length integers.
+   Attributes are stored channel by channel after the coordinates. The index
+   stored at the end of the file gives for each tile its position, its number
+   of points and its bounding box.
+*/
+class CODEC_API TiledPointCloud {
+public:
+
+  /// Tag starting and ending a TPC file.
+  static const std::string TAG;
+
+  /// The version of the format.
+  static const uint_t VERSION;
+
+  /// A tile of points.
+  struct Tile {
+    /// Position of the tile in the file.
+    uint64_t offset;
+    /// Size of the tile in the file.
+    uint64_t size;
+    /// Size of the uncompressed tile.
+    uint64_t rawsize;
+    /// Compression of the tile.
+    uchar_t compression;
+    /// Number of points of the tile.
+    uint_t nbpoints;
+    /// Bounding box of the points of the tile.
+    TOOLS(Vector3) lower;
+    TOOLS(Vector3) upper;
+  };
+
+  TiledPointCloud();
+
+  /// The attributes of the points as a combination of PointCloud::Channel.
+  uint_t channels;
+
+  /// The quantization step of the coordinates.
+  double precision;
+
+  std::vector<Tile> tiles;
+
+  /// Returns the number of points of the file.
+  uint64_t size() const;
+
+  /// Returns the bounding box of the file. Lower is greater than upper if the file is empty.
+  void getBoundingBox( TOOLS(Vector3)& lower, TOOLS(Vector3)& upper ) const;
+
+  /// Returns the positions of the tiles whose bounding box intersects [\e lower, \e upper].
+  std::vector<uint_t> findTiles( const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper ) const;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class TiledPointCloudWriter
+   \brief Writes a TPC file.
+
+   Points added to the writer are binned in the cells of a regular grid of
+   size \e tileSize anchored at the origin. A cell is written as a tile when it
+   holds \e maxTilePoints points, and the largest cells are written when the
+   writer holds \e maxPendingPoints points, so that clouds larger than the
+   memory can be written by successive calls to add. A cell may thus give
+   several tiles. The pending tiles are encoded in parallel.
+*/
+class CODEC_API TiledPointCloudWriter {
+public:
+
+  /// The default quantization step of the coordinates.
+  static const double DEFAULT_PRECISION;
+
+  /// The default maximum number of points of a tile.
+  static const uint_t DEFAULT_MAX_TILE_POINTS;
+
+  /// The default maximum number of points held by the writer.
+  static const size_t DEFAULT_MAX_PENDING_POINTS;
+
+  /** Opens \e fname to write points with the attributes of \e channels.
+      Tiles are compressed with \e compression, or with the best available
+      compression if it is not supported by this build. */
+  TiledPointCloudWriter( const std::string& fname, uint_t channels,
+                         real_t tileSize, double precision = DEFAULT_PRECISION,
+                         BinaryIndex::Compression compression = BinaryIndex::ZstdCompression );
+
+  /// Destructor. Closes the file.
+  ~TiledPointCloudWriter();
+
+  /// Returns whether the file is open and all the writes succeeded.
+  bool isValid() const;
+
+  /// Adds the points of \e cloud, which must have the attributes of the writer.
+  bool add( const PointCloud& cloud );
+
+  /// Writes the points of \e cloud as a single tile, without binning.
+  bool addTile( const PointCloud& cloud );
+
+  /// Writes the pending tiles and the index, and closes the file.
+  bool close();
+
+  /// Returns the index of the tiles written so far.
+  const TiledPointCloud& index() const { return __index; }
+
+  void setMaxTilePoints( uint_t nb ) { __maxTilePoints = nb; }
+  uint_t getMaxTilePoints( ) const { return __maxTilePoints; }
+
+  void setMaxPendingPoints( size_t nb ) { __maxPendingPoints = nb; }
+  size_t getMaxPendingPoints( ) const { return __maxPendingPoints; }
+
+  /** Writes \e cloud in \e fname. A \e tileSize of 0 is chosen so that the tiles
+      hold about DEFAULT_MAX_TILE_POINTS / 4 points, and a \e precision of 0 is
+      a millionth of the extent of the cloud. */
+  static bool write( const std::string& fname, const PointCloud& cloud,
+                     real_t tileSize = 0, double precision = 0,
+                     BinaryIndex::Compression compression = BinaryIndex::ZstdCompression );
+
+protected:
+
+  TiledPointCloudWriter( const TiledPointCloudWriter& );
+  TiledPointCloudWriter& operator=( const TiledPointCloudWriter& );
+
+  /// Writes the full cells, then the largest cells until at most \e keep points are pending.
+  bool flush( size_t keep );
+
+  /// Writes the encoded tiles of \e data.
+  bool writeTiles( const std::vector<std::string>& data, const std::vector<TiledPointCloud::Tile>& tiles );
+
+  TOOLS(leofstream) * __stream;
+  TiledPointCloud __index;
+  BinaryIndex::Compression __compression;
+  real_t __tileSize;
+  uint_t __maxTilePoints;
+  size_t __maxPendingPoints;
+  size_t __pendingPoints;
+  std::map<uint64_t, PointCloud> __cells;
+  bool __valid;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class TiledPointCloudReader
+   \brief Reads a TPC file.
+   The file is memory mapped and only the tiles intersecting a requested region
+   are decoded, in parallel.
+*/
+class CODEC_API TiledPointCloudReader {
+public:
+
+  /// Opens \e fname and reads its index.
+  TiledPointCloudReader( const std::string& fname );
+
+  /// Destructor.
+  ~TiledPointCloudReader();
+
+  /// Returns whether the file and its index were read.
+  bool isValid() const { return __valid; }
+
+  /// Returns the index of the file.
+  const TiledPointCloud& index() const { return __index; }
+
+  /// Reads the tile \e tile in \e result.
+  bool readTile( uint_t tile, PointCloud& result ) const;
+
+  /// Reads the tiles \e tiles in \e result, in this order.
+  bool readTiles( const std::vector<uint_t>& tiles, PointCloud& result ) const;
+
+  /// Reads all the points in \e result.
+  bool read( PointCloud& result ) const;
+
+  /// Reads the points in the box [\e lower, \e upper] in \e result.
+  bool read( const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper, PointCloud& result ) const;
+
+  /// Reads the points in the box [\e lower, \e upper] and their colors if any.
+  bool read( const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper,
+             Point3ArrayPtr& points, Color4ArrayPtr& colors ) const;
+
+protected:
+
+  TiledPointCloudReader( const TiledPointCloudReader& );
+  TiledPointCloudReader& operator=( const TiledPointCloudReader& );
+
+  TOOLS(MemoryMappedFile) * __file;
+  TiledPointCloud __index;
+  bool __valid;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __tiledpointcloud_h__
+#endif
@@ -54,6 +54,7 @@
 #include <plantgl/math/util_matrixmath.h>
 #include "miniball.h"
 #include "eigenvector.h"
+#include "symmetriceigen.h"
 
 // #define WITHOUT_QHULL
 
@@ -198,21 +199,36 @@ bool Fit::areRadiusNeeded(string classname){
 
 /* ----------------------------------------------------------------------- */
 
+/// Eigen decomposition of the covariance (normalized by n-1) of points.
+static void inertia_eigen(const Point3ArrayPtr& points, Vector3& values, Matrix3& vectors)
+{
+  size_t nbp = points->size();
+  Vector3 center;
+  for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it) center += *it;
+  center /= real_t(nbp);
+  real_t cov[6] = {0,0,0,0,0,0};
+  for (Point3Array::const_iterator it = points->begin(); it != points->end(); ++it){
+	Vector3 p = *it - center;
+	cov[0] += p.x()*p.x(); cov[1] += p.x()*p.y(); cov[2] += p.x()*p.z();
+	cov[3] += p.y()*p.y(); cov[4] += p.y()*p.z(); cov[5] += p.z()*p.z();
+  }
+  for (int i = 0; i < 6; ++i) cov[i] /= real_t(nbp-1);
+  symmetric_eigen_decomposition(Matrix3(cov[0],cov[1],cov[2],cov[1],cov[3],cov[4],cov[2],cov[4],cov[5]),values,vectors);
+}
+
 /// compute inertia axis
 bool Fit::inertiaAxis(const Point3ArrayPtr& points,
 					  Vector3& u, Vector3& v, Vector3& w, Vector3& s)
 {
   if(points->size()>2){
-	float vpvec[3][3];
-	float vpint[3] = {0,0,0};
-	float vpang[3][3];
-	short vpok[3];
-	Laxi_ComputeInertia (points,vpvec,vpint,vpang,vpok);
-	if(vpok[2]!=0  && vpok[1]!=0 && vpok[0]!=0 && vpint[2]!=0 && vpint[1]!=0 &&  vpint[0]!=0 ){
-	    u = Vector3(vpvec[0][0]/vpint[0],vpvec[0][1]/vpint[0],vpvec[0][2]/vpint[0]);
-	    v = Vector3(vpvec[1][0]/vpint[1],vpvec[1][1]/vpint[1],vpvec[1][2]/vpint[1]);
-	    w = Vector3(vpvec[2][0]/vpint[2],vpvec[2][1]/vpint[2],vpvec[2][2]/vpint[2]);
-	    s = Vector3(vpint[0],vpint[1],vpint[2]);
+	Vector3 values; Matrix3 vectors;
+	inertia_eigen(points,values,vectors);
+	if(values.x() > 1.0e-5 && values.y() > 1.0e-5 && values.z() > 1.0e-5){
+	    // u is the axis of smallest inertia and (w,v,u) is direct.
+	    w = vectors.getColumn(2);
+	    v = vectors.getColumn(1);
+	    u = cross(w,v);
+	    s = Vector3(2*sqrt(values.x()),2*sqrt(values.y()),2*sqrt(values.z()));
 		return true;
 	}
 	else return false;
@@ -224,16 +240,13 @@ bool Fit::inertiaAxis(const Point2ArrayPtr& points,
 						    TOOLS(Vector2)& u, TOOLS(Vector2)& v, TOOLS(Vector2)& s)
 {
   if(points->size()>2){
-	float vpvec[3][3];
-	float vpint[3] = {0,0,0};
-	float vpang[3][3];
-	short vpok[3];
-	Point3ArrayPtr npoints = Point3ArrayPtr(new Point3Array(*points,0));
-	Laxi_ComputeInertia (npoints,vpvec,vpint,vpang,vpok);
-	if(vpok[2]!=0  && vpok[1]!=0 && vpint[2]!=0 && vpint[1]!=0  ){
-	    u = Vector2(vpvec[1][0]/vpint[1],vpvec[1][1]/vpint[1]);
-	    v = Vector2(vpvec[2][0]/vpint[2],vpvec[2][1]/vpint[2]);
-	    s = Vector2(vpint[1],vpint[2]);
+	Vector3 values; Matrix3 vectors;
+	inertia_eigen(Point3ArrayPtr(new Point3Array(*points,0)),values,vectors);
+	// the smallest eigen value is the null one of the z axis.
+	if(values.y() > 1.0e-5 && values.z() > 1.0e-5){
+	    u = Vector2(vectors(0,1),vectors(1,1));
+	    v = Vector2(vectors(0,2),vectors(1,2));
+	    s = Vector2(2*sqrt(values.y()),2*sqrt(values.z()));
 		return true;
 	}
 	else return false;
@@ -0,0 +1,359 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "symmetriceigen.h"
+#include <plantgl/tool/util_parallel.h>
+#include <cmath>
+
+/* ----------------------------------------------------------------------- */
+
+// The instruction set is selected at compile time.
+// Define PGL_WITHOUT_SIMD to force the scalar implementation.
+#ifndef PGL_WITHOUT_SIMD
+# if defined(__AVX__)
+#  define PGL_EIGEN_AVX
+#  include <immintrin.h>
+# elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define PGL_EIGEN_SSE2
+#  include <emmintrin.h>
+# endif
+#endif
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+void SymMatrix3Batch::resize( size_t size )
+{
+    xx.resize(size,0); xy.resize(size,0); xz.resize(size,0);
+    yy.resize(size,0); yz.resize(size,0); zz.resize(size,0);
+}
+
+void SymMatrix3Batch::set( size_t i, const Matrix3& m )
+{
+    xx[i] = m(0,0); xy[i] = m(0,1); xz[i] = m(0,2);
+    yy[i] = m(1,1); yz[i] = m(1,2); zz[i] = m(2,2);
+}
+
+Matrix3 SymMatrix3Batch::get( size_t i ) const
+{
+    return Matrix3(xx[i], xy[i], xz[i],
+                   xy[i], yy[i], yz[i],
+                   xz[i], yz[i], zz[i]);
+}
+
+void Eigen3Batch::resize( size_t size )
+{
+    for (int k = 0; k < 3; ++k){
+        values[k].resize(size,0);
+        for (int c = 0; c < 3; ++c) vectors[k][c].resize(size,0);
+    }
+}
+
+Vector3 Eigen3Batch::getValues( size_t i ) const
+{ return Vector3(values[0][i], values[1][i], values[2][i]); }
+
+Vector3 Eigen3Batch::getVector( size_t i, uchar_t k ) const
+{ return Vector3(vectors[k][0][i], vectors[k][1][i], vectors[k][2][i]); }
+
+/* ----------------------------------------------------------------------- */
+
+/*
+    Packs of real values. Masks are packs whose lanes are all bits set (true)
+    or null (false). The scalar pack is used for the tails of the batches and
+    when no SIMD instruction set is available.
+*/
+
+struct ScalarPack {
+    enum { width = 1 };
+    real_t v;
+
+    ScalarPack( ) { }
+    ScalarPack( real_t value ) : v(value) { }
+
+    static inline ScalarPack load( const real_t * p ) { return ScalarPack(*p); }
+    inline void store( real_t * p ) const { *p = v; }
+
+    friend inline ScalarPack operator+( ScalarPack a, ScalarPack b ) { return a.v + b.v; }
+    friend inline ScalarPack operator-( ScalarPack a, ScalarPack b ) { return a.v - b.v; }
+    friend inline ScalarPack operator*( ScalarPack a, ScalarPack b ) { return a.v * b.v; }
+    friend inline ScalarPack operator/( ScalarPack a, ScalarPack b ) { return a.v / b.v; }
+    friend inline ScalarPack operator-( ScalarPack a ) { return -a.v; }
+
+    friend inline ScalarPack pack_sqrt( ScalarPack a ) { return std::sqrt(a.v); }
+    friend inline ScalarPack pack_abs( ScalarPack a ) { return std::fabs(a.v); }
+    friend inline ScalarPack pack_max( ScalarPack a, ScalarPack b ) { return a.v < b.v ? b.v : a.v; }
+    friend inline ScalarPack pack_lt( ScalarPack a, ScalarPack b ) { return a.v < b.v ? 1 : 0; }
+    friend inline ScalarPack pack_le( ScalarPack a, ScalarPack b ) { return a.v <= b.v ? 1 : 0; }
+    friend inline ScalarPack pack_select( ScalarPack m, ScalarPack a, ScalarPack b ) { return m.v != 0 ? a : b; }
+    friend inline bool pack_all( ScalarPack m ) { return m.v != 0; }
+};
+
+/*
+    SIMD packs. SSE2 has no blend instruction, so selection is done with
+    and/andnot/or which is also used for AVX.
+*/
+#define PGL_DEFINE_SIMD_PACK(NAME, VTYPE, WIDTH, PFX, SFX, LT, LE, ALLMASK) \
+struct NAME { \
+    enum { width = WIDTH }; \
+    VTYPE v; \
+    NAME( ) { } \
+    NAME( VTYPE value ) : v(value) { } \
+    NAME( real_t value ) : v(PFX##_set1_##SFX(value)) { } \
+    static inline NAME load( const real_t * p ) { return PFX##_loadu_##SFX(p); } \
+    inline void store( real_t * p ) const { PFX##_storeu_##SFX(p, v); } \
+    friend inline NAME operator+( NAME a, NAME b ) { return PFX##_add_##SFX(a.v, b.v); } \
+    friend inline NAME operator-( NAME a, NAME b ) { return PFX##_sub_##SFX(a.v, b.v); } \
+    friend inline NAME operator*( NAME a, NAME b ) { return PFX##_mul_##SFX(a.v, b.v); } \
+    friend inline NAME operator/( NAME a, NAME b ) { return PFX##_div_##SFX(a.v, b.v); } \
+    friend inline NAME operator-( NAME a ) { return PFX##_xor_##SFX(a.v, PFX##_set1_##SFX(real_t(-0.0))); } \
+    friend inline NAME pack_sqrt( NAME a ) { return PFX##_sqrt_##SFX(a.v); } \
+    friend inline NAME pack_abs( NAME a ) { return PFX##_andnot_##SFX(PFX##_set1_##SFX(real_t(-0.0)), a.v); } \
+    friend inline NAME pack_max( NAME a, NAME b ) { return PFX##_max_##SFX(a.v, b.v); } \
+    friend inline NAME pack_lt( NAME a, NAME b ) { return LT(a.v, b.v); } \
+    friend inline NAME pack_le( NAME a, NAME b ) { return LE(a.v, b.v); } \
+    friend inline NAME pack_select( NAME m, NAME a, NAME b ) \
+    { return PFX##_or_##SFX(PFX##_and_##SFX(m.v, a.v), PFX##_andnot_##SFX(m.v, b.v)); } \
+    friend inline bool pack_all( NAME m ) { return PFX##_movemask_##SFX(m.v) == ALLMASK; } \
+};
+
+#if defined(PGL_EIGEN_AVX)
+
+#define PGL_AVX_LT(a,b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define PGL_AVX_LE(a,b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define PGL_AVX_LTS(a,b) _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define PGL_AVX_LES(a,b) _mm256_cmp_ps(a, b, _CMP_LE_OQ)
+
+#ifdef PGL_USE_DOUBLE
+PGL_DEFINE_SIMD_PACK(SimdPack, __m256d, 4, _mm256, pd, PGL_AVX_LT, PGL_AVX_LE, 0xF)
+#else
+PGL_DEFINE_SIMD_PACK(SimdPack, __m256, 8, _mm256, ps, PGL_AVX_LTS, PGL_AVX_LES, 0xFF)
+#endif
+
+static const char * InstructionSet = "AVX";
+
+#elif defined(PGL_EIGEN_SSE2)
+
+#ifdef PGL_USE_DOUBLE
+PGL_DEFINE_SIMD_PACK(SimdPack, __m128d, 2, _mm, pd, _mm_cmplt_pd, _mm_cmple_pd, 0x3)
+#else
+PGL_DEFINE_SIMD_PACK(SimdPack, __m128, 4, _mm, ps, _mm_cmplt_ps, _mm_cmple_ps, 0xF)
+#endif
+
+static const char * InstructionSet = "SSE2";
+
+#else
+
+typedef ScalarPack SimdPack;
+static const char * InstructionSet = "scalar";
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+// Maximal number of cyclic Jacobi sweeps. Convergence is quadratic and usually
+// reached after 4 or 5 sweeps.
+static const int MAX_SWEEPS = 12;
+
+/*
+    Eigen decomposition of a pack of symmetric matrices by the cyclic Jacobi
+    method (see Numerical Recipes, 11.1). The matrices are first scaled so that
+    their largest coefficient is 1. All lanes are rotated at each step; the
+    rotation of a lane whose coefficient (p,q) is already negligible is the
+    identity. The iterations stop when all the lanes have converged.
+*/
+template<class Pack, bool Vectors>
+struct JacobiSolver {
+
+    Pack a[3][3];
+    Pack v[3][3];
+    Pack small;
+
+    inline void rotate( int p, int q, int r )
+    {
+        Pack& apq = a[p][q];
+        Pack negligible = pack_le(pack_abs(apq), small);
+        Pack safeapq = pack_select(negligible, Pack(real_t(1)), apq);
+        Pack theta = (a[q][q] - a[p][p]) / (Pack(real_t(2)) * safeapq);
+        Pack t = Pack(real_t(1)) / (pack_abs(theta) + pack_sqrt(theta * theta + Pack(real_t(1))));
+        t = pack_select(pack_lt(theta, Pack(real_t(0))), -t, t);
+        t = pack_select(negligible, Pack(real_t(0)), t);
+        Pack c = Pack(real_t(1)) / pack_sqrt(t * t + Pack(real_t(1)));
+        Pack s = t * c;
+
+        Pack tapq = t * apq;
+        a[p][p] = a[p][p] - tapq;
+        a[q][q] = a[q][q] + tapq;
+        a[p][q] = a[q][p] = Pack(real_t(0));
+
+        Pack arp = a[r][p], arq = a[r][q];
+        a[r][p] = a[p][r] = c * arp - s * arq;
+        a[r][q] = a[q][r] = s * arp + c * arq;
+
+        if (Vectors) {
+            for (int k = 0; k < 3; ++k) {
+                Pack vkp = v[k][p], vkq = v[k][q];
+                v[k][p] = c * vkp - s * vkq;
+                v[k][q] = s * vkp + c * vkq;
+            }
+        }
+    }
+
+    inline void swap( int i, int j )
+    {
+        Pack m = pack_lt(a[j][j], a[i][i]);
+        Pack ai = a[i][i];
+        a[i][i] = pack_select(m, a[j][j], ai);
+        a[j][j] = pack_select(m, ai, a[j][j]);
+        if (Vectors) {
+            for (int k = 0; k < 3; ++k) {
+                Pack vi = v[k][i];
+                v[k][i] = pack_select(m, v[k][j], vi);
+                v[k][j] = pack_select(m, vi, v[k][j]);
+            }
+        }
+    }
+
+    void solve( Pack xx, Pack xy, Pack xz, Pack yy, Pack yz, Pack zz, Pack values[3] )
+    {
+        Pack scale = pack_max(pack_max(pack_max(pack_abs(xx), pack_abs(xy)), pack_max(pack_abs(xz), pack_abs(yy))),
+                              pack_max(pack_abs(yz), pack_abs(zz)));
+        scale = pack_select(pack_le(scale, Pack(real_t(0))), Pack(real_t(1)), scale);
+        Pack invscale = Pack(real_t(1)) / scale;
+
+        a[0][0] = xx * invscale; a[0][1] = a[1][0] = xy * invscale; a[0][2] = a[2][0] = xz * invscale;
+        a[1][1] = yy * invscale; a[1][2] = a[2][1] = yz * invscale; a[2][2] = zz * invscale;
+
+        if (Vectors) {
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    v[i][j] = Pack(real_t(i == j ? 1 : 0));
+        }
+
+        small = Pack(REAL_EPSILON * REAL_EPSILON);
+        Pack tolerance = Pack(REAL_EPSILON * REAL_EPSILON);
+        for (int sweep = 0; sweep < MAX_SWEEPS; ++sweep) {
+            Pack off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+            if (pack_all(pack_le(off, tolerance))) break;
+            rotate(0, 1, 2);
+            rotate(0, 2, 1);
+            rotate(1, 2, 0);
+        }
+
+        swap(0, 1);
+        swap(1, 2);
+        swap(0, 1);
+
+        if (Vectors) {
+            // Jacobi rotations are direct but sorting may have swapped two columns.
+            Pack det = v[0][0] * (v[1][1] * v[2][2] - v[2][1] * v[1][2])
+                     - v[1][0] * (v[0][1] * v[2][2] - v[2][1] * v[0][2])
+                     + v[2][0] * (v[0][1] * v[1][2] - v[1][1] * v[0][2]);
+            Pack indirect = pack_lt(det, Pack(real_t(0)));
+            for (int k = 0; k < 3; ++k)
+                v[k][0] = pack_select(indirect, -v[k][0], v[k][0]);
+        }
+
+        for (int i = 0; i < 3; ++i) values[i] = a[i][i] * scale;
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+template<class Pack, bool Vectors>
+inline void solve_pack( const SymMatrix3Batch& matrices, Eigen3Batch& result, size_t i )
+{
+    JacobiSolver<Pack, Vectors> solver;
+    Pack values[3];
+    solver.solve(Pack::load(&matrices.xx[i]), Pack::load(&matrices.xy[i]), Pack::load(&matrices.xz[i]),
+                 Pack::load(&matrices.yy[i]), Pack::load(&matrices.yz[i]), Pack::load(&matrices.zz[i]),
+                 values);
+    for (int k = 0; k < 3; ++k) {
+        values[k].store(&result.values[k][i]);
+        if (Vectors)
+            for (int c = 0; c < 3; ++c)
+                solver.v[c][k].store(&result.vectors[k][c][i]);
+    }
+}
+
+template<bool Vectors>
+struct EigenRangeSolver {
+    const SymMatrix3Batch& matrices;
+    Eigen3Batch& result;
+
+    EigenRangeSolver( const SymMatrix3Batch& _matrices, Eigen3Batch& _result ) :
+        matrices(_matrices), result(_result) { }
+
+    void operator()( size_t first, size_t last )
+    {
+        size_t i = first;
+        for (; i + SimdPack::width <= last; i += SimdPack::width)
+            solve_pack<SimdPack, Vectors>(matrices, result, i);
+        for (; i < last; ++i)
+            solve_pack<ScalarPack, Vectors>(matrices, result, i);
+    }
+};
+
+void PGL::symmetric_eigen_decomposition( const SymMatrix3Batch& matrices,
+                                         Eigen3Batch& result,
+                                         bool computeVectors )
+{
+    result.resize(matrices.size());
+    if (computeVectors) {
+        EigenRangeSolver<true> solver(matrices, result);
+        pgl_parallel_for(0, matrices.size(), solver, 4096);
+    }
+    else {
+        EigenRangeSolver<false> solver(matrices, result);
+        pgl_parallel_for(0, matrices.size(), solver, 4096);
+    }
+}
+
+void PGL::symmetric_eigen_decomposition( const Matrix3& m, Vector3& values, Matrix3& vectors )
+{
+    JacobiSolver<ScalarPack, true> solver;
+    ScalarPack lambda[3];
+    solver.solve(m(0,0), m(0,1), m(0,2), m(1,1), m(1,2), m(2,2), lambda);
+    values = Vector3(lambda[0].v, lambda[1].v, lambda[2].v);
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            vectors(i,j) = solver.v[i][j].v;
+}
+
+const char * PGL::symmetric_eigen_instruction_set( )
+{
+    return InstructionSet;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,131 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file symmetriceigen.h
+    \brief Batched eigen decomposition of symmetric 3x3 matrices.
+*/
+
+#ifndef __symmetriceigen_h__
+#define __symmetriceigen_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/math/util_matrix.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \struct SymMatrix3Batch
+   \brief A set of symmetric 3x3 matrices stored as a structure of arrays:
+   the coefficient (i,j) of all the matrices are contiguous.
+*/
+struct ALGO_API SymMatrix3Batch {
+
+    SymMatrix3Batch( size_t size = 0 ) { resize(size); }
+
+    inline size_t size( ) const { return xx.size(); }
+
+    /// Resizes the batch. New matrices are null.
+    void resize( size_t size );
+
+    /// Sets the \e i-th matrix. Only the upper triangle of \e m is used.
+    void set( size_t i, const TOOLS(Matrix3)& m );
+
+    /// Returns the \e i-th matrix.
+    TOOLS(Matrix3) get( size_t i ) const;
+
+    std::vector<real_t> xx, xy, xz, yy, yz, zz;
+};
+
+/**
+   \struct Eigen3Batch
+   \brief The eigen values and eigen vectors of a SymMatrix3Batch.
+   Eigen values are sorted in increasing order. The eigen vectors are unit
+   and form a direct orthonormal basis.
+*/
+struct ALGO_API Eigen3Batch {
+
+    Eigen3Batch( size_t size = 0 ) { resize(size); }
+
+    inline size_t size( ) const { return values[0].size(); }
+
+    void resize( size_t size );
+
+    /// Returns the eigen values of the \e i-th matrix.
+    TOOLS(Vector3) getValues( size_t i ) const;
+
+    /// Returns the \e k-th eigen vector of the \e i-th matrix.
+    TOOLS(Vector3) getVector( size_t i, uchar_t k ) const;
+
+    /// values[k][i] is the k-th eigen value of the i-th matrix.
+    std::vector<real_t> values[3];
+
+    /// vectors[k][c][i] is the coordinate c of the k-th eigen vector of the i-th matrix.
+    std::vector<real_t> vectors[3][3];
+};
+
+/**
+    Computes the eigen values, and if \e computeVectors is true the eigen vectors,
+    of all the matrices of \e matrices.
+    Matrices are processed by groups of SIMD width with a fixed number of cyclic
+    Jacobi sweeps, and groups are distributed over the pgl_parallel_for threads.
+*/
+ALGO_API void symmetric_eigen_decomposition( const SymMatrix3Batch& matrices,
+                                             Eigen3Batch& result,
+                                             bool computeVectors = true );
+
+/**
+    Computes the eigen values (in increasing order) and the eigen vectors of
+    the symmetric matrix \e m. The k-th column of \e vectors is the eigen vector
+    associated to the k-th eigen value.
+*/
+ALGO_API void symmetric_eigen_decomposition( const TOOLS(Matrix3)& m,
+                                             TOOLS(Vector3)& values,
+                                             TOOLS(Matrix3)& vectors );
+
+/// Returns the instruction set used by symmetric_eigen_decomposition ("AVX", "SSE2" or "scalar").
+ALGO_API const char * symmetric_eigen_instruction_set( );
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#endif // __symmetriceigen_h__
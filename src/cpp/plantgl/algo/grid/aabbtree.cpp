@@ -0,0 +1,372 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2012 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "aabbtree.h"
+#include <plantgl/tool/util_parallel.h>
+#include <algorithm>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const uint_t AABBTree::DEFAULT_LEAF_SIZE(4);
+
+// A sub-traversal: node against itself, or node against a node of the other tree.
+struct AABBTree::Task {
+    uint_t node;
+    uint_t othernode;
+    bool self;
+
+    Task(uint_t _node, uint_t _othernode, bool _self) : node(_node), othernode(_othernode), self(_self) {}
+};
+
+/* ----------------------------------------------------------------------- */
+
+AABBTree::AABBTree(const std::vector<Vector3>& lowers,
+                   const std::vector<Vector3>& uppers,
+                   uint_t leafSize) :
+    RefCountObject(),
+    __lowers(lowers),
+    __uppers(uppers)
+{
+    build(leafSize);
+}
+
+AABBTree::AABBTree(const Point3ArrayPtr& points,
+                   const Index3ArrayPtr& triangles,
+                   uint_t leafSize) :
+    RefCountObject()
+{
+    __lowers.reserve(triangles->size());
+    __uppers.reserve(triangles->size());
+    for (Index3Array::const_iterator it = triangles->begin(); it != triangles->end(); ++it) {
+        Vector3 lower = points->getAt(it->getAt(0)), upper = lower;
+        for (uchar_t i = 1; i < 3; ++i) {
+            const Vector3& p = points->getAt(it->getAt(i));
+            for (uchar_t k = 0; k < 3; ++k) {
+                if (p[k] < lower[k]) lower[k] = p[k];
+                else if (p[k] > upper[k]) upper[k] = p[k];
+            }
+        }
+        __lowers.push_back(lower);
+        __uppers.push_back(upper);
+    }
+    build(leafSize);
+}
+
+AABBTree::~AABBTree()
+{
+}
+
+void AABBTree::build(uint_t leafSize)
+{
+    uint_t nbItems = __lowers.size();
+    __items.resize(nbItems);
+    std::vector<Vector3> centers(nbItems);
+    for (uint_t i = 0; i < nbItems; ++i) {
+        __items[i] = i;
+        centers[i] = (__lowers[i] + __uppers[i]) / 2;
+    }
+    __nodes.clear();
+    if (nbItems == 0) return;
+    __nodes.reserve(2 * (nbItems / std::max<uint_t>(1, leafSize)) + 1);
+    __nodes.resize(1);
+    buildNode(0, 0, nbItems, std::max<uint_t>(1, leafSize), centers);
+}
+
+struct CenterLess {
+    const std::vector<Vector3>& centers;
+    uchar_t axis;
+    CenterLess(const std::vector<Vector3>& _centers, uchar_t _axis) : centers(_centers), axis(_axis) {}
+    bool operator()(uint_t i, uint_t j) const { return centers[i][axis] < centers[j][axis]; }
+};
+
+// Fills node with the items [first,last) and builds its children.
+void AABBTree::buildNode(uint_t node, uint_t first, uint_t last, uint_t leafSize, const std::vector<Vector3>& centers)
+{
+    Vector3 lower = __lowers[__items[first]], upper = __uppers[__items[first]];
+    Vector3 clower = centers[__items[first]], cupper = clower;
+    for (uint_t i = first + 1; i < last; ++i) {
+        uint_t item = __items[i];
+        for (uchar_t k = 0; k < 3; ++k) {
+            lower[k] = std::min(lower[k], __lowers[item][k]);
+            upper[k] = std::max(upper[k], __uppers[item][k]);
+            clower[k] = std::min(clower[k], centers[item][k]);
+            cupper[k] = std::max(cupper[k], centers[item][k]);
+        }
+    }
+    __nodes[node].lower = lower;
+    __nodes[node].upper = upper;
+    if (last - first <= leafSize) {
+        __nodes[node].first = first;
+        __nodes[node].count = last - first;
+        return;
+    }
+
+    Vector3 extent = cupper - clower;
+    uchar_t axis = (extent.x() >= extent.y() ? (extent.x() >= extent.z() ? 0 : 2) : (extent.y() >= extent.z() ? 1 : 2));
+    uint_t middle = (first + last) / 2;
+    std::nth_element(__items.begin() + first, __items.begin() + middle, __items.begin() + last, CenterLess(centers, axis));
+
+    uint_t children = __nodes.size();
+    __nodes[node].first = children;
+    __nodes[node].count = 0;
+    __nodes.resize(children + 2);
+    buildNode(children, first, middle, leafSize, centers);
+    buildNode(children + 1, middle, last, leafSize, centers);
+}
+
+Vector3 AABBTree::getLowerCorner() const
+{ return __nodes.empty() ? Vector3::ORIGIN : __nodes[0].lower; }
+
+Vector3 AABBTree::getUpperCorner() const
+{ return __nodes.empty() ? Vector3::ORIGIN : __nodes[0].upper; }
+
+/* ----------------------------------------------------------------------- */
+
+inline bool box_overlap(const Vector3& lower1, const Vector3& upper1, const Vector3& lower2, const Vector3& upper2)
+{
+    return lower1.x() <= upper2.x() && lower2.x() <= upper1.x() &&
+           lower1.y() <= upper2.y() && lower2.y() <= upper1.y() &&
+           lower1.z() <= upper2.z() && lower2.z() <= upper1.z();
+}
+
+inline real_t box_volume(const Vector3& lower, const Vector3& upper)
+{
+    Vector3 extent = upper - lower;
+    return extent.x() * extent.y() * extent.z();
+}
+
+inline bool AABBTree::overlap(uint_t node, const AABBTree& other, uint_t othernode) const
+{
+    return box_overlap(__nodes[node].lower, __nodes[node].upper, other.__nodes[othernode].lower, other.__nodes[othernode].upper);
+}
+
+inline bool AABBTree::itemOverlap(uint_t item, const AABBTree& other, uint_t otheritem) const
+{
+    return box_overlap(__lowers[item], __uppers[item], other.__lowers[otheritem], other.__uppers[otheritem]);
+}
+
+std::vector<uint_t> AABBTree::boxQuery(const Vector3& lower, const Vector3& upper) const
+{
+    std::vector<uint_t> result;
+    if (__nodes.empty()) return result;
+    std::vector<uint_t> stack(1, 0);
+    while (!stack.empty()) {
+        const Node& node = __nodes[stack.back()];
+        stack.pop_back();
+        if (!box_overlap(node.lower, node.upper, lower, upper)) continue;
+        if (node.isLeaf()) {
+            for (uint_t i = node.first; i < node.first + node.count; ++i)
+                if (box_overlap(__lowers[__items[i]], __uppers[__items[i]], lower, upper)) result.push_back(__items[i]);
+        }
+        else {
+            stack.push_back(node.first + 1);
+            stack.push_back(node.first);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// Returns -1 if the box is entirely on the negative side of the plane, 1 if entirely on its positive side, 0 otherwise.
+inline int box_plane_side(const Vector3& lower, const Vector3& upper, const Vector4& plane)
+{
+    real_t pmin = plane.w(), pmax = plane.w();
+    for (uchar_t k = 0; k < 3; ++k) {
+        if (plane[k] >= 0) { pmin += plane[k] * lower[k]; pmax += plane[k] * upper[k]; }
+        else { pmin += plane[k] * upper[k]; pmax += plane[k] * lower[k]; }
+    }
+    if (pmax < 0) return -1;
+    return pmin >= 0 ? 1 : 0;
+}
+
+std::vector<uint_t> AABBTree::planesQuery(const std::vector<Vector4>& planes) const
+{
+    std::vector<uint_t> result;
+    if (__nodes.empty()) return result;
+    // Each node is given the mask of the planes that cross its parent. The planes that leave it inside are not tested below it.
+    uint_t nbPlanes = std::min<uint_t>(planes.size(), 32);
+    uint_t allPlanes = (nbPlanes == 32 ? 0xFFFFFFFF : (1u << nbPlanes) - 1);
+    std::vector<std::pair<uint_t,uint_t> > stack(1, std::pair<uint_t,uint_t>(0, allPlanes));
+    while (!stack.empty()) {
+        const Node& node = __nodes[stack.back().first];
+        uint_t mask = stack.back().second;
+        stack.pop_back();
+        bool outside = false;
+        for (uint_t p = 0; p < nbPlanes && !outside; ++p) {
+            if (!(mask & (1u << p))) continue;
+            int side = box_plane_side(node.lower, node.upper, planes[p]);
+            if (side < 0) outside = true;
+            else if (side > 0) mask &= ~(1u << p);
+        }
+        if (outside) continue;
+        if (node.isLeaf()) {
+            for (uint_t i = node.first; i < node.first + node.count; ++i) {
+                uint_t item = __items[i];
+                bool inside = true;
+                for (uint_t p = 0; p < nbPlanes && inside; ++p)
+                    if ((mask & (1u << p)) && box_plane_side(__lowers[item], __uppers[item], planes[p]) < 0) inside = false;
+                if (inside) result.push_back(item);
+            }
+        }
+        else {
+            stack.push_back(std::pair<uint_t,uint_t>(node.first + 1, mask));
+            stack.push_back(std::pair<uint_t,uint_t>(node.first, mask));
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Pairs of items of a node with themselves.
+void AABBTree::traverse(uint_t node, ItemPairList& result) const
+{
+    const Node& n = __nodes[node];
+    if (n.isLeaf()) {
+        for (uint_t i = n.first; i < n.first + n.count; ++i)
+            for (uint_t j = i + 1; j < n.first + n.count; ++j)
+                if (itemOverlap(__items[i], *this, __items[j]))
+                    result.push_back(ItemPair(std::min(__items[i], __items[j]), std::max(__items[i], __items[j])));
+        return;
+    }
+    traverse(n.first, result);
+    traverse(n.first + 1, result);
+    if (overlap(n.first, *this, n.first + 1)) traverse(n.first, *this, n.first + 1, result);
+}
+
+// Pairs of items of node and othernode, which are assumed to overlap.
+void AABBTree::traverse(uint_t node, const AABBTree& other, uint_t othernode, ItemPairList& result) const
+{
+    const Node& n = __nodes[node];
+    const Node& o = other.__nodes[othernode];
+    bool self = (&other == this);
+    if (n.isLeaf() && o.isLeaf()) {
+        for (uint_t i = n.first; i < n.first + n.count; ++i)
+            for (uint_t j = o.first; j < o.first + o.count; ++j)
+                if (itemOverlap(__items[i], other, other.__items[j])) {
+                    uint_t a = __items[i], b = other.__items[j];
+                    if (self && b < a) std::swap(a, b);
+                    result.push_back(ItemPair(a, b));
+                }
+        return;
+    }
+    // descend into the largest node.
+    if (o.isLeaf() || (!n.isLeaf() && box_volume(n.lower, n.upper) >= box_volume(o.lower, o.upper))) {
+        for (uint_t c = n.first; c < n.first + 2; ++c)
+            if (overlap(c, other, othernode)) traverse(c, other, othernode, result);
+    }
+    else {
+        for (uint_t c = o.first; c < o.first + 2; ++c)
+            if (overlap(node, other, c)) traverse(node, other, c, result);
+    }
+}
+
+AABBTree::ItemPairList AABBTree::parallelTraverse(std::vector<Task>& tasks, const AABBTree& other) const
+{
+    // tasks are split until there are enough of them to balance the load between threads.
+    size_t nbTasks = 8 * pgl_thread_count();
+    bool expanded = true;
+    while (expanded && tasks.size() < nbTasks) {
+        expanded = false;
+        std::vector<Task> next;
+        for (std::vector<Task>::const_iterator it = tasks.begin(); it != tasks.end(); ++it) {
+            const Node& n = __nodes[it->node];
+            const Node& o = other.__nodes[it->othernode];
+            if (it->self) {
+                if (n.isLeaf()) { next.push_back(*it); continue; }
+                next.push_back(Task(n.first, n.first, true));
+                next.push_back(Task(n.first + 1, n.first + 1, true));
+                if (overlap(n.first, *this, n.first + 1)) next.push_back(Task(n.first, n.first + 1, false));
+            }
+            else if (n.isLeaf() && o.isLeaf()) { next.push_back(*it); continue; }
+            else if (o.isLeaf() || (!n.isLeaf() && box_volume(n.lower, n.upper) >= box_volume(o.lower, o.upper))) {
+                for (uint_t c = n.first; c < n.first + 2; ++c)
+                    if (overlap(c, other, it->othernode)) next.push_back(Task(c, it->othernode, false));
+            }
+            else {
+                for (uint_t c = o.first; c < o.first + 2; ++c)
+                    if (overlap(it->node, other, c)) next.push_back(Task(it->node, c, false));
+            }
+            expanded = true;
+        }
+        tasks.swap(next);
+    }
+
+    std::vector<ItemPairList> results(tasks.size());
+    struct Runner {
+        const AABBTree& tree;
+        const AABBTree& other;
+        const std::vector<Task>& tasks;
+        std::vector<ItemPairList>& results;
+
+        Runner(const AABBTree& _tree, const AABBTree& _other, const std::vector<Task>& _tasks, std::vector<ItemPairList>& _results) :
+            tree(_tree), other(_other), tasks(_tasks), results(_results) {}
+
+        void operator()(size_t first, size_t last) {
+            for (size_t t = first; t < last; ++t) {
+                if (tasks[t].self) tree.traverse(tasks[t].node, results[t]);
+                else tree.traverse(tasks[t].node, other, tasks[t].othernode, results[t]);
+            }
+        }
+    } runner(*this, other, tasks, results);
+    pgl_parallel_for(0, tasks.size(), runner, 1);
+
+    size_t nbPairs = 0;
+    for (std::vector<ItemPairList>::const_iterator it = results.begin(); it != results.end(); ++it) nbPairs += it->size();
+    ItemPairList result;
+    result.reserve(nbPairs);
+    for (std::vector<ItemPairList>::const_iterator it = results.begin(); it != results.end(); ++it)
+        result.insert(result.end(), it->begin(), it->end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+AABBTree::ItemPairList AABBTree::overlappingPairs() const
+{
+    if (__nodes.empty()) return ItemPairList();
+    std::vector<Task> tasks(1, Task(0, 0, true));
+    return parallelTraverse(tasks, *this);
+}
+
+AABBTree::ItemPairList AABBTree::overlappingPairs(const AABBTree& other) const
+{
+    if (__nodes.empty() || other.__nodes.empty() || !overlap(0, other, 0)) return ItemPairList();
+    std::vector<Task> tasks(1, Task(0, 0, false));
+    return parallelTraverse(tasks, other);
+}
+
+/* ----------------------------------------------------------------------- */
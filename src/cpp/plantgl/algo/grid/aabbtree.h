@@ -0,0 +1,151 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2012 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file aabbtree.h
+    \brief Definition of AABBTree, a bounding volume hierarchy of axis aligned boxes.
+*/
+
+#ifndef __aabbtree_h__
+#define __aabbtree_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/tool/rcobject.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+    \class AABBTree
+    \brief A binary tree of axis aligned bounding boxes built over a set of items
+    (e.g. the triangles of a mesh) by median splits along the largest axis.
+    It finds the pairs of items whose boxes overlap, within the tree or with another tree.
+    Traversals are split in independent sub-traversals processed in parallel.
+*/
+
+class ALGO_API AABBTree : public TOOLS(RefCountObject)
+{
+public:
+    typedef std::pair<uint_t,uint_t> ItemPair;
+    typedef std::vector<ItemPair> ItemPairList;
+
+    /// The default maximal number of items in a leaf.
+    static const uint_t DEFAULT_LEAF_SIZE;
+
+    /// Builds the tree over the boxes [\e lowers[i], \e uppers[i]].
+    AABBTree(const std::vector<TOOLS(Vector3)>& lowers,
+             const std::vector<TOOLS(Vector3)>& uppers,
+             uint_t leafSize = DEFAULT_LEAF_SIZE);
+
+    /// Builds the tree over the bounding boxes of \e triangles.
+    AABBTree(const Point3ArrayPtr& points,
+             const Index3ArrayPtr& triangles,
+             uint_t leafSize = DEFAULT_LEAF_SIZE);
+
+    virtual ~AABBTree();
+
+    /// Returns the number of items.
+    inline uint_t size() const { return __lowers.size(); }
+
+    /// Returns the number of nodes.
+    inline uint_t getNbNodes() const { return __nodes.size(); }
+
+    /// Returns the box containing all the items.
+    TOOLS(Vector3) getLowerCorner() const;
+    TOOLS(Vector3) getUpperCorner() const;
+
+    /// Returns the box of the item \e i.
+    inline const TOOLS(Vector3)& getLowerCorner(uint_t i) const { return __lowers[i]; }
+    inline const TOOLS(Vector3)& getUpperCorner(uint_t i) const { return __uppers[i]; }
+
+    /// Returns the items whose box overlaps the box [\e lower, \e upper].
+    std::vector<uint_t> boxQuery(const TOOLS(Vector3)& lower, const TOOLS(Vector3)& upper) const;
+
+    /** Returns the items whose box is not entirely on the negative side of one of the \e planes,
+        sorted. A plane (a,b,c,d) keeps the points for which a.x+b.y+c.z+d >= 0.
+        At most 32 planes are taken into account. */
+    std::vector<uint_t> planesQuery(const std::vector<TOOLS(Vector4)>& planes) const;
+
+    /// Returns the pairs (i,j), i < j, of items whose boxes overlap, sorted.
+    ItemPairList overlappingPairs() const;
+
+    /// Returns the pairs (i,j) of items of this tree and of \e other whose boxes overlap, sorted.
+    ItemPairList overlappingPairs(const AABBTree& other) const;
+
+protected:
+
+    struct Node {
+        TOOLS(Vector3) lower;
+        TOOLS(Vector3) upper;
+        // an internal node has its children at first and first+1. A leaf has count items from first.
+        uint_t first;
+        uint_t count;
+
+        inline bool isLeaf() const { return count > 0; }
+    };
+
+    struct Task;
+
+    void build(uint_t leafSize);
+    void buildNode(uint_t node, uint_t first, uint_t last, uint_t leafSize, const std::vector<TOOLS(Vector3)>& centers);
+
+    inline bool overlap(uint_t node, const AABBTree& other, uint_t othernode) const;
+    inline bool itemOverlap(uint_t item, const AABBTree& other, uint_t otheritem) const;
+
+    void traverse(uint_t node, ItemPairList& result) const;
+    void traverse(uint_t node, const AABBTree& other, uint_t othernode, ItemPairList& result) const;
+    ItemPairList parallelTraverse(std::vector<Task>& tasks, const AABBTree& other) const;
+
+    std::vector<TOOLS(Vector3)> __lowers;
+    std::vector<TOOLS(Vector3)> __uppers;
+    std::vector<uint_t> __items;
+    std::vector<Node> __nodes;
+};
+
+typedef RCPtr<AABBTree> AABBTreePtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __aabbtree_h__
+#endif
@@ -41,6 +41,7 @@
 #include "../algo_config.h"
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/indexarray.h>
+#include <plantgl/tool/util_mutex.h>
 
 #ifdef WITH_ANN
 #include <ANN/ANN.h>
@@ -54,6 +55,13 @@ PGL_BEGIN_NAMESPACE
 
 #ifdef WITH_ANN
 
+/// ANN keeps the state of a search in global variables. Each search call is thus serialized.
+inline PglMutex& ann_search_mutex()
+{
+    static PglMutex mutex;
+    return mutex;
+}
+
 template<class VectorType>
 inline void toANNPoint(const VectorType& v, ANNpoint& point)
 {
@@ -101,7 +109,10 @@ inline IndexArrayPtr k_nearest_neighbors_of_kdtree_points(ANNkd_tree& kdtree, si
 
     /// For each point, ask k closest point to  kdtree
     for (size_t pointid = 0; pointid < nbPoints; ++pointid){
-        kdtree.annkSearch(pointdata[pointid],kk,nn_idx,dists);
+        {
+            PglMutexLocker lock(ann_search_mutex());
+            kdtree.annkSearch(pointdata[pointid],kk,nn_idx,dists);
+        }
         Index& pointres = res->getAt(pointid);
         for(uint32_t i = 0; i < kk; ++i) 
             if (nn_idx[i] != pointid)
@@ -135,7 +146,10 @@ inline IndexArrayPtr r_nearest_neighbors_of_kdtree_points(ANNkd_tree& kdtree, re
 
     /// For each point, ask k closest point to  kdtree
     for (size_t pointid = 0; pointid < nbPoints; ++pointid){
-        kdtree.annkFRSearch(pointdata[pointid],sqrRadius,kk,nn_idx,dists);
+        {
+            PglMutexLocker lock(ann_search_mutex());
+            kdtree.annkFRSearch(pointdata[pointid],sqrRadius,kk,nn_idx,dists);
+        }
         Index& pointres = res->getAt(pointid);
         for(uint32_t i = 0; i < kk; ++i) 
             if (nn_idx[i] != pointid)
@@ -197,10 +211,13 @@ class ANNKDTreeInternal
             toANNPoint(point,queryPoint);
 
             size_t kres = k;
-            if (maxdist != REAL_MAX)
-                kres = std::min<size_t>(k,__kdtree.annkFRSearch(queryPoint,maxdist*maxdist,k,nn_idx,dists));
-            else 
-                __kdtree.annkSearch(queryPoint,k,nn_idx,dists);
+            {
+                PglMutexLocker lock(ann_search_mutex());
+                if (maxdist != REAL_MAX)
+                    kres = std::min<size_t>(k,__kdtree.annkFRSearch(queryPoint,maxdist*maxdist,k,nn_idx,dists));
+                else 
+                    __kdtree.annkSearch(queryPoint,k,nn_idx,dists);
+            }
 
             Index res;
             for(uint32_t i = 0; i < kres; ++i) res.push_back(nn_idx[i]);
@@ -0,0 +1,563 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+
+#define GL_GLEXT_PROTOTYPES
+#include "glbufferobject.h"
+#include <plantgl/scenegraph/geometry/mesh.h>
+
+#ifndef PGL_WITHOUT_QT
+#include <QtOpenGL/QGLWidget>
+#endif
+
+#include <vector>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <string>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#ifndef APIENTRY
+#define APIENTRY
+#endif
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+
+#ifndef GL_VERTEX_PROGRAM_TWO_SIDE
+#define GL_VERTEX_PROGRAM_TWO_SIDE 0x8643
+#endif
+
+typedef char PglChar;
+
+typedef void (APIENTRY * PglGenBuffersProc) (GLsizei n, GLuint * buffers);
+typedef void (APIENTRY * PglDeleteBuffersProc) (GLsizei n, const GLuint * buffers);
+typedef void (APIENTRY * PglBindBufferProc) (GLenum target, GLuint buffer);
+typedef void (APIENTRY * PglBufferDataProc) (GLenum target, ptrdiff_t size, const GLvoid * data, GLenum usage);
+
+static PglGenBuffersProc pglGenBuffers = NULL;
+static PglDeleteBuffersProc pglDeleteBuffers = NULL;
+static PglBindBufferProc pglBindBuffer = NULL;
+static PglBufferDataProc pglBufferData = NULL;
+static int HasBufferObject = -1;
+
+typedef GLuint (APIENTRY * PglCreateShaderProc) (GLenum type);
+typedef void (APIENTRY * PglShaderSourceProc) (GLuint shader, GLsizei count, const PglChar * const * string, const GLint * length);
+typedef void (APIENTRY * PglCompileShaderProc) (GLuint shader);
+typedef void (APIENTRY * PglGetShaderivProc) (GLuint shader, GLenum pname, GLint * params);
+typedef void (APIENTRY * PglDeleteShaderProc) (GLuint shader);
+typedef GLuint (APIENTRY * PglCreateProgramProc) (void);
+typedef void (APIENTRY * PglAttachShaderProc) (GLuint program, GLuint shader);
+typedef void (APIENTRY * PglBindAttribLocationProc) (GLuint program, GLuint index, const PglChar * name);
+typedef void (APIENTRY * PglLinkProgramProc) (GLuint program);
+typedef void (APIENTRY * PglGetProgramivProc) (GLuint program, GLenum pname, GLint * params);
+typedef void (APIENTRY * PglDeleteProgramProc) (GLuint program);
+typedef void (APIENTRY * PglUseProgramProc) (GLuint program);
+typedef GLint (APIENTRY * PglGetUniformLocationProc) (GLuint program, const PglChar * name);
+typedef void (APIENTRY * PglUniform1iProc) (GLint location, GLint v0);
+typedef void (APIENTRY * PglUniform1ivProc) (GLint location, GLsizei count, const GLint * value);
+typedef void (APIENTRY * PglEnableVertexAttribArrayProc) (GLuint index);
+typedef void (APIENTRY * PglDisableVertexAttribArrayProc) (GLuint index);
+typedef void (APIENTRY * PglVertexAttribPointerProc) (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid * pointer);
+typedef void (APIENTRY * PglVertexAttribDivisorProc) (GLuint index, GLuint divisor);
+typedef void (APIENTRY * PglDrawArraysInstancedProc) (GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
+
+static PglCreateShaderProc pglCreateShader = NULL;
+static PglShaderSourceProc pglShaderSource = NULL;
+static PglCompileShaderProc pglCompileShader = NULL;
+static PglGetShaderivProc pglGetShaderiv = NULL;
+static PglDeleteShaderProc pglDeleteShader = NULL;
+static PglCreateProgramProc pglCreateProgram = NULL;
+static PglAttachShaderProc pglAttachShader = NULL;
+static PglBindAttribLocationProc pglBindAttribLocation = NULL;
+static PglLinkProgramProc pglLinkProgram = NULL;
+static PglGetProgramivProc pglGetProgramiv = NULL;
+static PglDeleteProgramProc pglDeleteProgram = NULL;
+static PglUseProgramProc pglUseProgram = NULL;
+static PglGetUniformLocationProc pglGetUniformLocation = NULL;
+static PglUniform1iProc pglUniform1i = NULL;
+static PglUniform1ivProc pglUniform1iv = NULL;
+static PglEnableVertexAttribArrayProc pglEnableVertexAttribArray = NULL;
+static PglDisableVertexAttribArrayProc pglDisableVertexAttribArray = NULL;
+static PglVertexAttribPointerProc pglVertexAttribPointer = NULL;
+static PglVertexAttribDivisorProc pglVertexAttribDivisor = NULL;
+static PglDrawArraysInstancedProc pglDrawArraysInstanced = NULL;
+static int HasInstancing = -1;
+
+#if !defined(PGL_WITHOUT_QT) && !defined(_WIN32)
+// A context made current without Qt, such as an offscreen one, uses the entry points exported by the GL library.
+#define PGL_GL_PROC(type,name) (QGLContext::currentContext() ? (type)QGLContext::currentContext()->getProcAddress(#name) : (type)&name)
+#elif !defined(PGL_WITHOUT_QT)
+#define PGL_GL_PROC(type,name) (type)QGLContext::currentContext()->getProcAddress(#name)
+#elif !defined(_WIN32)
+// The GL entry points are exported by the GL library.
+#define PGL_GL_PROC(type,name) (type)&name
+#else
+#define PGL_GL_PROC(type,name) (type)NULL
+#endif
+
+bool GLMeshBuffer::isSupported()
+{
+  if (HasBufferObject == -1) {
+#if !defined(PGL_WITHOUT_QT) && defined(_WIN32)
+    if (!QGLContext::currentContext()) return false;
+#endif
+    pglGenBuffers = PGL_GL_PROC(PglGenBuffersProc,glGenBuffers);
+    pglDeleteBuffers = PGL_GL_PROC(PglDeleteBuffersProc,glDeleteBuffers);
+    pglBindBuffer = PGL_GL_PROC(PglBindBufferProc,glBindBuffer);
+    pglBufferData = PGL_GL_PROC(PglBufferDataProc,glBufferData);
+    HasBufferObject = (pglGenBuffers && pglDeleteBuffers && pglBindBuffer && pglBufferData ? 1 : 0);
+  }
+  return HasBufferObject == 1;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// A vertex of a triangle as stored in the buffer.
+struct GLBufferVertex {
+  GLfloat position[3];
+  GLfloat normal[3];
+  GLubyte color[4];
+  GLfloat texcoord[2];
+};
+
+#define GL_BUFFER_OFFSET(field) ((const GLvoid *)offsetof(GLBufferVertex,field))
+
+inline void setVector(GLfloat * dest, const Vector3& v)
+{ dest[0] = (GLfloat)v.x(); dest[1] = (GLfloat)v.y(); dest[2] = (GLfloat)v.z(); }
+
+inline void setColor(GLubyte * dest, const Color4& c)
+{ dest[0] = c.getRed(); dest[1] = c.getGreen(); dest[2] = c.getBlue(); dest[3] = 255 - c.getAlpha(); }
+
+/* ----------------------------------------------------------------------- */
+
+GLMeshBuffer::GLMeshBuffer() :
+  __id(0),
+  __count(0),
+  __textured(false),
+  __texcoord(false),
+  __color(false),
+  __ccw(true)
+{
+}
+
+bool GLMeshBuffer::build(Mesh& mesh, bool textured)
+{
+  if (!isSupported()) return false;
+  mesh.checkNormalList();
+
+  uint_t nbfaces = mesh.getIndexListSize();
+  size_t nbvertices = 0;
+  for (uint_t i = 0; i < nbfaces; ++i) {
+    uint_t facesize = mesh.getFaceSize(i);
+    if (facesize > 2) nbvertices += 3 * (facesize - 2);
+  }
+  if (nbvertices == 0) return false;
+
+  bool normalV = mesh.getNormalPerVertex();
+  bool texcoord = textured && mesh.hasTexCoordList();
+  bool colorV = mesh.getColorPerVertex();
+  // As in immediate mode, the texture coordinates replace the colors of the vertices.
+  bool color = mesh.hasColorList() && !(texcoord && colorV);
+
+  std::vector<GLBufferVertex> vertices(nbvertices);
+  GLBufferVertex * v = &vertices[0];
+  GLBufferVertex corners[3];
+  for (uint_t i = 0; i < nbfaces; ++i) {
+    uint_t facesize = mesh.getFaceSize(i);
+    if (facesize < 3) continue;
+    // The polygons are triangulated as a fan around their first vertex.
+    for (uint_t j = 0; j < facesize; ++j) {
+      GLBufferVertex& corner = corners[j < 2 ? j : 2];
+      setVector(corner.position, mesh.getFacePointAt(i,j));
+      setVector(corner.normal, normalV ? mesh.getFaceNormalAt(i,j) : mesh.getNormalAt(i));
+      if (color) setColor(corner.color, colorV ? mesh.getFaceColorAt(i,j) : mesh.getColorAt(i));
+      if (texcoord) {
+        const Vector2& t = mesh.getFaceTexCoordAt(i,j);
+        corner.texcoord[0] = (GLfloat)t.x(); corner.texcoord[1] = (GLfloat)t.y();
+      }
+      if (j >= 2) {
+        *v++ = corners[0]; *v++ = corners[1]; *v++ = corners[2];
+        corners[1] = corners[2];
+      }
+    }
+  }
+
+  if (__id == 0) pglGenBuffers(1, &__id);
+  if (__id == 0) return false;
+  pglBindBuffer(GL_ARRAY_BUFFER, __id);
+  pglBufferData(GL_ARRAY_BUFFER, nbvertices * sizeof(GLBufferVertex), &vertices[0], GL_STATIC_DRAW);
+  pglBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  __count = (GLsizei)nbvertices;
+  __textured = textured;
+  __texcoord = texcoord;
+  __color = color;
+  __ccw = mesh.getCCW();
+  return true;
+}
+
+void GLMeshBuffer::draw() const
+{
+  if (__id == 0) return;
+  bind();
+  glDrawArrays(GL_TRIANGLES, 0, __count);
+  unbind();
+}
+
+void GLMeshBuffer::bind() const
+{
+  pglBindBuffer(GL_ARRAY_BUFFER, __id);
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glVertexPointer(3, GL_FLOAT, sizeof(GLBufferVertex), GL_BUFFER_OFFSET(position));
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glNormalPointer(GL_FLOAT, sizeof(GLBufferVertex), GL_BUFFER_OFFSET(normal));
+
+  if (__color) {
+    // The colors of the mesh are its ambient color as in immediate mode.
+    glPushAttrib(GL_LIGHTING_BIT);
+    glColorMaterial(GL_FRONT_AND_BACK, GL_AMBIENT);
+    glEnable(GL_COLOR_MATERIAL);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(GLBufferVertex), GL_BUFFER_OFFSET(color));
+  }
+  if (__texcoord) {
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexCoordPointer(2, GL_FLOAT, sizeof(GLBufferVertex), GL_BUFFER_OFFSET(texcoord));
+  }
+  pglBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void GLMeshBuffer::unbind() const
+{
+  if (__texcoord) glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  if (__color) {
+    glDisableClientState(GL_COLOR_ARRAY);
+    glPopAttrib();
+  }
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+}
+
+void GLMeshBuffer::release()
+{
+  if (__id != 0 && HasBufferObject == 1) pglDeleteBuffers(1, &__id);
+  __id = 0;
+  __count = 0;
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool GLInstanceDrawer::isSupported()
+{
+  if (HasInstancing == -1) {
+    if (!GLMeshBuffer::isSupported()) return false;
+    // The instanced arrays are part of GL 3.3.
+    const char * version = (const char *)glGetString(GL_VERSION);
+    const char * extensions = (const char *)glGetString(GL_EXTENSIONS);
+    bool available = (version && (version[0] > '3' || (version[0] == '3' && version[2] >= '3'))) ||
+                     (extensions && strstr(extensions,"GL_ARB_instanced_arrays") && strstr(extensions,"GL_ARB_draw_instanced"));
+    if (!available) { HasInstancing = 0; return false; }
+    pglCreateShader = PGL_GL_PROC(PglCreateShaderProc,glCreateShader);
+    pglShaderSource = PGL_GL_PROC(PglShaderSourceProc,glShaderSource);
+    pglCompileShader = PGL_GL_PROC(PglCompileShaderProc,glCompileShader);
+    pglGetShaderiv = PGL_GL_PROC(PglGetShaderivProc,glGetShaderiv);
+    pglDeleteShader = PGL_GL_PROC(PglDeleteShaderProc,glDeleteShader);
+    pglCreateProgram = PGL_GL_PROC(PglCreateProgramProc,glCreateProgram);
+    pglAttachShader = PGL_GL_PROC(PglAttachShaderProc,glAttachShader);
+    pglBindAttribLocation = PGL_GL_PROC(PglBindAttribLocationProc,glBindAttribLocation);
+    pglLinkProgram = PGL_GL_PROC(PglLinkProgramProc,glLinkProgram);
+    pglGetProgramiv = PGL_GL_PROC(PglGetProgramivProc,glGetProgramiv);
+    pglDeleteProgram = PGL_GL_PROC(PglDeleteProgramProc,glDeleteProgram);
+    pglUseProgram = PGL_GL_PROC(PglUseProgramProc,glUseProgram);
+    pglGetUniformLocation = PGL_GL_PROC(PglGetUniformLocationProc,glGetUniformLocation);
+    pglUniform1i = PGL_GL_PROC(PglUniform1iProc,glUniform1i);
+    pglUniform1iv = PGL_GL_PROC(PglUniform1ivProc,glUniform1iv);
+    pglEnableVertexAttribArray = PGL_GL_PROC(PglEnableVertexAttribArrayProc,glEnableVertexAttribArray);
+    pglDisableVertexAttribArray = PGL_GL_PROC(PglDisableVertexAttribArrayProc,glDisableVertexAttribArray);
+    pglVertexAttribPointer = PGL_GL_PROC(PglVertexAttribPointerProc,glVertexAttribPointer);
+    pglVertexAttribDivisor = PGL_GL_PROC(PglVertexAttribDivisorProc,glVertexAttribDivisor);
+    pglDrawArraysInstanced = PGL_GL_PROC(PglDrawArraysInstancedProc,glDrawArraysInstanced);
+    HasInstancing = (pglCreateShader && pglShaderSource && pglCompileShader && pglGetShaderiv &&
+                     pglDeleteShader && pglCreateProgram && pglAttachShader && pglBindAttribLocation &&
+                     pglLinkProgram && pglGetProgramiv && pglDeleteProgram && pglUseProgram &&
+                     pglGetUniformLocation && pglUniform1i && pglUniform1iv &&
+                     pglEnableVertexAttribArray && pglDisableVertexAttribArray && pglVertexAttribPointer &&
+                     pglVertexAttribDivisor && pglDrawArraysInstanced ? 1 : 0);
+  }
+  return HasInstancing == 1;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// The first attribute location of the instances. It aliases the unused texture units of the fixed pipeline.
+#define GL_INSTANCE_ATTRIB 9
+#define GL_INSTANCE_OFFSET(field) ((const GLvoid *)offsetof(GLMeshInstance,field))
+
+/* The vertex program computes the colors of the vertices with the equations of the
+   fixed pipeline so that the instances look like the meshes drawn without it.
+   It is specialized for the lighting state by the definitions put before it. */
+static const char * GLInstanceProgram =
+"attribute vec4 pglRow0;\n"
+"attribute vec4 pglRow1;\n"
+"attribute vec4 pglRow2;\n"
+"attribute vec4 pglAmbient;\n"
+"attribute vec4 pglDiffuse;\n"
+"attribute vec4 pglSpecular;\n"
+"attribute vec4 pglEmission;\n"
+"vec3 pglLight(gl_LightSourceParameters light, vec3 n, vec3 eye, vec3 ambient) {\n"
+"  vec3 l = light.position.xyz;\n"
+"  float att = 1.0;\n"
+"  if (light.position.w != 0.0) {\n"
+"    l = l / light.position.w - eye;\n"
+"    float d = length(l);\n"
+"    l = l / d;\n"
+"    att = 1.0 / (light.constantAttenuation + d * (light.linearAttenuation + d * light.quadraticAttenuation));\n"
+"    if (light.spotCutoff != 180.0) {\n"
+"      float s = dot(-l, normalize(light.spotDirection));\n"
+"      att *= (s < light.spotCosCutoff ? 0.0 : pow(s, light.spotExponent));\n"
+"    }\n"
+"  }\n"
+"  else l = normalize(l);\n"
+"  vec3 c = ambient * light.ambient.rgb;\n"
+"  float nl = dot(n, l);\n"
+"  if (nl > 0.0) {\n"
+"#ifdef PGL_LOCAL_VIEWER\n"
+"    vec3 h = normalize(l - normalize(eye));\n"
+"#else\n"
+"    vec3 h = normalize(l + vec3(0.0, 0.0, 1.0));\n"
+"#endif\n"
+"    float nh = max(dot(n, h), 0.0);\n"
+"    float sp = (pglSpecular.a == 0.0 ? 1.0 : (nh > 0.0 ? pow(nh, pglSpecular.a) : 0.0));\n"
+"    c += nl * pglDiffuse.rgb * light.diffuse.rgb + sp * pglSpecular.rgb * light.specular.rgb;\n"
+"  }\n"
+"  return att * c;\n"
+"}\n"
+"vec4 pglLighting(vec3 n, vec3 eye, vec3 ambient) {\n"
+"  vec3 c = pglEmission.rgb + ambient * gl_LightModel.ambient.rgb;\n"
+"  PGL_LIGHTS\n"
+"  return vec4(c, pglDiffuse.a);\n"
+"}\n"
+"void main() {\n"
+"  vec4 eye = vec4(dot(pglRow0, gl_Vertex), dot(pglRow1, gl_Vertex), dot(pglRow2, gl_Vertex), gl_Vertex.w);\n"
+"  gl_Position = gl_ProjectionMatrix * eye;\n"
+"  gl_ClipVertex = eye;\n"
+"  gl_FogFragCoord = abs(eye.z);\n"
+"#ifdef PGL_LIGHTING\n"
+"  // The normals are transformed by the inverse transpose of the linear part of the transformation.\n"
+"  vec3 a = pglRow0.xyz, b = pglRow1.xyz, c = pglRow2.xyz;\n"
+"  vec3 bc = cross(b, c);\n"
+"  vec3 n = normalize(vec3(dot(bc, gl_Normal), dot(cross(c, a), gl_Normal), dot(cross(a, b), gl_Normal)));\n"
+"  if (dot(a, bc) < 0.0) n = -n;\n"
+"#ifdef PGL_VERTEX_COLOR\n"
+"  vec3 ambient = gl_Color.rgb;\n"
+"#else\n"
+"  vec3 ambient = pglAmbient.rgb;\n"
+"#endif\n"
+"  gl_FrontColor = pglLighting(n, eye.xyz, ambient);\n"
+"#ifdef PGL_TWO_SIDE\n"
+"  gl_BackColor = pglLighting(-n, eye.xyz, ambient);\n"
+"#endif\n"
+"#else\n"
+"#ifdef PGL_VERTEX_COLOR\n"
+"  gl_FrontColor = gl_Color;\n"
+"#else\n"
+"  gl_FrontColor = pglDiffuse;\n"
+"#endif\n"
+"#endif\n"
+"}\n";
+
+/// The parts of the GL state for which a program is specialized.
+enum GLInstanceState {
+  GL_INSTANCE_LIGHTS = 0x00FF,
+  GL_INSTANCE_LIGHTING = 0x0100,
+  GL_INSTANCE_TWO_SIDE = 0x0200,
+  GL_INSTANCE_LOCAL_VIEWER = 0x0400,
+  GL_INSTANCE_VERTEX_COLOR = 0x0800
+};
+
+GLInstanceDrawer::GLInstanceDrawer() :
+  __programs(),
+  __buffer(0),
+  __failed(false)
+{
+}
+
+GLuint GLInstanceDrawer::getProgram(unsigned int state)
+{
+  std::map<unsigned int,GLuint>::const_iterator it = __programs.find(state);
+  if (it != __programs.end()) return it->second;
+
+  std::string definitions = "#version 120\n";
+  if (state & GL_INSTANCE_LIGHTING) definitions += "#define PGL_LIGHTING\n";
+  if (state & GL_INSTANCE_TWO_SIDE) definitions += "#define PGL_TWO_SIDE\n";
+  if (state & GL_INSTANCE_LOCAL_VIEWER) definitions += "#define PGL_LOCAL_VIEWER\n";
+  if (state & GL_INSTANCE_VERTEX_COLOR) definitions += "#define PGL_VERTEX_COLOR\n";
+  // Only the enabled lights are computed.
+  definitions += "#define PGL_LIGHTS";
+  for (int i = 0; i < 8; ++i)
+    if (state & (1 << i)) {
+      char light[80];
+      sprintf(light, " c += pglLight(gl_LightSource[%i], n, eye, ambient);", i);
+      definitions += light;
+    }
+  definitions += "\n";
+
+  GLuint program = 0;
+  GLuint shader = pglCreateShader(GL_VERTEX_SHADER);
+  if (shader != 0) {
+    const char * sources[2] = { definitions.c_str(), GLInstanceProgram };
+    pglShaderSource(shader, 2, sources, NULL);
+    pglCompileShader(shader);
+    GLint status = 0;
+    pglGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status) {
+      program = pglCreateProgram();
+      pglAttachShader(program, shader);
+      const char * attributes[] = { "pglRow0", "pglRow1", "pglRow2", "pglAmbient", "pglDiffuse", "pglSpecular", "pglEmission" };
+      for (GLuint i = 0; i < 7; ++i)
+        pglBindAttribLocation(program, GL_INSTANCE_ATTRIB + i, attributes[i]);
+      pglLinkProgram(program);
+      pglGetProgramiv(program, GL_LINK_STATUS, &status);
+      if (!status) {
+        pglDeleteProgram(program);
+        program = 0;
+      }
+    }
+    // The shader is deleted with the program.
+    pglDeleteShader(shader);
+  }
+  if (program != 0) __programs[state] = program;
+  return program;
+}
+
+bool GLInstanceDrawer::init()
+{
+  if (__buffer != 0) return true;
+  if (__failed || !isSupported()) return false;
+  // The simplest program is built to check that the instanced drawing works.
+  __failed = true;
+  if (getProgram(0) == 0) return false;
+  pglGenBuffers(1, &__buffer);
+  if (__buffer == 0) return false;
+  __failed = false;
+  return true;
+}
+
+bool GLInstanceDrawer::draw(const GLMeshBuffer& buffer, const std::vector<GLMeshInstance>& instances)
+{
+  if (!buffer.isValid() || instances.empty()) return true;
+  if (!init()) return false;
+
+  // The program is chosen according to the lighting state of the fixed pipeline.
+  unsigned int state = 0;
+  GLboolean twoside = GL_FALSE;
+  if (glIsEnabled(GL_LIGHTING)) {
+    state |= GL_INSTANCE_LIGHTING;
+    for (int i = 0; i < 8; ++i)
+      if (glIsEnabled(GL_LIGHT0 + i)) state |= (1 << i);
+    GLboolean localviewer = GL_FALSE;
+    glGetBooleanv(GL_LIGHT_MODEL_TWO_SIDE, &twoside);
+    glGetBooleanv(GL_LIGHT_MODEL_LOCAL_VIEWER, &localviewer);
+    if (twoside) state |= GL_INSTANCE_TWO_SIDE;
+    if (localviewer) state |= GL_INSTANCE_LOCAL_VIEWER;
+  }
+  if (buffer.hasColor()) state |= GL_INSTANCE_VERTEX_COLOR;
+  GLuint program = getProgram(state);
+  if (program == 0) return false;
+
+  pglBindBuffer(GL_ARRAY_BUFFER, __buffer);
+  pglBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(GLMeshInstance), &instances[0], GL_STREAM_DRAW);
+  for (GLuint i = 0; i < 7; ++i) {
+    pglEnableVertexAttribArray(GL_INSTANCE_ATTRIB + i);
+    pglVertexAttribPointer(GL_INSTANCE_ATTRIB + i, 4, GL_FLOAT, GL_FALSE, sizeof(GLMeshInstance),
+                           (const GLubyte *)GL_INSTANCE_OFFSET(transformation) + 4 * sizeof(GLfloat) * i);
+    pglVertexAttribDivisor(GL_INSTANCE_ATTRIB + i, 1);
+  }
+  pglBindBuffer(GL_ARRAY_BUFFER, 0);
+
+  pglUseProgram(program);
+  if (twoside) glEnable(GL_VERTEX_PROGRAM_TWO_SIDE);
+  glFrontFace(buffer.getCCW() ? GL_CCW : GL_CW);
+  buffer.bind();
+  pglDrawArraysInstanced(GL_TRIANGLES, 0, buffer.getVertexCount(), (GLsizei)instances.size());
+  buffer.unbind();
+  if (twoside) glDisable(GL_VERTEX_PROGRAM_TWO_SIDE);
+  pglUseProgram(0);
+
+  for (GLuint i = 0; i < 7; ++i) {
+    pglVertexAttribDivisor(GL_INSTANCE_ATTRIB + i, 0);
+    pglDisableVertexAttribArray(GL_INSTANCE_ATTRIB + i);
+  }
+  return true;
+}
+
+void GLInstanceDrawer::release()
+{
+  if (HasInstancing == 1) {
+    for (std::map<unsigned int,GLuint>::const_iterator it = __programs.begin(); it != __programs.end(); ++it)
+      pglDeleteProgram(it->second);
+    if (__buffer != 0) pglDeleteBuffers(1, &__buffer);
+  }
+  __programs.clear();
+  __buffer = 0;
+  __failed = false;
+}
+
+/* ----------------------------------------------------------------------- */
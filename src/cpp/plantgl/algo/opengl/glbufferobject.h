@@ -0,0 +1,188 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file glbufferobject.h
+    \brief Definition of GLMeshBuffer, the triangles of a mesh stored in a GL vertex buffer object,
+    and of GLInstanceDrawer which draws it several times in a single call.
+*/
+
+
+
+#ifndef __glbufferobject_h__
+#define __glbufferobject_h__
+
+
+#include "util_gl.h"
+#include <vector>
+#include <map>
+
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+class Mesh;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class GLMeshBuffer
+   \brief The triangles of a mesh stored in a vertex buffer object.
+
+   The faces of the mesh are triangulated once. Each vertex of a face is stored
+   with its normal, color and texture coordinates in an interleaved array
+   so that the mesh is drawn with a single call.
+*/
+
+class ALGO_API GLMeshBuffer
+{
+
+public:
+
+  /// Constructs an empty buffer.
+  GLMeshBuffer();
+
+  /** Returns whether the buffer objects are supported by the current GL context.
+      The GL entry points are resolved at the first call. */
+  static bool isSupported();
+
+  /** Uploads the triangulation of \e mesh. Its normals are computed if needed.
+      The texture coordinates are stored if \e textured and if the mesh has some.
+      Returns false if the buffer objects are not supported or if the mesh has no face. */
+  bool build(Mesh& mesh, bool textured);
+
+  /// Draws the triangles of the buffer.
+  void draw() const;
+
+  /// Binds the vertex arrays of the buffer without drawing them.
+  void bind() const;
+
+  /// Unbinds the vertex arrays bound by bind().
+  void unbind() const;
+
+  /// Deletes the GL buffer.
+  void release();
+
+  /// Returns whether the buffer has been uploaded.
+  bool isValid() const { return __id != 0; }
+
+  /// Returns whether the buffer was built for a textured appearance.
+  bool isTextured() const { return __textured; }
+
+  /// Returns whether the buffer contains texture coordinates.
+  bool hasTexCoord() const { return __texcoord; }
+
+  /// Returns whether the buffer contains colors.
+  bool hasColor() const { return __color; }
+
+  /// Returns whether the faces are counter clockwise.
+  bool getCCW() const { return __ccw; }
+
+  /// Returns the number of vertices of the triangles.
+  GLsizei getVertexCount() const { return __count; }
+
+protected:
+
+  GLuint __id;
+  GLsizei __count;
+  bool __textured;
+  bool __texcoord;
+  bool __color;
+  bool __ccw;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// The transformation and the material of an instance of a GLMeshBuffer.
+struct GLMeshInstance {
+  /// The first three rows of the modelview matrix of the instance.
+  GLfloat transformation[12];
+  GLfloat ambient[4];
+  GLfloat diffuse[4];
+  /// The specular color with the shininess as fourth component.
+  GLfloat specular[4];
+  GLfloat emission[4];
+};
+
+/**
+   \class GLInstanceDrawer
+   \brief Draws all the instances of a GLMeshBuffer with a single instanced call.
+
+   The instances are stored in a buffer object read by a vertex program
+   which reproduces the fixed pipeline lighting of the current GL context.
+   A program is built for each lighting state met.
+*/
+
+class ALGO_API GLInstanceDrawer
+{
+
+public:
+
+  /// Constructs a drawer. Its GL resources are created at the first draw.
+  GLInstanceDrawer();
+
+  /** Returns whether the instanced drawing is supported by the current GL context.
+      The GL entry points are resolved at the first call. */
+  static bool isSupported();
+
+  /** Draws the triangles of \e buffer once for each of the \e instances.
+      Returns false if the instanced drawing is not available. */
+  bool draw(const GLMeshBuffer& buffer, const std::vector<GLMeshInstance>& instances);
+
+  /** Builds the GL program if needed.
+      Returns false if the instanced drawing is not available. */
+  bool init();
+
+  /// Deletes the GL program and buffer.
+  void release();
+
+protected:
+
+  /// Returns the program specialized for \e state, built at the first call.
+  GLuint getProgram(unsigned int state);
+
+  /// The programs for each lighting state.
+  std::map<unsigned int,GLuint> __programs;
+  GLuint __buffer;
+  bool __failed;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __glbufferobject_h__
+#endif
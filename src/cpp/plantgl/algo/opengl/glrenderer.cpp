@@ -146,10 +146,18 @@ TOOLS_USING_NAMESPACE
 #define GEOM_GLRENDERER_UPDATE_APPEARANCE(app) \
   __appearance = AppearancePtr(app);
 
+#define GEOM_GLRENDERER_BUFFER_RENDER(mesh) \
+  if(__Mode == BufferObject && renderBuffer(__bufferkey != 0 ? __bufferkey : mesh->getId(), mesh)) return true;
+
 template<class T>
 bool GLRenderer::discretize_and_render(T * geom){
   GEOM_ASSERT_OBJ(geom);
   GEOM_GLRENDERER_CHECK_CACHE(geom);
+  // The buffer of the discretization is stored with the id of geom to avoid discretizing it again.
+  if(__Mode == BufferObject){
+    if(renderBuffer(geom->getId())) return true;
+    __bufferkey = geom->getId();
+  }
   if(__appearance && __appearance->isTexture())
       __discretizer.computeTexCoord(true);
   else __discretizer.computeTexCoord(false);
@@ -157,6 +165,7 @@ bool GLRenderer::discretize_and_render(T * geom){
   if( b && (b=(__discretizer.getDiscretization()))){
       b=__discretizer.getDiscretization()->apply(*this);
   }
+  __bufferkey = 0;
   GEOM_GLRENDERER_UPDATE_CACHE(geom);
   return b;
 }
@@ -204,6 +213,9 @@ GLRenderer::GLRenderer( Discretizer& discretizer
 #ifndef PGL_WITHOUT_QT
   __glframe(glframe),
 #endif
+  __bufferkey(0),
+  __instancing(false),
+  __processing(false),
   __currentdisplaylist(false),
   __dopushpop(true),
   __executionmode(GL_COMPILE_AND_EXECUTE),
@@ -301,6 +313,14 @@ void GLRenderer::clear( )
     if (_it2->second) glDeleteTextures(1,&(_it2->second));
   }
   __cachetexture.clear();
+  for (Cache<GLMeshBuffer>::Iterator _it3 = __cachebuffer.begin();
+       _it3 != __cachebuffer.end();
+       _it3++){
+    _it3->second.release();
+  }
+  __cachebuffer.clear();
+  __instances.clear();
+  __instancedrawer.release();
   __currentdisplaylist = false;
   if(__compil != -1)__compil = 0;
 }
@@ -337,7 +357,7 @@ bool GLRenderer::check(size_t id, GLuint& displaylist){
 }
 
 bool GLRenderer::call(size_t id){
-  if(__Mode != DynamicPrimitive){
+  if(__Mode != DynamicPrimitive && __Mode != BufferObject){
 	Cache<GLuint>::Iterator _it = __cache.find((uint_t)id);
 	if (_it != __cache.end()) {
 	  glCallList(_it->second);
@@ -384,6 +404,137 @@ GLuint GLRenderer::getTextureId(ImageTexture * texture)
   else return 0;
 }
 
+bool GLRenderer::renderBuffer(size_t id, Mesh * mesh)
+{
+  bool textured = __appearance && __appearance->isTexture();
+  Cache<GLMeshBuffer>::Iterator it = __cachebuffer.find(id);
+  if(it == __cachebuffer.end() || it->second.isTextured() != textured){
+    if(!mesh) return false;
+    GLMeshBuffer buffer;
+    if(it != __cachebuffer.end()) buffer = it->second;
+    if(!buffer.build(*mesh,textured)){
+      buffer.release();
+      if(it != __cachebuffer.end()) __cachebuffer.remove(id);
+      return false;
+    }
+    if(it != __cachebuffer.end()) it->second = buffer;
+    else it = __cachebuffer.insert(id,buffer);
+  }
+  const GLMeshBuffer& buffer = it->second;
+  if(!textured && addInstance(id)) return true;
+
+  glFrontFace(buffer.getCCW() ? GL_CCW : GL_CW);
+  bool texgen = textured && !buffer.hasTexCoord();
+  if(texgen){
+    glEnable(GL_TEXTURE_GEN_S);
+    glEnable(GL_TEXTURE_GEN_T);
+  }
+  buffer.draw();
+  if(texgen){
+    glDisable(GL_TEXTURE_GEN_S);
+    glDisable(GL_TEXTURE_GEN_T);
+  }
+  GEOM_ASSERT(glGetError() == GL_NO_ERROR);
+  return true;
+}
+
+bool GLRenderer::addInstance(size_t id)
+{
+  if(!__instancing || !__processing || !__instancedrawer.init()) return false;
+  // The transparent shapes are drawn in the order of the scene, after the instances recorded before them.
+  Material * material = dynamic_cast<Material *>(__appearance.get());
+  if(!material || material->getTransparency() > 0) return false;
+  GLfloat m[16];
+  glGetFloatv(GL_MODELVIEW_MATRIX, m);
+  if(m[3] != 0 || m[7] != 0 || m[11] != 0 || m[15] != 1) return false;
+
+  Cache<std::vector<GLMeshInstance> >::Iterator it = __instances.find(id);
+  if(it == __instances.end()) it = __instances.insert(id,std::vector<GLMeshInstance>());
+  it->second.push_back(GLMeshInstance());
+  GLMeshInstance& instance = it->second.back();
+  // The GL matrices are stored by columns.
+  for(int i = 0; i < 3; ++i)
+    for(int j = 0; j < 4; ++j)
+      instance.transformation[4*i+j] = m[4*j+i];
+
+  const Color3& _ambient = material->getAmbient();
+  instance.ambient[0] = (GLfloat)_ambient.getRedClamped();
+  instance.ambient[1] = (GLfloat)_ambient.getGreenClamped();
+  instance.ambient[2] = (GLfloat)_ambient.getBlueClamped();
+  instance.ambient[3] = 1.0f;
+  const real_t& _diffuse = material->getDiffuse();
+  for(int i = 0; i < 3; ++i) instance.diffuse[i] = GLfloat(instance.ambient[i] * _diffuse);
+  instance.diffuse[3] = 1.0f;
+  const Color3& _specular = material->getSpecular();
+  instance.specular[0] = (GLfloat)_specular.getRedClamped();
+  instance.specular[1] = (GLfloat)_specular.getGreenClamped();
+  instance.specular[2] = (GLfloat)_specular.getBlueClamped();
+  instance.specular[3] = (GLfloat)material->getShininess();
+  const Color3& _emission = material->getEmission();
+  instance.emission[0] = (GLfloat)_emission.getRedClamped();
+  instance.emission[1] = (GLfloat)_emission.getGreenClamped();
+  instance.emission[2] = (GLfloat)_emission.getBlueClamped();
+  instance.emission[3] = 1.0f;
+  return true;
+}
+
+/// Draw the instances of \e buffer one by one with the fixed pipeline.
+static void drawInstancesDirectly(const GLMeshBuffer& buffer, const std::vector<GLMeshInstance>& instances)
+{
+  glPushMatrix();
+  glFrontFace(buffer.getCCW() ? GL_CCW : GL_CW);
+  GLfloat m[16];
+  m[3] = m[7] = m[11] = 0; m[15] = 1;
+  for (std::vector<GLMeshInstance>::const_iterator _it = instances.begin(); _it != instances.end(); ++_it){
+    for(int i = 0; i < 3; ++i)
+      for(int j = 0; j < 4; ++j)
+        m[4*j+i] = _it->transformation[4*i+j];
+    glLoadMatrixf(m);
+    glMaterialfv(GL_FRONT_AND_BACK,GL_AMBIENT,_it->ambient);
+    glMaterialfv(GL_FRONT_AND_BACK,GL_DIFFUSE,_it->diffuse);
+    glColor4fv(_it->diffuse);
+    GLfloat _specular[4] = { _it->specular[0], _it->specular[1], _it->specular[2], 1.0f };
+    glMaterialfv(GL_FRONT_AND_BACK,GL_SPECULAR,_specular);
+    glMaterialfv(GL_FRONT_AND_BACK,GL_EMISSION,_it->emission);
+    glMaterialf(GL_FRONT_AND_BACK,GL_SHININESS,_it->specular[3]);
+    buffer.draw();
+  }
+  glPopMatrix();
+}
+
+void GLRenderer::drawInstances()
+{
+  for (Cache<std::vector<GLMeshInstance> >::Iterator _it = __instances.begin();
+       _it != __instances.end();
+       _it++){
+    if(_it->second.empty()) continue;
+    Cache<GLMeshBuffer>::Iterator buffer = __cachebuffer.find(_it->first);
+    // The instances are drawn one by one if the instanced program cannot be built.
+    if(buffer != __cachebuffer.end() && !__instancedrawer.draw(buffer->second,_it->second))
+      drawInstancesDirectly(buffer->second,_it->second);
+    _it->second.clear();
+  }
+  GEOM_ASSERT(glGetError() == GL_NO_ERROR);
+}
+
+size_t GLRenderer::getBufferObjectCount() const
+{
+  size_t count = 0;
+  for (Cache<GLMeshBuffer>::const_Iterator _it = __cachebuffer.begin();
+       _it != __cachebuffer.end();
+       _it++)
+    if(_it->second.isValid()) ++count;
+  return count;
+}
+
+void GLRenderer::setInstancing(bool enabled)
+{
+  if(__instancing != enabled){
+    __instances.clear();
+    __instancing = enabled;
+  }
+}
+
 /* ----------------------------------------------------------------------- */
 void
 GLRenderer::setRenderingMode(RenderingMode mode)
@@ -395,7 +546,10 @@ GLRenderer::setRenderingMode(RenderingMode mode)
     if(!(__Mode & Dynamic) && (mode & DynamicScene)){
       clearSceneList();
     }
-    if(mode &  DynamicPrimitive)__compil = -1;
+    if(mode == BufferObject){
+      clearSceneList();
+    }
+    if((mode &  DynamicPrimitive) || mode == BufferObject)__compil = -1;
 	else if(__compil == -1)__compil = 0;
     __Mode = mode;
 #ifdef GEOM_DLDEBUG
@@ -403,6 +557,7 @@ GLRenderer::setRenderingMode(RenderingMode mode)
     else if (mode == DynamicScene) printf("Mode: DynamicScene\n");
     else if (mode == Dynamic) printf("Mode: Dynamic\n");
     else if (mode == Normal) printf("Mode: Normal\n");
+    else if (mode == BufferObject) printf("Mode: BufferObject\n");
     else if (mode == Selection) printf("Mode: Selection\n");
 #endif
   }
@@ -485,6 +640,7 @@ inline const T &pglMax(const T &a, const T &b) { return (a < b) ? b : a; }
 
 
 bool GLRenderer::beginProcess(){
+  __processing = true;
   if(__Mode == Selection){
     glInitNames();
   }
@@ -516,6 +672,8 @@ bool GLRenderer::endProcess(){
   }
   glDisable( GL_TEXTURE_2D );
   glBindTexture(GL_TEXTURE_2D, 0);
+  if(__instancing) drawInstances();
+  __processing = false;
   __appearance = AppearancePtr();
   // __discretizer.computeTexCoord(false);
   return true;
@@ -840,6 +998,7 @@ bool GLRenderer::process( ExtrudedHull * extrudedHull ) {
 bool GLRenderer::process( FaceSet * faceSet ) {
   GEOM_ASSERT_OBJ(faceSet);
   GEOM_GLRENDERER_PRECOMPILE(faceSet);
+  GEOM_GLRENDERER_BUFFER_RENDER(faceSet);
   GEOM_GLRENDERER_CHECK_CACHE(faceSet);
 
   glFrontFace(faceSet->getCCW() ? GL_CCW : GL_CW);
@@ -1026,6 +1185,8 @@ bool GLRenderer::process( IFS * ifs ) {
 
 bool GLRenderer::process( Material * material ) {
   GEOM_ASSERT_OBJ(material);
+  // The opaque shapes recorded as instances are drawn before the transparent shapes are blended with them.
+  if(__instancing && material->getTransparency() > 0) drawInstances();
   GEOM_GLRENDERER_CHECK_APPEARANCE(material);
 
   glDisable( GL_TEXTURE_2D );
@@ -1476,6 +1637,7 @@ bool GLRenderer::process( PGL(Polyline) * polyline ) {
 bool GLRenderer::process( QuadSet * quadSet ) {
   GEOM_ASSERT_OBJ(quadSet);
   GEOM_GLRENDERER_PRECOMPILE(quadSet);
+  GEOM_GLRENDERER_BUFFER_RENDER(quadSet);
 
   GEOM_GLRENDERER_CHECK_CACHE(quadSet);
 
@@ -1700,6 +1862,7 @@ bool GLRenderer::process( Tapered * tapered ) {
   GEOM_GLRENDERER_PRECOMPILE_END(tapered);
 
   GEOM_GLRENDERER_CHECK_CACHE(tapered);
+  if(__Mode == BufferObject && renderBuffer(tapered->getId())) return true;
 
   PrimitivePtr _primitive = tapered->getPrimitive();
   if(_primitive->apply(__discretizer)){
@@ -1707,7 +1870,9 @@ bool GLRenderer::process( Tapered * tapered ) {
 
       Transformation3DPtr _taper(tapered->getTransformation());
       ExplicitModelPtr _tExplicit = _explicit->transform(_taper);
+      if(__Mode == BufferObject) __bufferkey = tapered->getId();
       _tExplicit->apply(*this);
+      __bufferkey = 0;
 
       GEOM_GLRENDERER_UPDATE_CACHE(tapered);
       return true;
@@ -1745,6 +1910,7 @@ using namespace std;
 bool GLRenderer::process( TriangleSet * triangleSet ) {
   GEOM_ASSERT_OBJ(triangleSet);
   GEOM_GLRENDERER_PRECOMPILE(triangleSet);
+  GEOM_GLRENDERER_BUFFER_RENDER(triangleSet);
 
   GEOM_GLRENDERER_CHECK_CACHE(triangleSet);
 
@@ -42,6 +42,7 @@
 
 
 #include "util_gl.h"
+#include "glbufferobject.h"
 
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/tool/rcobject.h>
@@ -59,6 +60,7 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
 class Discretizer;
+class Mesh;
 
 /* ----------------------------------------------------------------------- */
 
@@ -97,12 +99,17 @@ public:
   \var RenderingMode Dynamic
     Rendering of dynamic object. Not using display list.
   */
+  /*!
+  \var RenderingMode BufferObject
+    Rendering of the meshes with vertex buffer objects. Not using display list.
+  */
   enum RenderingMode {
     Normal = 0x0001,
     Selection = 0x0002,
     DynamicScene = 0x0004,
 	DynamicPrimitive = 0x0008,
     Dynamic = DynamicPrimitive | DynamicScene,
+    BufferObject = 0x0010
   };
 
 
@@ -128,6 +135,16 @@ public:
   /// Get the rendering mode
   const RenderingMode& getRenderingMode() const;
 
+  /** Set whether the meshes shared by several shapes are drawn with a single
+      instanced call at the end of the process in BufferObject mode. */
+  void setInstancing(bool);
+
+  /// Get whether the shared meshes are drawn with instanced calls.
+  bool getInstancing() const { return __instancing; }
+
+  /// Returns the number of buffer objects uploaded in BufferObject mode.
+  size_t getBufferObjectCount() const;
+
   void setSelectionMode(SelectionId);
 
   const SelectionId getSelectionMode() const;
@@ -290,6 +307,15 @@ protected:
   /// A cache used to store texture.
   TOOLS(Cache)<GLuint> __cachetexture;
 
+  /// A cache used to store the vertex buffer objects of the meshes.
+  TOOLS(Cache)<GLMeshBuffer> __cachebuffer;
+
+  /// The instances of the buffer objects collected during a process in instancing mode.
+  TOOLS(Cache)<std::vector<GLMeshInstance> > __instances;
+
+  /// The drawer of the collected instances.
+  GLInstanceDrawer __instancedrawer;
+
   /// A cache used to store display list of all scene.
   GLuint __scenecache;
 
@@ -310,10 +336,29 @@ protected:
   QGLWidget * __glframe;
 #endif
   
+  /** Draws the buffer object cached for \e id. If it does not exist or does not fit
+      the current appearance, it is built from \e mesh if not null. */
+  bool renderBuffer(size_t id, Mesh * mesh = NULL);
+
+  /** Records the current transformation and material as an instance of the buffer
+      object cached for \e id. Returns false if it must be drawn directly. */
+  bool addInstance(size_t id);
+
+  /// Draws the collected instances and clears them.
+  void drawInstances();
+
 private:
   template<class T> 
   bool discretize_and_render(T * geom);
 
+  /// Id of the geometry whose discretization is rendered in BufferObject mode.
+  size_t __bufferkey;
+
+  bool __instancing;
+
+  /// Whether the renderer is between beginProcess and endProcess.
+  bool __processing;
+
   bool __currentdisplaylist;
 
   bool __dopushpop;
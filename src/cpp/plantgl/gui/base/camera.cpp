@@ -1022,6 +1022,25 @@ Vector3 ViewCameraGL::getRight(){
         return right;
 }
 
+std::vector<Vector4> ViewCameraGL::getFrustumPlanes() const {
+  GLdouble projection[16], modelview[16];
+  glGetDoublev(GL_PROJECTION_MATRIX,projection);
+  glGetDoublev(GL_MODELVIEW_MATRIX,modelview);
+  // rows of projection * modelview. GL matrices are stored by columns.
+  real_t rows[4][4];
+  for(int i = 0; i < 4; ++i)
+    for(int j = 0; j < 4; ++j){
+      rows[i][j] = 0;
+      for(int k = 0; k < 4; ++k) rows[i][j] += projection[4*k+i] * modelview[4*j+k];
+    }
+  std::vector<Vector4> planes;
+  for(int i = 0; i < 3; ++i)
+    for(int sign = -1; sign <= 1; sign += 2)
+      planes.push_back(Vector4(rows[3][0] + sign * rows[i][0], rows[3][1] + sign * rows[i][1],
+                               rows[3][2] + sign * rows[i][2], rows[3][3] + sign * rows[i][3]));
+  return planes;
+}
+
 Matrix4 ViewCameraGL::getMatrix(){
         if( __geomsys){ /// Geom Sys Coordinates
 
@@ -47,6 +47,7 @@
 #endif
 
 #include <QtCore/qstring.h>
+#include <vector>
 
 #include <plantgl/scenegraph/geometry/boundingbox.h>
 #include "object.h"
@@ -207,6 +208,11 @@ public:
   /// Get The Camera matrix
   Matrix4 getMatrix();
 
+  /** Get the six planes of the current view frustum in scene coordinates, computed
+      from the GL projection and modelview matrices. A plane (a,b,c,d) keeps the
+      points for which a.x+b.y+c.z+d >= 0. The GL context must be current. */
+  std::vector<TOOLS(Vector4)> getFrustumPlanes() const;
+
   virtual void cameraEvent(ViewEvent *);
 
   void setAngles(double azimuth, double elevation);
@@ -53,6 +53,18 @@
 #include <QtCore/qregexp.h>
 #include <QtCore/qtimer.h>
 #include <QtCore/qurl.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qdatetime.h>
+
+#include "event.h"
+#include "../viewer/geomevent.h"
+#include "../viewer/scenestream.h"
+#include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
+#include <sstream>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
 
 
 /* ----------------------------------------------------------------------- */
@@ -60,7 +72,10 @@
 
 ViewerDaemon::ViewerDaemon( QObject* parent ) :
 QTcpServer(parent),
-currentSocket(NULL)
+currentSocket(NULL),
+streaming(false),
+sceneStream(NULL),
+droppedFrames(0)
 {
 	QObject::connect(this,SIGNAL(newConnection()),this,SLOT(processNextConnection()));
 	listen(QHostAddress::LocalHost,7777);
@@ -70,6 +85,11 @@ currentSocket(NULL)
 	}
 }
 
+ViewerDaemon::~ViewerDaemon()
+{
+  delete sceneStream;
+}
+
 void 
 ViewerDaemon::processNextConnection( )
 {
@@ -77,6 +97,8 @@ ViewerDaemon::processNextConnection( )
   // communication with the client is done over this QSocket. QSocket
   // works asynchronouslyl, this means that all the communication is done
   // in the two slots readClient() and discardClient().
+  // The new client does not continue the stream of the previous one.
+  endStream();
   currentSocket = nextPendingConnection();
   connect( currentSocket, SIGNAL(readyRead()), this, SLOT(readClient()) );
   connect( currentSocket, SIGNAL(disconnected()), this, SLOT(discardClient()) );
@@ -86,12 +108,27 @@ ViewerDaemon::processNextConnection( )
 void ViewerDaemon::readClient()
 {
   if(currentSocket == NULL) return;
+  if(streaming) { readStream(); return; }
   QTcpSocket* socket = currentSocket;
   if ( socket->canReadLine() ) {
 	QString line = socket->readLine();
 	emit receiveRequest(line);
 	QStringList tokens = line.split( QRegExp("[ \r\n][ \r\n]*") );
-	if ( tokens[0] == "GET" ) {
+	if ( tokens[0] == "STREAM" ) {
+		// The connection stays open to receive the frames.
+		socket->write("Accepted\r\n");
+		streaming = true;
+		streamBuffer.clear();
+		if(sceneStream == NULL) sceneStream = new ViewSceneStream();
+		else sceneStream->clear();
+		// The camera is not adjusted and the unchanged shapes are not compiled again for each frame.
+		if(parent()){
+			ViewAnimationEvent e(eAnimatedScene);
+			QApplication::sendEvent(parent(),&e);
+		}
+		readStream();
+	}
+	else if ( tokens[0] == "GET" ) {
 		QTextStream os( socket );
 		os.setAutoDetectUnicode (true);
 		os << "Accepted\r\n";
@@ -130,13 +167,175 @@ void ViewerDaemon::readClient()
   }
 }
 
+void ViewerDaemon::readStream()
+{
+  streamBuffer += currentSocket->readAll();
+  // The frames received while the viewer was busy are merged: only the last scene is displayed.
+  ViewSceneDelta delta;
+  int nbframes = 0;
+  quint32 lastframe = 0;
+  int pos = 0;
+  while ( streamBuffer.size() - pos >= 8 ) {
+	const uchar * header = (const uchar *)streamBuffer.constData() + pos;
+	quint32 size = qFromLittleEndian<quint32>(header);
+	if ( (quint64)(streamBuffer.size() - pos - 8) < size ) break;
+	lastframe = qFromLittleEndian<quint32>(header + 4);
+	lemmapstream input(streamBuffer.constData() + pos + 8, size);
+	std::stringstream errlog;
+	ViewSceneDelta framedelta;
+	if ( !framedelta.read(input,errlog) ) {
+		emit receiveRequest("Invalid stream frame "+QString::number(lastframe)+" : "+QString(errlog.str().c_str()));
+		streamBuffer.clear();
+		currentSocket->close();
+		return;
+	}
+	if ( nbframes == 0 ) delta = framedelta;
+	else delta.merge(framedelta);
+	++nbframes;
+	pos += 8 + size;
+  }
+  streamBuffer.remove(0,pos);
+  if ( nbframes == 0 ) return;
+  droppedFrames += nbframes - 1;
+
+  sceneStream->apply(delta);
+  if(parent()){
+	GeomSceneChangeEvent e(sceneStream->getScene());
+	QApplication::sendEvent(parent(),&e);
+  }
+  // The acknowledgement lets the client send its next frames.
+  uchar ack[4];
+  qToLittleEndian<quint32>(lastframe,ack);
+  if(currentSocket) currentSocket->write((const char *)ack,4);
+}
+
 void ViewerDaemon::discardClient()
 {
   delete currentSocket;
   currentSocket = NULL;
+  endStream();
   emit endConnect();
 }
 
+void ViewerDaemon::endStream()
+{
+  if(streaming && sceneStream) sceneStream->clear();
+  streaming = false;
+  streamBuffer.clear();
+}
+
+/* ----------------------------------------------------------------------- */
+
+ViewStreamClient::ViewStreamClient( int window ) :
+  __socket(new QTcpSocket()),
+  __state(new ViewSceneStream()),
+  __frame(0),
+  __acknowledged(0),
+  __dropped(0),
+  __window(window > 0 ? window : 1)
+{
+}
+
+ViewStreamClient::~ViewStreamClient()
+{
+  close();
+  delete __socket;
+  delete __state;
+}
+
+bool ViewStreamClient::connectToViewer( const QString& host, quint16 port, int timeout )
+{
+  close();
+  __socket->connectToHost(host,port);
+  if ( !__socket->waitForConnected(timeout) ) return false;
+  __socket->write("STREAM\r\n");
+  while ( !__socket->canReadLine() ) {
+	if ( !__socket->waitForReadyRead(timeout) ) { close(); return false; }
+  }
+  if ( QString(__socket->readLine()) != "Accepted\r\n" ) { close(); return false; }
+  __state->clear();
+  __pending = ScenePtr();
+  __frame = __acknowledged = 0;
+  return true;
+}
+
+bool ViewStreamClient::isConnected() const
+{
+  return __socket->state() == QAbstractSocket::ConnectedState;
+}
+
+bool ViewStreamClient::send( const ScenePtr& scene )
+{
+  if ( !isConnected() ) return false;
+  readAcknowledgements(0);
+  if ( __frame - __acknowledged >= (uint_t)__window ) {
+	// The viewer lags: the scene replaces the one kept before.
+	if ( __pending ) ++__dropped;
+	__pending = scene;
+	return true;
+  }
+  if ( __pending ) { ++__dropped; __pending = ScenePtr(); }
+  return sendFrame(scene);
+}
+
+bool ViewStreamClient::flush( int timeout )
+{
+  QTime timer;
+  timer.start();
+  while ( isConnected() && (__pending || __frame != __acknowledged) ) {
+	if ( __pending && __frame - __acknowledged < (uint_t)__window ) {
+	  ScenePtr scene = __pending;
+	  __pending = ScenePtr();
+	  if ( !sendFrame(scene) ) return false;
+	  continue;
+	}
+	int remaining = timeout - timer.elapsed();
+	if ( remaining <= 0 ) return false;
+	readAcknowledgements(remaining);
+  }
+  return isConnected();
+}
+
+void ViewStreamClient::close()
+{
+  if ( __socket->state() != QAbstractSocket::UnconnectedState ) {
+	__socket->disconnectFromHost();
+	if ( __socket->state() != QAbstractSocket::UnconnectedState )
+	  __socket->waitForDisconnected(1000);
+  }
+  __pending = ScenePtr();
+}
+
+bool ViewStreamClient::sendFrame( const ScenePtr& scene )
+{
+  ViewSceneDelta delta = __state->update(scene);
+  if ( delta.empty() ) return true;
+  leomstream stream;
+  delta.write(stream);
+  std::string payload = stream.str();
+  ++__frame;
+  uchar header[8];
+  qToLittleEndian<quint32>((quint32)payload.size(),header);
+  qToLittleEndian<quint32>(__frame,header+4);
+  __socket->write((const char *)header,8);
+  __socket->write(payload.c_str(),payload.size());
+  // Without event loop, the data is only written while waiting for it.
+  while ( __socket->bytesToWrite() > 0 ) {
+	if ( !__socket->waitForBytesWritten(30000) ) return false;
+  }
+  return true;
+}
+
+void ViewStreamClient::readAcknowledgements( int timeout )
+{
+  if ( __socket->bytesAvailable() < 4 ) __socket->waitForReadyRead(timeout);
+  while ( __socket->bytesAvailable() >= 4 ) {
+	uchar ack[4];
+	__socket->read((char *)ack,4);
+	__acknowledged = qFromLittleEndian<quint32>(ack);
+  }
+}
+
 #ifdef VIEW_NETWORK_SUPPORT
 
 /* ----------------------------------------------------------------------- */
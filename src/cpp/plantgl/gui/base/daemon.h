@@ -45,6 +45,7 @@ class QLabel;
 class QTextView;
 class QPushButton;
 class QSocket;
+class ViewSceneStream;
 #include <QtNetwork/qtcpserver.h>
 #if QT_VERSION >= QT_VERSION_CHECK(5,0,0) 
     #include <QtWidgets/qdialog.h>
@@ -53,19 +54,37 @@ class QSocket;
 #endif
 
 #include "../gui_config.h"
+#include <plantgl/scenegraph/scene/scene.h>
 /* ----------------------------------------------------------------------- */
 
 // #define VIEW_NETWORK_SUPPORT
 
 
+/**
+   \class ViewerDaemon
+   \brief A server receiving the requests of other processes to the viewer.
+
+   A request is a line "GET /READ file", "GET /ADD file" or "GET /SHOW".
+   After a line "STREAM", the connection stays open and receives the successive
+   scenes of a process as binary frames: the size of the payload and the number
+   of the frame, as little endian 32 bits integers, followed by a ViewSceneDelta.
+   All the frames received while the viewer was busy are merged and only the last
+   scene is displayed. The number of the last frame displayed is sent back to
+   acknowledge it.
+*/
 class VIEW_API ViewerDaemon : public QTcpServer
 {
     Q_OBJECT
 public:
     ViewerDaemon( QObject* parent=0 );
 
+    virtual ~ViewerDaemon();
+
     void newConnection( int socket );
 
+    /// Return the number of streamed frames that were not displayed.
+    uint_t getDroppedFrames() const { return droppedFrames; }
+
 signals:
     void newConnect();
     void endConnect();
@@ -82,8 +101,83 @@ private slots:
     void processNextConnection();
 
 protected:
+    /// Read the frames of a stream and display the last scene.
+    void readStream();
+
+    /// End the stream of the current connection, if any.
+    void endStream();
+
 	QTcpSocket * currentSocket;
 
+    /// Whether the current connection streams scenes.
+    bool streaming;
+
+    /// The bytes of the incomplete frame of the stream.
+    QByteArray streamBuffer;
+
+    /// The scene built from the frames of the stream.
+    ViewSceneStream * sceneStream;
+
+    uint_t droppedFrames;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ViewStreamClient
+   \brief Stream the successive scenes of a process to the viewer daemon.
+
+   Only the changes of each scene from the previous one sent are transmitted.
+   When the viewer has not acknowledged the last \e window frames, the scenes are
+   not sent: the last one is sent as soon as the viewer catches up and the others
+   are dropped. The socket is used in blocking mode and needs no event loop.
+*/
+class VIEW_API ViewStreamClient
+{
+public:
+    ViewStreamClient( int window = 2 );
+
+    virtual ~ViewStreamClient();
+
+    /// Connect to the daemon of a viewer and start a stream.
+    bool connectToViewer( const QString& host = "localhost", quint16 port = 7777, int timeout = 3000 );
+
+    bool isConnected() const;
+
+    /** Send \e scene as the next frame. If the viewer lags, \e scene is kept
+        to be sent by a next call and replaces the scene kept before. */
+    bool send( const PGL(ScenePtr)& scene );
+
+    /// Send the scene kept, if any, and wait for the viewer to display the last frame.
+    bool flush( int timeout = 30000 );
+
+    void close();
+
+    /// Return the number of frames sent.
+    uint_t getSentFrames() const { return __frame; }
+
+    /// Return the number of scenes that were not sent because the viewer lagged.
+    uint_t getDroppedFrames() const { return __dropped; }
+
+protected:
+    bool sendFrame( const PGL(ScenePtr)& scene );
+
+    /// Read the acknowledgements of the viewer, waiting at most \e timeout ms for one.
+    void readAcknowledgements( int timeout );
+
+    QTcpSocket * __socket;
+
+    /// The last scene sent.
+    ViewSceneStream * __state;
+
+    /// The scene waiting for the viewer to catch up.
+    PGL(ScenePtr) __pending;
+
+    uint_t __frame;
+    uint_t __acknowledged;
+    uint_t __dropped;
+    int __window;
 };
 
 /* ----------------------------------------------------------------------- */
@@ -860,10 +860,35 @@ void ViewGLFrame::paintGL()
   SelectGL
 */
 
+std::vector<TOOLS(Vector4)> ViewGLFrame::getPickingPlanes() const
+{
+  std::vector<TOOLS(Vector4)> planes = __camera->getFrustumPlanes();
+  for(int i = 1; i <= 6; ++i)
+    if(__clippingPlane->isPlaneEnable(i))
+      planes.push_back(TOOLS(Vector4)(__clippingPlane->valA(i),__clippingPlane->valB(i),
+                                      __clippingPlane->valC(i),__clippingPlane->valD(i)));
+  return planes;
+}
+
 void ViewGLFrame::selectGL()
 {
   makeCurrent();
 
+  if (__scene){
+    // The renderer may find the picked shapes without drawing the scene.
+    __camera->beginSelectGL(__mouse);
+    std::vector<TOOLS(Vector4)> planes = getPickingPlanes();
+    __camera->endSelectGL();
+    std::vector<uint_t> ids;
+    if(__scene->pick(planes,true,ids)){
+      if(!ids.empty()){
+        __scene->selectionEvent(ids[0]);
+        emit selectedShape(__scene->translateId(ids[0]));
+      }
+      return;
+    }
+  }
+
   GLint hits;
   GLsizei bufsize = 512;
   GLuint selectBuf[512];
@@ -931,6 +956,30 @@ void ViewGLFrame::multipleSelectGL(const QPoint& p)
 {
   makeCurrent();
 
+  if (__scene){
+    __camera->beginSelectGL(QRect(min(__mouse.x(),p.x()),
+								  min(__mouse.y(),p.y()),
+								  abs(__mouse.x()-p.x()),
+								  abs(__mouse.y()-p.y())));
+    std::vector<TOOLS(Vector4)> planes = getPickingPlanes();
+    __camera->endSelectGL();
+    vector<uint_t> actualvals;
+    if(__scene->pick(planes,false,actualvals)){
+      if(actualvals.size()==1){
+        __scene->selectionEvent(actualvals[0]);
+        emit selectedShape(__scene->translateId(actualvals[0]));
+      }
+      else if(!actualvals.empty()){
+        vector<uint_t> vals;
+        for(vector<uint_t>::const_iterator it = actualvals.begin(); it != actualvals.end(); ++it)
+          vals.push_back(__scene->translateId(*it));
+        __scene->selectionEvent(actualvals);
+        emit selectedShapes(vals);
+      }
+      return;
+    }
+  }
+
   GLint hits;
   GLsizei bufsize = 400000;
   GLuint selectBuf[400000];
@@ -337,6 +337,10 @@ signals:
   virtual void selectGL();
   virtual void multipleSelectGL(const QPoint&);
 
+  /** Returns the planes delimiting the region picked with the current projection: the ones of the
+      view frustum and the enabled clipping planes. */
+  std::vector<TOOLS(Vector4)> getPickingPlanes() const;
+
   /// Set up the OpenGL view port, matrix mode, etc.
   virtual void resizeGL( int w, int h );
 
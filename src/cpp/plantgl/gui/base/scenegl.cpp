@@ -104,6 +104,12 @@ ViewRendererGL::selectGL()
 {
 }
 
+bool
+ViewRendererGL::pick(const std::vector<TOOLS(Vector4)>&, bool, std::vector<uint_t>&)
+{
+  return false;
+}
+
 void
 ViewRendererGL::selectionEvent(uint_t i)
 {
@@ -109,6 +109,11 @@ public :
   /// Paint scene for Selection.
   virtual void selectGL();
 
+  /** Find on CPU the objects having a primitive in the region delimited by \e planes, as the GL selection does.
+      \e planes[5] is the near plane, used to keep only the nearest object if \e nearest.
+      Return false if this renderer can only select with the GL selection mode. */
+  virtual bool pick(const std::vector<TOOLS(Vector4)>& planes, bool nearest, std::vector<uint_t>& ids);
+
   /// End of Selection. Return whether viewer must stay in selection mode (true) or not (false).
   virtual bool endSelect();
 
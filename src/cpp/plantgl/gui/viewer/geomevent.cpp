@@ -88,3 +88,30 @@ GeomMultiSceneChangeEvent::copy()
 
 /* ----------------------------------------------------------------------- */
 
+GeomSceneBatchEvent::GeomSceneBatchEvent(ScenePtr _batch,
+					 BoundingBoxPtr _bbox,
+					 uint_t _loaded,
+					 uint_t _total,
+					 const QString& _errlog,
+					 const QString& _file,
+					 bool add):
+  GeomSceneChangeEvent(_batch, _errlog, _file, add),
+    bbox(_bbox),
+    loaded(_loaded),
+    total(_total)
+{
+  setSceneType(eSceneBatchEvent);
+}
+
+GeomSceneBatchEvent::~GeomSceneBatchEvent()
+{
+}
+
+ViewSceneChangeEvent * 
+GeomSceneBatchEvent::copy()
+{
+  return new GeomSceneBatchEvent(*this);
+}
+
+/* ----------------------------------------------------------------------- */
+
@@ -43,6 +43,7 @@
 
 #include "../base/event.h"
 #include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/geometry/boundingbox.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -62,6 +63,7 @@ class VIEW_API GeomSceneChangeEvent : public ViewSceneChangeEvent {
 			 eFirstGeomSceneEvent = 0,
 			 eGeomSceneEvent = eFirstGeomSceneEvent,
 			 eMultiSceneEvent,
+			 eSceneBatchEvent,
 			 eLastGeomSceneEvent
 	  };
 
@@ -120,6 +122,40 @@ class VIEW_API GeomMultiSceneChangeEvent : public GeomSceneChangeEvent {
 
 };
 
+/** 
+    \class GeomSceneBatchEvent
+    \brief Event for a batch of shapes of a scene loaded progressively.
+*/
+class VIEW_API GeomSceneBatchEvent : public GeomSceneChangeEvent {
+  
+  public :
+    
+  /// Constructor.
+  GeomSceneBatchEvent(PGL(ScenePtr) batch,
+		      PGL(BoundingBoxPtr) bbox,
+		      uint_t loaded,
+		      uint_t total,
+		      const QString& errlog = QString::null, 
+		      const QString& file = QString::null,
+		      bool add = false);
+  
+  /// Destructor.
+  ~GeomSceneBatchEvent();
+    
+  /// copy object.
+  virtual ViewSceneChangeEvent * copy();
+
+  /// The bounding box of the batch.
+  PGL(BoundingBoxPtr) bbox;
+
+  /// The number of shapes loaded with this batch.
+  uint_t loaded;
+
+  /// The number of shapes of the whole scene.
+  uint_t total;
+
+};
+
 /* ----------------------------------------------------------------------- */
 
 typedef TViewGeomEvent<ViewGeomEvent::eGetScene,PGL(ScenePtr)> GeomGetSceneEvent;
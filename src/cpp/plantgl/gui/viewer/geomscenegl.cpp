@@ -36,13 +36,19 @@
 /// Tools
 #include <plantgl/tool/util_string.h>
 #include <plantgl/algo/opengl/util_appegl.h>
+#include <plantgl/algo/opengl/util_glut.h>
 
 /// GEOM
 #include <plantgl/scenegraph/scene/shape.h>
 #include <plantgl/scenegraph/appearance/appearance.h>
 #include <plantgl/scenegraph/geometry/explicitmodel.h>
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/geometry/pointset.h>
 #include <plantgl/algo/base/wirecomputer.h>
 #include <plantgl/algo/base/tesselator.h>
+#include <plantgl/tool/util_parallel.h>
+#include <limits>
+#include <algorithm>
 
 /// Viewer
 #include "../base/light.h"
@@ -54,6 +60,8 @@
 /// Qt
 #include <QtCore/QHash>
 #include <QtCore/QSet>
+#include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
 
 #include <QtGui/qpainter.h>
 #include <QtGui/qclipboard.h>
@@ -104,7 +112,10 @@ ViewGeomSceneGL::ViewGeomSceneGL(ViewCameraGL * camera,
   __ctrlPtRenderer(__discretizer),
   __bbox(new BoundingBox(Vector3(-1,-1,-1),Vector3(1,1,1))),
   __selectedShapes(),
-  __blending(true)
+  __blending(true),
+  __frustumCulling(false),
+  __proxySize(0),
+  __batchListsReady(false)
 #ifdef QT_THREAD_SUPPORT
   ,__reader(0)
 #endif
@@ -145,7 +156,21 @@ void ViewGeomSceneGL::connectTo(QGLWidget * glw)
 bool
 ViewGeomSceneGL::sceneChangeEvent( ViewSceneChangeEvent * k)
 {
-	if(k->getSceneType() == GeomSceneChangeEvent::eGeomSceneEvent){
+	if(k->getSceneType() == GeomSceneChangeEvent::eSceneBatchEvent){
+		GeomSceneBatchEvent * event = ( GeomSceneBatchEvent * )k;
+		if(event->addition)appendScene(event->scene,event->bbox);
+		else setScene(event->scene);
+		if(!event->error.isEmpty()){
+			error(event->error);
+		}
+		progress(event->loaded,event->total);
+		if(event->loaded < event->total)
+			status(tr("Loading")+" "+QString::number(event->loaded)+"/"+QString::number(event->total)+" "+tr("geometric shapes."));
+		else status(tr("Display")+" "+QString::number(__scene->size())+" "+tr("geometric shapes."),10000);
+		setFilename(event->file);
+		return true;
+	}
+	else if(k->getSceneType() == GeomSceneChangeEvent::eGeomSceneEvent){
 		GeomSceneChangeEvent * event = ( GeomSceneChangeEvent * )k;
 		if(event->addition)addScene(ScenePtr(event->scene));
 		else setScene(event->scene);
@@ -163,6 +188,8 @@ ViewGeomSceneGL::clear()
 {
   __scene = ScenePtr();
   __dynamicscene = ScenePtr();
+  __shapeTree = AABBTreePtr();
+  __pickingMeshes.clear();
   __bbox= BoundingBoxPtr(new BoundingBox(Vector3(-1,-1,-1),Vector3(1,1,1)));
   setFilename("");
   clearCache();
@@ -181,6 +208,8 @@ ViewGeomSceneGL::clearCache()
 void
 ViewGeomSceneGL::clearDisplayList()
 {
+  clearShapeLists();
+  clearBatches();
   __renderer.clear();
   __skelComputer.clear();
   __bboxComputer.clear();
@@ -264,7 +293,8 @@ ViewGeomSceneGL::getSelectionBoundingBox()
 /* ----------------------------------------------------------------------- */
 void
 ViewGeomSceneGL::changeDisplayListUse(){
-  if(__renderer.getRenderingMode() & GLRenderer::Dynamic){
+  bool bufferobject = getBufferObjectUse();
+  if(!getDisplayListUse()){
 	__renderer.setRenderingMode(GLRenderer::Normal);
 	emit displayList(true);
   }
@@ -272,6 +302,7 @@ ViewGeomSceneGL::changeDisplayListUse(){
 	__renderer.setRenderingMode(GLRenderer::Dynamic);
 	emit displayList(false);
   }
+  if(bufferobject) emit bufferObject(false);
 }
 
 void
@@ -283,7 +314,63 @@ ViewGeomSceneGL::useDisplayList(bool b){
 
 bool 
 ViewGeomSceneGL::getDisplayListUse() const {
-  return !(__renderer.getRenderingMode() & GLRenderer::Dynamic);
+  return !(__renderer.getRenderingMode() & (GLRenderer::Dynamic | GLRenderer::BufferObject));
+}
+
+bool 
+ViewGeomSceneGL::getBufferObjectUse() const {
+  return __renderer.getRenderingMode() == GLRenderer::BufferObject;
+}
+
+void
+ViewGeomSceneGL::useBufferObject(bool b){
+  if( getBufferObjectUse() != b){
+	bool displaylist = getDisplayListUse();
+	__renderer.setRenderingMode(b ? GLRenderer::BufferObject : GLRenderer::Normal);
+	if(displaylist != getDisplayListUse()) emit displayList(!displaylist);
+	emit bufferObject(b);
+	emit valueChanged();
+  }
+}
+
+bool 
+ViewGeomSceneGL::getInstancingUse() const {
+  return __renderer.getInstancing();
+}
+
+void
+ViewGeomSceneGL::useInstancing(bool b){
+  if( getInstancingUse() != b){
+	__renderer.setInstancing(b);
+	emit instancing(b);
+	if(b) useBufferObject(true);
+	emit valueChanged();
+  }
+}
+
+void
+ViewGeomSceneGL::useFrustumCulling(bool b){
+  if( __frustumCulling != b){
+	__frustumCulling = b;
+	emit frustumCulling(b);
+	emit valueChanged();
+  }
+}
+
+void
+ViewGeomSceneGL::setProxySize(int size){
+  size = max(0,size);
+  if( __proxySize != size){
+	bool proxies = __proxySize > 0;
+	__proxySize = size;
+	if(proxies != (size > 0)) emit boundingBoxProxies(size > 0);
+	emit valueChanged();
+  }
+}
+
+void
+ViewGeomSceneGL::useBoundingBoxProxies(bool b){
+  if( (__proxySize > 0) != b) setProxySize(b ? 4 : 0);
 }
 
 void 
@@ -295,9 +382,10 @@ void ViewGeomSceneGL::enableBlending(bool b) { __blending = b; emit valueChanged
 
 void ViewGeomSceneGL::animationChangedEvent(eAnimationFlag a)
 {
-	if(a == eAnimatedScene) __renderer.setRenderingMode(GLRenderer::DynamicScene);
-	else if(a == eAnimatedPrimitives) __renderer.setRenderingMode(GLRenderer::Dynamic);
+	// In an animated scene, the geometries are cached by the viewer with their display lists.
+	if(a == eAnimatedScene || a == eAnimatedPrimitives) __renderer.setRenderingMode(GLRenderer::Dynamic);
 	else __renderer.setRenderingMode(GLRenderer::Normal);
+	if(a != eAnimatedScene) clearShapeLists();
 }
 
 /* ----------------------------------------------------------------------- */
@@ -367,6 +455,10 @@ ViewGeomSceneGL::setScene( const ScenePtr& scene )
 
   // Sets the scene
   __scene = scene;
+  __shapeTree = AABBTreePtr();
+  __pickingMeshes.clear();
+  clearBatches();
+  if (isAnimated() == eAnimatedScene) updateShapeLists();
 
   if (is_null_ptr(__bbox)){
 	  // Computes the global bounding box
@@ -394,6 +486,53 @@ ViewGeomSceneGL::setScene( const ScenePtr& scene )
   return 1;
 }
 
+int
+ViewGeomSceneGL::appendScene( const ScenePtr& scene, const BoundingBoxPtr& bbox )
+{
+  if (isEmpty()) return setScene(scene);
+  if (isAnimated() != eStatic) return addScene(scene);
+  if (!scene || scene->empty()) return 0;
+
+  if (__batches.empty()){
+    // The shapes already displayed form the first batch. The scene given to setScene is not modified.
+    ShapeBatch batch;
+    batch.scene = __scene;
+    batch.list = 0;
+    __batches.push_back(batch);
+    __scene = ScenePtr(new Scene());
+    __scene->merge(batch.scene);
+  }
+  __scene->merge(scene);
+  ShapeBatch batch;
+  batch.scene = scene;
+  batch.list = 0;
+  __batches.push_back(batch);
+  __shapeTree = AABBTreePtr();
+  __pickingMeshes.clear();
+
+  // The camera is not moved: it was fitted on the first shapes.
+  BoundingBoxPtr batchbbox = bbox;
+  if (!batchbbox && __bboxComputer.process(scene)) batchbbox = __bboxComputer.getBoundingBox();
+  if (batchbbox){
+    if (__bbox) __bbox->extend(batchbbox);
+    else __bbox = BoundingBoxPtr(new BoundingBox(*batchbbox));
+  }
+
+  for (Scene::const_iterator itsh = scene->begin(); itsh != scene->end(); ++itsh)
+    if ((*itsh)->hasDynamicRendering())
+        __dynamicscene->add(*itsh);
+
+  // The other modes still draw the whole scene in a single list.
+  __renderer.clearSceneList();
+  __skelRenderer.clearSceneList();
+  __bboxRenderer.clearSceneList();
+  __ctrlPtRenderer.clearSceneList();
+
+  emit sceneChanged();
+  if(__frame != NULL && __frame->isVisible())emit valueChanged();
+  return 1;
+}
+
 void  
 ViewGeomSceneGL::computeCamera()
 {
@@ -418,6 +557,9 @@ ViewGeomSceneGL::initializeGL()
 void
 ViewGeomSceneGL::paintGL()
 {
+    for(std::vector<GLuint>::const_iterator it = __obsoleteLists.begin(); it != __obsoleteLists.end(); ++it)
+      glDeleteLists(*it,1);
+    __obsoleteLists.clear();
 
     if (__scene && !__scene->empty()){
 
@@ -427,7 +569,18 @@ ViewGeomSceneGL::paintGL()
       if(__blending)glBlendFunc(GL_SRC_ALPHA,GL_ONE_MINUS_SRC_ALPHA);
       else glBlendFunc(GL_ONE,GL_ZERO);
       glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
-      if(__renderer.beginSceneList()){
+      if(isAnimated() == eAnimatedScene){
+        paintShapeLists();
+      }
+      else if((__frustumCulling || __proxySize > 0) && !(__renderer.getRenderingMode() & GLRenderer::Dynamic)){
+        // The visible shapes change with the camera. The scene cannot be stored in a single display list.
+        paintVisibleShapes();
+      }
+      else if(!__batches.empty() && __renderer.getRenderingMode() == GLRenderer::Normal){
+        // The scene grows while it is loaded. Only its new batches are compiled.
+        paintBatches();
+      }
+      else if(__renderer.beginSceneList()){
 		if(__renderer.getRenderingMode() & GLRenderer::Dynamic){
 			__scene->apply(__renderer);
         }
@@ -540,6 +693,387 @@ ViewGeomSceneGL::paintGL()
   }
 }
 
+void
+ViewGeomSceneGL::computeShapeTree()
+{
+  std::vector<Vector3> lowers, uppers;
+  __shapeTreeIndices.clear();
+  __unboundedShapes.clear();
+  uint_t i = 0;
+  for(Scene::const_iterator it = __scene->begin(); it != __scene->end(); ++it, ++i){
+    if((*it)->hasDynamicRendering()) continue;
+    if((*it)->apply(__bboxComputer) && __bboxComputer.getBoundingBox()){
+      BoundingBoxPtr bbox = __bboxComputer.getBoundingBox();
+      lowers.push_back(bbox->getLowerLeftCorner());
+      uppers.push_back(bbox->getUpperRightCorner());
+      __shapeTreeIndices.push_back(i);
+    }
+    else __unboundedShapes.push_back(i);
+  }
+  __shapeTree = AABBTreePtr(new AABBTree(lowers,uppers));
+}
+
+void
+ViewGeomSceneGL::paintVisibleShapes()
+{
+  if(!__shapeTree) computeShapeTree();
+  std::vector<uint_t> visible;
+  if(__frustumCulling) visible = __shapeTree->planesQuery(__camera->getFrustumPlanes());
+  else visible = __shapeTree->planesQuery(std::vector<Vector4>());
+
+  // The size of a shape on screen is its radius projected at the distance of its center.
+  GLdouble projection[16], modelview[16];
+  GLint viewport[4];
+  glGetDoublev(GL_PROJECTION_MATRIX,projection);
+  glGetDoublev(GL_MODELVIEW_MATRIX,modelview);
+  glGetIntegerv(GL_VIEWPORT,viewport);
+  real_t pixelScale = projection[5] * viewport[3] / 2.0;
+
+  bool displaylist = getDisplayListUse();
+  std::vector<uint_t>::const_iterator unbounded = __unboundedShapes.begin();
+  __renderer.beginProcess();
+  for(std::vector<uint_t>::const_iterator it = visible.begin(); it != visible.end() || unbounded != __unboundedShapes.end(); ){
+    // The shapes are drawn in the order of the scene for the blending.
+    if(unbounded != __unboundedShapes.end() && (it == visible.end() || *unbounded < __shapeTreeIndices[*it])){
+      __scene->getAt(*unbounded)->apply(__renderer);
+      ++unbounded;
+      continue;
+    }
+    Shape3DPtr shape = __scene->getAt(__shapeTreeIndices[*it]);
+    const Vector3& lower = __shapeTree->getLowerCorner(*it);
+    const Vector3& upper = __shapeTree->getUpperCorner(*it);
+    ++it;
+    ShapePtr sh = dynamic_pointer_cast<Shape>(shape);
+    if(!sh){
+      shape->apply(__renderer);
+      continue;
+    }
+    if(__proxySize > 0){
+      Vector3 center = (lower + upper) / 2;
+      real_t radius = norm(upper - lower) / 2;
+      // An orthographic projection does not depend on the depth.
+      real_t depth = 1;
+      if(projection[15] == 0){
+        depth = -(modelview[2] * center.x() + modelview[6] * center.y() + modelview[10] * center.z() + modelview[14]);
+        if(depth <= radius) depth = 0;
+      }
+      if(depth > 0 && radius * pixelScale < __proxySize * depth){
+        __renderer.processAppereance(sh.get());
+        glPushMatrix();
+        glGeomTranslate(center);
+        glGeomScale(upper - lower);
+        glutSolidCube(1);
+        glPopMatrix();
+        continue;
+      }
+    }
+    __renderer.processAppereance(sh.get());
+    // Each shape is stored in a display list since the scene is not.
+    GLuint shapelist = 0;
+    if(!displaylist || !__renderer.check(sh->SceneObject::getId(),shapelist)){
+      __renderer.processGeometry(sh.get());
+      if(displaylist) __renderer.update(sh->SceneObject::getId(),shapelist);
+    }
+  }
+  __renderer.endProcess();
+}
+
+/// Returns the value of the equation of \e plane at \e p.
+static inline real_t planeValue(const Vector4& plane, const Vector3& p)
+{
+  return plane.x() * p.x() + plane.y() * p.y() + plane.z() * p.z() + plane.w();
+}
+
+/** Clips the triangle (a,b,c) by \e planes. Returns false if nothing is left.
+    Else \e depth is the minimal value of the plane \e nearplane on what is left, as for the GL selection. */
+static bool clipTriangle(const Vector3& a, const Vector3& b, const Vector3& c,
+                         const std::vector<Vector4>& planes, const Vector4& nearplane, real_t& depth)
+{
+  std::vector<Vector3> polygon, clipped;
+  polygon.push_back(a); polygon.push_back(b); polygon.push_back(c);
+  std::vector<real_t> values;
+  for(std::vector<Vector4>::const_iterator plane = planes.begin(); plane != planes.end(); ++plane){
+    values.clear();
+    bool inside = true, outside = true;
+    for(std::vector<Vector3>::const_iterator p = polygon.begin(); p != polygon.end(); ++p){
+      values.push_back(planeValue(*plane,*p));
+      if(values.back() >= 0) outside = false;
+      else inside = false;
+    }
+    if(outside) return false;
+    if(inside) continue;
+    clipped.clear();
+    for(size_t i = 0; i < polygon.size(); ++i){
+      size_t j = (i + 1) % polygon.size();
+      if(values[i] >= 0) clipped.push_back(polygon[i]);
+      if((values[i] >= 0) != (values[j] >= 0))
+        clipped.push_back(polygon[i] + (polygon[j] - polygon[i]) * (values[i] / (values[i] - values[j])));
+    }
+    polygon.swap(clipped);
+  }
+  depth = planeValue(nearplane,polygon[0]);
+  for(size_t i = 1; i < polygon.size(); ++i) depth = std::min(depth,planeValue(nearplane,polygon[i]));
+  return true;
+}
+
+/// Returns the minimal value of the plane \e nearplane on the box [\e lower, \e upper].
+static real_t boxDepth(const Vector3& lower, const Vector3& upper, const Vector4& nearplane)
+{
+  // The minimum of a linear function on a box is at the corner opposed to its gradient.
+  Vector3 corner(nearplane.x() > 0 ? lower.x() : upper.x(),
+                 nearplane.y() > 0 ? lower.y() : upper.y(),
+                 nearplane.z() > 0 ? lower.z() : upper.z());
+  return planeValue(nearplane,corner);
+}
+
+/// Orders the picking candidates by depth.
+struct candidatecmp {
+  bool operator()(const std::pair<real_t,Shape3DPtr>& a, const std::pair<real_t,Shape3DPtr>& b) const
+  { return a.first < b.first; }
+};
+
+bool
+ViewGeomSceneGL::pick(const std::vector<Vector4>& planes, bool nearest, std::vector<uint_t>& ids)
+{
+  ids.clear();
+  if(!__scene || __scene->empty() || planes.size() < 6) return true;
+  if(!__shapeTree) computeShapeTree();
+  const Vector4& nearplane = planes[5];
+
+  // The candidates are the shapes whose bounding box is in the region, the nearest first.
+  std::vector<std::pair<real_t,Shape3DPtr> > candidates;
+  std::vector<uint_t> items = __shapeTree->planesQuery(planes);
+  for(std::vector<uint_t>::const_iterator it = items.begin(); it != items.end(); ++it)
+    candidates.push_back(std::pair<real_t,Shape3DPtr>(
+        nearest ? boxDepth(__shapeTree->getLowerCorner(*it),__shapeTree->getUpperCorner(*it),nearplane) : 0,
+        __scene->getAt(__shapeTreeIndices[*it])));
+  real_t infinity = std::numeric_limits<real_t>::max();
+  for(std::vector<uint_t>::const_iterator it = __unboundedShapes.begin(); it != __unboundedShapes.end(); ++it)
+    candidates.push_back(std::pair<real_t,Shape3DPtr>(-infinity,__scene->getAt(*it)));
+  for(Scene::const_iterator it = __dynamicscene->begin(); it != __dynamicscene->end(); ++it)
+    candidates.push_back(std::pair<real_t,Shape3DPtr>(-infinity,*it));
+  if(nearest) std::stable_sort(candidates.begin(),candidates.end(),candidatecmp());
+
+  real_t bestdepth = infinity;
+  for(std::vector<std::pair<real_t,Shape3DPtr> >::const_iterator it = candidates.begin(); it != candidates.end(); ++it){
+    if(nearest && it->first >= bestdepth) break;
+    real_t depth = 0;
+    if(!pickShape(it->second,planes,nearest,depth)) continue;
+    uint_t id = (uint_t)it->second->SceneObject::getId();
+    if(!nearest) ids.push_back(id);
+    else if(depth < bestdepth){
+      ids.assign(1,id);
+      bestdepth = depth;
+    }
+  }
+  return true;
+}
+
+bool
+ViewGeomSceneGL::pickShape(const Shape3DPtr& shape, const std::vector<Vector4>& planes, bool nearest, real_t& depth)
+{
+  uint_t id = (uint_t)shape->SceneObject::getId();
+  PickingMeshCache::const_iterator cached = __pickingMeshes.find(id);
+  PickingMesh mesh;
+  if(cached != __pickingMeshes.end()) mesh = cached.value();
+  else {
+    ShapePtr sh = dynamic_pointer_cast<Shape>(shape);
+    if(sh && sh->geometry && sh->geometry->apply(__tesselator)){
+      TriangleSetPtr triangles = __tesselator.getTriangulation();
+      ExplicitModelPtr model = __tesselator.getDiscretization();
+      if(triangles){
+        mesh.points = triangles->getPointList();
+        mesh.primitives = triangles->getIndexList();
+      }
+      else if(model && model->getPointList()){
+        mesh.points = model->getPointList();
+        uint_t nbpoints = mesh.points->size();
+        if(dynamic_pointer_cast<Polyline>(model)){
+          mesh.primitives = Index3ArrayPtr(new Index3Array(nbpoints > 0 ? nbpoints - 1 : 0));
+          for(uint_t i = 0; i + 1 < nbpoints; ++i) mesh.primitives->setAt(i,Index3(i,i+1,i+1));
+        }
+        else {
+          mesh.primitives = Index3ArrayPtr(new Index3Array(nbpoints));
+          for(uint_t i = 0; i < nbpoints; ++i) mesh.primitives->setAt(i,Index3(i,i,i));
+        }
+      }
+      if(mesh.primitives && mesh.primitives->size() > AABBTree::DEFAULT_LEAF_SIZE){
+        std::vector<Vector3> lowers, uppers;
+        for(Index3Array::const_iterator it = mesh.primitives->begin(); it != mesh.primitives->end(); ++it){
+          const Vector3& a = mesh.points->getAt(it->getAt(0));
+          const Vector3& b = mesh.points->getAt(it->getAt(1));
+          const Vector3& c = mesh.points->getAt(it->getAt(2));
+          lowers.push_back(Vector3(std::min(a.x(),std::min(b.x(),c.x())),std::min(a.y(),std::min(b.y(),c.y())),std::min(a.z(),std::min(b.z(),c.z()))));
+          uppers.push_back(Vector3(std::max(a.x(),std::max(b.x(),c.x())),std::max(a.y(),std::max(b.y(),c.y())),std::max(a.z(),std::max(b.z(),c.z()))));
+        }
+        mesh.tree = AABBTreePtr(new AABBTree(lowers,uppers));
+      }
+    }
+    // The dynamic shapes change at each frame.
+    if(!shape->hasDynamicRendering()) __pickingMeshes.insert(id,mesh);
+  }
+
+  const Vector4& nearplane = planes[5];
+  if(!mesh.primitives){
+    // Without primitives, the bounding box which has been tested stands for the shape.
+    if(!shape->apply(__bboxComputer) || !__bboxComputer.getBoundingBox()) return false;
+    BoundingBoxPtr bbox = __bboxComputer.getBoundingBox();
+    depth = boxDepth(bbox->getLowerLeftCorner(),bbox->getUpperRightCorner(),nearplane);
+    return true;
+  }
+  std::vector<uint_t> primitives;
+  if(mesh.tree) primitives = mesh.tree->planesQuery(planes);
+  else for(uint_t i = 0; i < mesh.primitives->size(); ++i) primitives.push_back(i);
+  bool found = false;
+  for(std::vector<uint_t>::const_iterator it = primitives.begin(); it != primitives.end(); ++it){
+    const Index3& primitive = mesh.primitives->getAt(*it);
+    real_t primitivedepth;
+    if(clipTriangle(mesh.points->getAt(primitive.getAt(0)),mesh.points->getAt(primitive.getAt(1)),
+                    mesh.points->getAt(primitive.getAt(2)),planes,nearplane,primitivedepth)){
+      if(!nearest) return true;
+      if(!found || primitivedepth < depth) depth = primitivedepth;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/// Discretizes a range of geometries. Each range has its own discretizer.
+struct ShapeListDiscretizer {
+  const std::vector<GeometryPtr>& geometries;
+  std::vector<ExplicitModelPtr>& discretizations;
+
+  ShapeListDiscretizer(const std::vector<GeometryPtr>& _geometries, std::vector<ExplicitModelPtr>& _discretizations) :
+    geometries(_geometries), discretizations(_discretizations) {}
+
+  void operator()(size_t first, size_t last){
+    Discretizer discretizer;
+    for(size_t i = first; i < last; ++i)
+      if(geometries[i]->apply(discretizer)) discretizations[i] = discretizer.getDiscretization();
+  }
+};
+
+void
+ViewGeomSceneGL::updateShapeLists()
+{
+  ShapeListCache previous;
+  previous.swap(__shapeLists);
+  std::vector<GeometryPtr> added;
+  uint_t kept = 0;
+  for(Scene::const_iterator it = __scene->begin(); it != __scene->end(); ++it){
+    ShapePtr sh = dynamic_pointer_cast<Shape>(*it);
+    if(!sh || !sh->geometry || sh->hasDynamicRendering()) continue;
+    size_t id = sh->geometry->getId();
+    if(__shapeLists.contains(id)) continue;
+    // The previous geometries are still alive: an equal id is the same geometry.
+    ShapeListCache::iterator previt = previous.find(id);
+    if(previt != previous.end()){
+      __shapeLists.insert(id,previt.value());
+      previous.erase(previt);
+      ++kept;
+    }
+    else {
+      ShapeList entry;
+      entry.geometry = sh->geometry;
+      entry.list = 0;
+      entry.textured = sh->appearance && sh->appearance->isTexture();
+      // The texture coordinates are computed by the renderer.
+      if(!entry.textured) added.push_back(sh->geometry);
+      __shapeLists.insert(id,entry);
+    }
+  }
+  for(ShapeListCache::const_iterator previt = previous.begin(); previt != previous.end(); ++previt)
+    if(previt.value().list != 0) __obsoleteLists.push_back(previt.value().list);
+
+  // The new geometries are discretized by the worker threads. Their lists are compiled at the next paint.
+  std::vector<ExplicitModelPtr> discretizations(added.size());
+  ShapeListDiscretizer discretizer(added,discretizations);
+  pgl_parallel_for(0,added.size(),discretizer,16);
+  for(size_t i = 0; i < added.size(); ++i)
+    __shapeLists[added[i]->getId()].discretization = discretizations[i];
+  status(tr("Animation step")+": "+QString::number(kept)+" "+tr("geometries kept")+", "
+         +QString::number(__shapeLists.size()-kept)+" "+tr("new")+", "
+         +QString::number(previous.size())+" "+tr("removed")+".",2000);
+}
+
+void
+ViewGeomSceneGL::paintShapeLists()
+{
+  __renderer.beginProcess();
+  for(Scene::const_iterator it = __scene->begin(); it != __scene->end(); ++it){
+    if((*it)->hasDynamicRendering()) continue;
+    ShapePtr sh = dynamic_pointer_cast<Shape>(*it);
+    ShapeListCache::iterator entry;
+    if(!sh || !sh->geometry || (entry = __shapeLists.find(sh->geometry->getId())) == __shapeLists.end()){
+      (*it)->apply(__renderer);
+      continue;
+    }
+    __renderer.processAppereance(sh.get());
+    ShapeList& shapelist = entry.value();
+    bool textured = sh->appearance && sh->appearance->isTexture();
+    if(shapelist.list != 0 && shapelist.textured == textured){
+      glCallList(shapelist.list);
+      continue;
+    }
+    if(shapelist.list == 0) shapelist.list = glGenLists(1);
+    if(shapelist.list != 0) glNewList(shapelist.list,GL_COMPILE_AND_EXECUTE);
+    if(shapelist.discretization && !textured) shapelist.discretization->apply(__renderer);
+    else sh->geometry->apply(__renderer);
+    if(shapelist.list != 0) glEndList();
+    shapelist.discretization = ExplicitModelPtr();
+    shapelist.textured = textured;
+  }
+  __renderer.endProcess();
+}
+
+void
+ViewGeomSceneGL::clearShapeLists()
+{
+  for(ShapeListCache::const_iterator it = __shapeLists.begin(); it != __shapeLists.end(); ++it)
+    if(it.value().list != 0) __obsoleteLists.push_back(it.value().list);
+  __shapeLists.clear();
+}
+
+void
+ViewGeomSceneGL::paintBatches()
+{
+  // The compilation of the batches is spread over several frames to keep the interface responsive.
+  QElapsedTimer timer;
+  timer.start();
+  bool displaylist = __batchListsReady && getDisplayListUse();
+  bool pending = false;
+  __renderer.beginProcess();
+  for(std::vector<ShapeBatch>::iterator batch = __batches.begin(); batch != __batches.end(); ++batch){
+    if(batch->list != 0){
+      glCallList(batch->list);
+      continue;
+    }
+    if(displaylist){
+      if(timer.elapsed() > 100){
+        pending = true;
+        continue;
+      }
+      batch->list = glGenLists(1);
+      if(batch->list != 0) glNewList(batch->list,GL_COMPILE_AND_EXECUTE);
+    }
+    for(Scene::const_iterator it = batch->scene->begin(); it != batch->scene->end(); ++it)
+      if (!(*it)->hasDynamicRendering()) (*it)->apply(__renderer);
+    if(batch->list != 0) glEndList();
+  }
+  __renderer.endProcess();
+  __batchListsReady = true;
+  if(pending) QTimer::singleShot(0,this,SIGNAL(valueChanged()));
+}
+
+void
+ViewGeomSceneGL::clearBatches()
+{
+  for(std::vector<ShapeBatch>::const_iterator it = __batches.begin(); it != __batches.end(); ++it)
+    if(it->list != 0) __obsoleteLists.push_back(it->list);
+  __batches.clear();
+  __batchListsReady = false;
+}
+
 void
 ViewGeomSceneGL::selectGL()
 {
@@ -1180,7 +1714,8 @@ ViewMultiGeomSceneGL::setRenderingStep(int i)
 bool 
 ViewMultiGeomSceneGL::sceneChangeEvent( ViewSceneChangeEvent * k)
 {
-	if(k->getSceneType() == GeomSceneChangeEvent::eGeomSceneEvent)
+	if(k->getSceneType() == GeomSceneChangeEvent::eGeomSceneEvent ||
+	   k->getSceneType() == GeomSceneChangeEvent::eSceneBatchEvent)
 		return ViewGeomSceneGL::sceneChangeEvent(k);
 	else if(k->getSceneType() == GeomSceneChangeEvent::eMultiSceneEvent){
 		GeomMultiSceneChangeEvent * event = ( GeomMultiSceneChangeEvent * )k;
@@ -44,6 +44,7 @@
 #include <plantgl/scenegraph/scene/scene.h>
 #include <plantgl/scenegraph/geometry/polyline.h>
 #include <plantgl/algo/base/discretizer.h>
+#include <plantgl/algo/base/tesselator.h>
 #include <plantgl/algo/base/skelcomputer.h>
 #include <plantgl/algo/base/bboxcomputer.h>
 #include <plantgl/algo/opengl/glbboxrenderer.h>
@@ -51,6 +52,7 @@
 #include <plantgl/algo/opengl/gltransitionrenderer.h>
 #include <plantgl/algo/opengl/glskelrenderer.h>
 #include <plantgl/algo/opengl/glctrlptrenderer.h>
+#include <plantgl/algo/grid/aabbtree.h>
 // #include <plantgl/tool/util_hashmap.h>
 #include <vector>
 #include <QtCore/QHash>
@@ -95,6 +97,10 @@ class VIEW_API ViewGeomSceneGL  : public ViewModalRendererGL
 
   virtual void selectGL();
 
+  /** Finds the picked shapes on CPU, with the hierarchy of the bounding boxes of the shapes
+      and then the triangles, segments or points of their discretization. */
+  virtual bool pick(const std::vector<TOOLS(Vector4)>& planes, bool nearest, std::vector<uint_t>& ids);
+
   /// Scene change Event.
   virtual bool sceneChangeEvent(ViewSceneChangeEvent *);
 
@@ -130,6 +136,10 @@ class VIEW_API ViewGeomSceneGL  : public ViewModalRendererGL
   /// Set the scene \b _scene to the frame and display.
   int setScene( const PGL(ScenePtr)& scene );
 
+  /** Add the shapes of \b scene, a batch of a scene loaded progressively, to the displayed scene.
+      Only the new shapes are compiled and the camera is kept. \b bbox is the bounding box of \b scene if known. */
+  int appendScene( const PGL(ScenePtr)& scene, const PGL(BoundingBoxPtr)& bbox = PGL(BoundingBoxPtr)() );
+
   /// Get the scene.
   PGL(ScenePtr) getScene( ) const;
 
@@ -167,6 +177,18 @@ class VIEW_API ViewGeomSceneGL  : public ViewModalRendererGL
  
   bool getDisplayListUse() const;
 
+  /// Returns whether the meshes are rendered with vertex buffer objects.
+  bool getBufferObjectUse() const;
+
+  /// Returns whether the shared meshes are drawn with instanced calls.
+  bool getInstancingUse() const;
+
+  /// Returns whether the shapes outside of the view frustum are skipped.
+  bool getFrustumCullingUse() const { return __frustumCulling; }
+
+  /// Returns the size in pixels under which a shape is drawn as its bounding box. 0 if disabled.
+  int getProxySize() const { return __proxySize; }
+
   static bool useThread();
 
   /// Save current scene in GEOM format in the file \b filename.
@@ -278,6 +300,9 @@ public slots:
   /// Load geom objects.
   void addGeomFile();
 
+  /// Stop the loading of the current file. The shapes already loaded are kept.
+  void cancelLoading();
+
   /// Load geom objects.
   void openGeomViewFile();
 
@@ -299,6 +324,21 @@ public slots:
   void changeDisplayListUse();
   virtual void useDisplayList(bool);
 
+  /// Render the meshes with vertex buffer objects instead of display lists.
+  void useBufferObject(bool);
+
+  /// Draw the meshes shared by several shapes with instanced calls. It enables the vertex buffer objects.
+  void useInstancing(bool);
+
+  /// Skip the shapes whose bounding box is outside of the view frustum.
+  void useFrustumCulling(bool);
+
+  /// Draw the shapes which appear smaller than \e size pixels as their bounding box. 0 disables it.
+  void setProxySize(int size);
+
+  /// Draw the shapes which appear smaller than a few pixels as their bounding box.
+  void useBoundingBoxProxies(bool);
+
   /// Clear Selection Event.
   virtual void clearSelectionEvent();
   virtual void clearDisplayList();
@@ -325,12 +365,47 @@ signals:
   
   void displayList(bool);
 
+  void bufferObject(bool);
+
+  void instancing(bool);
+
+  void frustumCulling(bool);
+
+  void boundingBoxProxies(bool);
+
 protected :
 
   virtual void customEvent(QEvent *); 
 
   virtual void animationChangedEvent(eAnimationFlag);
 
+  /// Builds the hierarchy of the bounding boxes of the shapes of the scene.
+  void computeShapeTree();
+
+  /// Draws the shapes in the view frustum, or their bounding box if they appear too small.
+  void paintVisibleShapes();
+
+  /** Returns whether one of the primitives of \e shape is in the region delimited by \e planes.
+      \e depth is then the minimal value of the near plane on them if \e nearest. */
+  bool pickShape(const PGL(Shape3DPtr)& shape, const std::vector<TOOLS(Vector4)>& planes, bool nearest, real_t& depth);
+
+  /** Matches the geometries of a new animation step with the ones of the previous step.
+      The display lists of the kept geometries are reused and the new geometries are
+      discretized in parallel. */
+  void updateShapeLists();
+
+  /// Draws an animation step with the display lists of its geometries.
+  void paintShapeLists();
+
+  /// Releases the display lists of the animation.
+  void clearShapeLists();
+
+  /// Draws a scene loaded progressively with a display list per batch of shapes.
+  void paintBatches();
+
+  /// Releases the display lists of the batches.
+  void clearBatches();
+
   /// The scene object (which contains all the geometric shape and appereance to display).
   PGL(ScenePtr) __scene;
 
@@ -372,6 +447,65 @@ protected :
   /// Do some blending
   bool __blending;
 
+  /// Skip the shapes out of the view frustum.
+  bool __frustumCulling;
+
+  /// The size in pixels under which a shape is drawn as its bounding box.
+  int __proxySize;
+
+  /// The hierarchy of the bounding boxes of the static shapes of the scene.
+  PGL(AABBTreePtr) __shapeTree;
+
+  /// The index in the scene of the shapes of the tree.
+  std::vector<uint_t> __shapeTreeIndices;
+
+  /// The index of the static shapes without bounding box, always drawn.
+  std::vector<uint_t> __unboundedShapes;
+
+  /** The primitives of the discretization of a shape used for the picking, as triangles in world coordinates.
+      A segment or a point is a triangle with repeated indices. The large meshes have a tree of their primitives. */
+  struct PickingMesh {
+    PGL(Point3ArrayPtr) points;
+    PGL(Index3ArrayPtr) primitives;
+    PGL(AABBTreePtr) tree;
+  };
+
+  /// The picking meshes of the static shapes by shape id, computed when a shape is first a candidate.
+  typedef QHash<uint_t,PickingMesh> PickingMeshCache;
+  PickingMeshCache __pickingMeshes;
+
+  /// The Tesselator used for the picking.
+  PGL(Tesselator) __tesselator;
+
+  /// The display list of a geometry of an animated scene. The geometry is kept so that its id stays valid.
+  struct ShapeList {
+    PGL(GeometryPtr) geometry;
+    /// The discretization computed in advance, until the list is compiled.
+    PGL(ExplicitModelPtr) discretization;
+    GLuint list;
+    bool textured;
+  };
+
+  /// The display lists of the geometries of an animated scene by geometry id.
+  typedef QHash<size_t,ShapeList> ShapeListCache;
+  ShapeListCache __shapeLists;
+
+  /// The display lists of the removed geometries, deleted at the next paint when the GL context is current.
+  std::vector<GLuint> __obsoleteLists;
+
+  /// A batch of shapes of a scene loaded progressively, with its display list.
+  struct ShapeBatch {
+    PGL(ScenePtr) scene;
+    GLuint list;
+  };
+
+  /// The batches of the scene, in their order of loading.
+  std::vector<ShapeBatch> __batches;
+
+  /** Set when the batches have been drawn once since the renderer was cleared. The first pass
+      compiles the shared geometries in their own lists, which cannot be nested in a batch list. */
+  bool __batchListsReady;
+
 #ifdef QT_THREAD_SUPPORT
   /// Reader.
   ViewGeomReader * __reader;
@@ -110,6 +110,8 @@ ViewGeomSceneGL::addOpenEntries(QMenu * menu)
                        this,SLOT(openGeomFile()),Qt::CTRL+Qt::Key_G);
   menu->addAction( openIcon, tr("&Add Geom File"),
                        this,SLOT(addGeomFile()));
+  menu->addAction( tr("&Cancel Loading"),
+                       this,SLOT(cancelLoading()));
   return true;
 }
 
@@ -324,6 +326,17 @@ ViewGeomSceneGL::addGeomFile()
      addGeomFile(filename);
 }
 
+void
+ViewGeomSceneGL::cancelLoading()
+{
+#ifdef GEOM_THREAD
+  if(__reader && __reader->isRunning()){
+    __reader->cancel();
+    status(tr("Loading of")+" "+__reader->getFilename()+" "+tr("cancelled."),10000);
+  }
+#endif
+}
+
 /* ----------------------------------------------------------------------- */
 
 void
@@ -1304,6 +1317,7 @@ ViewMultiGeomSceneGL::addOpenEntries(QMenu * menu)
   menu->addAction( openIcon, tr("Open &Geom File"),  this,SLOT(openGeomFile()),Qt::CTRL+Qt::Key_G);
   menu->addAction( openIcon, tr("&Add Geom File"),   this,SLOT(addGeomFile()));
   menu->addAction( openIcon, tr("Open &2 Geom File"),this,SLOT(openGeomFiles()));
+  menu->addAction( tr("&Cancel Loading"),             this,SLOT(cancelLoading()));
   return true;
 }
 
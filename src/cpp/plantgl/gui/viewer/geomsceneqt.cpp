@@ -504,10 +504,33 @@ ViewGeomSceneGL::createToolsMenu(QWidget * parent)
   act->setCheckable(true);
   act->setChecked(getDisplayListUse());
   QObject::connect(this,SIGNAL(displayList(bool)),act,SLOT(setChecked(bool)));
+  act = __displayMenu->addAction(tr("Vertex Buffer Objects"));
+  act->setCheckable(true);
+  act->setChecked(getBufferObjectUse());
+  QObject::connect(act,SIGNAL(toggled(bool)),this,SLOT(useBufferObject(bool)));
+  QObject::connect(this,SIGNAL(bufferObject(bool)),act,SLOT(setChecked(bool)));
+  act = __displayMenu->addAction(tr("Instanced Drawing"));
+  act->setCheckable(true);
+  act->setChecked(getInstancingUse());
+  QObject::connect(act,SIGNAL(toggled(bool)),this,SLOT(useInstancing(bool)));
+  QObject::connect(this,SIGNAL(instancing(bool)),act,SLOT(setChecked(bool)));
   __displayMenu->addSeparator();
   __displayMenu->addAction(tr("Recompute"),      this,SLOT(clearDisplayList()));
   __displayMenu->setTitle(tr("&Display List"));
   menu->addMenu(__displayMenu);
+  QMenu * __cullingMenu = new QMenu(menu);
+  act = __cullingMenu->addAction(tr("Frustum Culling"));
+  act->setCheckable(true);
+  act->setChecked(getFrustumCullingUse());
+  QObject::connect(act,SIGNAL(toggled(bool)),this,SLOT(useFrustumCulling(bool)));
+  QObject::connect(this,SIGNAL(frustumCulling(bool)),act,SLOT(setChecked(bool)));
+  act = __cullingMenu->addAction(tr("Bounding Box of Small Shapes"));
+  act->setCheckable(true);
+  act->setChecked(getProxySize() > 0);
+  QObject::connect(act,SIGNAL(toggled(bool)),this,SLOT(useBoundingBoxProxies(bool)));
+  QObject::connect(this,SIGNAL(boundingBoxProxies(bool)),act,SLOT(setChecked(bool)));
+  __cullingMenu->setTitle(tr("&Culling"));
+  menu->addMenu(__cullingMenu);
   return menu;
 }
 
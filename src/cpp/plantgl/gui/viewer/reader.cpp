@@ -47,8 +47,12 @@
 #include "geomscenegl.h"
 
 #include <plantgl/algo/codec/ligfile.h>
+#include <plantgl/algo/base/tesselator.h>
+#include <plantgl/algo/base/bboxcomputer.h>
+#include <plantgl/scenegraph/geometry/boundingbox.h>
 
 #include <sstream>
+#include <algorithm>
 
 PGL_USING_NAMESPACE
 using namespace std;
@@ -64,7 +68,9 @@ ViewGeomReader::ViewGeomReader(const QString& f,
   _filename(f),
   _g(g),
   maxerror(i),
-  addition(add)
+  addition(add),
+  _batchsize(10000),
+  _cancelled(0)
 {
 }
 
@@ -90,6 +96,30 @@ ViewGeomReader::setMaxError(int i)
   maxerror = i;
 }
 
+void
+ViewGeomReader::setBatchSize(uint_t size)
+{
+  _batchsize = size;
+}
+
+uint_t
+ViewGeomReader::getBatchSize() const
+{
+  return _batchsize;
+}
+
+void
+ViewGeomReader::cancel()
+{
+  _cancelled.fetchAndStoreOrdered(1);
+}
+
+bool
+ViewGeomReader::isCancelled() const
+{
+  return const_cast<QAtomicInt&>(_cancelled).fetchAndAddOrdered(0) != 0;
+}
+
 void ViewGeomReader::run()
 {
 
@@ -99,9 +129,38 @@ void ViewGeomReader::run()
                                           maxerror));
       _errlog << std::ends;
       string _msg = _errlog.str();
-      GeomSceneChangeEvent * e = new GeomSceneChangeEvent(scene,_msg.c_str(),_filename,addition);
-      QApplication::postEvent(_g,e);
+      sendScene(scene,_msg.c_str());
+    }
+}
+
+void ViewGeomReader::sendScene(const ScenePtr& scene, const QString& errlog)
+{
+  uint_t total = scene->size();
+  if(_batchsize == 0 || total <= _batchsize){
+    if(!isCancelled())
+      QApplication::postEvent(_g,new GeomSceneChangeEvent(scene,errlog,_filename,addition));
+    return;
+  }
+  // The bounding box of a batch is computed here so that the frame only extends its own.
+  Tesselator tesselator;
+  BBoxComputer bboxcomputer(tesselator);
+  bool first = true;
+  uint_t i = 0;
+  while(i < total && !isCancelled()){
+    ScenePtr batch(new Scene());
+    for(uint_t last = std::min(total, i + _batchsize); i < last; ++i){
+      // The shapes of an indexed BGEOM file are read by chunks at their first access.
+      Shape3DPtr shape = scene->getAt(i);
+      if(shape) batch->add(shape);
     }
+    if(batch->empty()) continue;
+    BoundingBoxPtr bbox;
+    if(bboxcomputer.process(batch)) bbox = bboxcomputer.getBoundingBox();
+    QApplication::postEvent(_g,new GeomSceneBatchEvent(batch,bbox,i,total,
+                                                       first ? errlog : QString(),
+                                                       _filename,addition || !first));
+    first = false;
+  }
 }
 
 
@@ -253,8 +312,7 @@ void ViewLinetreeReader::run(){
       _errlog << ends;
       string _msg = _errlog.str();
       if(!scene) scene = ScenePtr(new Scene());
-      GeomSceneChangeEvent * e = new GeomSceneChangeEvent(scene,_msg.c_str(),_filename,addition);
-      QApplication::postEvent(_g,e);
+      sendScene(scene,_msg.c_str());
     }
 }
 #endif
@@ -54,6 +54,7 @@
 
 #include <QtCore/qthread.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qatomic.h>
 #include <plantgl/scenegraph/scene/scene.h>
 
 /* ----------------------------------------------------------------------- */
@@ -88,10 +89,25 @@ class VIEW_API ViewGeomReader : public QThread
 
     void setMaxError(int i);
 
+    /** Sets the number of shapes sent at once to the frame while they are loaded.
+        0 sends the whole scene at the end of the reading. */
+    void setBatchSize(uint_t size);
+
+    uint_t getBatchSize() const;
+
+    /// Stops the reading after the current batch. The shapes already sent are kept.
+    void cancel();
+
+    bool isCancelled() const;
+
     protected :
 
       virtual void run();
 
+    /** Sends \e scene to the frame by batches of shapes. The shapes of a scene
+        opened lazily are loaded here, in the thread of the reader. */
+    void sendScene(const PGL(ScenePtr)& scene, const QString& errlog);
+
     /// The file to read.
     QString _filename;
 
@@ -102,6 +118,12 @@ class VIEW_API ViewGeomReader : public QThread
     int maxerror;
 
         bool addition;
+
+    /// The number of shapes of a batch.
+    uint_t _batchsize;
+
+    /// Set when the reading is cancelled.
+    QAtomicInt _cancelled;
 };
 
 
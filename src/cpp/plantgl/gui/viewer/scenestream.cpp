@@ -0,0 +1,320 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr)
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "scenestream.h"
+
+#include <plantgl/scenegraph/transformation/translated.h>
+#include <plantgl/scenegraph/transformation/scaled.h>
+#include <plantgl/scenegraph/transformation/eulerrotated.h>
+#include <plantgl/algo/codec/binaryprinter.h>
+#include <plantgl/algo/codec/scne_binaryparser.h>
+#include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
+#include <set>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+using namespace std;
+
+/* ----------------------------------------------------------------------- */
+
+ViewSceneDelta::ViewSceneDelta(bool _reset):
+  reset(_reset)
+{
+}
+
+bool
+ViewSceneDelta::empty() const
+{
+  return !reset && removed.empty() && shapes.empty() && transforms.empty();
+}
+
+void
+ViewSceneDelta::merge(const ViewSceneDelta& next)
+{
+  if (next.reset) { *this = next; return; }
+
+  // The shapes of self replaced or removed by next and the transformations it overrides are dropped.
+  set<uint_t> dropped(next.removed.begin(),next.removed.end());
+  for(ShapeList::const_iterator it = next.shapes.begin(); it != next.shapes.end(); ++it)
+    dropped.insert(it->first);
+  set<uint_t> transformed(dropped);
+  for(TransformList::const_iterator it = next.transforms.begin(); it != next.transforms.end(); ++it)
+    transformed.insert(it->first);
+
+  ShapeList nshapes;
+  for(ShapeList::const_iterator it = shapes.begin(); it != shapes.end(); ++it)
+    if (dropped.find(it->first) == dropped.end()) nshapes.push_back(*it);
+  nshapes.insert(nshapes.end(),next.shapes.begin(),next.shapes.end());
+  shapes.swap(nshapes);
+
+  TransformList ntransforms;
+  for(TransformList::const_iterator it = transforms.begin(); it != transforms.end(); ++it)
+    if (transformed.find(it->first) == transformed.end()) ntransforms.push_back(*it);
+  ntransforms.insert(ntransforms.end(),next.transforms.begin(),next.transforms.end());
+  transforms.swap(ntransforms);
+
+  // A reset delta already starts from an empty scene.
+  if (!reset) removed.insert(removed.end(),next.removed.begin(),next.removed.end());
+}
+
+void
+ViewSceneDelta::write(leofstream& stream) const
+{
+  stream << (uchar_t)(reset?1:0);
+  stream << (uint_t)removed.size();
+  for(vector<uint_t>::const_iterator it = removed.begin(); it != removed.end(); ++it)
+    stream << *it;
+  stream << (uint_t)transforms.size();
+  for(TransformList::const_iterator it = transforms.begin(); it != transforms.end(); ++it){
+    // The last row of the affine transformations is not written.
+    stream << it->first;
+    for(Matrix4::const_iterator itm = it->second.begin(); itm != it->second.begin()+12; ++itm)
+      stream << (double)*itm;
+  }
+  stream << (uint_t)shapes.size();
+  if (shapes.empty()) return;
+  ScenePtr scene(new Scene());
+  for(ShapeList::const_iterator it = shapes.begin(); it != shapes.end(); ++it){
+    stream << it->first;
+    scene->add(it->second);
+  }
+  // The shapes are written as a BGEOM stream preceded by its size.
+  leomstream bgeom;
+  BinaryPrinter printer(bgeom);
+  printer.print(scene,"stream");
+  string data = bgeom.str();
+  stream << (uint_t)data.size();
+  stream.write(data.c_str(),data.size());
+}
+
+bool
+ViewSceneDelta::read(lemmapstream& stream, ostream& errlog)
+{
+  shapes.clear(); removed.clear(); transforms.clear();
+  uchar_t _reset = 0;
+  stream >> _reset;
+  reset = (_reset != 0);
+  uint_t nb = 0;
+  stream >> nb;
+  if (!stream || nb > stream.remaining() / sizeof(uint_t)) return false;
+  removed.resize(nb);
+  for(vector<uint_t>::iterator it = removed.begin(); it != removed.end(); ++it)
+    stream >> *it;
+  stream >> nb;
+  if (!stream || nb > stream.remaining() / (sizeof(uint_t)+12*sizeof(double))) return false;
+  transforms.resize(nb,make_pair(0,Matrix4::IDENTITY));
+  for(TransformList::iterator it = transforms.begin(); it != transforms.end(); ++it){
+    stream >> it->first;
+    for(Matrix4::iterator itm = it->second.begin(); itm != it->second.begin()+12; ++itm){
+      double value = 0;
+      stream >> value;
+      *itm = value;
+    }
+  }
+  stream >> nb;
+  if (!stream || nb > stream.remaining() / sizeof(uint_t)) return false;
+  if (nb == 0) return true;
+  vector<uint_t> keys(nb);
+  for(vector<uint_t>::iterator it = keys.begin(); it != keys.end(); ++it)
+    stream >> *it;
+  uint_t size = 0;
+  stream >> size;
+  if (!stream || size > stream.remaining()) return false;
+  BinaryParser parser(errlog);
+  bool ok = parser.parse(stream.data()+stream.tell(),size);
+  stream.seek(stream.tell()+size);
+  ScenePtr scene = parser.getScene();
+  if (!ok || !scene || scene->size() != nb) {
+    errlog << "*** Stream : " << nb << " shapes expected in the frame." << endl;
+    return false;
+  }
+  shapes.resize(nb);
+  for(uint_t i = 0; i < nb; ++i)
+    shapes[i] = make_pair(keys[i],scene->getAt(i));
+  return true;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Return \e geometry without its top level matrix transformations and accumulate them in \e matrix.
+static GeometryPtr removeTransformations(const GeometryPtr& geometry, Matrix4& matrix)
+{
+  GeometryPtr base = geometry;
+  MatrixTransformedPtr transformed;
+  while ((transformed = dynamic_pointer_cast<MatrixTransformed>(base))){
+    Matrix4TransformationPtr transformation = dynamic_pointer_cast<Matrix4Transformation>(transformed->getTransformation());
+    if (!transformation) break;
+    matrix *= transformation->getMatrix();
+    base = transformed->getGeometry();
+  }
+  return base;
+}
+
+ViewSceneStream::ViewSceneStream()
+{
+}
+
+uint_t
+ViewSceneStream::getKey(const Shape3DPtr& shape)
+{
+  ShapePtr sh = dynamic_pointer_cast<Shape>(shape);
+  if (sh && sh->id != Shape::NOID) return sh->id;
+  return (uint_t)shape->SceneObject::getId();
+}
+
+ViewSceneStream::Entry
+ViewSceneStream::makeEntry(const Shape3DPtr& shape)
+{
+  Entry entry;
+  entry.shape = shape;
+  entry.matrix = Matrix4::IDENTITY;
+  ShapePtr sh = dynamic_pointer_cast<Shape>(shape);
+  if (sh) {
+    entry.geometry = sh->geometry;
+    entry.appearance = sh->appearance;
+    if (entry.geometry) entry.base = removeTransformations(entry.geometry,entry.matrix);
+  }
+  return entry;
+}
+
+GeometryPtr
+ViewSceneStream::transform(const GeometryPtr& base, const Matrix4& matrix)
+{
+  Vector3 scale, angles, translation;
+  matrix.getTransformation(scale,angles,translation);
+  GeometryPtr result = base;
+  if (normLinf(scale - Vector3(1,1,1)) > GEOM_EPSILON)
+    result = GeometryPtr(new Scaled(scale,result));
+  if (normLinf(angles) > GEOM_EPSILON)
+    result = GeometryPtr(new EulerRotated(angles.x(),angles.y(),angles.z(),result));
+  if (normLinf(translation) > GEOM_EPSILON)
+    result = GeometryPtr(new Translated(translation,result));
+
+  // Shears and mirrors cannot be decomposed this way.
+  Matrix4 check = Matrix4::IDENTITY;
+  removeTransformations(result,check);
+  real_t magnitude = 1;
+  for(Matrix4::const_iterator it = matrix.begin(); it != matrix.end(); ++it)
+    magnitude = max(magnitude,fabs(*it));
+  for(Matrix4::const_iterator it = matrix.begin(), itc = check.begin(); it != matrix.end(); ++it, ++itc)
+    if (fabs(*it - *itc) > GEOM_EPSILON * magnitude) return GeometryPtr();
+  return result;
+}
+
+ViewSceneDelta
+ViewSceneStream::update(const ScenePtr& scene)
+{
+  // The first frame resets the scene displayed by the viewer.
+  ViewSceneDelta delta(__entries.empty());
+  EntryMap entries;
+  vector<uint_t> order;
+  if (scene) {
+    for(Scene::const_iterator itsh = scene->begin(); itsh != scene->end(); ++itsh){
+      if (!*itsh) continue;
+      uint_t key = getKey(*itsh);
+      // Several shapes may share an id, such as the shapes of one module in L-Py: the next ones are keyed by their object id.
+      if (entries.find(key) != entries.end()) key = (uint_t)(*itsh)->SceneObject::getId();
+      if (entries.find(key) != entries.end()) continue;
+      Entry entry = makeEntry(*itsh);
+      entries[key] = entry;
+      order.push_back(key);
+
+      EntryMap::const_iterator previous = __entries.find(key);
+      if (delta.reset || previous == __entries.end())
+        delta.shapes.push_back(make_pair(key,*itsh));
+      // The matrices are compared by value since the transformations may have been modified in place.
+      // A shape rebuilt with the same transformation is unchanged.
+      else if (entry.geometry ? (entry.base == previous->second.base && entry.appearance == previous->second.appearance
+                                 && entry.matrix == previous->second.matrix)
+                              : entry.shape == previous->second.shape) continue;
+      else if (entry.base && entry.base == previous->second.base && entry.appearance == previous->second.appearance
+               && transform(entry.base,entry.matrix))
+        delta.transforms.push_back(make_pair(key,entry.matrix));
+      else
+        delta.shapes.push_back(make_pair(key,*itsh));
+    }
+  }
+  if (!delta.reset)
+    for(vector<uint_t>::const_iterator it = __order.begin(); it != __order.end(); ++it)
+      if (entries.find(*it) == entries.end()) delta.removed.push_back(*it);
+  __entries.swap(entries);
+  __order.swap(order);
+  return delta;
+}
+
+void
+ViewSceneStream::apply(const ViewSceneDelta& delta)
+{
+  if (delta.reset) clear();
+  if (!delta.removed.empty()) {
+    for(vector<uint_t>::const_iterator it = delta.removed.begin(); it != delta.removed.end(); ++it)
+      __entries.erase(*it);
+    vector<uint_t> order;
+    for(vector<uint_t>::const_iterator it = __order.begin(); it != __order.end(); ++it)
+      if (__entries.find(*it) != __entries.end()) order.push_back(*it);
+    __order.swap(order);
+  }
+  for(ViewSceneDelta::ShapeList::const_iterator it = delta.shapes.begin(); it != delta.shapes.end(); ++it){
+    if (__entries.find(it->first) == __entries.end()) __order.push_back(it->first);
+    __entries[it->first] = makeEntry(it->second);
+  }
+  for(ViewSceneDelta::TransformList::const_iterator it = delta.transforms.begin(); it != delta.transforms.end(); ++it){
+    EntryMap::iterator entry = __entries.find(it->first);
+    if (entry == __entries.end() || !entry->second.base) continue;
+    GeometryPtr geometry = transform(entry->second.base,it->second);
+    if (!geometry) continue;
+    ShapePtr previous = dynamic_pointer_cast<Shape>(entry->second.shape);
+    entry->second.shape = Shape3DPtr(new Shape(previous->getName(),geometry,previous->appearance,previous->id,previous->parentId));
+    entry->second.geometry = geometry;
+    entry->second.matrix = it->second;
+  }
+}
+
+ScenePtr
+ViewSceneStream::getScene() const
+{
+  ScenePtr scene(new Scene());
+  for(vector<uint_t>::const_iterator it = __order.begin(); it != __order.end(); ++it)
+    scene->add(__entries.find(*it)->second.shape);
+  return scene;
+}
+
+void
+ViewSceneStream::clear()
+{
+  __entries.clear();
+  __order.clear();
+}
+
+/* ----------------------------------------------------------------------- */
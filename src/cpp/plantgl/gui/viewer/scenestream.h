@@ -0,0 +1,176 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2006 - Cirad/Inria/Inra - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr)
+ *
+ *       Development site : https://gforge.inria.fr/projects/openalea/
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/*! \file view_scenestream.h
+    \brief Definition of the viewer classes ViewSceneDelta and ViewSceneStream.
+*/
+
+#ifndef __view_scenestream_h__
+#define __view_scenestream_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../gui_config.h"
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/math/util_matrix.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <vector>
+#include <iostream>
+
+TOOLS_BEGIN_NAMESPACE
+class leofstream;
+class lemmapstream;
+TOOLS_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ViewSceneDelta
+   \brief The changes of a scene streamed to the viewer between two frames.
+
+   The shapes are identified by a key: their id, or their object id if they have none
+   or if a previous shape of the scene has the same id.
+   The changes are applied in order: removal, addition or replacement of whole shapes
+   and then update of the transformation of the shapes whose geometry did not change.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class VIEW_API ViewSceneDelta
+{
+public:
+
+  typedef std::vector<std::pair<uint_t,PGL(Shape3DPtr)> > ShapeList;
+  typedef std::vector<std::pair<uint_t,TOOLS(Matrix4)> > TransformList;
+
+  ViewSceneDelta(bool reset = false);
+
+  /// Return whether the delta does not change the scene.
+  bool empty() const;
+
+  /** Merge the delta \e next that follows \e self.
+      \e self then goes from the scene before \e self to the scene after \e next. */
+  void merge(const ViewSceneDelta& next);
+
+  /// Write \e self in binary format. The shapes are written as a BGEOM scene.
+  void write(TOOLS(leofstream)& stream) const;
+
+  /// Read \e self from \e stream. Return false if the stream is not valid.
+  bool read(TOOLS(lemmapstream)& stream, std::ostream& errlog);
+
+  /// Whether the delta replaces the whole scene.
+  bool reset;
+
+  /// The keys of the removed shapes.
+  std::vector<uint_t> removed;
+
+  /// The shapes added or replaced, with their key.
+  ShapeList shapes;
+
+  /// The new transformation of the shapes of which only the transformation changed.
+  TransformList transforms;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ViewSceneStream
+   \brief The last state of a scene streamed to the viewer.
+
+   The sending process computes the delta of each new scene with update.
+   The viewer rebuilds the scene by applying the received deltas.
+   The shapes that did not change are shared between the successive scenes.
+
+   A shape changes when its geometry or its appearance is replaced, or when the matrix
+   of the transformations at the top of its geometry changes, even if they are modified in place.
+   Other modifications made in place, such as a new point list of a mesh, are not detected:
+   the modified geometry must be a new object to be streamed again.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class VIEW_API ViewSceneStream
+{
+public:
+
+  ViewSceneStream();
+
+  /// Return the changes from the current state to \e scene, which becomes the current state.
+  ViewSceneDelta update(const PGL(ScenePtr)& scene);
+
+  /// Apply \e delta to the current state.
+  void apply(const ViewSceneDelta& delta);
+
+  /// Return the scene of the current state.
+  PGL(ScenePtr) getScene() const;
+
+  /// Clear the current state. The next update resets the whole scene.
+  void clear();
+
+  /// Return the number of shapes of the current state.
+  size_t size() const { return __entries.size(); }
+
+  /// Return the key identifying \e shape in the stream, unless a previous shape of the scene has the same id.
+  static uint_t getKey(const PGL(Shape3DPtr)& shape);
+
+  /** Return the geometry \e base transformed by \e matrix with Scaled, EulerRotated and Translated nodes.
+      Return a null pointer if \e matrix cannot be expressed this way. */
+  static PGL(GeometryPtr) transform(const PGL(GeometryPtr)& base, const TOOLS(Matrix4)& matrix);
+
+protected:
+
+  struct Entry {
+    /// The shape.
+    PGL(Shape3DPtr) shape;
+    /// The geometry and the appearance of the shape when it was recorded.
+    PGL(GeometryPtr) geometry;
+    PGL(AppearancePtr) appearance;
+    /// The geometry without its top level matrix transformations, and their product.
+    PGL(GeometryPtr) base;
+    TOOLS(Matrix4) matrix;
+  };
+
+  static Entry makeEntry(const PGL(Shape3DPtr)& shape);
+
+  typedef pgl_hash_map<uint_t,Entry> EntryMap;
+
+  /// The shapes of the current state and their order in the scene.
+  EntryMap __entries;
+  std::vector<uint_t> __order;
+
+};
+
+/* ----------------------------------------------------------------------- */
+#endif
@@ -56,6 +56,21 @@ protected:
 
 /* ----------------------------------------------------------------------- */
 
+/** Releases the GIL during its lifetime, so that other python threads can run
+    while a long C++ computation is done. No python object must be used meanwhile. */
+class PythonInterpreterReleaser {
+public:
+
+    PythonInterpreterReleaser() : state(PyEval_SaveThread()) { }
+
+    ~PythonInterpreterReleaser() { PyEval_RestoreThread(state); }
+
+protected:
+    PyThreadState * state;
+};
+
+/* ----------------------------------------------------------------------- */
+
 class PyStateSaver {
 public:
   PyStateSaver() : _state(0) { }
@@ -0,0 +1,93 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#ifndef __release_gil_h__
+#define __release_gil_h__
+
+/*! \file release_gil.h
+    \brief Wrappers of C++ functions that release the GIL during their call.
+
+    \c PGL_NOGIL(&func) and \c PGL_NOGIL_SIG(signature,&func) give a function
+    with the signature of \e func to export with \c def. The GIL is released
+    once the arguments are converted and taken back before the conversion of
+    the result, so that other python threads run during the computation.
+    Only pure C++ functions, that do not use python objects, can be wrapped.
+    Member functions are wrapped into functions taking the object as first argument.
+*/
+
+#include "pyinterpreter.h"
+#include <boost/preprocessor/arithmetic/inc.hpp>
+#include <boost/preprocessor/repetition/enum_params.hpp>
+#include <boost/preprocessor/repetition/enum_binary_params.hpp>
+#include <boost/preprocessor/repetition/enum_trailing_params.hpp>
+#include <boost/preprocessor/repetition/enum_trailing_binary_params.hpp>
+#include <boost/preprocessor/repetition/repeat.hpp>
+#include <boost/typeof/typeof.hpp>
+
+/* ----------------------------------------------------------------------- */
+
+#ifndef PGL_NOGIL_MAX_ARITY
+#define PGL_NOGIL_MAX_ARITY 12
+#endif
+
+template<class F, F f> struct pgl_nogil_caller;
+
+#define PGL_NOGIL_CALLER(z, n, unused) \
+template<class R BOOST_PP_ENUM_TRAILING_PARAMS(n, class A), R (*f)(BOOST_PP_ENUM_PARAMS(n, A))> \
+struct pgl_nogil_caller<R (*)(BOOST_PP_ENUM_PARAMS(n, A)), f> { \
+    static R call(BOOST_PP_ENUM_BINARY_PARAMS(n, A, a)) \
+    { PythonInterpreterReleaser nogil; return f(BOOST_PP_ENUM_PARAMS(n, a)); } \
+}; \
+template<class R, class C BOOST_PP_ENUM_TRAILING_PARAMS(n, class A), R (C::*f)(BOOST_PP_ENUM_PARAMS(n, A))> \
+struct pgl_nogil_caller<R (C::*)(BOOST_PP_ENUM_PARAMS(n, A)), f> { \
+    static R call(C& self BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n, A, a)) \
+    { PythonInterpreterReleaser nogil; return (self.*f)(BOOST_PP_ENUM_PARAMS(n, a)); } \
+}; \
+template<class R, class C BOOST_PP_ENUM_TRAILING_PARAMS(n, class A), R (C::*f)(BOOST_PP_ENUM_PARAMS(n, A)) const> \
+struct pgl_nogil_caller<R (C::*)(BOOST_PP_ENUM_PARAMS(n, A)) const, f> { \
+    static R call(const C& self BOOST_PP_ENUM_TRAILING_BINARY_PARAMS(n, A, a)) \
+    { PythonInterpreterReleaser nogil; return (self.*f)(BOOST_PP_ENUM_PARAMS(n, a)); } \
+}; \
+
+BOOST_PP_REPEAT(BOOST_PP_INC(PGL_NOGIL_MAX_ARITY), PGL_NOGIL_CALLER, ~)
+
+#undef PGL_NOGIL_CALLER
+
+/// A function calling the non overloaded function \e FUNC without the GIL.
+#define PGL_NOGIL(FUNC) &pgl_nogil_caller<BOOST_TYPEOF(FUNC), FUNC>::call
+
+/// A function calling the function \e FUNC of signature \e SIG without the GIL.
+#define PGL_NOGIL_SIG(SIG, FUNC) &pgl_nogil_caller<SIG, FUNC>::call
+
+/* ----------------------------------------------------------------------- */
+
+// __release_gil_h__
+#endif
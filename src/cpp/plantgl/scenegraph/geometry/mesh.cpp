@@ -38,6 +38,7 @@
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/colorarray.h>
 #include <plantgl/tool/util_string.h>
+#include <plantgl/tool/util_parallel.h>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -52,11 +53,62 @@ const bool Mesh::DEFAULT_COLORPERVERTEX(true);
 
 const Vector3 Mesh::DEFAULT_NORMAL_VALUE(0,0,1);
 const PolylinePtr Mesh::DEFAULT_SKELETON;
+const uint_t Mesh::PARALLEL_NORMAL_THRESHOLD(100000);
 
 
 /* ----------------------------------------------------------------------- */
 
 
+VertexFaceAdjacency::VertexFaceAdjacency( const Mesh& mesh ) :
+  RefCountObject(),
+  __offsets(mesh.getPointList()->size()+1,0),
+  __faces(),
+  __source(mesh.getIndexListObject()),
+  __nbFaces(mesh.getIndexListSize()),
+  __checksum(computeChecksum(mesh))
+{
+  uint_t nbFaces = mesh.getIndexListSize();
+  for(uint_t j = 0; j < nbFaces; ++j)
+      for(uint_t i = 0; i < mesh.getFaceSize(j); ++i)
+          ++__offsets[mesh.getFacePointIndexAt(j,i)+1];
+  for(uint_t k = 1; k < __offsets.size(); ++k)
+      __offsets[k] += __offsets[k-1];
+  __faces.resize(__offsets.back());
+  std::vector<uint_t> fill(__offsets.begin(),__offsets.end()-1);
+  for(uint_t j = 0; j < nbFaces; ++j)
+      for(uint_t i = 0; i < mesh.getFaceSize(j); ++i)
+          __faces[fill[mesh.getFacePointIndexAt(j,i)]++] = j;
+}
+
+VertexFaceAdjacency::~VertexFaceAdjacency( ) {
+}
+
+bool
+VertexFaceAdjacency::isValidFor( const Mesh& mesh ) const {
+  return __source == mesh.getIndexListObject() &&
+         is_valid_ptr(mesh.getPointList()) &&
+         mesh.getPointList()->size() == getNbPoints() &&
+         mesh.getIndexListSize() == __nbFaces &&
+         computeChecksum(mesh) == __checksum;
+}
+
+uint64_t
+VertexFaceAdjacency::computeChecksum( const Mesh& mesh ) {
+  // FNV-1a hash of the face sizes and of the indices.
+  uint64_t checksum = 14695981039346656037ULL;
+  uint_t nbFaces = mesh.getIndexListSize();
+  for(uint_t j = 0; j < nbFaces; ++j){
+      uint_t size = mesh.getFaceSize(j);
+      checksum = (checksum ^ size) * 1099511628211ULL;
+      for(uint_t i = 0; i < size; ++i)
+          checksum = (checksum ^ mesh.getFacePointIndexAt(j,i)) * 1099511628211ULL;
+  }
+  return checksum;
+}
+
+/* ----------------------------------------------------------------------- */
+
+
 Mesh::Builder::Builder( )
   : ExplicitModel::Builder()
   , CCW(0)
@@ -102,12 +154,8 @@ Mesh::Builder::MeshValid( ) const{
   if(!EMValid())return false;
   
   if(NormalList){
+    // The number of normals depends on the index lists and is checked by the indexed meshes.
     uint_t _normalListSize = (*NormalList)->size();
-	if(NormalPerVertex && *NormalPerVertex &&_normalListSize != (*PointList)->size()){
-    pglErrorEx(PGLWARNINGMSG(INVALID_FIELD_VALUE_sss),"Mesh","Normals","Number of normals must be compatible to PointList.");
-	return false;
-	}
-
     for (uint_t _i = 0; _i < _normalListSize; _i++){
       if (!(*NormalList)->getAt(_i).isValid()) {
 	pglErrorEx
@@ -308,8 +356,13 @@ Mesh::isNormalListToDefault() const {
 void
 Mesh::computeNormalList(bool pervertex){
 	__normalPerVertex = pervertex;
-  if(pervertex)
-	__normalList = computeNormalPerVertex();
+  if(pervertex){
+    if (getIndexListSize() > PARALLEL_NORMAL_THRESHOLD && pgl_thread_count() > 1) {
+      // Build the adjacency once before the parallel loop shares it.
+      getVertexFaceAdjacency();
+    }
+    __normalList = computeNormalPerVertex();
+  }
   else
 	__normalList = computeNormalPerFace();
 }
@@ -331,47 +384,157 @@ Mesh::getFaceCenter( uint_t i ) const
 }
 
 
+/* ----------------------------------------------------------------------- */
+
+// Number of faces whose normals are computed together. The coordinates of a block
+// are gathered in separate arrays so that the cross products can be vectorized.
+#define FACE_NORMAL_BLOCK 256
+
+struct FaceNormalComputer {
+    const Mesh& mesh;
+    Point3Array * normals;
+    uint_t second, third;
+
+    FaceNormalComputer(const Mesh& _mesh, Point3Array * _normals = NULL) :
+        mesh(_mesh), normals(_normals),
+        second(_mesh.getCCW() ? 1 : 2), third(_mesh.getCCW() ? 2 : 1) {}
+
+    // Computes the unnormalized normals of the faces [block, block+nb) in result.
+    void computeBlock(size_t block, size_t nb, Vector3 * result) const {
+        real_t ux[FACE_NORMAL_BLOCK], uy[FACE_NORMAL_BLOCK], uz[FACE_NORMAL_BLOCK];
+        real_t vx[FACE_NORMAL_BLOCK], vy[FACE_NORMAL_BLOCK], vz[FACE_NORMAL_BLOCK];
+        real_t nx[FACE_NORMAL_BLOCK], ny[FACE_NORMAL_BLOCK], nz[FACE_NORMAL_BLOCK];
+
+        for(size_t k = 0; k < nb; ++k){
+            const Vector3& p0 = mesh.getFacePointAt(block+k,0);
+            const Vector3& p1 = mesh.getFacePointAt(block+k,second);
+            const Vector3& p2 = mesh.getFacePointAt(block+k,third);
+            ux[k] = p1.x() - p0.x(); uy[k] = p1.y() - p0.y(); uz[k] = p1.z() - p0.z();
+            vx[k] = p2.x() - p0.x(); vy[k] = p2.y() - p0.y(); vz[k] = p2.z() - p0.z();
+        }
+        for(size_t k = 0; k < nb; ++k){
+            nx[k] = uy[k] * vz[k] - uz[k] * vy[k];
+            ny[k] = uz[k] * vx[k] - ux[k] * vz[k];
+            nz[k] = ux[k] * vy[k] - uy[k] * vx[k];
+        }
+        for(size_t k = 0; k < nb; ++k)
+            result[k] = Vector3(nx[k],ny[k],nz[k]);
+    }
+
+    void operator()(size_t first, size_t last) const {
+        GEOM_ASSERT(normals != NULL);
+        for(size_t block = first; block < last; block += FACE_NORMAL_BLOCK)
+            computeBlock(block, std::min<size_t>(FACE_NORMAL_BLOCK, last - block), &*(normals->begin() + block));
+    }
+};
+
+// Sums the (area weighted) normals of the faces around each point.
+struct VertexNormalGatherer {
+    const VertexFaceAdjacency& adjacency;
+    const Point3Array& faceNormals;
+    Point3Array& normals;
+
+    VertexNormalGatherer(const VertexFaceAdjacency& _adjacency, const Point3Array& _faceNormals, Point3Array& _normals) :
+        adjacency(_adjacency), faceNormals(_faceNormals), normals(_normals) {}
+
+    void operator()(size_t first, size_t last) const {
+        for(size_t i = first; i < last; ++i){
+            uint_t nbFaces = adjacency.getNbFaces(i);
+            if (nbFaces == 0) { normals.setAt(i, Vector3(1,0,0)); continue; }
+            const uint_t * faces = adjacency.getFaces(i);
+            Vector3 sum;
+            for(uint_t f = 0; f < nbFaces; ++f) sum += faceNormals.getAt(faces[f]);
+            normals.setAt(i, sum);
+        }
+    }
+};
+
+struct NormalNormalizer {
+    Point3Array& normals;
+
+    NormalNormalizer(Point3Array& _normals) : normals(_normals) {}
+
+    void operator()(size_t first, size_t last) const {
+        for(Point3Array::iterator _it = normals.begin() + first; _it != normals.begin() + last; ++_it){
+            _it->normalize();
+            if (fabs(norm(*_it) - 1.0) > GEOM_EPSILON) *_it = Mesh::DEFAULT_NORMAL_VALUE;
+        }
+    }
+};
+
+template<class Function>
+inline void apply_on_range(size_t size, Function& function, bool parallel)
+{
+    if (parallel) pgl_parallel_for(0, size, function, Mesh::PARALLEL_NORMAL_THRESHOLD / 8);
+    else function(0, size);
+}
+
+/* ----------------------------------------------------------------------- */
+
+const VertexFaceAdjacencyPtr&
+Mesh::getVertexFaceAdjacency( ) {
+    if (!__vertexFaceAdjacency || !__vertexFaceAdjacency->isValidFor(*this))
+        __vertexFaceAdjacency = VertexFaceAdjacencyPtr(new VertexFaceAdjacency(*this));
+    return __vertexFaceAdjacency;
+}
+
 Point3ArrayPtr 
 Mesh::computeNormalPerVertex() const {
-    std::vector<bool> hasNormal(__pointList->size(),false);
+    uint_t nbFaces = getIndexListSize();
     Point3ArrayPtr normalList(new Point3Array(__pointList->size()));
-    uint_t i = 0;
-    uint_t j = 0;
-    for(j=0; j < getIndexListSize(); j++){
-        Vector3 _norm = cross(getFacePointAt(j,__ccw ? 1 : 2) - getFacePointAt(j,0),
-                              getFacePointAt(j,__ccw ? 2 : 1) - getFacePointAt(j,0));
-        for(i = 0; i < getFaceSize(j); i++){
-            uint_t _index = getFacePointIndexAt(j,i);
-            normalList->getAt(_index)+=_norm;
-            hasNormal[_index] = true;
-        }
-    }
-    for(i=0; i < __pointList->size(); i++) {
-        if(!hasNormal[i] )
-            normalList->setAt(i,Vector3( 1,0,0 ) );
+
+    if (nbFaces > PARALLEL_NORMAL_THRESHOLD && pgl_thread_count() > 1) {
+        // Face normals are computed first and then gathered around each point
+        // using the adjacency, so that no two threads write the same normal.
+        Point3Array faceNormals(nbFaces);
+        FaceNormalComputer faceComputer(*this, &faceNormals);
+        pgl_parallel_for(0, nbFaces, faceComputer, PARALLEL_NORMAL_THRESHOLD / 8);
+
+        VertexFaceAdjacencyPtr adjacency = __vertexFaceAdjacency;
+        if (!adjacency || !adjacency->isValidFor(*this))
+            adjacency = VertexFaceAdjacencyPtr(new VertexFaceAdjacency(*this));
+
+        VertexNormalGatherer gatherer(*adjacency, faceNormals, *normalList);
+        pgl_parallel_for(0, normalList->size(), gatherer, PARALLEL_NORMAL_THRESHOLD / 8);
     }
-    for(Point3Array::iterator _it=normalList->begin();_it!=normalList->end();_it++)
-    {
-	    _it->normalize();
-        if (fabs(norm(*_it) - 1.0) > GEOM_EPSILON) *_it = DEFAULT_NORMAL_VALUE;
+    else {
+        std::vector<bool> hasNormal(__pointList->size(),false);
+        FaceNormalComputer faceComputer(*this);
+        Vector3 faceNormals[FACE_NORMAL_BLOCK];
+        for(uint_t block = 0; block < nbFaces; block += FACE_NORMAL_BLOCK){
+            uint_t nb = std::min<uint_t>(FACE_NORMAL_BLOCK, nbFaces - block);
+            faceComputer.computeBlock(block, nb, faceNormals);
+            for(uint_t k = 0; k < nb; ++k){
+                for(uint_t i = 0; i < getFaceSize(block+k); i++){
+                    uint_t _index = getFacePointIndexAt(block+k,i);
+                    normalList->getAt(_index) += faceNormals[k];
+                    hasNormal[_index] = true;
+                }
+            }
+        }
+        for(uint_t i = 0; i < __pointList->size(); i++) {
+            if(!hasNormal[i] )
+                normalList->setAt(i,Vector3( 1,0,0 ) );
+        }
     }
 
+    NormalNormalizer normalizer(*normalList);
+    apply_on_range(normalList->size(), normalizer, nbFaces > PARALLEL_NORMAL_THRESHOLD);
+
     return normalList;
 }
 
 Point3ArrayPtr 
 Mesh::computeNormalPerFace() const {
-    Point3ArrayPtr normalList(new Point3Array(getIndexListSize())); 
-    for(uint_t j=0; j < getIndexListSize(); j++){ 
-	    normalList->setAt(j,cross(getFacePointAt(j,__ccw ? 1 : 2) - getFacePointAt(j,0), 
-			      getFacePointAt(j,__ccw ? 2 : 1) - getFacePointAt(j,0))); 
-    }
-    bool hasinvalid = false;
-    for(Point3Array::iterator _it=normalList->begin();_it!=normalList->end();_it++)
-    {
-	    _it->normalize();
-        if (fabs(norm(*_it) - 1.0) > GEOM_EPSILON) *_it = DEFAULT_NORMAL_VALUE;
-    }
+    uint_t nbFaces = getIndexListSize();
+    bool parallel = nbFaces > PARALLEL_NORMAL_THRESHOLD;
+
+    Point3ArrayPtr normalList(new Point3Array(nbFaces)); 
+    FaceNormalComputer faceComputer(*this, normalList.get());
+    apply_on_range(nbFaces, faceComputer, parallel);
+
+    NormalNormalizer normalizer(*normalList);
+    apply_on_range(nbFaces, normalizer, parallel);
 
 	return normalList;
 }
@@ -41,6 +41,7 @@
 
 #include "explicitmodel.h"
 #include "polyline.h"
+#include <vector>
 /* ----------------------------------------------------------------------- */
 
 TOOLS_BEGIN_NAMESPACE
@@ -51,6 +52,67 @@ TOOLS_END_NAMESPACE
 
 PGL_BEGIN_NAMESPACE
 
+class Mesh;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class VertexFaceAdjacency
+   \brief The faces incident to each point of a mesh, stored in compressed rows:
+   the faces around the point \e i are getFaces(i)[0] ... getFaces(i)[getNbFaces(i)-1],
+   in increasing face order.
+*/
+
+class SG_API VertexFaceAdjacency : public TOOLS(RefCountObject)
+{
+
+public:
+
+  /// Constructs the adjacency of \e mesh.
+  VertexFaceAdjacency( const Mesh& mesh );
+
+  /// Destructor
+  virtual ~VertexFaceAdjacency( );
+
+  /// Returns the number of points described by \e self.
+  inline uint_t getNbPoints( ) const { return __offsets.size() - 1; }
+
+  /// Returns the number of faces incident to the \e i-th point.
+  inline uint_t getNbFaces( uint_t i ) const
+  { GEOM_ASSERT(i < getNbPoints()); return __offsets[i+1] - __offsets[i]; }
+
+  /// Returns the ids of the faces incident to the \e i-th point.
+  inline const uint_t * getFaces( uint_t i ) const
+  { GEOM_ASSERT(i < getNbPoints()); return __faces.empty() ? NULL : &__faces[__offsets[i]]; }
+
+  /** Returns whether \e self still describes \e mesh, i.e. it has been built
+      from the same index list object for the same number of points and the
+      indices have not changed since. The indices are checked with a checksum,
+      so that the modifications of the index list in place are detected. */
+  bool isValidFor( const Mesh& mesh ) const;
+
+  /// Returns the checksum of the indices of \e mesh compared by isValidFor.
+  static uint64_t computeChecksum( const Mesh& mesh );
+
+protected:
+
+  /// Start of the faces of each point in __faces. Has one more element than points.
+  std::vector<uint_t> __offsets;
+
+  /// The face ids of all points.
+  std::vector<uint_t> __faces;
+
+  /// The index list from which \e self has been built.
+  TOOLS(RefCountObjectPtr) __source;
+
+  /// The number of faces and the checksum of the indices from which \e self has been built.
+  uint_t __nbFaces;
+  uint64_t __checksum;
+
+};
+
+/// VertexFaceAdjacency Pointer
+typedef RCPtr<VertexFaceAdjacency> VertexFaceAdjacencyPtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -82,6 +144,9 @@ public:
   /// The default normal value
   static const TOOLS(Vector3) DEFAULT_NORMAL_VALUE;
 
+  /// Number of faces above which normals are computed with several threads.
+  static const uint_t PARALLEL_NORMAL_THRESHOLD;
+
   /// A structure which helps to build an object of type of Mesh.
   struct SG_API Builder : public ExplicitModel::Builder {
 
@@ -356,6 +421,16 @@ public:
   Point3ArrayPtr computeNormalPerVertex() const;
   Point3ArrayPtr computeNormalPerFace() const;
 
+  /** Returns the vertex to face adjacency of \e self. It is computed on first
+      call and kept until the point list or the index list object changes. */
+  const VertexFaceAdjacencyPtr& getVertexFaceAdjacency( );
+
+  /// Discards the cached adjacency. Needed after in place modification of the indices.
+  inline void invalidateVertexFaceAdjacency( ) { __vertexFaceAdjacency = VertexFaceAdjacencyPtr(); }
+
+  /// Returns the object storing the indices of the faces.
+  virtual TOOLS(RefCountObjectPtr) getIndexListObject( ) const = 0;
+
   inline bool hasNormalList() const { return is_valid_ptr(__normalList); }
   inline void checkNormalList() { if(!hasNormalList())computeNormalList(); }
   inline void computeNormalList() { computeNormalList(__normalPerVertex); };
@@ -388,6 +463,9 @@ public:
   /// The Skeleton field.
   PolylinePtr __skeleton;
 
+  /// The cached vertex to face adjacency.
+  VertexFaceAdjacencyPtr __vertexFaceAdjacency;
+
 }; // Mesh
 
 /// Mesh Pointer
@@ -539,6 +617,10 @@ public:
   virtual uint_t getIndexListSize( ) const 
   { return (__indexList?__indexList->size():0); }
 
+  /// Returns the object storing the indices of the faces.
+  virtual TOOLS(RefCountObjectPtr) getIndexListObject( ) const
+  { return TOOLS(RefCountObjectPtr)(__indexList.get()); }
+
   /// Returns the nb of points of the \b i-th face.
   virtual uint_t getFaceSize( uint_t i ) const 
   { return __indexList->getIndexSizeAt(i); }
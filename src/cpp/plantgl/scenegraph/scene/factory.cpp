@@ -33,6 +33,7 @@
 #include <algorithm>
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/util_string.h>
+#include <plantgl/tool/util_mutex.h>
 #include <plantgl/scenegraph/core/pgl_messages.h>
 
 PGL_USING_NAMESPACE
@@ -69,6 +70,47 @@ bool SceneCodec::test(const std::string& fname, Mode openingMode)
 
 SceneFactoryPtr SceneFactory::__factory;
 
+namespace {
+
+/* The mutex is never destroyed since threads reading files may still
+   use it when the static objects are destroyed. */
+PglRecursiveMutex& codecMutex()
+{
+  static PglRecursiveMutex * mutex = new PglRecursiveMutex();
+  return *mutex;
+}
+
+SceneFactory::LockWaitBegin lockWaitBegin = NULL;
+SceneFactory::LockWaitEnd lockWaitEnd = NULL;
+
+/// Locks the codecs for the lifetime of the locker.
+struct CodecLocker {
+  CodecLocker() { SceneFactory::lock(); }
+  ~CodecLocker() { SceneFactory::unlock(); }
+};
+
+}
+
+void SceneFactory::lock()
+{
+  PglRecursiveMutex& mutex = codecMutex();
+  if (mutex.tryLock()) return;
+  void * state = (lockWaitBegin ? lockWaitBegin() : NULL);
+  mutex.lock();
+  if (lockWaitEnd) lockWaitEnd(state);
+}
+
+void SceneFactory::unlock()
+{
+  codecMutex().unlock();
+}
+
+void SceneFactory::setLockWaitFunctions(LockWaitBegin begin, LockWaitEnd end)
+{
+  lockWaitBegin = begin;
+  lockWaitEnd = end;
+}
+
 
 SceneFactory::SceneFactory()
 {
@@ -139,6 +181,7 @@ SceneFactory::read(const std::string& fname)
       pglErrorEx(PGLERRORMSG(C_FILE_OPEN_ERR_s),fname.c_str());
       return ScenePtr();
     };
+	CodecLocker locker;
 	std::string cwd = get_cwd();
 	for(CodecList::reverse_iterator it = __codecs.rbegin(); it !=__codecs.rend(); ++it){
 			SceneCodecPtr codec = *it;
@@ -159,6 +202,7 @@ SceneFactory::read(const std::string& fname)
 
 bool SceneFactory::write(const std::string& fname,const ScenePtr& scene)
 {
+	CodecLocker locker;
 	std::string cwd = get_cwd();
 	bool done = false;
 	for(CodecList::reverse_iterator it = __codecs.rbegin();
@@ -190,6 +234,7 @@ ScenePtr
 SceneFactory::read(const std::string& fname, const std::string& codecname)
 {
 	SceneCodecPtr codec = findCodec(codecname);
+	CodecLocker locker;
 	if (codec) // && codec->test(fname,SceneCodec::Read))
 		return codec->read(fname);
     else {
@@ -204,6 +249,7 @@ bool
 SceneFactory::write(const std::string& fname,const ScenePtr& scene, const std::string& codecname)
 {
 	SceneCodecPtr codec = findCodec(codecname);
+	CodecLocker locker;
 	if (codec) // && codec->test(fname,SceneCodec::Write))
 		return codec->write(fname,scene);
         
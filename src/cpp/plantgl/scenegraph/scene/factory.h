@@ -133,6 +133,21 @@ public:
 	bool installDefaultLib();
 	void clear();
 
+	/** Locks the codecs for the calling thread. The reading and writing of files are
+	    serialized since the codecs change the current directory and use static states.
+	    The lock is reentrant. */
+	static void lock();
+
+	/// Unlocks the codecs.
+	static void unlock();
+
+	/** Functions called before and after a thread waits for the lock of the codecs,
+	    with the value returned by the first one. They allow to release the python
+	    interpreter while waiting for a thread reading a file with a python codec. */
+	typedef void * (*LockWaitBegin)();
+	typedef void (*LockWaitEnd)(void *);
+	static void setLockWaitFunctions(LockWaitBegin begin, LockWaitEnd end);
+
     typedef CodecList::const_iterator const_iterator;
     const_iterator begin() const { return __codecs.begin(); }
     const_iterator end() const { return __codecs.end(); }
@@ -31,13 +31,23 @@
 
 #include "inline.h"
 #include "scene.h"
+#include "factory.h"
 #include <plantgl/scenegraph/transformation/translated.h>
 
 #include <plantgl/scenegraph/core/pgl_messages.h>
 #include <plantgl/tool/util_string.h>
 #include <plantgl/tool/dirnames.h>
+#include <plantgl/tool/util_mutex.h>
 
 #include <fstream>
+#include <map>
+
+#ifndef PGL_CORE_WITHOUT_QT
+    #include <QtCore/QThreadPool>
+    #include <QtCore/QRunnable>
+#elif defined(PGL_THREAD_SUPPORT)
+    #include <thread>
+#endif
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -127,7 +137,7 @@ Inline::Inline(const string& filename, const Vector3& translation, const Vector3
     __filename(filename),
     __translation(translation),
     __scale(scale),
-    __scene(new Scene(filename, "")){
+    __scene(){
     if ( __name.empty() ) setDefaultName();
 }
 
@@ -146,50 +156,322 @@ Inline::getFileName() const {
   return __filename;
 }
 
+/* Protects the sub scenes of the inlines, which may be read by several threads.
+   The mutex is never destroyed, as the one of the cache. */
+static PglMutex& inlineSceneMutex()
+{
+  static PglMutex * mutex = new PglMutex();
+  return *mutex;
+}
+
+/// The scene is read with the inlines unlocked, since it may contain inlines.
+const ScenePtr& Inline::getScene() const {
+  if(!isLoaded()) {
+    ScenePtr scene = InlineSceneCache::get(__filename);
+    PglMutexLocker lock(inlineSceneMutex());
+    // Another thread may have set it meanwhile.
+    if(!__scene) __scene = scene;
+  }
+  return __scene;
+}
+
+bool Inline::isLoaded() const {
+  PglMutexLocker lock(inlineSceneMutex());
+  return __scene.get() != NULL;
+}
+
+void Inline::prefetch() const {
+  if(!isLoaded()) InlineSceneCache::prefetch(__filename);
+}
+
+/// A scene which is not read yet is only checked for the existence of its file.
 bool Inline::isValid( ) const{
-    if(!__scene) return false;
+    if(!isLoaded()) return exists(__filename);
     else return __scene->isValid();
 }
 
 SceneObjectPtr Inline::copy(DeepCopier& copier) const
 {
+  // The scene is read first, so that it does not change while self is copied.
+  const ScenePtr& scene = getScene();
   Inline * ptr = new Inline(*this);
-  if(ptr->__scene)ptr->__scene = ptr->__scene->deepcopy(copier);
+  ptr->__scene = scene->deepcopy(copier);
   return SceneObjectPtr(ptr);
 }
 
 bool
 Inline::applyGeometryFirst( Action& action )
 {
-  if(__scene) return __scene->applyGeometryFirst(action );
+  const ScenePtr& scene = getScene();
+  if(scene) return scene->applyGeometryFirst(action );
   return false;
 }
 
 bool
 Inline::applyGeometryOnly( Action& action )
 {
-  if(__scene) return __scene->applyGeometryOnly(action );
+  const ScenePtr& scene = getScene();
+  if(scene) return scene->applyGeometryOnly(action );
   return false;
 }
 
 bool
 Inline::applyAppearanceFirst( Action& action )
 {
-  if(__scene) return __scene->applyAppearanceFirst(action );
+  const ScenePtr& scene = getScene();
+  if(scene) return scene->applyAppearanceFirst(action );
   return false;
 }
 
 bool
 Inline::applyAppearanceOnly( Action& action )
 {
-  if(__scene) return __scene->applyAppearanceOnly(action );
+  const ScenePtr& scene = getScene();
+  if(scene) return scene->applyAppearanceOnly(action );
   return false;
 }
 
   /// Return whether self should be rendered dynamically
 bool Inline::hasDynamicRendering() const 
 { 
-    if(__scene) return __scene->hasDynamicRendering(); 
+    const ScenePtr& scene = getScene();
+    if(scene) return scene->hasDynamicRendering();
     return false;
 }
 
+/* ----------------------------------------------------------------------- */
+
+namespace {
+
+/* A scene of the cache. \e scene, \e loaded and \e users are accessed with the
+   cache locked. The entry is deleted when it is neither in the cache nor used
+   by a thread reading or loading it. */
+struct InlineCacheEntry {
+  InlineCacheEntry(const string& _filename, time_t _mtime) :
+    filename(_filename), mtime(_mtime), scene(), loaded(false), users(1) {}
+
+  const string filename;
+  const time_t mtime;
+  ScenePtr scene;
+  bool loaded;
+  // One for the cache while the entry is in it, plus one per thread using it.
+  uint_t users;
+};
+
+typedef std::map<string,InlineCacheEntry *> InlineCacheMap;
+
+/* The mutex is never destroyed since prefetching threads may still
+   use it when the static objects are destroyed. */
+struct InlineCacheData {
+  InlineCacheData() : enabled(true), mutex(new PglMutex()) {}
+
+  InlineCacheMap entries;
+  bool enabled;
+  // Protects entries and the fields of the entries.
+  PglMutex * mutex;
+};
+
+InlineCacheData& inlineCache()
+{
+  static InlineCacheData * data = new InlineCacheData();
+  return *data;
+}
+
+/// Releases a use of \e entry. Returns whether it must be deleted. The cache must be locked.
+inline bool releaseEntryLocked(InlineCacheEntry * entry)
+{ return --entry->users == 0; }
+
+/// Releases a use of \e entry, and deletes it if it is not used anymore.
+void releaseEntry(InlineCacheEntry * entry)
+{
+  InlineCacheData& cache = inlineCache();
+  cache.mutex->lock();
+  bool unused = releaseEntryLocked(entry);
+  cache.mutex->unlock();
+  if (unused) delete entry;
+}
+
+/// Reads the scene of \e entry if it is not already done. The caller must use \e entry.
+void loadEntry(InlineCacheEntry * entry)
+{
+  InlineCacheData& cache = inlineCache();
+  // The scene is read with the codecs locked, since they change the current
+  // directory and use static states.
+  SceneFactory::lock();
+  cache.mutex->lock();
+  bool loaded = entry->loaded;
+  cache.mutex->unlock();
+  if (!loaded) {
+    // The scene is only referenced once published, so that its
+    // counter is never modified by two threads at once.
+    Scene * scene = new Scene(entry->filename, "");
+    cache.mutex->lock();
+    entry->scene = ScenePtr(scene);
+    entry->loaded = true;
+    cache.mutex->unlock();
+  }
+  SceneFactory::unlock();
+}
+
+/// Loads \e entry and releases it.
+void prefetchEntry(InlineCacheEntry * entry)
+{
+  loadEntry(entry);
+  releaseEntry(entry);
+}
+
+#ifndef PGL_CORE_WITHOUT_QT
+
+class InlinePrefetchTask : public QRunnable {
+public:
+  InlinePrefetchTask(InlineCacheEntry * entry) : QRunnable(), __entry(entry) { setAutoDelete(true); }
+
+  virtual void run() { prefetchEntry(__entry); }
+
+protected:
+  InlineCacheEntry * __entry;
+};
+
+#endif
+
+/* Returns the entry of \e filename, or creates it, with a use for the caller.
+   An entry of an obsolete version of the file is removed from the cache. Its
+   pending prefetch, if any, completes and then releases it. */
+InlineCacheEntry * findEntry(const string& filename, bool& created)
+{
+  InlineCacheData& cache = inlineCache();
+  time_t mtime = last_modification(filename);
+  created = false;
+  InlineCacheEntry * obsolete = NULL;
+  InlineCacheEntry * entry;
+  cache.mutex->lock();
+  InlineCacheMap::iterator it = cache.entries.find(filename);
+  if (it != cache.entries.end() && it->second->mtime != mtime) {
+    if (releaseEntryLocked(it->second)) obsolete = it->second;
+    cache.entries.erase(it);
+    it = cache.entries.end();
+  }
+  if (it == cache.entries.end()) {
+    entry = new InlineCacheEntry(filename, mtime);
+    cache.entries[filename] = entry;
+    created = true;
+  }
+  else entry = it->second;
+  ++entry->users;
+  cache.mutex->unlock();
+  if (obsolete) delete obsolete;
+  return entry;
+}
+
+}
+
+ScenePtr InlineSceneCache::get(const std::string& filename)
+{
+  if (!isEnabled()) return ScenePtr(new Scene(filename, ""));
+  bool created;
+  InlineCacheEntry * entry = findEntry(absolute_filename(filename), created);
+  loadEntry(entry);
+  InlineCacheData& cache = inlineCache();
+  cache.mutex->lock();
+  ScenePtr scene = entry->scene;
+  bool unused = releaseEntryLocked(entry);
+  cache.mutex->unlock();
+  if (unused) delete entry;
+  return scene;
+}
+
+void InlineSceneCache::prefetch(const std::string& filename)
+{
+  if (!isEnabled()) return;
+  bool created;
+  InlineCacheEntry * entry = findEntry(absolute_filename(filename), created);
+  if (!created) { releaseEntry(entry); return; }
+  // The prefetch owns the use of the entry.
+#ifndef PGL_CORE_WITHOUT_QT
+  QThreadPool::globalInstance()->start(new InlinePrefetchTask(entry));
+#elif defined(PGL_THREAD_SUPPORT)
+  std::thread(prefetchEntry, entry).detach();
+#else
+  prefetchEntry(entry);
+#endif
+}
+
+void InlineSceneCache::wait()
+{
+  InlineCacheData& cache = inlineCache();
+  std::vector<InlineCacheEntry *> pending;
+  cache.mutex->lock();
+  for (InlineCacheMap::const_iterator it = cache.entries.begin(); it != cache.entries.end(); ++it)
+    if (!it->second->loaded) {
+      ++it->second->users;
+      pending.push_back(it->second);
+    }
+  cache.mutex->unlock();
+  for (std::vector<InlineCacheEntry *>::const_iterator it = pending.begin(); it != pending.end(); ++it)
+    prefetchEntry(*it);
+}
+
+void InlineSceneCache::setEnabled(bool enabled)
+{
+  InlineCacheData& cache = inlineCache();
+  cache.mutex->lock();
+  cache.enabled = enabled;
+  cache.mutex->unlock();
+  if (!enabled) clear();
+}
+
+bool InlineSceneCache::isEnabled()
+{
+  InlineCacheData& cache = inlineCache();
+  cache.mutex->lock();
+  bool enabled = cache.enabled;
+  cache.mutex->unlock();
+  return enabled;
+}
+
+size_t InlineSceneCache::size()
+{
+  InlineCacheData& cache = inlineCache();
+  cache.mutex->lock();
+  size_t nb = cache.entries.size();
+  cache.mutex->unlock();
+  return nb;
+}
+
+size_t InlineSceneCache::purge()
+{
+  InlineCacheData& cache = inlineCache();
+  std::vector<InlineCacheEntry *> unused;
+  size_t nb = 0;
+  cache.mutex->lock();
+  for (InlineCacheMap::iterator it = cache.entries.begin(); it != cache.entries.end(); ) {
+    InlineCacheEntry * entry = it->second;
+    if (entry->loaded && (!entry->scene || entry->scene->unique())) {
+      if (releaseEntryLocked(entry)) unused.push_back(entry);
+      cache.entries.erase(it++);
+      ++nb;
+    }
+    else ++it;
+  }
+  cache.mutex->unlock();
+  // The scenes are deleted with the cache unlocked.
+  for (std::vector<InlineCacheEntry *>::const_iterator it = unused.begin(); it != unused.end(); ++it)
+    delete *it;
+  return nb;
+}
+
+void InlineSceneCache::clear()
+{
+  InlineCacheData& cache = inlineCache();
+  std::vector<InlineCacheEntry *> unused;
+  cache.mutex->lock();
+  for (InlineCacheMap::iterator it = cache.entries.begin(); it != cache.entries.end(); ++it)
+    if (releaseEntryLocked(it->second)) unused.push_back(it->second);
+  cache.entries.clear();
+  cache.mutex->unlock();
+  // The pending prefetches complete and release their entries.
+  for (std::vector<InlineCacheEntry *>::const_iterator it = unused.begin(); it != unused.end(); ++it)
+    delete *it;
+}
+
+/* ----------------------------------------------------------------------- */
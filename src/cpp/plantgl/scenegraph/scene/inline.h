@@ -65,6 +65,8 @@ typedef RCPtr<Scene> ScenePtr;
    \class Inline
    \brief A 3D Scene represented by a list of objects
    of type of Shape which are positionned and .
+   The scene is read from its file on the first call to getScene(),
+   and shared through InlineSceneCache with the other inlines of the same file.
 */
 
 /* ----------------------------------------------------------------------- */
@@ -138,8 +140,14 @@ public:
   /// Return FileName value.
   const std::string& getFileName() const;
 
-  /// Return Sub Scene value.
-  inline const ScenePtr& getScene() const { return __scene; }
+  /// Return Sub Scene value. The file is read on the first call.
+  const ScenePtr& getScene() const;
+
+  /// Return whether the sub scene has already been read.
+  bool isLoaded() const;
+
+  /// Start to read the sub scene in the background. See InlineSceneCache::prefetch.
+  void prefetch() const;
 
   /// Return the translation value.
   inline const TOOLS(Vector3)& getTranslation() const { return __translation; }
@@ -176,8 +184,8 @@ protected :
   /// The scale
   TOOLS(Vector3) __scale;
 
-  /// The subscene.
-  ScenePtr __scene;
+  /// The subscene, read on demand. It is set once with the inlines locked.
+  mutable ScenePtr __scene;
 
 };
 
@@ -186,6 +194,49 @@ typedef RCPtr<Inline> InlinePtr;
 
 /* ----------------------------------------------------------------------- */
 
+/**
+   \class InlineSceneCache
+   \brief A process wide cache of the scenes of Inline, keyed by the absolute
+   path of their file and its modification time. The inlines of a same file
+   share a single scene, which is read again only if the file changes.
+   Files are read with the codecs locked (see SceneFactory::lock) since the
+   parsers are not reentrant.
+*/
+
+class SG_API InlineSceneCache {
+
+public:
+
+  /** Returns the scene of \e filename, reading it if it is not in the cache
+      or if the file was modified. Waits for a pending prefetch of the file. */
+  static ScenePtr get(const std::string& filename);
+
+  /** Starts to read \e filename in a background thread, so that a later call
+      to get() does not wait. The file is read immediately without thread support. */
+  static void prefetch(const std::string& filename);
+
+  /// Waits for all the pending prefetches.
+  static void wait();
+
+  /// Enables or disables the cache. When disabled, each inline reads its own scene.
+  static void setEnabled(bool enabled);
+
+  /// Returns whether the cache is enabled.
+  static bool isEnabled();
+
+  /// Returns the number of scenes in the cache.
+  static size_t size();
+
+  /// Removes the scenes used only by the cache and returns their number.
+  static size_t purge();
+
+  /// Removes all the scenes from the cache. The pending prefetches complete in the background.
+  static void clear();
+
+};
+
+/* ----------------------------------------------------------------------- */
+
 PGL_END_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
@@ -69,6 +69,7 @@ Scene::Scene(unsigned int size ) :
   {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
+   __loadMutex = new PglMutex();
 #endif
 #ifdef WITH_POOL
       POOL.registerScene(this);
@@ -81,10 +82,12 @@ Scene::Scene(const Scene& scene) :
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
+   __loadMutex = new PglMutex();
 #endif
 #ifdef WITH_POOL
       POOL.registerScene(this);
 #endif
+  scene.loadAll();
   scene.lock();
   __shapeList = std::vector<Shape3DPtr>(scene.__shapeList);
   scene.unlock();
@@ -92,7 +95,9 @@ Scene::Scene(const Scene& scene) :
 }
 
 Scene& Scene::operator=( const Scene& scene){
+  scene.loadAll();
   lock();
+  __loader = LoaderPtr();
   scene.lock();
   __shapeList = std::vector<Shape3DPtr>(scene.__shapeList);
   scene.unlock();
@@ -106,6 +111,7 @@ Scene::Scene(const string& filename, const std::string& format, ostream& errlog,
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
+   __loadMutex = new PglMutex();
 #endif
 #ifdef WITH_POOL
       POOL.registerScene(this);
@@ -120,6 +126,7 @@ Scene::Scene(const SceneObjectSymbolTable& table) :
 {
 #ifdef PGL_THREAD_SUPPORT
    __mutex = new PglMutex();
+   __loadMutex = new PglMutex();
 #endif
 #ifdef WITH_POOL
       POOL.registerScene(this);
@@ -181,6 +188,7 @@ Scene::~Scene( ){
 #endif
 #ifdef PGL_THREAD_SUPPORT
 	if (__mutex)delete __mutex;
+	if (__loadMutex)delete __loadMutex;
 #endif
 #ifdef GEOM_DEBUG
     cerr << "Delete Scene" << endl;
@@ -204,6 +212,7 @@ void Scene::unlock( ) const{
 void Scene::clear( ){
   lock();
   __shapeList.clear();
+  __loader = LoaderPtr();
   unlock();
 }
 
@@ -252,6 +261,7 @@ void Scene::remove( Scene::iterator& it )
 bool Scene::apply( Action& action ) {
   bool _result;
   if( ! (_result = action.beginProcess()))return false;
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::iterator _i = __shapeList.begin();
        _i != __shapeList.end();
@@ -266,6 +276,7 @@ bool Scene::apply( Action& action ) {
 bool Scene::applyGeometryFirst( Action& action ) {
   bool _result;
   if( ! (_result = action.beginProcess()))return false;
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::iterator _i = __shapeList.begin();
        _i != __shapeList.end();
@@ -281,6 +292,7 @@ bool Scene::applyGeometryFirst( Action& action ) {
 bool Scene::applyGeometryOnly( Action& action ) {
   bool _result;
   if( ! (_result = action.beginProcess()))return false;
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::iterator _i = __shapeList.begin();
        _i != __shapeList.end();
@@ -294,6 +306,7 @@ bool Scene::applyGeometryOnly( Action& action ) {
 bool Scene::applyAppearanceFirst( Action& action ) {
   bool _result;
   if( ! (_result = action.beginProcess()))return false;
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::iterator _i = __shapeList.begin();
        _i != __shapeList.end();
@@ -308,6 +321,7 @@ bool Scene::applyAppearanceFirst( Action& action ) {
 bool Scene::applyAppearanceOnly( Action& action ) {
   bool _result;
   if( ! (_result = action.beginProcess()))return false;
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::iterator _i = __shapeList.begin();
        _i != __shapeList.end();
@@ -342,10 +356,73 @@ bool Scene::empty( ) const {
 const Shape3DPtr Scene::getAt(uint_t i ) const {
   lock();
   Shape3DPtr ptr = __shapeList[i];
+  LoaderPtr loader = __loader;
   unlock();
+  if (is_null_ptr(ptr) && is_valid_ptr(loader)) {
+#ifdef PGL_THREAD_SUPPORT
+      __loadMutex->lock();
+#endif
+      // loadAll may have removed the loader meanwhile.
+      lock();
+      bool attached = (__loader == loader);
+      unlock();
+      if (attached) loader->load(*const_cast<Scene *>(this), i);
+      lock();
+      ptr = (i < __shapeList.size() ? __shapeList[i] : Shape3DPtr());
+      unlock();
+#ifdef PGL_THREAD_SUPPORT
+      __loadMutex->unlock();
+#endif
+  }
   return ptr;
 }
 
+void Scene::setLoader( const LoaderPtr& loader ) {
+  lock();
+  __loader = loader;
+  unlock();
+}
+
+bool Scene::isLoaded( uint_t i ) const {
+  lock();
+  bool loaded = is_valid_ptr(__shapeList[i]);
+  unlock();
+  return loaded;
+}
+
+void Scene::loadAll( ) const {
+  lock();
+  LoaderPtr loader = __loader;
+  uint_t nb = __shapeList.size();
+  unlock();
+  if (is_null_ptr(loader)) return;
+  Scene * self = const_cast<Scene *>(this);
+#ifdef PGL_THREAD_SUPPORT
+  // No shape is loaded by getAt until the list is compacted: its indices would be shifted.
+  __loadMutex->lock();
+#endif
+  lock();
+  bool attached = (__loader == loader);
+  unlock();
+  if (attached) {
+      for (uint_t i = 0; i < nb; ++i)
+          if (!isLoaded(i)) loader->load(*self, i);
+      lock();
+      self->__loader = LoaderPtr();
+      self->__shapeList.erase(std::remove(self->__shapeList.begin(), self->__shapeList.end(), Shape3DPtr()),
+                              self->__shapeList.end());
+      unlock();
+  }
+#ifdef PGL_THREAD_SUPPORT
+  __loadMutex->unlock();
+#endif
+}
+
+Scene::Loader::Loader() :
+  RefCountObject() {}
+
+Scene::Loader::~Loader() {}
+
 void Scene::setAt(uint_t i, const Shape3DPtr& ptr) {
   lock();
   __shapeList[i] = ptr;
@@ -354,6 +431,7 @@ void Scene::setAt(uint_t i, const Shape3DPtr& ptr) {
 
 const ShapePtr 
 Scene::getShapeId(uint_t id ) const {
+  loadAll();
   lock();
   for(Scene::const_iterator _it = __shapeList.begin() ; 
 					  _it != __shapeList.end(); 
@@ -371,6 +449,7 @@ Scene::getShapeId(uint_t id ) const {
 
 const Shape3DPtr 
 Scene::getSceneObjectId(uint_t id ) const {
+  loadAll();
   lock();
   for(Scene::const_iterator _it = __shapeList.begin() ; 
 					  _it != __shapeList.end(); 
@@ -397,6 +476,7 @@ ScenePtr Scene::deepcopy(DeepCopier& copier) const {
 }
 
 bool Scene::isValid( ) const {
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::const_iterator _i = __shapeList.begin();
   _i != __shapeList.end();
@@ -432,6 +512,7 @@ bool Scene::isValid( ostream& error,ostream& warning, ostream& info) const {
 
 bool Scene::hasDynamicRendering() const
 {
+  loadAll();
   lock();
   for (vector<Shape3DPtr>::const_iterator _i = __shapeList.begin();
   _i != __shapeList.end();
@@ -446,8 +527,14 @@ bool Scene::hasDynamicRendering() const
 void Scene::merge( const ScenePtr& scene ) {
   GEOM_ASSERT((scene) && (scene->isValid()));
   lock();
+  bool adopt = __shapeList.empty() && is_null_ptr(__loader);
+  unlock();
+  // An empty scene takes the shapes of a lazy scene without loading them.
+  if (!adopt) scene->loadAll();
+  lock();
   scene->lock();
-  __shapeList.insert(__shapeList.end(),scene->begin(),scene->end());
+  __shapeList.insert(__shapeList.end(),scene->__shapeList.begin(),scene->__shapeList.end());
+  if (adopt) __loader = scene->__loader;
   scene->unlock();
   unlock();
 }
@@ -470,6 +557,7 @@ struct shapecmp{
 };
 
 void Scene::sort() {
+    loadAll();
     std::sort(__shapeList.begin(),__shapeList.end(),shapecmp());
 }
 
@@ -80,6 +80,23 @@ public:
   /// A const iterator used to iterate through a Scene.
   typedef std::vector<Shape3DPtr>::const_iterator const_iterator;
 
+  /**
+     \class Loader
+     \brief Loads on demand the shapes of a Scene, for instance from a file.
+  */
+  class SG_API Loader : public TOOLS(RefCountObject) {
+  public:
+      Loader();
+      virtual ~Loader();
+
+      /** Sets in \e scene its \e i-th shape, and possibly the other shapes stored with it.
+          Returns false if the shape cannot be loaded. */
+      virtual bool load(Scene& scene, uint_t i) = 0;
+  };
+
+  /// A pointer to a Loader.
+  typedef RCPtr<Loader> LoaderPtr;
+
   /// Constructs an empty Scene.
   Scene(unsigned int size=0);
 
@@ -158,21 +175,36 @@ public:
   /// Clears \e self.
   void clear( );
 
-  /// Returns a const iterator at the beginning of \e self.
-  inline const_iterator begin( ) const { return __shapeList.begin(); }
+  /// Returns a const iterator at the beginning of \e self. Loads all the shapes.
+  inline const_iterator begin( ) const { if (is_valid_ptr(__loader)) loadAll(); return __shapeList.begin(); }
 
-  /// Returns an iterator at the beginning of \e self.
-  inline iterator begin( ) { return __shapeList.begin(); }
+  /// Returns an iterator at the beginning of \e self. Loads all the shapes.
+  inline iterator begin( ) { if (is_valid_ptr(__loader)) loadAll(); return __shapeList.begin(); }
 
-  /// Returns a const iterator at the end of \e self.
-  inline const_iterator end( ) const { return __shapeList.end(); }
+  /// Returns a const iterator at the end of \e self. Loads all the shapes.
+  inline const_iterator end( ) const { if (is_valid_ptr(__loader)) loadAll(); return __shapeList.end(); }
 
-  /// Returns an iterator at the end of \e self.
-  inline iterator end( ) { return __shapeList.end(); }
+  /// Returns an iterator at the end of \e self. Loads all the shapes.
+  inline iterator end( ) { if (is_valid_ptr(__loader)) loadAll(); return __shapeList.end(); }
 
-  /// Returns the \e i-th element of \e self.
+  /// Returns the \e i-th element of \e self. Loads it if needed.
   const Shape3DPtr getAt(uint_t i ) const ;
 
+  /** Sets the loader of the shapes of \e self. Null shapes are loaded
+      by \e loader on first access. */
+  void setLoader( const LoaderPtr& loader );
+
+  /// Returns the loader of the shapes of \e self, if any.
+  const LoaderPtr& getLoader( ) const { return __loader; }
+
+  /// Returns whether the \e i-th shape of \e self is loaded.
+  bool isLoaded( uint_t i ) const ;
+
+  /** Loads all the shapes not loaded yet and removes the loader.
+      Shapes that cannot be loaded are removed once the loader is removed.
+      The shapes are never loaded concurrently with this removal. */
+  void loadAll( ) const ;
+
   /// Returns the \e i-th element of \e self.
   void setAt(uint_t i, const Shape3DPtr& );
 
@@ -239,6 +271,12 @@ protected:
 
   PglMutex* __mutex;
 
+  /// The loader of the shapes not loaded yet.
+  LoaderPtr __loader;
+
+  /// Serializes the loading of the shapes and the removal of the loader.
+  PglMutex* __loadMutex;
+
 public:
 
     /// A Scene Pool class
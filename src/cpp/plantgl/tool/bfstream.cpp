@@ -57,6 +57,11 @@ leofstream::~leofstream() { }
 
 /* ----------------------------------------------------------------------- */
 
+/// Destructor. The buffer is detached from the stream before being destroyed.
+leomstream::~leomstream() { static_cast<std::ostream&>(__stream).rdbuf(0); }
+
+/* ----------------------------------------------------------------------- */
+
 /// Destructor.
 leifstream::~leifstream() { }
 
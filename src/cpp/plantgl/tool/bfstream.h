@@ -44,41 +44,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 //using namespace std;
 #include "util_tuple.h"
-
-/* ----------------------------------------------------------------------- */
-
-/// Big Endian value for byte order.
-#ifndef __BIG_ENDIAN
-#define __BIG_ENDIAN 0
-#endif
-/// Little Endian value for byte order.
-#ifndef __LITTLE_ENDIAN
-#define __LITTLE_ENDIAN 1
-#endif
-/// Byte Order. If not defined (on windows for example), assign it to little endian
-#ifndef __BYTE_ORDER
-
-#ifdef __BYTE_ORDER__
-#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
-    #define __BYTE_ORDER __LITTLE_ENDIAN
-#else
-    #define __BYTE_ORDER __BIG_ENDIAN
-#endif
-
-#else
-
-#ifdef _MSC_VER
-#pragma message("__BYTE_ORDER macro not defined. Use Little Endian by default.")
-#else
-#warning "__BYTE_ORDER macro not defined. Use Little Endian by default."
-#endif
-#define __BYTE_ORDER __LITTLE_ENDIAN
-#endif
-
-#endif
+#include "util_endian.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -294,6 +264,12 @@ private:
 
 protected:
 
+  /// Constructs a stream not attached to a file.
+  bofstream( ) :
+    __stream()
+  {
+  }
+
   std::ofstream __stream;
 
 };
@@ -500,9 +476,17 @@ public:
 
   //@}
 
+protected:
+
+  /// Constructs a little endian stream not attached to a file.
+  leofstream( ) :
+    bofstream()
+  {
+  }
+
 private:
 
-#if __BYTE_ORDER == __BIG_ENDIAN
+#if PGL_BIG_ENDIAN
   virtual bofstream& _writeBytes( const char * data, size_t size )
   {
     char flipped_data[8];
@@ -515,6 +499,39 @@ private:
 };
 
 
+/* ----------------------------------------------------------------------- */
+
+/** \class leomstream
+    \brief leomstream specializes the \c leofstream class to store variables
+    in little endian format in a memory buffer instead of a file. */
+
+class TOOLS_API leomstream : public leofstream
+{
+
+public:
+
+  /// Constructs an empty little endian memory stream.
+  leomstream( ) :
+    leofstream()
+  {
+    static_cast<std::ostream&>(__stream).rdbuf(&__buffer);
+  }
+
+  /// Destructor.
+  virtual ~leomstream();
+
+  /// Returns the content written in the stream.
+  std::string str( ) const { return __buffer.str(); }
+
+  /// Returns the number of bytes written in the stream.
+  size_t size( ) { return (size_t)__stream.tellp(); }
+
+protected:
+
+  std::stringbuf __buffer;
+
+};
+
 /* ----------------------------------------------------------------------- */
 
 /** \class leifstream
@@ -547,7 +564,7 @@ public:
 
 private:
 
-#if __BYTE_ORDER == __BIG_ENDIAN
+#if PGL_BIG_ENDIAN
   virtual bifstream& _readBytes( char * data, size_t size )
   {
     char flipped_data[8];
@@ -593,7 +610,7 @@ public:
   //@}
 private:
 
-#if __BYTE_ORDER == __LITTLE_ENDIAN
+#if !PGL_BIG_ENDIAN
   virtual bofstream& _writeBytes( const char * data, size_t size )
   {
     char flipped_data[8];
@@ -638,7 +655,7 @@ public:
 
 private:
 
-#if __BYTE_ORDER == __LITTLE_ENDIAN
+#if !PGL_BIG_ENDIAN
  virtual bifstream& _readBytes( char * data, size_t size )
   {
     char flipped_data[8];
@@ -43,6 +43,9 @@
 #endif
 #endif
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 #ifdef _WIN32
 #include <windows.h>
 #include <Shlwapi.h>
@@ -112,7 +115,7 @@ string get_dirname(const string & filename) {
     size_t backslashit = filename.rfind("\\"); 
     if (slashit == std::string::npos && backslashit == std::string::npos) return filename;
     size_t end = slashit;
-    if (slashit == std::string::npos || slashit <   backslashit)
+    if (slashit == std::string::npos || (backslashit != std::string::npos && slashit < backslashit))
         end = backslashit;
     return std::string(filename.begin(), filename.begin()+end);
 
@@ -128,7 +131,7 @@ string get_filename(const string & filename) {
     size_t backslashit = filename.rfind("\\"); 
     if (slashit == std::string::npos && backslashit == std::string::npos) return filename;
     size_t begin = slashit;
-    if (slashit == std::string::npos || slashit <   backslashit)
+    if (slashit == std::string::npos || (backslashit != std::string::npos && slashit < backslashit))
         begin = backslashit;
     return std::string(filename.begin()+begin+1, filename.end());
 
@@ -162,7 +165,14 @@ string absolute_filename(const string & filename) {
     return QString2StdString(QFileInfo(filename.c_str()).absoluteFilePath()); 
 
 #else
+#ifdef _WIN32
     return absolute_dirname(filename)+"/"+get_filename(filename);
+#else
+    // realpath resolves the whole filename, including its last part.
+    char resolved_path[PATH_MAX];
+    if (realpath(filename.c_str(), resolved_path)) return string(resolved_path);
+    return filename;
+#endif
 
 #endif
 }
@@ -289,6 +299,12 @@ bool exists(const string & filename){
 #endif
 }
 
+time_t last_modification(const string & filename){
+    struct stat st;
+    if (stat(filename.c_str(), &st) != 0) return 0;
+    return st.st_mtime;
+}
+
 bool similar_dir(const std::string& filename,const std::string& filename2){
         string f1 = short_dirname(absolute_filename(filename));
         string f2 = short_dirname(absolute_filename(filename2));
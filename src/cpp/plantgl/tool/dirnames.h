@@ -40,6 +40,7 @@
 */
 
 #include <string>
+#include <ctime>
 #include "tools_config.h"
 
 TOOLS_BEGIN_NAMESPACE
@@ -101,6 +102,11 @@ std::string TOOLS_API set_suffix(const std::string& filename,const std::string&
 */
 bool TOOLS_API exists(const std::string& filename);
 
+/*!
+  Return the time of the last modification of the file, or 0 if it does not exist.
+*/
+time_t TOOLS_API last_modification(const std::string& filename);
+
 /*!
   Return whether 2 filename are similar.
 */
@@ -50,6 +50,7 @@ GENERIC_LEXER::GENERIC_LEXER(std::istream* is ,
                              const char* filename , // NULL corresponds to cin/readline
                              const char* prompt ):
     yyFlexLexer(is,os), // if NULL,NULL uses cin and cout
+    _li(is),
     _uses_readline(is?false:true), // if is is NULL uses readline
     _prompt(prompt)
 {
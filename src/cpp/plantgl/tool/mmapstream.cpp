@@ -0,0 +1,151 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Plant Graphic Library
+ *
+ *       Copyright 1995-2003 UMR Cirad/Inria/Inra Dap - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------------- */
+
+#include "mmapstream.h"
+#include <fstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+MemoryMappedFile::MemoryMappedFile( const std::string& file_name ) :
+    __data(0), __size(0), __valid(false), __mapped(false)
+#ifdef _WIN32
+    , __file(INVALID_HANDLE_VALUE), __mapping(NULL)
+#endif
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (file != INVALID_HANDLE_VALUE) {
+        __valid = true;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMapping(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping != NULL) {
+                __data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (__data) {
+                    __size = (size_t)size.QuadPart;
+                    __mapped = true;
+                    __file = file;
+                    __mapping = mapping;
+                    return;
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        __valid = true;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+            void * data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+                madvise(data, st.st_size, MADV_SEQUENTIAL);
+#endif
+                __data = (const char *)data;
+                __size = st.st_size;
+                __mapped = true;
+            }
+        }
+        ::close(fd);
+        if (__mapped) return;
+    }
+#endif
+    if (!__valid) return;
+    // The file cannot be mapped (empty, special file or not supported). Read it in memory.
+    std::ifstream stream(file_name.c_str(), std::ios::in | std::ios::binary);
+    if (!stream) { __valid = false; return; }
+    char block[65536];
+    while (stream) {
+        stream.read(block, sizeof(block));
+        __buffer.insert(__buffer.end(), block, block + stream.gcount());
+    }
+    __size = __buffer.size();
+    __data = __size > 0 ? &__buffer[0] : 0;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (!__mapped) return;
+#ifdef _WIN32
+    UnmapViewOfFile(__data);
+    CloseHandle((HANDLE)__mapping);
+    CloseHandle((HANDLE)__file);
+#else
+    munmap((void *)__data, __size);
+#endif
+}
+
+/* ----------------------------------------------------------------------- */
+
+lemmapstream::lemmapstream( const char * file_name ) :
+    __file(new MemoryMappedFile(file_name))
+{ _init(); }
+
+lemmapstream::lemmapstream( const std::string& file_name ) :
+    __file(new MemoryMappedFile(file_name))
+{ _init(); }
+
+lemmapstream::lemmapstream( const char * data, size_t size ) :
+    __file(0), __begin(data), __current(data), __end(data+size),
+    __eof(false), __fail(data == 0 && size > 0)
+{ }
+
+lemmapstream::~lemmapstream() { delete __file; }
+
+void lemmapstream::_init()
+{
+    __begin = __current = __file->data();
+    __end = __begin + __file->size();
+    __eof = false;
+    __fail = !__file->isValid();
+}
+
+/* ----------------------------------------------------------------------- */
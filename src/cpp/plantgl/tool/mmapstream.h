@@ -0,0 +1,294 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Plant Graphic Library
+ *
+ *       Copyright 1995-2003 UMR Cirad/Inria/Inra Dap - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#ifndef __mmapstream_h__
+#define __mmapstream_h__
+
+/*! \file mmapstream.h
+    \brief Memory mapped file and little endian binary stream reading it.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+#include "bfstream.h"
+#include "util_endian.h"
+#include "util_types.h"
+#include <string.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/** \class MemoryMappedFile
+    \brief A read only view of a whole file. The file is mapped in memory
+    when the system allows it, and read in a buffer otherwise. */
+
+class TOOLS_API MemoryMappedFile
+{
+
+public:
+
+  /// Maps the file \e file_name.
+  MemoryMappedFile( const std::string& file_name );
+
+  /// Destructor. Unmaps the file.
+  ~MemoryMappedFile();
+
+  /// Returns whether the file was opened.
+  bool isValid() const { return __valid; }
+
+  /// Returns the content of the file.
+  const char * data() const { return __data; }
+
+  /// Returns the size of the file.
+  size_t size() const { return __size; }
+
+  /// Returns whether the file is memory mapped or was copied in a buffer.
+  bool isMapped() const { return __mapped; }
+
+private:
+
+  MemoryMappedFile( const MemoryMappedFile& );
+  MemoryMappedFile& operator=( const MemoryMappedFile& );
+
+  const char * __data;
+  size_t __size;
+  bool __valid;
+  bool __mapped;
+  std::vector<char> __buffer;
+#ifdef _WIN32
+  void * __file;
+  void * __mapping;
+#endif
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+/** \class lemmapstream
+    \brief lemmapstream restores variables stored in little endian binary format
+    from a memory mapped file. It has the reading interface of \c leifstream and
+    in addition can decode whole blocks of values at once.
+    As for \c ifstream, eof() becomes true when a read goes past the end of the file.
+*/
+
+class TOOLS_API lemmapstream
+{
+
+public:
+
+  /// Constructs a readable stream on the file \e file_name.
+  lemmapstream( const char * file_name );
+
+  /// Constructs a readable stream on the file \e file_name.
+  lemmapstream( const std::string& file_name );
+
+  /** Constructs a readable stream on the \e size bytes of \e data.
+      The data are not copied and must outlive the stream. */
+  lemmapstream( const char * data, size_t size );
+
+  /// Destructor.
+  virtual ~lemmapstream();
+
+  /** @name Reading functions
+      Reads the appropriate built-in types from \e self. */
+  //@{
+
+  lemmapstream& operator>>( bool& b ) { return _readValue(b); }
+  lemmapstream& operator>>( char& c ) { return _readValue(c); }
+  lemmapstream& operator>>( double& d ) { return _readValue(d); }
+  lemmapstream& operator>>( float& f ) { return _readValue(f); }
+  lemmapstream& operator>>( int& i ) { return _readValue(i); }
+  lemmapstream& operator>>( long& l ) { return _readValue(l); }
+  lemmapstream& operator>>( short& s ) { return _readValue(s); }
+  lemmapstream& operator>>( unsigned char& uc ) { return _readValue(uc); }
+  lemmapstream& operator>>( unsigned int& ui ) { return _readValue(ui); }
+  lemmapstream& operator>>( unsigned long& ul ) { return _readValue(ul); }
+  lemmapstream& operator>>( unsigned short& us ) { return _readValue(us); }
+
+  /// Binary read of a \b Tuple2.
+  template<class T>
+  lemmapstream& operator>>( Tuple2<T>& t )
+  { return (operator>>(t.getAt(0))).operator>>(t.getAt(1)); }
+
+  /// Binary read of a \b Tuple3.
+  template<class T>
+  lemmapstream& operator>>( Tuple3<T>& t )
+  { return ((operator>>(t.getAt(0))).operator>>(t.getAt(1))).operator>>(t.getAt(2)); }
+
+  /// Binary read of a \b Tuple4.
+  template<class T>
+  lemmapstream& operator>>( Tuple4<T>& t )
+  { return (((operator>>(t.getAt(0))).operator>>(t.getAt(1))).operator>>(t.getAt(2))).operator>>(t.getAt(3)); }
+
+  /// Binary read of \e data of size \e size.
+  void read( char * data, size_t size )
+  {
+    size_t nb = _consume(size);
+    memcpy(data, __current - nb, nb);
+  }
+
+  /// Reads \e nb values of \e T (of 1, 2, 4 or 8 bytes) at once.
+  template<class T>
+  void readValues( T * data, size_t nb )
+  {
+    size_t nbbytes = _consume(nb * sizeof(T));
+    memcpy(data, __current - nbbytes, nbbytes);
+#if PGL_BIG_ENDIAN
+    for (size_t i = 0; i < nbbytes / sizeof(T); ++i) {
+      T value = data[i];
+      flipBytes((const char *)&value, (char *)(data+i), sizeof(T));
+    }
+#endif
+  }
+
+  /** Reads \e nb reals stored as float, or as double if \e doubleprecision.
+      Values are copied if the precision matches real_t and converted otherwise. */
+  void readReals( real_t * data, size_t nb, bool doubleprecision )
+  {
+    if (doubleprecision == (sizeof(real_t) == sizeof(double))) readValues(data, nb);
+    else if (doubleprecision) _convert<double>(data, nb);
+    else _convert<float>(data, nb);
+  }
+
+  //@}
+
+  /** @name Stream
+      Function related to the stream. */
+  //@{
+
+  /// Returns the current position in the file.
+  size_t tell( ) const { return __current - __begin; }
+
+  /// Returns the number of bytes left.
+  size_t remaining( ) const { return __end - __current; }
+
+  /// Returns the size of the stream.
+  size_t size( ) const { return __end - __begin; }
+
+  /// Returns the content of the stream.
+  const char * data( ) const { return __begin; }
+
+  /// Moves to the position \e pos. Returns false if \e pos is out of the stream.
+  bool seek( size_t pos )
+  {
+    if (pos > size()) return false;
+    __current = __begin + pos; __eof = __fail = false;
+    return true;
+  }
+
+  /// Skips the bytes up to the next position multiple of \e alignment.
+  void align( size_t alignment )
+  {
+    size_t pos = tell() % alignment;
+    if (pos != 0) _consume(alignment - pos);
+  }
+
+  /// Returns true if \e stream is valid.
+  operator bool( ) const { return !__fail; }
+
+  /// Returns true if \e stream is not valid.
+  bool operator!( ) const { return __fail; }
+
+  /// Returns true if \e stream is at the end.
+  bool eof( ) const { return __eof; }
+
+  //@}
+
+private:
+
+  lemmapstream( const lemmapstream& );
+  lemmapstream& operator=( const lemmapstream& );
+
+  void _init( );
+
+  /// Advances of \e size bytes and returns the number of bytes actually available.
+  size_t _consume( size_t size )
+  {
+    size_t available = __end - __current;
+    if (size > available) { size = available; __eof = __fail = true; }
+    __current += size;
+    return size;
+  }
+
+  template<class T>
+  lemmapstream& _readValue( T& value )
+  {
+    if (sizeof(T) <= remaining()) {
+#if PGL_BIG_ENDIAN
+      flipBytes(__current, (char *)&value, sizeof(T));
+#else
+      memcpy(&value, __current, sizeof(T));
+#endif
+      __current += sizeof(T);
+    }
+    else _consume(sizeof(T));
+    return *this;
+  }
+
+  /// Reads and converts reals stored with type \e T by blocks, so that the conversion loop can be vectorized.
+  template<class T>
+  void _convert( real_t * data, size_t nb )
+  {
+    const size_t blocksize = 1024;
+    T block[blocksize];
+    while (nb > 0 && !__eof) {
+      size_t n = nb < blocksize ? nb : blocksize;
+      size_t nbread = (_consume(n * sizeof(T))) / sizeof(T);
+      memcpy(block, __current - nbread * sizeof(T), nbread * sizeof(T));
+#if PGL_BIG_ENDIAN
+      for (size_t i = 0; i < nbread; ++i) { T value = block[i]; flipBytes((const char *)&value, (char *)(block+i), sizeof(T)); }
+#endif
+      for (size_t i = 0; i < nbread; ++i) data[i] = real_t(block[i]);
+      data += nbread; nb -= nbread;
+    }
+  }
+
+  MemoryMappedFile * __file;
+  const char * __begin;
+  const char * __current;
+  const char * __end;
+  bool __eof;
+  bool __fail;
+
+};
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// __mmapstream_h__
+#endif
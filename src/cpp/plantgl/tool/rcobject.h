@@ -62,6 +62,13 @@
 
 #define WITH_REFCOUNTLISTENER
 
+/* The reference counters are atomic when C++11 is available, so that objects
+   can be shared by threads, e.g. by python wrappers that release the GIL. */
+#if !defined(PGL_NO_ATOMIC_REFCOUNT) && (__cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1700))
+#define PGL_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
+
 /* ----------------------------------------------------------------------- */
 
 /**
@@ -487,7 +494,7 @@ public:
   /// Decrements the reference counter.  
   inline void removeReference( )
   {
-    --_ref_count;
+    size_t count = --_ref_count;
 #ifdef RCOBJECT_DEBUG
     std::cerr << this << " ref-- => " << getReferenceCount();
     std::cerr << "\t(" << typeid(*this).name() << ")" << std::endl;
@@ -495,7 +502,7 @@ public:
 #ifdef WITH_REFCOUNTLISTENER
 	if(_ref_count_listener) _ref_count_listener->referenceRemoved(this);
 #endif
-    if (_ref_count == 0) delete this;
+    if (count == 0) delete this;
   }
   
   //@}
@@ -514,7 +521,11 @@ public:
 
 private:
 
+#ifdef PGL_ATOMIC_REFCOUNT
+  std::atomic<size_t> _ref_count;
+#else
   size_t _ref_count;
+#endif
 #ifdef WITH_REFCOUNTLISTENER
   RefCountListener * _ref_count_listener;
 #endif
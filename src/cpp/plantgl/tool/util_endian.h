@@ -0,0 +1,78 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file util_endian.h
+    \brief Detection of the byte order of the host, in PGL_BIG_ENDIAN.
+*/
+
+#ifndef __util_endian_h__
+#define __util_endian_h__
+
+/* ----------------------------------------------------------------------- */
+
+/// PGL_BIG_ENDIAN is 1 on big endian hosts and 0 on little endian ones.
+#ifndef PGL_BIG_ENDIAN
+
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+    // gcc and clang
+    #if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        #define PGL_BIG_ENDIAN 1
+    #else
+        #define PGL_BIG_ENDIAN 0
+    #endif
+#elif defined(_WIN32)
+    // all the architectures supported by windows are little endian
+    #define PGL_BIG_ENDIAN 0
+#elif defined(__BYTE_ORDER) && defined(__BIG_ENDIAN) && defined(__LITTLE_ENDIAN) && __BIG_ENDIAN != __LITTLE_ENDIAN
+    // glibc <endian.h>
+    #if __BYTE_ORDER == __BIG_ENDIAN
+        #define PGL_BIG_ENDIAN 1
+    #else
+        #define PGL_BIG_ENDIAN 0
+    #endif
+#elif defined(__BIG_ENDIAN__)
+    #define PGL_BIG_ENDIAN 1
+#elif defined(__LITTLE_ENDIAN__)
+    #define PGL_BIG_ENDIAN 0
+#else
+    #ifdef _MSC_VER
+    #pragma message("Byte order of the host not detected. Use Little Endian by default.")
+    #else
+    #warning "Byte order of the host not detected. Use Little Endian by default."
+    #endif
+    #define PGL_BIG_ENDIAN 0
+#endif
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+#endif
@@ -46,6 +46,14 @@
         #define PglMutexInternal QMutex
         #define PglMutexInternalTryLock(mutex) mutex.tryLock()
 
+        #if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+            #define PglRecursiveMutexInternal QRecursiveMutex
+        #else
+            struct PglRecursiveMutexInternal : public QMutex {
+                PglRecursiveMutexInternal() : QMutex(QMutex::Recursive) {}
+            };
+        #endif
+
 
     #endif
 
@@ -59,6 +67,7 @@
         #define PGL_THREAD_SUPPORT
         #define PglMutexInternal std::mutex
         #define PglMutexInternalTryLock(mutex) mutex.try_lock()
+        #define PglRecursiveMutexInternal std::recursive_mutex
 
     #endif
 
@@ -78,6 +87,19 @@
         PglMutexInternal __mutexinternal;
 
     };
+
+    /// A mutex which can be locked several times by the thread owning it.
+    struct PglRecursiveMutex {
+    public:
+        PglRecursiveMutex()  {}
+        void lock() { __mutexinternal.lock(); }
+        void unlock() { __mutexinternal.unlock(); }
+        bool tryLock() { return PglMutexInternalTryLock(__mutexinternal); }
+
+    protected:
+        PglRecursiveMutexInternal __mutexinternal;
+
+    };
 #else
     struct PglMutex {
     public:
@@ -87,6 +109,22 @@
         bool tryLock() { return true; }
     };
 
+    typedef PglMutex PglRecursiveMutex;
+
 #endif
 
+    /// Lock a PglMutex for the lifetime of the locker.
+    struct PglMutexLocker {
+    public:
+        PglMutexLocker(PglMutex& mutex) : __mutex(mutex) { __mutex.lock(); }
+        ~PglMutexLocker() { __mutex.unlock(); }
+
+    protected:
+        PglMutex& __mutex;
+
+    private:
+        PglMutexLocker(const PglMutexLocker&);
+        PglMutexLocker& operator=(const PglMutexLocker&);
+    };
+
 #endif
@@ -0,0 +1,154 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file util_parallel.h
+    \brief Definition of pgl_parallel_for, a range splitting helper running on
+    the Qt global thread pool or on std::thread when Qt is not available.
+*/
+
+#ifndef __util_parallel_h__
+#define __util_parallel_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "tools_config.h"
+#include "util_mutex.h"
+#include <algorithm>
+#include <vector>
+
+#ifndef PGL_CORE_WITHOUT_QT
+
+    #include <QtCore/QThreadPool>
+    #include <QtCore/QRunnable>
+    #include <QtCore/QSemaphore>
+
+#else
+
+    #ifdef PGL_THREAD_SUPPORT
+        #include <thread>
+        #include <functional>
+    #endif
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/// Returns the number of threads that pgl_parallel_for may use.
+inline size_t pgl_thread_count()
+{
+#ifndef PGL_CORE_WITHOUT_QT
+    return std::max<int>(1,QThreadPool::globalInstance()->maxThreadCount());
+#elif defined(PGL_THREAD_SUPPORT)
+    return std::max<unsigned int>(1,std::thread::hardware_concurrency());
+#else
+    return 1;
+#endif
+}
+
+/* ----------------------------------------------------------------------- */
+
+#ifndef PGL_CORE_WITHOUT_QT
+
+template<class Function>
+class PglRangeTask : public QRunnable {
+public:
+    PglRangeTask(Function& function, size_t first, size_t last, QSemaphore * done) :
+        QRunnable(), __function(function), __first(first), __last(last), __done(done)
+        { setAutoDelete(true); }
+
+    virtual void run() { __function(__first,__last); __done->release(); }
+
+protected:
+    Function& __function;
+    size_t __first;
+    size_t __last;
+    QSemaphore * __done;
+};
+
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+/**
+    Calls \e function(first,last) on contiguous sub-ranges covering [\e begin, \e end).
+    The range is split in at most pgl_thread_count() chunks of at least \e grainsize
+    elements. Ranges smaller than 2 * \e grainsize are processed in the calling thread.
+    \e function must be thread safe for disjoint sub-ranges.
+    When no worker is available (e.g. when called from a pool thread), the chunk is
+    processed by the calling thread, so nested calls cannot deadlock.
+*/
+template<class Function>
+void pgl_parallel_for(size_t begin, size_t end, Function& function, size_t grainsize = 1024)
+{
+    if (end <= begin) return;
+    size_t nbelements = end - begin;
+    size_t nbchunks = std::min(pgl_thread_count(), nbelements / std::max<size_t>(1,grainsize));
+    if (nbchunks <= 1) { function(begin,end); return; }
+
+    size_t chunksize = nbelements / nbchunks;
+    if (chunksize * nbchunks < nbelements) ++chunksize;
+
+#ifndef PGL_CORE_WITHOUT_QT
+    QSemaphore done;
+    int nbstarted = 0;
+    size_t first = begin + chunksize;
+    for (; first < end; first += chunksize) {
+        size_t last = std::min(first + chunksize, end);
+        PglRangeTask<Function> * task = new PglRangeTask<Function>(function, first, last, &done);
+        if (QThreadPool::globalInstance()->tryStart(task)) ++nbstarted;
+        else { task->setAutoDelete(false); function(first,last); delete task; }
+    }
+    function(begin, begin + chunksize);
+    done.acquire(nbstarted);
+#elif defined(PGL_THREAD_SUPPORT)
+    std::vector<std::thread> workers;
+    for (size_t first = begin + chunksize; first < end; first += chunksize)
+        workers.push_back(std::thread(std::ref(function), first, std::min(first + chunksize, end)));
+    function(begin, begin + chunksize);
+    for (std::vector<std::thread>::iterator it = workers.begin(); it != workers.end(); ++it)
+        it->join();
+#else
+    function(begin,end);
+#endif
+}
+
+/* ----------------------------------------------------------------------- */
+
+TOOLS_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __util_parallel_h__
+#endif
@@ -39,6 +39,7 @@
 
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include <string>
 #include <sstream>
@@ -129,6 +130,82 @@ inline std::string toUpper(const std::string& c){
   return res;
 }
 
+/// Returns whether \e c separates the numbers of a line.
+inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/** Parses an integer starting at \e p, after blanks, and not going beyond \e end.
+    Returns the position after the number or NULL if there is no number. */
+inline const char * parseInt(const char * p, const char * end, long& value){
+  while (p < end && isBlank(*p)) ++p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) { negative = (*p == '-'); ++p; }
+  if (p == end || *p < '0' || *p > '9') return NULL;
+  long result = 0;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p) result = result * 10 + (*p - '0');
+  value = negative ? -result : result;
+  return p;
+}
+
+/** Parses a real starting exactly at \e p and not going beyond \e end.
+    The number ends at the first character that cannot be part of it.
+    Returns the position after the number or NULL if there is no digit.
+    Usual numbers are converted exactly without strtod, which is used for the others. */
+inline const char * parseRealPrefix(const char * p, const char * end, double& value){
+  static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) { negative = (*p == '-'); ++p; }
+  const char * start = p;
+  unsigned long long mantissa = 0;
+  int digits = 0, exponent = 0;
+  bool valid = false;
+  for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+    valid = true;
+    if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; }
+    else ++exponent;
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+      valid = true;
+      if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; --exponent; }
+    }
+  }
+  if (!valid) return NULL;
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char * e = p + 1;
+    bool negativeExponent = false;
+    if (e < end && (*e == '-' || *e == '+')) { negativeExponent = (*e == '-'); ++e; }
+    if (e < end && *e >= '0' && *e <= '9') {
+      int exp = 0;
+      for (; e < end && *e >= '0' && *e <= '9'; ++e) if (exp < 10000) exp = exp * 10 + (*e - '0');
+      exponent += negativeExponent ? -exp : exp;
+      p = e;
+    }
+  }
+  if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    value = exponent < 0 ? double(mantissa) / powers[-exponent] : double(mantissa) * powers[exponent];
+  else value = strtod(std::string(start, p).c_str(), NULL);
+  if (negative) value = -value;
+  return p;
+}
+
+/** Parses a real starting at \e p, after blanks, and not going beyond \e end.
+    The number must be followed by a blank, an end of line or \e end.
+    Returns the position after the number or NULL if there is no valid number. */
+inline const char * parseReal(const char * p, const char * end, double& value){
+  while (p < end && isBlank(*p)) ++p;
+  const char * numberEnd = parseRealPrefix(p, end, value);
+  if (numberEnd && (numberEnd == end || isBlank(*numberEnd) || *numberEnd == '\n')) return numberEnd;
+  // nan, inf or invalid token.
+  const char * tokenEnd = p;
+  while (tokenEnd < end && !isspace(*tokenEnd)) ++tokenEnd;
+  std::string token(p, tokenEnd);
+  char * parsed = NULL;
+  value = strtod(token.c_str(), &parsed);
+  if (token.empty() || *parsed != '\0') return NULL;
+  return tokenEnd;
+}
+
 TOOLS_END_NAMESPACE
 
 #endif
@@ -1,2 +1,34 @@
 import openalea.plantgl.scenegraph
-from _pglalgo import *
\ No newline at end of file
+from _pglalgo import *
+
+from openalea.plantgl.scenegraph import SceneObject, Scene
+
+try:
+    from pickle import PickleBuffer
+except ImportError:
+    PickleBuffer = None
+
+def _pgl_unpickle(data, buffers):
+    return pgl_deserialize(data, buffers).recast()
+
+def _pgl_unpickle_scene(data, buffers):
+    return pgl_deserialize_scene(data, buffers)
+
+def __pgl_reduce_ex__(self, protocol):
+    """ Pickle scene objects and scenes with their binary representation.
+        With protocol 5, large arrays are given out of band without copy.
+        The objects shared are kept shared only inside one pickled root: a scene object
+        shared by two objects pickled separately, for instance in a list, is duplicated. """
+    outofband = PickleBuffer is not None and protocol >= 5
+    data, buffers = pgl_serialize(self, outofband)
+    if outofband:
+        buffers = tuple(PickleBuffer(buffer) for buffer in buffers)
+    else:
+        buffers = ()
+    if isinstance(self, Scene):
+        return _pgl_unpickle_scene, (data, buffers)
+    return _pgl_unpickle, (data, buffers)
+
+SceneObject.__reduce_ex__ = __pgl_reduce_ex__
+Scene.__reduce_ex__ = __pgl_reduce_ex__
+del __pgl_reduce_ex__
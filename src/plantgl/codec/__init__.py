@@ -1,4 +1,2 @@
 import asc
-import gts
-import obj
-import ply
\ No newline at end of file
+import gts
\ No newline at end of file
@@ -51,6 +51,7 @@ void export_MatrixComputer();
 // custom algo
 void export_Merge();
 void export_Fit();
+void export_MeshOptimizer();
 
 /* ----------------------------------------------------------------------- */
 // abstract printer export
@@ -68,6 +69,9 @@ void export_PyPrinter();
 // reader export
 void export_PglReader();
 
+// binary serialization export
+void export_Pickle();
+
 /* ----------------------------------------------------------------------- */
 // gl export
 void export_GLRenderer();
@@ -98,6 +102,7 @@ void export_Mvs();
 void export_Octree();
 void export_PointGrid();
 void export_KDtree();
+void export_AABBTree();
 void export_PyGrid();
 void export_PlaneClip();
 
@@ -36,6 +36,7 @@
 #include <plantgl/scenegraph/geometry/explicitmodel.h>
 #include <plantgl/scenegraph/geometry/triangleset.h>
 #include <plantgl/python/exception.h>
+#include <plantgl/python/release_gil.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -61,7 +62,12 @@ void set_Dis_texCoord(Discretizer * obj, bool v){
 ExplicitModelPtr py_discretize( const GeometryPtr& obj) {
 	if (!obj)throw PythonExc_ValueError("Cannot discretize empty object.");
 	Discretizer d;
-	if (!obj->apply(d))throw PythonExc_ValueError("Error in discretization.");
+	bool ok;
+	{
+		PythonInterpreterReleaser nogil;
+		ok = obj->apply(d);
+	}
+	if (!ok)throw PythonExc_ValueError("Error in discretization.");
 	else return d.getDiscretization();
 }
 
@@ -88,14 +94,24 @@ TriangleSetPtr 	t_getTriangulation ( Tesselator* t )
 TriangleSetPtr py_tesselate( const GeometryPtr& obj) {
 	if (!obj)throw PythonExc_ValueError("Cannot tesselate empty object.");
 	Tesselator t;
-	if (!obj->apply(t))throw PythonExc_ValueError("Error in tesselation.");
+	bool ok;
+	{
+		PythonInterpreterReleaser nogil;
+		ok = obj->apply(t);
+	}
+	if (!ok)throw PythonExc_ValueError("Error in tesselation.");
 	else return t.getTriangulation();
 }
 
 TriangleSetPtr py_triangulation( const GeometryPtr& obj) {
 	if (!obj)throw PythonExc_ValueError("Cannot tesselate empty object.");
 	Tesselator t;
-	if (!obj->apply(t))throw PythonExc_ValueError("Error in tesselation.");
+	bool ok;
+	{
+		PythonInterpreterReleaser nogil;
+		ok = obj->apply(t);
+	}
+	if (!ok)throw PythonExc_ValueError("Error in tesselation.");
 	else return t.getTriangulation();
 }
 
@@ -121,8 +137,8 @@ void export_Tesselator()
 	  .export_values()
 	  ;
 
-   def("polygonization",&PGL::polygonization,(bp::arg("contour"),bp::arg("method")=eConvexTriangulation));
-   def("triangulation",&PGL::triangulation,(bp::arg("contour"),bp::arg("method")=eConvexTriangulation));
+   def("polygonization",PGL_NOGIL(&PGL::polygonization),(bp::arg("contour"),bp::arg("method")=eConvexTriangulation));
+   def("triangulation",PGL_NOGIL(&PGL::triangulation),(bp::arg("contour"),bp::arg("method")=eConvexTriangulation));
    def("is_simple_polygon",&PGL::is_simple_polygon,(bp::arg("contour")));
 
 }
@@ -30,6 +30,7 @@
  */
 
 #include <plantgl/python/export_property.h>
+#include <plantgl/python/release_gil.h>
 #include <plantgl/algo/fitting/fit.h>
 #include <plantgl/algo/base/discretizer.h>
 #include <boost/python.hpp>
@@ -58,6 +59,7 @@ boost::python::list getVolumeClassNames(){
 }
 
 GeometryPtr fit(std::string algo,GeometryPtr src){
+	PythonInterpreterReleaser nogil;
 	Discretizer d;
 	src->apply(d);
 	Fit f;
@@ -67,7 +69,11 @@ GeometryPtr fit(std::string algo,GeometryPtr src){
 
 boost::python::object inertiaAxis(Point3Array * points){
 	Vector3 u,v,w,s;
-	bool res = Fit::inertiaAxis(Point3ArrayPtr(points),u,v,w,s);
+	bool res;
+	{
+		PythonInterpreterReleaser nogil;
+		res = Fit::inertiaAxis(Point3ArrayPtr(points),u,v,w,s);
+	}
 	if (!res) return object();
 	else return make_tuple(u,v,w,s);
 }
@@ -90,7 +96,11 @@ boost::python::object py_boundingCircle(Point2Array * points){
 boost::python::object py_plane(Point3Array * points, const Index& subset = Index()){
     Vector3 center;
     Plane3 plane;
-    bool res = Fit::plane(Point3ArrayPtr(points),center,plane,subset);
+    bool res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = Fit::plane(Point3ArrayPtr(points),center,plane,subset);
+    }
     if (!res) return object();
     else return make_tuple(center,plane);
 }
@@ -102,29 +112,29 @@ void export_Fit()
   class_< Fit > ("Fit", init<>
      ( "Fit()" "fitting algorithms." ))
 	.def(init<Point3ArrayPtr>("Fit(points)",args("points")))
-    .def("use",&Fit::use)
-    .def("__call__",&Fit::use)
+    .def("use",PGL_NOGIL(&Fit::use))
+    .def("__call__",PGL_NOGIL(&Fit::use))
 	.add_property("points",&Fit::getPoints,&Fit::setPoints)
 	.add_property("radius",&Fit::getRadius,&Fit::setRadius)
-    .def("sphere",&Fit::sphere)
-    .def("asphere",&Fit::asphere)
-    .def("bsphere",&Fit::bsphere)
-    .def("cylinder",&Fit::cylinder)
-    .def("acylinder",&Fit::acylinder)
-    .def("bcylinder",&Fit::bcylinder)
-    .def("ellipsoid",&Fit::ellipsoid)
-    .def("ellipsoid2",&Fit::ellipsoid2)
-    .def("bellipsoid",&Fit::bellipsoid)
-    .def("aellipsoid",&Fit::aellipsoid)
-    .def("aalignedbox",&Fit::aalignedbox)
-    .def("balignedbox",&Fit::balignedbox)
-    .def("box",&Fit::box)
-    .def("abox",&Fit::abox)
-    .def("bbox",&Fit::bbox)
+    .def("sphere",PGL_NOGIL(&Fit::sphere))
+    .def("asphere",PGL_NOGIL(&Fit::asphere))
+    .def("bsphere",PGL_NOGIL(&Fit::bsphere))
+    .def("cylinder",PGL_NOGIL(&Fit::cylinder))
+    .def("acylinder",PGL_NOGIL(&Fit::acylinder))
+    .def("bcylinder",PGL_NOGIL(&Fit::bcylinder))
+    .def("ellipsoid",PGL_NOGIL(&Fit::ellipsoid))
+    .def("ellipsoid2",PGL_NOGIL(&Fit::ellipsoid2))
+    .def("bellipsoid",PGL_NOGIL(&Fit::bellipsoid))
+    .def("aellipsoid",PGL_NOGIL(&Fit::aellipsoid))
+    .def("aalignedbox",PGL_NOGIL(&Fit::aalignedbox))
+    .def("balignedbox",PGL_NOGIL(&Fit::balignedbox))
+    .def("box",PGL_NOGIL(&Fit::box))
+    .def("abox",PGL_NOGIL(&Fit::abox))
+    .def("bbox",PGL_NOGIL(&Fit::bbox))
     // .def("frustum",&Fit::frustum)
-    .def("extrudedHull",&Fit::extrudedHull)
-    .def("asymmetricHull",&Fit::asymmetricHull)
-    .def("convexHull",&Fit::convexHull)
+    .def("extrudedHull",PGL_NOGIL(&Fit::extrudedHull))
+    .def("asymmetricHull",PGL_NOGIL(&Fit::asymmetricHull))
+    .def("convexHull",PGL_NOGIL(&Fit::convexHull))
     .def("convexPolyline",&Fit::convexPolyline)
 	.staticmethod("convexPolyline")
     .def("nurbsCurve",(LineicModelPtr(*)(const Point3ArrayPtr &, int, int))&Fit::nurbsCurve,args("points","degree","nbctrlpoints"))
@@ -83,10 +83,14 @@ void export_GLRenderer()
 #endif
 	.add_property("renderingMode",&get_rd_mode,&GLRenderer::setRenderingMode)
 	.add_property("selectionMode",&get_sel_mode,&GLRenderer::setSelectionMode)
+	.add_property("instancing",&GLRenderer::getInstancing,&GLRenderer::setInstancing)
 	// .add_property("frameGL",&get_fgl_mode,&GLRenderer::setGLFrame)
 	 .def("getDiscretizer",&GLRenderer::getDiscretizer, return_internal_reference<>())
 	 .def("registerTexture",&GLRenderer::registerTexture, (bp::arg("texture"),bp::arg("id"),bp::arg("erasePreviousIfExists")=true))
 	 .def("getTextureId",&GLRenderer::getTextureId)
+	 .def("getBufferObjectCount",&GLRenderer::getBufferObjectCount,"getBufferObjectCount() : return the number of buffer objects uploaded in BufferObject mode.")
+	 .def("isBufferObjectSupported",&GLMeshBuffer::isSupported,"isBufferObjectSupported() : return whether the current GL context supports the buffer objects.")
+	 .staticmethod("isBufferObjectSupported")
     ;
 
   enum_<GLRenderer::RenderingMode>("RenderingMode")
@@ -95,6 +99,7 @@ void export_GLRenderer()
 	  .value("DynamicPrimitive",GLRenderer::DynamicPrimitive)
 	  .value("DynamicScene",GLRenderer::DynamicScene)
 	  .value("Dynamic",GLRenderer::Dynamic)
+	  .value("BufferObject",GLRenderer::BufferObject)
 	  .export_values()
 	  ;
 
@@ -184,12 +184,26 @@ object py_triangle_triangle_intersection(const TOOLS(Vector3)& t11, const TOOLS(
 
 }
 
+object py_intersection_result(const std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr>& result)
+{
+    boost::python::list pairs;
+    for (std::vector<std::pair<uint32_t,uint32_t> >::const_iterator it = result.first.begin(); it != result.first.end(); ++it)
+        pairs.append(boost::python::make_tuple(it->first, it->second));
+    return boost::python::make_tuple(pairs, result.second);
+}
+
+object py_auto_intersection(Point3ArrayPtr points, Index3ArrayPtr triangles)
+{ return py_intersection_result(auto_intersection(points, triangles)); }
 
+object py_mesh_intersection(Point3ArrayPtr points1, Index3ArrayPtr triangles1, Point3ArrayPtr points2, Index3ArrayPtr triangles2)
+{ return py_intersection_result(mesh_intersection(points1, triangles1, points2, triangles2)); }
 
 void export_Intersection()
 {
     def("polygon2ds_intersection",&py_polygon2ds_intersection_1, "Compute intersection between two 2D polygons.", bp::args("polygon1", "polygon1"));
     def("polygon2ds_intersection",&py_polygon2ds_intersection_2, "Compute intersection between two 2D polygons.", bp::args("points", "polygon1", "polygon1"));
     def("triangle_triangle_intersection", &py_triangle_triangle_intersection);
+    def("auto_intersection", &py_auto_intersection, "Compute the intersections between the triangles of a mesh. Return the list of pairs of intersecting triangles and their intersections.", bp::args("points", "triangles"));
+    def("mesh_intersection", &py_mesh_intersection, "Compute the intersections between the triangles of two meshes. Return the list of pairs of intersecting triangles and their intersections.", bp::args("points1", "triangles1", "points2", "triangles2"));
 }
 
@@ -30,8 +30,14 @@
  */
 
 #include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
 #include <plantgl/python/boost_python.h>
+#include <boost/python/make_constructor.hpp>
+#include <plantgl/python/release_gil.h>
+#include <plantgl/python/export_list.h>
+#include <plantgl/python/extract_list.h>
 #include <plantgl/algo/grid/kdtree.h>
+#include <plantgl/algo/grid/aabbtree.h>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -47,9 +53,9 @@ class kdtree_func : public boost::python::def_visitor<kdtree_func<KDTreeN> >
     template <class classT>
     void visit(classT& c) const
     {
-	    c.def("k_closest_points", &KDTreeN::k_closest_points, (bp::arg("point"),bp::arg("k"),bp::arg("maxdist")= REAL_MAX),"Return the k closest points of point") 
-         .def("k_nearest_neighbors", &KDTreeN::k_nearest_neighbors,args("k"), "Return the k closest points for each point in the kdtree")
-         .def("r_nearest_neighbors", &KDTreeN::r_nearest_neighbors,args("radius"), "Return points at a distance inf of radius for each point in the kdtree")
+	    c.def("k_closest_points", PGL_NOGIL(&KDTreeN::k_closest_points), (bp::arg("point"),bp::arg("k"),bp::arg("maxdist")= REAL_MAX),"Return the k closest points of point") 
+         .def("k_nearest_neighbors", PGL_NOGIL(&KDTreeN::k_nearest_neighbors),args("k"), "Return the k closest points for each point in the kdtree")
+         .def("r_nearest_neighbors", PGL_NOGIL(&KDTreeN::r_nearest_neighbors),args("radius"), "Return points at a distance inf of radius for each point in the kdtree")
 	     .def("size", &KDTreeN::size, "Return the number of point in the kdtree.")
 	     .def("__len__", &KDTreeN::size, "Return the number of point in the kdtree.")
         ;
@@ -89,11 +95,102 @@ void export_KDtree()
       ("ANNKDTree4", init<Point4ArrayPtr>("Construct a KD-Tree from a set of 4D points.") );
   implicitly_convertible< ANNKDTree4Ptr, KDTree4Ptr >();
 
-  def("KDTree2", init_kdtree2, args("points"), "Construct a KD-Tree from a set of 2D points.");
-  def("KDTree3", init_kdtree3, args("points"), "Construct a KD-Tree from a set of 3D points.");
-  def("KDTree4", init_kdtree4, args("points"), "Construct a KD-Tree from a set of 4D points.");
+  def("KDTree2", PGL_NOGIL(&init_kdtree2), args("points"), "Construct a KD-Tree from a set of 2D points.");
+  def("KDTree3", PGL_NOGIL(&init_kdtree3), args("points"), "Construct a KD-Tree from a set of 3D points.");
+  def("KDTree4", PGL_NOGIL(&init_kdtree4), args("points"), "Construct a KD-Tree from a set of 4D points.");
 
 #endif
 }
 
+/* ----------------------------------------------------------------------- */
+
+AABBTree * aabb_from_boxes(bp::object lowers, bp::object uppers, uint_t leafSize)
+{
+    std::vector<Vector3> l = extract_vec<Vector3>(lowers)();
+    std::vector<Vector3> u = extract_vec<Vector3>(uppers)();
+    if (l.size() != u.size()) throw PythonExc_ValueError("lowers and uppers must have the same size.");
+    PythonInterpreterReleaser nogil;
+    return new AABBTree(l, u, leafSize);
+}
+
+AABBTree * aabb_from_triangles(Point3ArrayPtr points, Index3ArrayPtr triangles, uint_t leafSize)
+{
+    PythonInterpreterReleaser nogil;
+    return new AABBTree(points, triangles, leafSize);
+}
+
+bp::object aabb_boxQuery(const AABBTree * tree, const Vector3& lower, const Vector3& upper)
+{
+    std::vector<uint_t> result;
+    {
+        PythonInterpreterReleaser nogil;
+        result = tree->boxQuery(lower, upper);
+    }
+    return make_list(result)();
+}
+
+bp::object aabb_planesQuery(const AABBTree * tree, bp::object planes)
+{
+    std::vector<Vector4> p = extract_vec<Vector4>(planes)();
+    std::vector<uint_t> result;
+    {
+        PythonInterpreterReleaser nogil;
+        result = tree->planesQuery(p);
+    }
+    return make_list(result)();
+}
+
+bp::list aabb_pairs(const AABBTree::ItemPairList& pairs)
+{
+    bp::list result;
+    for (AABBTree::ItemPairList::const_iterator it = pairs.begin(); it != pairs.end(); ++it)
+        result.append(bp::make_tuple(it->first, it->second));
+    return result;
+}
+
+bp::list aabb_overlappingPairs(const AABBTree * tree)
+{
+    AABBTree::ItemPairList pairs;
+    {
+        PythonInterpreterReleaser nogil;
+        pairs = tree->overlappingPairs();
+    }
+    return aabb_pairs(pairs);
+}
+
+bp::list aabb_overlappingPairs2(const AABBTree * tree, const AABBTree& other)
+{
+    AABBTree::ItemPairList pairs;
+    {
+        PythonInterpreterReleaser nogil;
+        pairs = tree->overlappingPairs(other);
+    }
+    return aabb_pairs(pairs);
+}
+
+void export_AABBTree()
+{
+  class_< AABBTree, AABBTreePtr, boost::noncopyable >("AABBTree",
+      "A binary tree of axis aligned bounding boxes built over a set of boxes or over the triangles of a mesh.",
+      no_init)
+    .def("__init__", make_constructor(&aabb_from_boxes, default_call_policies(),
+         (bp::arg("lowers"), bp::arg("uppers"), bp::arg("leafSize") = AABBTree::DEFAULT_LEAF_SIZE)),
+         "AABBTree(lowers, uppers, leafSize) : build the tree over the boxes [lowers[i], uppers[i]].")
+    .def("__init__", make_constructor(&aabb_from_triangles, default_call_policies(),
+         (bp::arg("points"), bp::arg("triangles"), bp::arg("leafSize") = AABBTree::DEFAULT_LEAF_SIZE)),
+         "AABBTree(points, triangles, leafSize) : build the tree over the bounding boxes of the triangles.")
+    .def("__len__", &AABBTree::size)
+    .def("getLowerCorner", (Vector3 (AABBTree::*)() const)&AABBTree::getLowerCorner)
+    .def("getUpperCorner", (Vector3 (AABBTree::*)() const)&AABBTree::getUpperCorner)
+    .def("boxQuery", &aabb_boxQuery, (bp::arg("lower"), bp::arg("upper")),
+         "boxQuery(lower, upper) : return the items whose box overlaps the box [lower, upper].")
+    .def("planesQuery", &aabb_planesQuery, bp::arg("planes"),
+         "planesQuery(planes) : return the items whose box is not entirely on the negative side of one of the planes, sorted. "
+         "A plane (a,b,c,d) keeps the points for which a.x+b.y+c.z+d >= 0.")
+    .def("overlappingPairs", &aabb_overlappingPairs,
+         "overlappingPairs() : return the pairs (i,j), i < j, of items whose boxes overlap, sorted.")
+    .def("overlappingPairs", &aabb_overlappingPairs2, bp::arg("other"),
+         "overlappingPairs(other) : return the pairs (i,j) of items of self and of other whose boxes overlap, sorted.")
+    ;
+}
 
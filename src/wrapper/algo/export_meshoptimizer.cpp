@@ -0,0 +1,83 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon, DDS et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/base/meshoptimizer.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+ExplicitModelPtr optimize_mesh(const ExplicitModelPtr& mesh, real_t weldTolerance, bool weld, bool removeDegenerated, bool reorder, uint_t cacheSize)
+{
+    MeshOptimizer optimizer(weldTolerance, cacheSize);
+    optimizer.setWeldingEnabled(weld);
+    optimizer.setDegeneratedRemovalEnabled(removeDegenerated);
+    optimizer.setReorderingEnabled(reorder);
+    return optimizer.optimize(mesh);
+}
+
+/* ----------------------------------------------------------------------- */
+
+void export_MeshOptimizer()
+{
+  class_< MeshOptimizer, boost::noncopyable >
+    ("MeshOptimizer", "Weld points, remove degenerated faces and reorder faces and points of meshes for vertex cache efficiency.",
+     init<optional<real_t,uint_t> >("MeshOptimizer([weldTolerance, cacheSize])",
+                                     (bp::arg("weldTolerance") = MeshOptimizer::DEFAULT_WELD_TOLERANCE,
+                                      bp::arg("cacheSize") = MeshOptimizer::DEFAULT_CACHE_SIZE)))
+    .def("optimize", (ExplicitModelPtr (MeshOptimizer::*)(const ExplicitModelPtr&))&MeshOptimizer::optimize,
+         "optimize(mesh) : return an optimized copy of a TriangleSet, a QuadSet or a FaceSet.")
+    .add_property("weldTolerance", &MeshOptimizer::getWeldTolerance, &MeshOptimizer::setWeldTolerance)
+    .add_property("cacheSize", &MeshOptimizer::getCacheSize, &MeshOptimizer::setCacheSize)
+    .add_property("welding", &MeshOptimizer::isWeldingEnabled, &MeshOptimizer::setWeldingEnabled)
+    .add_property("degeneratedRemoval", &MeshOptimizer::isDegeneratedRemovalEnabled, &MeshOptimizer::setDegeneratedRemovalEnabled)
+    .add_property("reordering", &MeshOptimizer::isReorderingEnabled, &MeshOptimizer::setReorderingEnabled)
+    .add_property("nbRemovedPoints", &MeshOptimizer::getNbRemovedPoints)
+    .add_property("nbRemovedFaces", &MeshOptimizer::getNbRemovedFaces)
+    .def("averageCacheMissRatio", &MeshOptimizer::averageCacheMissRatio, (bp::arg("mesh"), bp::arg("cacheSize") = MeshOptimizer::DEFAULT_CACHE_SIZE))
+    .staticmethod("averageCacheMissRatio")
+    ;
+
+  def("optimize_mesh", &optimize_mesh,
+      (bp::arg("mesh"), bp::arg("weldTolerance") = MeshOptimizer::DEFAULT_WELD_TOLERANCE,
+       bp::arg("weld") = true, bp::arg("removeDegenerated") = true, bp::arg("reorder") = true,
+       bp::arg("cacheSize") = MeshOptimizer::DEFAULT_CACHE_SIZE),
+      "optimize_mesh(mesh [, weldTolerance, weld, removeDegenerated, reorder, cacheSize]) : return an optimized copy of mesh.");
+}
+
+/* ----------------------------------------------------------------------- */
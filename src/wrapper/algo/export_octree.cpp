@@ -35,11 +35,14 @@
 #include <plantgl/python/export_refcountptr.h>
 #include <plantgl/python/export_list.h>
 #include <plantgl/python/export_property.h>
+#include <plantgl/python/release_gil.h>
+#include <boost/python/make_constructor.hpp>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
 using namespace boost::python;
 using namespace std;
+#define bp boost::python
 
 
 
@@ -67,7 +70,11 @@ Vector3* intersect( Octree* self, Vector3* point, Vector3* direction )
 {
   Ray ray(*point, *direction);
   Vector3 res;
-  bool ok= self->intersect( ray, res );
+  bool ok;
+  {
+    PythonInterpreterReleaser nogil;
+    ok = self->intersect( ray, res );
+  }
   if( ok )
       return new Vector3( res );
   else
@@ -89,30 +96,53 @@ object get_oct_sizes(Octree * oc)
 
 object oct_intersect(Octree * oct, const Ray& ray) {
     Vector3 res;
-    bool touch = oct->intersect(ray,res);
+    bool touch;
+    {
+        PythonInterpreterReleaser nogil;
+        touch = oct->intersect(ray,res);
+    }
     if(touch)return object(res);
     else return object();
 }
 
 object oct_findfirstpoint(Octree * oct, const Ray& ray) {
     Vector3 res;
-    bool touch = oct->intersect(ray,res);
+    bool touch;
+    {
+        PythonInterpreterReleaser nogil;
+        touch = oct->intersect(ray,res);
+    }
     if(touch)return object(res);
     else return object();
 }
 
+// the construction of an octree may be long and does not involve python.
+OctreePtr oct_make(const ScenePtr& scene, uint_t maxscale, uint_t maxelements, Octree::ConstructionMethod method)
+{
+  PythonInterpreterReleaser nogil;
+  return OctreePtr(new Octree(scene, maxscale, maxelements, method));
+}
+
+OctreePtr oct_make2(const ScenePtr& scene, const Vector3& center, const Vector3& size, 
+                    uint_t maxscale, uint_t maxelements, Octree::ConstructionMethod method)
+{
+  PythonInterpreterReleaser nogil;
+  return OctreePtr(new Octree(scene, center, size, maxscale, maxelements, method));
+}
+
 void export_Octree()
 {
-  scope octree = class_< Octree, OctreePtr, boost::noncopyable >("Octree", 
-          init<const ScenePtr&,optional< uint_t,uint_t, Octree::ConstructionMethod> >
-              ("Octree(scene,maxscale,maxelements,method)",args("scene","maxscale","maxelements","method")))
-     .def(init<const ScenePtr&,const Vector3&, const Vector3&, 
-              optional<uint_t,uint_t,Octree::ConstructionMethod> >
-              ("Octree(scene,center,size,maxscale,maxelements,method)",args("scene","center","size","maxscale","maxelements","method")))
+  scope octree = class_< Octree, OctreePtr, boost::noncopyable >("Octree", no_init)
+     .def("__init__", make_constructor(&oct_make, default_call_policies(),
+              (bp::arg("scene"),bp::arg("maxscale")=10,bp::arg("maxelements")=10,bp::arg("method")=Octree::TriangleBased)),
+              "Octree(scene,maxscale,maxelements,method)")
+     .def("__init__", make_constructor(&oct_make2, default_call_policies(),
+              (bp::arg("scene"),bp::arg("center"),bp::arg("size"),bp::arg("maxscale")=10,bp::arg("maxelements")=10,bp::arg("method")=Octree::TriangleBased)),
+              "Octree(scene,center,size,maxscale,maxelements,method)")
      .add_property("center",&get_oct_center)
      .add_property("size",&get_oct_size)
      .add_property("depth",&Octree::getDepth)
-     .def("getRepresentation",&Octree::getRepresentation)
+     .def("getRepresentation",PGL_NOGIL(&Octree::getRepresentation))
      .def("getVolume",&Octree::getVolume)
      .def("getDetails",&get_oct_details)
      .def("getSizes",&get_oct_sizes)
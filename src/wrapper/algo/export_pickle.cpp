@@ -0,0 +1,182 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
+#include <plantgl/python/release_gil.h>
+#include <plantgl/algo/codec/binaryprinter.h>
+#include <plantgl/algo/codec/scne_binaryparser.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/tool/bfstream.h>
+#include <sstream>
+#include <limits>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+/// Read only access to an out of band buffer through the buffer protocol. The buffer keeps its array alive.
+int bb_getbuffer(PyObject * obj, Py_buffer * view, int flags)
+{
+    const BinaryBuffer& buffer = extract<const BinaryBuffer&>(obj)();
+    return PyBuffer_FillInfo(view, obj, (void *)buffer.data, buffer.size, 1, flags);
+}
+
+size_t bb_len(const BinaryBuffer * buffer) { return buffer->size; }
+
+/* ----------------------------------------------------------------------- */
+
+bool print_binary(BinaryPrinter& printer, const ScenePtr& scene)
+{ return printer.print(scene, "pickle"); }
+
+bool print_binary(BinaryPrinter& printer, const SceneObjectPtr& object)
+{ return printer.printObject(object, "pickle"); }
+
+/* Return the binary representation of obj as a tuple (bytes, list of buffers).
+   If outofband, the arrays of more than minsize bytes are not copied in the bytes
+   but given as buffers referring to their memory. */
+template<class T>
+object pgl_serialize(const RCPtr<T>& obj, bool outofband, size_t minsize)
+{
+    if (!obj) throw PythonExc_ValueError("Cannot serialize a null object.");
+    leomstream stream;
+    BinaryPrinter printer(stream);
+    BinaryBufferList buffers;
+    // The parser always expects the positions of the buffers in the stream.
+    printer.setOutOfBandBuffers(&buffers, outofband ? minsize : std::numeric_limits<size_t>::max());
+    bool ok;
+    {
+        PythonInterpreterReleaser nogil;
+        ok = print_binary(printer, obj);
+    }
+    if (!ok) throw PythonExc_ValueError("Cannot serialize object.");
+    std::string data = stream.str();
+    bp::list pybuffers;
+    for (BinaryBufferList::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
+        pybuffers.append(*it);
+    return make_tuple(object(handle<>(PyBytes_FromStringAndSize(data.data(), data.size()))), pybuffers);
+}
+
+object sc_serialize(const ScenePtr& scene, bool outofband, size_t minsize)
+{ return pgl_serialize(scene, outofband, minsize); }
+
+object sco_serialize(const SceneObjectPtr& object, bool outofband, size_t minsize)
+{ return pgl_serialize(object, outofband, minsize); }
+
+/* ----------------------------------------------------------------------- */
+
+/// The views on the python buffers read by a parser. They are released with the list.
+class PyBufferViews {
+public:
+    ~PyBufferViews() {
+        for (std::vector<Py_buffer>::iterator it = __views.begin(); it != __views.end(); ++it)
+            PyBuffer_Release(&*it);
+    }
+
+    BinaryBuffer get(const object& obj) {
+        Py_buffer view;
+        if (PyObject_GetBuffer(obj.ptr(), &view, PyBUF_SIMPLE) != 0) throw_error_already_set();
+        __views.push_back(view);
+        return BinaryBuffer((const char *)view.buf, view.len);
+    }
+
+protected:
+    std::vector<Py_buffer> __views;
+};
+
+/// Parse the binary representation made of data and of the out of band buffers.
+void pgl_parse(BinaryParser& parser, const std::stringstream& errors, const object& data, const object& buffers)
+{
+    PyBufferViews views;
+    BinaryBuffer stream = views.get(data);
+    BinaryBufferList bufferlist;
+    for (size_t i = 0, n = len(buffers); i < n; ++i)
+        bufferlist.push_back(views.get(buffers[i]));
+    bool ok;
+    {
+        PythonInterpreterReleaser nogil;
+        ok = parser.parse(stream.data, stream.size, &bufferlist);
+    }
+    if (!ok) {
+        std::string msg = "Invalid binary representation of a scene object. " + errors.str();
+        PyErr_SetString(PyExc_ValueError, msg.c_str());
+        throw_error_already_set();
+    }
+}
+
+SceneObjectPtr pgl_deserialize(const object& data, const object& buffers)
+{
+    std::stringstream errors;
+    BinaryParser parser(errors);
+    pgl_parse(parser, errors, data, buffers);
+    return parser.getResult();
+}
+
+ScenePtr pgl_deserialize_scene(const object& data, const object& buffers)
+{
+    std::stringstream errors;
+    BinaryParser parser(errors);
+    pgl_parse(parser, errors, data, buffers);
+    return parser.getScene();
+}
+
+/* ----------------------------------------------------------------------- */
+
+void export_Pickle()
+{
+    class_<BinaryBuffer> bb("BinaryBuffer", "Memory of an array serialized out of band. Support the buffer protocol.", no_init);
+    bb.def("__len__", &bb_len);
+    PyTypeObject * type = (PyTypeObject *)bb.ptr();
+    static PyBufferProcs procs;
+    procs.bf_getbuffer = &bb_getbuffer;
+    procs.bf_releasebuffer = NULL;
+    type->tp_as_buffer = &procs;
+#if PY_MAJOR_VERSION < 3
+    type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+
+    size_t minsize = BinaryPrinter::DEFAULT_BUFFER_SIZE;
+    def("pgl_serialize", &sco_serialize, (bp::arg("object"), bp::arg("outofband")=false, bp::arg("minsize")=minsize),
+        "Return the binary representation of a scene object as a tuple (bytes, buffers). "
+        "If outofband, the arrays of at least minsize bytes are given as buffers sharing their memory. "
+        "The objects shared inside object are shared again once deserialized, not the ones shared with other serialized objects.");
+    def("pgl_serialize", &sc_serialize, (bp::arg("scene"), bp::arg("outofband")=false, bp::arg("minsize")=minsize));
+    def("pgl_deserialize", &pgl_deserialize, (bp::arg("data"), bp::arg("buffers")=bp::tuple()),
+        "Build a scene object from its binary representation.");
+    def("pgl_deserialize_scene", &pgl_deserialize_scene, (bp::arg("data"), bp::arg("buffers")=bp::tuple()),
+        "Build a scene from its binary representation.");
+}
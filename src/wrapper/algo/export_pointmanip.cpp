@@ -30,8 +30,10 @@
  */
 
 #include <plantgl/algo/base/pointmanipulation.h>
+#include <plantgl/algo/base/tiledpointprocessing.h>
 #include <boost/python.hpp>
 #include <plantgl/python/export_list.h>
+#include <plantgl/python/release_gil.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -55,17 +57,38 @@ object py_points_dijkstra_shortest_path(const Point3ArrayPtr points,
                                         const IndexArrayPtr adjacencies, 
                                         uint32_t root)
 {
-    return make_pair_tuple(points_dijkstra_shortest_path(points,adjacencies,root));
+    std::pair<TOOLS(Uint32Array1Ptr),TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = points_dijkstra_shortest_path(points,adjacencies,root);
+    }
+    return make_pair_tuple(res);
 }
 
 object
 py_skeleton_from_distance_to_root_clusters(const Point3ArrayPtr points, uint32_t root, real_t binsize, uint32_t k, bool connect_all_points = false, bool verbose = false)
 {
     TOOLS(Uint32Array1Ptr) group_parents; IndexArrayPtr group_components;
-    Point3ArrayPtr group_centroids = skeleton_from_distance_to_root_clusters(points, root, binsize, k, group_parents, group_components, connect_all_points, verbose );
+    Point3ArrayPtr group_centroids;
+    {
+        PythonInterpreterReleaser nogil;
+        group_centroids = skeleton_from_distance_to_root_clusters(points, root, binsize, k, group_parents, group_components, connect_all_points, verbose );
+    }
     return make_tuple(group_centroids, group_parents, group_components);
 }
 
+object
+py_tiled_skeleton_from_distance_to_root_clusters(const std::string& fname, real_t tilesize, real_t halo, real_t binsize, uint32_t k)
+{
+    TOOLS(Uint32Array1Ptr) parents;
+    Point3ArrayPtr nodes;
+    {
+        PythonInterpreterReleaser nogil;
+        nodes = tiled_skeleton_from_distance_to_root_clusters(fname, tilesize, halo, binsize, k, parents);
+    }
+    return make_tuple(nodes, parents);
+}
+
 object
 py_remove_nodes(const Index& toremove,
                 Point3ArrayPtr nodes,
@@ -126,13 +149,23 @@ py_principal_curvatures_0(const Point3ArrayPtr points, uint32_t pid, const Index
 bp::object
 py_principal_curvatures_1(const Point3ArrayPtr points, const IndexArrayPtr groups, size_t fitting_degree = 4, size_t monge_degree = 4)
 {
-    return translate_pc_info_set(principal_curvatures(points,groups,fitting_degree,monge_degree));
+    std::vector<CurvatureInfo> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = principal_curvatures(points,groups,fitting_degree,monge_degree);
+    }
+    return translate_pc_info_set(res);
 }
 
 bp::object
 py_principal_curvatures_2(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, real_t radius, size_t fitting_degree = 4, size_t monge_degree = 4)
 {
-    return translate_pc_info_set(principal_curvatures(points,adjacencies,radius,fitting_degree,monge_degree));
+    std::vector<CurvatureInfo> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = principal_curvatures(points,adjacencies,radius,fitting_degree,monge_degree);
+    }
+    return translate_pc_info_set(res);
 }
 
 #endif
@@ -172,22 +205,42 @@ object py_estimate_pointset_circle(const Point3ArrayPtr points, const Index&  gr
 
 object py_estimate_pointsets_circles(const Point3ArrayPtr points, const IndexArrayPtr  groups, const Point3ArrayPtr directions = Point3ArrayPtr(0), bool bounding = false)
 {
-    return make_pair_tuple(pointsets_circles(points, groups, directions, bounding));
+    std::pair<Point3ArrayPtr,TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = pointsets_circles(points, groups, directions, bounding);
+    }
+    return make_pair_tuple(res);
 }
 
 object py_estimate_pointsets_section_circles(const Point3ArrayPtr points, const IndexArrayPtr  adjacencies, const Point3ArrayPtr directions, real_t width, bool bounding = false)
 {
-    return make_pair_tuple(pointsets_section_circles(points, adjacencies, directions, width, bounding));
+    std::pair<Point3ArrayPtr,TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = pointsets_section_circles(points, adjacencies, directions, width, bounding);
+    }
+    return make_pair_tuple(res);
 }
 
 object py_adaptive_section_circles(const Point3ArrayPtr points, const IndexArrayPtr  adjacencies, const Point3ArrayPtr directions, const RealArrayPtr widths, const RealArrayPtr maxradii)
 {
-    return make_pair_tuple(adaptive_section_circles(points, adjacencies, directions, widths, maxradii));
+    std::pair<Point3ArrayPtr,TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = adaptive_section_circles(points, adjacencies, directions, widths, maxradii);
+    }
+    return make_pair_tuple(res);
 }
 
 object py_adaptive_section_circles2(const Point3ArrayPtr points, const IndexArrayPtr  adjacencies, const Point3ArrayPtr directions, const real_t widths, const RealArrayPtr maxradii)
 {
-    return make_pair_tuple(adaptive_section_circles(points, adjacencies, directions, widths, maxradii));
+    std::pair<Point3ArrayPtr,TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = adaptive_section_circles(points, adjacencies, directions, widths, maxradii);
+    }
+    return make_pair_tuple(res);
 }
 
 object
@@ -200,7 +253,12 @@ py_adaptive_section_contration(const Point3ArrayPtr points,
                      const real_t alpha, 
 	                 const real_t beta)
 {
-    return make_pair_tuple(adaptive_section_contration(points, orientations, adjacencies, density, minradius, maxradius, densityradiusmap, alpha, beta ));
+    std::pair<Point3ArrayPtr,TOOLS(RealArrayPtr)> res;
+    {
+        PythonInterpreterReleaser nogil;
+        res = adaptive_section_contration(points, orientations, adjacencies, density, minradius, maxradius, densityradiusmap, alpha, beta );
+    }
+    return make_pair_tuple(res);
 }
 
 object py_findClosestFromSubset(const Vector3& o, Point3ArrayPtr pts, const Index& index)
@@ -229,6 +287,8 @@ static boost::python::object pyprogressfunction;
 
 void py_c_progressfunc(const char * msg, float percent)
 {
+    // algorithms may report their progress while the GIL is released
+    PythonInterpreterAcquirer py;
     pyprogressfunction(msg,percent);
 }
 
@@ -249,63 +309,66 @@ void export_PointManip()
     def("pgl_unregister_progressstatus_func",&py_unregister_progressstatus_func);
 
 
-    def("contract_point2",&contract_point<Point2Array>,args("points","radius"));
-    def("contract_point3",&contract_point<Point3Array>,args("points","radius"));
-    def("contract_point4",&contract_point<Point4Array>,args("points","radius"));
+    def("contract_point2",PGL_NOGIL(&contract_point<Point2Array>),args("points","radius"));
+    def("contract_point3",PGL_NOGIL(&contract_point<Point3Array>),args("points","radius"));
+    def("contract_point4",PGL_NOGIL(&contract_point<Point4Array>),args("points","radius"));
 
-    def("select_not_ground", &select_not_ground, args("point", "kclosest"));
-    def("select_wire", &select_wire, args("points", "kclosest"));
+    def("select_not_ground", PGL_NOGIL(&select_not_ground), args("point", "kclosest"));
+    def("select_wire", PGL_NOGIL(&select_wire), args("points", "kclosest"));
 
 #ifdef WITH_CGAL
-    def("delaunay_point_connection",&delaunay_point_connection,args("points"));
-    def("delaunay_triangulation",&delaunay_triangulation,args("points"));
-    def("k_closest_points_from_delaunay",&k_closest_points_from_delaunay,args("points","k"));
+    def("delaunay_point_connection",PGL_NOGIL(&delaunay_point_connection),args("points"));
+    def("delaunay_triangulation",PGL_NOGIL(&delaunay_triangulation),args("points"));
+    def("k_closest_points_from_delaunay",PGL_NOGIL(&k_closest_points_from_delaunay),args("points","k"));
 #endif
 #ifdef WITH_ANN
-    def("k_closest_points_from_ann",&k_closest_points_from_ann,(bp::arg("points"),bp::arg("k"),bp::arg("symmetric")=false));
+    def("k_closest_points_from_ann",PGL_NOGIL(&k_closest_points_from_ann),(bp::arg("points"),bp::arg("k"),bp::arg("symmetric")=false));
 #endif
 
-    def("symmetrize_connections",&symmetrize_connections,(bp::arg("adjacencies")));
-    def("connect_all_connex_components",&connect_all_connex_components,(bp::arg("points"),bp::arg("adjacencies"),bp::arg("verbose")=false));
+    def("symmetrize_connections",PGL_NOGIL(&symmetrize_connections),(bp::arg("adjacencies")));
+    def("connect_all_connex_components",PGL_NOGIL(&connect_all_connex_components),(bp::arg("points"),bp::arg("adjacencies"),bp::arg("verbose")=false));
 
 
-    def("r_neighborhood",&r_neighborhood,args("pid","points","adjacencies","radius"));
-    def("r_neighborhoods",(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr))&r_neighborhoods,args("points","adjacencies","radii"));
-    def("r_neighborhoods",(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool))&r_neighborhoods,(bp::arg("points"),bp::arg("adjacencies"),bp::arg("radius"),bp::arg("verbose")=false));
-    def("r_neighborhoods_mt",(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool))&r_neighborhoods_mt,(bp::arg("points"),bp::arg("adjacencies"),bp::arg("radius"),bp::arg("verbose")=false));
-    def("r_anisotropic_neighborhood",&r_anisotropic_neighborhood,args("pid","points","adjacencies","radius","direction","alpha","beta"));
+    def("r_neighborhood",PGL_NOGIL(&r_neighborhood),args("pid","points","adjacencies","radius"));
+    def("r_neighborhoods",PGL_NOGIL_SIG(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr), &r_neighborhoods),args("points","adjacencies","radii"));
+    def("r_neighborhoods",PGL_NOGIL_SIG(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool), &r_neighborhoods),(bp::arg("points"),bp::arg("adjacencies"),bp::arg("radius"),bp::arg("verbose")=false));
+    def("r_neighborhoods_mt",PGL_NOGIL_SIG(IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool), &r_neighborhoods_mt),(bp::arg("points"),bp::arg("adjacencies"),bp::arg("radius"),bp::arg("verbose")=false));
+    def("r_anisotropic_neighborhood",PGL_NOGIL(&r_anisotropic_neighborhood),args("pid","points","adjacencies","radius","direction","alpha","beta"));
     def("r_anisotropic_neighborhoods",
-        (IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr, const Point3ArrayPtr, const real_t, const real_t ))&r_anisotropic_neighborhoods,
+        PGL_NOGIL_SIG(IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr, const Point3ArrayPtr, const real_t, const real_t ), &r_anisotropic_neighborhoods),
         args("points","adjacencies","radii","directions","alpha","beta"));
     def("r_anisotropic_neighborhoods",
-        (IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t, const Point3ArrayPtr, const real_t, const real_t ))&r_anisotropic_neighborhoods,
+        PGL_NOGIL_SIG(IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t, const Point3ArrayPtr, const real_t, const real_t ), &r_anisotropic_neighborhoods),
         args("points","adjacencies","radius","directions","alpha","beta"));
 
-    def("k_neighborhood",&k_neighborhood,args("pid","points","adjacencies","k"));
-    def("k_neighborhoods",&k_neighborhoods,args("points","adjacencies","k"));
+    def("k_neighborhood",PGL_NOGIL(&k_neighborhood),args("pid","points","adjacencies","k"));
+    def("k_neighborhoods",PGL_NOGIL(&k_neighborhoods),args("points","adjacencies","k"));
+
+    def("density_from_r_neighborhood",PGL_NOGIL(&density_from_r_neighborhood),args("pid","points","adjacencies","radius"));
+    def("densities_from_r_neighborhood",PGL_NOGIL_SIG(RealArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t), &densities_from_r_neighborhood),args("points","adjacencies","radius"));
+    def("densities_from_r_neighborhood",PGL_NOGIL_SIG(RealArrayPtr(*)(const IndexArrayPtr, const real_t), &densities_from_r_neighborhood),args("neighborhood","radius"));
 
-    def("density_from_r_neighborhood",&density_from_r_neighborhood,args("pid","points","adjacencies","radius"));
-    def("densities_from_r_neighborhood",(RealArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t))&densities_from_r_neighborhood,args("points","adjacencies","radius"));
-    def("densities_from_r_neighborhood",(RealArrayPtr(*)(const IndexArrayPtr, const real_t))&densities_from_r_neighborhood,args("neighborhood","radius"));
+    def("pointset_max_distance",PGL_NOGIL_SIG(real_t (*)(uint32_t, const Point3ArrayPtr, const Index&), &pointset_max_distance),args("pid","points","group"));
+    def("pointset_max_distance",PGL_NOGIL_SIG(real_t (*)(const Vector3&, const Point3ArrayPtr, const Index&), &pointset_max_distance),args("center","points","group"));
+    def("pointset_mean_distance",PGL_NOGIL(&pointset_mean_distance<Index>),args("center","points","group"));
+    def("pointset_mean_distances",PGL_NOGIL(&pointset_mean_distances<IndexArray>),args("points","groups"));
+    def("pointset_mean_radial_distance",PGL_NOGIL(&pointset_mean_radial_distance),args("center","direction","points","group"));
+    def("pointset_max_radial_distance",PGL_NOGIL(&pointset_max_radial_distance),args("center","direction","points","group"));
 
-    def("pointset_max_distance",(real_t (*)(uint32_t, const Point3ArrayPtr, const Index&))&pointset_max_distance,args("pid","points","group"));
-    def("pointset_max_distance",(real_t (*)(const Vector3&, const Point3ArrayPtr, const Index&))&pointset_max_distance,args("center","points","group"));
-    def("pointset_mean_distance",&pointset_mean_distance<Index>,args("center","points","group"));
-    def("pointset_mean_distances",&pointset_mean_distances<IndexArray>,args("points","groups"));
-    def("pointset_mean_radial_distance",&pointset_mean_radial_distance,args("center","direction","points","group"));
-    def("pointset_max_radial_distance",&pointset_max_radial_distance,args("center","direction","points","group"));
+    def("pointset_covariance",PGL_NOGIL(&pointset_covariance),(arg("points"),arg("group")=Index()));
 
-    def("pointset_covariance",&pointset_covariance,(arg("points"),arg("group")=Index()));
+    def("density_from_k_neighborhood",PGL_NOGIL(&density_from_k_neighborhood),(bp::arg("pid"),bp::arg("points"),bp::arg("adjacencies"),bp::arg("k")=0),"Compute density of a point according to its k neighboordhood. If k is 0, its value is deduced from adjacencies.");
+    def("densities_from_k_neighborhood",PGL_NOGIL(&densities_from_k_neighborhood),(bp::arg("points"),bp::arg("adjacencies"),bp::arg("k")=0),"Compute local densities of a set of points according to their k neighboordhood. If k is 0, its value is deduced from adjacencies.");
 
-    def("density_from_k_neighborhood",&density_from_k_neighborhood,(bp::arg("pid"),bp::arg("points"),bp::arg("adjacencies"),bp::arg("k")=0),"Compute density of a point according to its k neighboordhood. If k is 0, its value is deduced from adjacencies.");
-    def("densities_from_k_neighborhood",&densities_from_k_neighborhood,(bp::arg("points"),bp::arg("adjacencies"),bp::arg("k")=0),"Compute local densities of a set of points according to their k neighboordhood. If k is 0, its value is deduced from adjacencies.");
+    def("pointset_orientation",PGL_NOGIL(&pointset_orientation),args("points","group"));
+    def("pointsets_orientations",PGL_NOGIL(&pointsets_orientations),args("points","groups"));
+    def("pointset_normal",PGL_NOGIL(&pointset_normal),(bp::arg("points"),bp::arg("groups")));
+    def("pointsets_normals",PGL_NOGIL(&pointsets_normals),(bp::arg("points"),bp::arg("groups")));
+    def("pointsets_curvatures",PGL_NOGIL(&pointsets_curvatures),(bp::arg("points"),bp::arg("groups")),"Compute the surface variation l0/(l0+l1+l2) of the covariance of each group of points.");
+    def("pointsets_linearities",PGL_NOGIL(&pointsets_linearities),(bp::arg("points"),bp::arg("groups")),"Compute the linearity (l2-l1)/l2 of the covariance of each group of points.");
 
 #ifdef WITH_CGAL
-    def("pointset_orientation",&pointset_orientation,args("points","group"));
-    def("pointsets_orientations",&pointsets_orientations,args("points","groups"));
-    def("pointset_normal",&pointset_normal,(bp::arg("points"),bp::arg("groups")));
-    def("pointsets_normals",&pointsets_normals,(bp::arg("points"),bp::arg("groups")));
-    def("triangleset_orientation",&triangleset_orientation,args("points","triangles"));
+    def("triangleset_orientation",PGL_NOGIL(&triangleset_orientation),args("points","triangles"));
 
 #ifdef CGAL_AND_SVD_SOLVER_ENABLED
     def("principal_curvatures",&py_principal_curvatures_0,(bp::arg("points"),bp::arg("pid"),bp::arg("group"),bp::arg("fitting_degree")=4,bp::arg("monge_degree")=4),
@@ -314,14 +377,14 @@ void export_PointManip()
     def("principal_curvatures",&py_principal_curvatures_2,(bp::arg("points"),bp::arg("adjacencies"),bp::arg("radius"),bp::arg("fitting_degree")=4,bp::arg("monge_degree")=4));
 #endif
 #endif
-    def("pointsets_orient_normals",(Point3ArrayPtr (*)(const Point3ArrayPtr, const Point3ArrayPtr, const IndexArrayPtr ))&pointsets_orient_normals,(bp::arg("normals"),bp::arg("points"),bp::arg("adjacencies")));
-    def("pointsets_orient_normals",(Point3ArrayPtr (*)(const Point3ArrayPtr, uint32_t, const IndexArrayPtr ))&pointsets_orient_normals,(bp::arg("normals"),bp::arg("source"),bp::arg("adjacencies")));
-
-    def("point_section",(Index (*)(uint32_t, const Point3ArrayPtr, const IndexArrayPtr, const TOOLS(Vector3)&, real_t))         &point_section,args("pid","points","adjacencies","direction","width"));
-    def("point_section",(Index (*)(uint32_t, const Point3ArrayPtr, const IndexArrayPtr, const TOOLS(Vector3)&, real_t, real_t)) &point_section,args("pid","points","adjacencies","direction","width","maxradius"));
-    def("points_sections",&points_sections,args("points","adjacencies","directions","width"));
-    def("section_normal",&section_normal,args("pointnormals","section"));
-    def("sections_normals",&sections_normals,args("pointnormals","sections"));
+    def("pointsets_orient_normals",PGL_NOGIL_SIG(Point3ArrayPtr (*)(const Point3ArrayPtr, const Point3ArrayPtr, const IndexArrayPtr ), &pointsets_orient_normals),(bp::arg("normals"),bp::arg("points"),bp::arg("adjacencies")));
+    def("pointsets_orient_normals",PGL_NOGIL_SIG(Point3ArrayPtr (*)(const Point3ArrayPtr, uint32_t, const IndexArrayPtr ), &pointsets_orient_normals),(bp::arg("normals"),bp::arg("source"),bp::arg("adjacencies")));
+
+    def("point_section",PGL_NOGIL_SIG(Index (*)(uint32_t, const Point3ArrayPtr, const IndexArrayPtr, const TOOLS(Vector3)&, real_t), &point_section),args("pid","points","adjacencies","direction","width"));
+    def("point_section",PGL_NOGIL_SIG(Index (*)(uint32_t, const Point3ArrayPtr, const IndexArrayPtr, const TOOLS(Vector3)&, real_t, real_t), &point_section),args("pid","points","adjacencies","direction","width","maxradius"));
+    def("points_sections",PGL_NOGIL(&points_sections),args("points","adjacencies","directions","width"));
+    def("section_normal",PGL_NOGIL(&section_normal),args("pointnormals","section"));
+    def("sections_normals",PGL_NOGIL(&sections_normals),args("pointnormals","sections"));
     
     def("pointset_circle",&py_estimate_pointset_circle,(bp::arg("points"),bp::arg("group"),bp::arg("direction")=bp::object(),bp::arg("bounding")=false));
     def("pointsets_circles",&py_estimate_pointsets_circles,(arg("points"),bp::arg("groups"),bp::arg("directions")=Point3ArrayPtr(0),bp::arg("bounding")=false));
@@ -330,14 +393,14 @@ void export_PointManip()
     def("adaptive_section_circles",&py_adaptive_section_circles,(arg("points"),bp::arg("adjacencies"),bp::arg("directions"),bp::arg("widths"),bp::arg("maxradii")));
     def("adaptive_section_circles",&py_adaptive_section_circles2,(arg("points"),bp::arg("adjacencies"),bp::arg("directions"),bp::arg("widths"),bp::arg("maxradii")));
 
-    def("centroid_of_group",&centroid_of_group<Index>,args("","group"));
-    def("centroids_of_groups",&centroids_of_groups<IndexArray>,args("points","groups"));
-    def("points_clusters",&points_clusters,args("points","clustercentroid"));
-    def("cluster_points",&cluster_points,args("points","clustercentroid"));
+    def("centroid_of_group",PGL_NOGIL(&centroid_of_group<Index>),args("","group"));
+    def("centroids_of_groups",PGL_NOGIL(&centroids_of_groups<IndexArray>),args("points","groups"));
+    def("points_clusters",PGL_NOGIL(&points_clusters),args("points","clustercentroid"));
+    def("cluster_points",PGL_NOGIL(&cluster_points),args("points","clustercentroid"));
 
 
-    def("adaptive_radii",&adaptive_radii,(bp::arg("density"),bp::arg("minradius"),bp::arg("maxradius"),bp::arg("densityradiusmap")=QuantisedFunctionPtr(0)),"Compute a radius for each density value");
-    def("adaptive_contration",&adaptive_contration,(bp::arg("points"),bp::arg("orientations"),bp::arg("adjacencies"),
+    def("adaptive_radii",PGL_NOGIL(&adaptive_radii),(bp::arg("density"),bp::arg("minradius"),bp::arg("maxradius"),bp::arg("densityradiusmap")=QuantisedFunctionPtr(0)),"Compute a radius for each density value");
+    def("adaptive_contration",PGL_NOGIL(&adaptive_contration),(bp::arg("points"),bp::arg("orientations"),bp::arg("adjacencies"),
                                                     bp::arg("densities"),bp::arg("minradius"),bp::arg("maxradius"),
                                                     bp::arg("densityradiusmap")=NULL,
                                                     bp::arg("alpha")=1.0,bp::arg("beta")=1.0),"Contract the pointset with an adptive radius of contraction");
@@ -347,55 +410,62 @@ void export_PointManip()
                                                     bp::arg("densityradiusmap")=NULL,
                                                     bp::arg("alpha")=1.0,bp::arg("beta")=1.0),"Contract the pointset with an adptive radius of contraction");
 
-    def("get_sorted_element_order",&get_sorted_element_order,args("elements"));
+    def("get_sorted_element_order",PGL_NOGIL(&get_sorted_element_order),args("elements"));
     def("points_dijkstra_shortest_path",&py_points_dijkstra_shortest_path,args("points","adjacencies","root"));
-    def("quotient_points_from_adjacency_graph",&quotient_points_from_adjacency_graph,args("binsize","points","adjacencies","distances_to_root"));
-    def("quotient_adjacency_graph",&quotient_adjacency_graph,args("adjacencies","groups"));
+    def("quotient_points_from_adjacency_graph",PGL_NOGIL(&quotient_points_from_adjacency_graph),args("binsize","points","adjacencies","distances_to_root"));
+    def("quotient_adjacency_graph",PGL_NOGIL(&quotient_adjacency_graph),args("adjacencies","groups"));
     def("skeleton_from_distance_to_root_clusters",&py_skeleton_from_distance_to_root_clusters,
         (bp::arg("points"),bp::arg("root"),bp::arg("binsize"),bp::arg("k")=10,bp::arg("connect_all_points")=false,bp::arg("verbose")=false),"Implementation of Xu et al. 07 method for main branching system");
 
-    def("points_in_range_from_root",&points_in_range_from_root,args("initiallevel","binsize","distances_to_root"));
+    def("tiled_r_neighborhoods",PGL_NOGIL(&tiled_r_neighborhoods),args("fname","tilesize","radius"),"Ball neighborhoods of the points of a tpc file, computed tile by tile. Ids are positions in the file.");
+    def("tiled_pointsets_normals",PGL_NOGIL(&tiled_pointsets_normals),args("fname","tilesize","radius"),"Normals of the points of a tpc file from their ball neighborhoods, computed tile by tile.");
+    def("tiled_densities_from_r_neighborhood",PGL_NOGIL(&tiled_densities_from_r_neighborhood),args("fname","tilesize","radius"),"Densities of the points of a tpc file from their ball neighborhoods, computed tile by tile.");
+    def("tiled_voxel_downsampling",PGL_NOGIL(&tiled_voxel_downsampling),args("fname","output","tilesize","voxelsize"),"Downsamples the points of a tpc file by voxels and writes the centroids in the tpc file output.");
+    def("tiled_skeleton_from_distance_to_root_clusters",&py_tiled_skeleton_from_distance_to_root_clusters,
+        (bp::arg("fname"),bp::arg("tilesize"),bp::arg("halo"),bp::arg("binsize"),bp::arg("k")=10),"Skeleton forest of the points of a tpc file, computed tile by tile.");
+
+    def("points_in_range_from_root",PGL_NOGIL(&points_in_range_from_root),args("initiallevel","binsize","distances_to_root"));
     def("next_quotient_points_from_adjacency_graph",&py_next_quotient_points_from_adjacency_graph,args("initiallevel","binsize","current","adjacencies","distances_to_root"));
     
     def("determine_children", &py_determine_children);
-    def("carried_length",&carried_length,bp::args("points","parents"));
-    def("subtrees_size",(Uint32Array1Ptr(*)(const Uint32Array1Ptr))&subtrees_size,bp::args("parents"));
-    def("subtrees_size",(Uint32Array1Ptr(*)(const IndexArrayPtr, uint32_t))&subtrees_size,bp::args("children","root"));
+    def("carried_length",PGL_NOGIL(&carried_length),bp::args("points","parents"));
+    def("subtrees_size",PGL_NOGIL_SIG(Uint32Array1Ptr(*)(const Uint32Array1Ptr), &subtrees_size),bp::args("parents"));
+    def("subtrees_size",PGL_NOGIL_SIG(Uint32Array1Ptr(*)(const IndexArrayPtr, uint32_t), &subtrees_size),bp::args("children","root"));
 
-    def("optimize_orientations",&optimize_orientations,bp::args("points","parents","weights"));
-    def("optimize_positions",&optimize_positions,bp::args("points","orientations","parents","weights"));
+    def("optimize_orientations",PGL_NOGIL(&optimize_orientations),bp::args("points","parents","weights"));
+    def("optimize_positions",PGL_NOGIL(&optimize_positions),bp::args("points","orientations","parents","weights"));
 
-    def("average_radius",&average_radius,(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("maxclosestnodes")=10));
-    def("distance_to_shape",&distance_to_shape,(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("maxclosestnodes")=10));
-    def("average_distance_to_shape",&average_distance_to_shape,(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("maxclosestnodes")=10));
-    def("points_at_distance_from_skeleton",&points_at_distance_from_skeleton,(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("distance"),bp::arg("maxclosestnodes")=10),"Return indices of all point which are below a given distance ot the skeleton. If distance is negative, return point above a distance");
+    def("average_radius",PGL_NOGIL(&average_radius),(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("maxclosestnodes")=10));
+    def("distance_to_shape",PGL_NOGIL(&distance_to_shape),(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("maxclosestnodes")=10));
+    def("average_distance_to_shape",PGL_NOGIL(&average_distance_to_shape),(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("maxclosestnodes")=10));
+    def("points_at_distance_from_skeleton",PGL_NOGIL(&points_at_distance_from_skeleton),(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("distance"),bp::arg("maxclosestnodes")=10),"Return indices of all point which are below a given distance ot the skeleton. If distance is negative, return point above a distance");
 
-    def("estimate_radii_from_points",&estimate_radii_from_points,(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("maxmethod")=false,bp::arg("maxclosestnodes")=10));
-    def("estimate_radii_from_pipemodel",&estimate_radii_from_pipemodel,(bp::arg("nodes"),bp::arg("parents"),bp::arg("weights"),bp::arg("averageradius"),bp::arg("pipeexponent")=2.5));
+    def("estimate_radii_from_points",PGL_NOGIL(&estimate_radii_from_points),(bp::arg("points"),bp::arg("nodes"),bp::arg("parents"),bp::arg("maxmethod")=false,bp::arg("maxclosestnodes")=10));
+    def("estimate_radii_from_pipemodel",PGL_NOGIL(&estimate_radii_from_pipemodel),(bp::arg("nodes"),bp::arg("parents"),bp::arg("weights"),bp::arg("averageradius"),bp::arg("pipeexponent")=2.5));
     
-    def("min_max_mean_edge_length",(Vector3 (*)(const Point3ArrayPtr, Uint32Array1Ptr))&min_max_mean_edge_length,(bp::arg("points"),bp::arg("parents")));
-    def("min_max_mean_edge_length",(Vector3 (*)(const Point3ArrayPtr, IndexArrayPtr))&min_max_mean_edge_length,(bp::arg("points"),bp::arg("graph")));
+    def("min_max_mean_edge_length",PGL_NOGIL_SIG(Vector3 (*)(const Point3ArrayPtr, Uint32Array1Ptr), &min_max_mean_edge_length),(bp::arg("points"),bp::arg("parents")));
+    def("min_max_mean_edge_length",PGL_NOGIL_SIG(Vector3 (*)(const Point3ArrayPtr, IndexArrayPtr), &min_max_mean_edge_length),(bp::arg("points"),bp::arg("graph")));
 
     def("node_continuity_test",&py_node_continuity_test,(bp::arg("node"),bp::arg("radius"),bp::arg("parent"),bp::arg("parentradius"),bp::arg("child"),bp::arg("radius"),bp::arg("overlapfilter")=0.5,bp::arg("verbose")=false));
     def("node_intersection_test",&py_node_intersection_test,(bp::arg("parent"),bp::arg("parentradius"),bp::arg("node1"),bp::arg("radius1"),bp::arg("node2"),bp::arg("radius2"),bp::arg("overlapfilter")=0.5,bp::arg("verbose")=false));
-    def("detect_short_nodes",&detect_short_nodes,(bp::arg("nodes"),bp::arg("parents"),bp::arg("edgelengthfilter")=0.001));
+    def("detect_short_nodes",PGL_NOGIL(&detect_short_nodes),(bp::arg("nodes"),bp::arg("parents"),bp::arg("edgelengthfilter")=0.001));
     def("remove_nodes",&py_remove_nodes,(bp::arg("toremove"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii")=RealArrayPtr(0)));
-    def("detect_similar_nodes",&detect_similar_nodes,(bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("weight"),bp::arg("overlapfilter")=0.5));
+    def("detect_similar_nodes",PGL_NOGIL(&detect_similar_nodes),(bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("weight"),bp::arg("overlapfilter")=0.5));
     def("merge_nodes",&py_merge_nodes,(bp::arg("tomerge"),bp::arg("nodes"),bp::arg("parents"),bp::arg("radii"),bp::arg("weight")));
 
-    def("pointset_mean_direction",&pointset_mean_direction,(bp::arg("origin"),bp::arg("points"),bp::arg("group")=Index()));
-    def("pointset_directions",&pointset_directions,(bp::arg("origin"),bp::arg("points"),bp::arg("group")=Index()));
-    def("pointset_angulardirections",&pointset_angulardirections,(bp::arg("points"),bp::arg("origin")=Vector3::ORIGIN,bp::arg("group")=Index()));
+    def("pointset_mean_direction",PGL_NOGIL(&pointset_mean_direction),(bp::arg("origin"),bp::arg("points"),bp::arg("group")=Index()));
+    def("pointset_directions",PGL_NOGIL(&pointset_directions),(bp::arg("origin"),bp::arg("points"),bp::arg("group")=Index()));
+    def("pointset_angulardirections",PGL_NOGIL(&pointset_angulardirections),(bp::arg("points"),bp::arg("origin")=Vector3::ORIGIN,bp::arg("group")=Index()));
 
     def("findClosestFromSubset",&py_findClosestFromSubset,(bp::arg("origin"),bp::arg("points"),bp::arg("group")=Index()));
 
-    def("orientations_distances",&orientations_distances,(bp::arg("orientations"),bp::arg("group")=Index()));
-    def("orientations_similarities",&orientations_similarities,(bp::arg("orientations"),bp::arg("group")=Index()));
+    def("orientations_distances",PGL_NOGIL(&orientations_distances),(bp::arg("orientations"),bp::arg("group")=Index()));
+    def("orientations_similarities",PGL_NOGIL(&orientations_similarities),(bp::arg("orientations"),bp::arg("group")=Index()));
 
     def("cluster_junction_points",&py_cluster_junction_points,(bp::arg("pointtoppology"),bp::arg("group1"),bp::arg("group2")));
 
-    def("pointset_median",&pointset_median,(bp::arg("points")));
-    def("approx_pointset_median",&approx_pointset_median,(bp::arg("points"),bp::arg("nbIterMax")=200));
+    def("pointset_median",PGL_NOGIL(&pointset_median),(bp::arg("points")));
+    def("approx_pointset_median",PGL_NOGIL(&approx_pointset_median),(bp::arg("points"),bp::arg("nbIterMax")=200));
 }
 
 
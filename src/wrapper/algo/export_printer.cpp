@@ -33,6 +33,7 @@
 #include <plantgl/algo/codec/printer.h>
 #include <plantgl/algo/codec/binaryprinter.h>
 #include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
 #include <plantgl/tool/bfstream.h>
 #include <boost/python.hpp>
 
@@ -41,6 +42,7 @@
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
 using namespace boost::python;
+#define bp boost::python
 
 /* ----------------------------------------------------------------------- */
 
@@ -87,6 +89,15 @@ void print_header0(Printer * p)
 void print_header(Printer * p, const std::string comment)
 { p->header(comment.c_str()); }
 
+bool print_begin0(Printer * p)
+{ return p->begin(); }
+
+bool print_begin(Printer * p, const std::string comment)
+{ return p->begin(comment.c_str()); }
+
+bool print_add(Printer * p, Shape3DPtr shape)
+{ return p->add(shape); }
+
 void export_PglPrinter()
 {
  class_< Printer, bases< Action >, boost::noncopyable > ( "PglPrinter" , no_init )
@@ -95,6 +106,11 @@ void export_PglPrinter()
     .def("isPrinted",&Printer::isPrinted)
     .def("header",&print_header0)
     .def("header",&print_header)
+    .def("begin",&print_begin0,"begin() : begin a stream of shapes and print the header.")
+    .def("begin",&print_begin,args("comment"))
+    .def("add",&print_add,args("shape"),"add(shape) : print a shape of the stream.")
+    .def("end",&Printer::end,"end() : end the stream of shapes.")
+    .def("isStreaming",&Printer::isStreaming)
     ;
 
   class_< PyStrPGLPrinter , bases< PyStrPrinter, Printer > , boost::noncopyable> 
@@ -122,12 +138,37 @@ bool abp_print(BinaryPrinter* printer, ScenePtr scene)
   return printer->print(scene);
 }
 
+bool abp_printIndexed(ScenePtr scene, const std::string& filename,
+                      BinaryIndex::Compression compression, size_t chunkSize)
+{
+  return BinaryPrinter::printIndexed(scene,filename,"File Generated with PlantGL.",compression,chunkSize);
+}
+
 void export_PglBinaryPrinter()
 {
+  enum_<BinaryIndex::Compression>("BinaryCompression")
+    .value("NoCompression",BinaryIndex::NoCompression)
+    .value("LZ4Compression",BinaryIndex::LZ4Compression)
+    .value("ZstdCompression",BinaryIndex::ZstdCompression)
+    .export_values()
+    ;
+  def("isBinaryCompressionSupported",&BinaryIndex::isSupported,args("compression"));
+
   class_< PyFileBinaryPrinter, bases< Printer >, boost::noncopyable> 
 	  ("PglBinaryPrinter",init<const std::string&>("Binary Pgl Printer",args("filename")))
     .def("print",abp_print)
-	.def("getCanonicalFilename",BinaryPrinter::getCanonicalFilename,args("filename"))
-	.staticmethod("getCanonicalFilename");
+	.def("getCanonicalFilename",(std::string(*)(const std::string&))&BinaryPrinter::getCanonicalFilename,args("filename"))
+	.staticmethod("getCanonicalFilename")
+	.def("printIndexed",&abp_printIndexed,(bp::arg("scene"),bp::arg("filename"),
+	     bp::arg("compression")=BinaryIndex::NoCompression,bp::arg("chunkSize")=BinaryPrinter::DEFAULT_CHUNK_SIZE),
+	     "printIndexed(scene,filename,compression,chunkSize) : print scene in the indexed binary format (version 3.0). "
+	     "The shapes are grouped in chunks of about chunkSize bytes, compressed if the compression is supported.")
+	.staticmethod("printIndexed")
+	.def("isIndexedByDefault",&BinaryPrinter::isIndexedByDefault)
+	.staticmethod("isIndexedByDefault")
+	.def("setIndexedByDefault",&BinaryPrinter::setIndexedByDefault,args("indexed"),
+	     "setIndexedByDefault(indexed) : whether the BGEOM files are saved in the indexed format (version 3.0), "
+	     "which cannot be read by the versions of PlantGL prior to it.")
+	.staticmethod("setIndexedByDefault")
     ;
 }
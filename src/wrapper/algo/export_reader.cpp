@@ -41,6 +41,9 @@
 #include <plantgl/scenegraph/core/smbtable.h>
 #endif
 #include <plantgl/algo/codec/scne_binaryparser.h>
+#include <plantgl/algo/codec/tiledpointcloud.h>
+#include <plantgl/scenegraph/core/pgl_messages.h>
+#include <plantgl/python/pyinterpreter.h>
 #include <sstream>
 
 /* ----------------------------------------------------------------------- */
@@ -63,6 +66,76 @@ object pgl_read(const std::string& txt, const std::string& fname)
 
 #endif
 
+object pbp_result(BinaryParser& parser, bool ok)
+{
+	if (!ok || !parser.getScene()) return object();
+	return object(parser.getScene());
+}
+
+object pbp_parseShapesWithIds(const std::string& filename, object ids)
+{
+	std::vector<uint_t> _ids;
+	for (size_t i = 0, nb = len(ids); i < nb; ++i) _ids.push_back(extract<uint_t>(ids[i]));
+	BinaryParser parser(*PglErrorStream::error);
+	return pbp_result(parser, parser.parseShapesWithIds(filename, _ids));
+}
+
+bool pbp_isIndexedFile(const std::string& filename)
+{
+	std::stringstream errlog;
+	BinaryParser parser(errlog);
+	if (!parser.open(filename)) return false;
+	bool result = parser.readHeader() && parser.readSceneHeader() && parser.isIndexed();
+	parser.close();
+	return result;
+}
+
+object pbp_parseShapesInBox(const std::string& filename, const Vector3& lower, const Vector3& upper)
+{
+	BinaryParser parser(*PglErrorStream::error);
+	return pbp_result(parser, parser.parseShapesInBox(filename, lower, upper));
+}
+
+object tpcr_result(bool ok, const Point3ArrayPtr& points, const Color4ArrayPtr& colors)
+{
+	if (!ok) return object();
+	return make_tuple(points, colors ? object(colors) : object());
+}
+
+object tpcr_read(TiledPointCloudReader * reader)
+{
+	PointCloud cloud;
+	bool ok;
+	{
+		PythonInterpreterReleaser nogil;
+		ok = reader->read(cloud);
+	}
+	return tpcr_result(ok, cloud.points, cloud.colors);
+}
+
+object tpcr_read_box(TiledPointCloudReader * reader, const Vector3& lower, const Vector3& upper)
+{
+	Point3ArrayPtr points;
+	Color4ArrayPtr colors;
+	bool ok;
+	{
+		PythonInterpreterReleaser nogil;
+		ok = reader->read(lower, upper, points, colors);
+	}
+	return tpcr_result(ok, points, colors);
+}
+
+size_t tpcr_len(TiledPointCloudReader * reader)
+{ return reader->index().size(); }
+
+object tpcr_bbox(TiledPointCloudReader * reader)
+{
+	if (!reader->isValid()) return object();
+	Vector3 lower, upper;
+	reader->index().getBoundingBox(lower, upper);
+	return make_tuple(lower, upper);
+}
+
 void export_PglReader()
 {
 #ifdef WITH_BISONFLEX
@@ -70,4 +143,25 @@ void export_PglReader()
 #endif
 	def("pglParserVerbose",&parserVerbose, (bp::arg("verbose")=true));
 	def("isPglParserVerbose",&isParserVerbose);
+
+	class_<BinaryParser, boost::noncopyable>("PglBinaryParser", no_init)
+	.def("parseShapesWithIds",&pbp_parseShapesWithIds,args("filename","ids"),
+	     "parseShapesWithIds(filename,ids) : read the shapes of ids from an indexed BGEOM file. Return None if it fails.")
+	.staticmethod("parseShapesWithIds")
+	.def("parseShapesInBox",&pbp_parseShapesInBox,args("filename","lower","upper"),
+	     "parseShapesInBox(filename,lower,upper) : read the shapes of an indexed BGEOM file whose bounding box intersects [lower,upper]. Return None if it fails.")
+	.staticmethod("parseShapesInBox")
+	.def("isIndexedFile",&pbp_isIndexedFile,args("filename"),"isIndexedFile(filename) : test if filename is a BGEOM file written with its index.")
+	.staticmethod("isIndexedFile")
+	;
+
+	class_<TiledPointCloudReader, boost::noncopyable>("TiledPointCloudReader",
+		"Reader of a tiled point cloud (tpc) file. Only the tiles intersecting a requested box are decoded.",
+		init<const std::string&>(args("filename")))
+	.def("isValid",&TiledPointCloudReader::isValid)
+	.def("__len__",&tpcr_len)
+	.def("getBoundingBox",&tpcr_bbox,"getBoundingBox() : return the lower and upper corners of the points, or None if the file is invalid.")
+	.def("read",&tpcr_read,"read() : return the points and their colors, or None if they cannot be read. The colors are None if the file has none.")
+	.def("read",&tpcr_read_box,args("lower","upper"),"read(lower,upper) : return the points in the box [lower,upper] and their colors, or None if they cannot be read.")
+	;
 }
@@ -57,6 +57,7 @@ void module_algo()
 	// custom algo
     export_Merge();
     export_Fit();
+    export_MeshOptimizer();
 
 	// abstract printer export
     export_StrPrinter();
@@ -72,6 +73,7 @@ void module_algo()
 
     // reader export
     export_PglReader();
+    export_Pickle();
 
     // gl export
     export_GLRenderer();
@@ -98,6 +100,7 @@ void module_algo()
     export_Octree();
     export_PointGrid();
     export_KDtree();
+    export_AABBTree();
     export_PyGrid();
     export_PlaneClip();
 
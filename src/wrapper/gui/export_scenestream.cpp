@@ -0,0 +1,129 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "export_viewer.h"
+#include <boost/python.hpp>
+
+#include <plantgl/gui/viewer/scenestream.h>
+#include <plantgl/tool/bfstream.h>
+#include <plantgl/tool/mmapstream.h>
+#include <plantgl/python/exception.h>
+#include <sstream>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+bp::list vsd_get_removed(ViewSceneDelta * delta)
+{
+	bp::list res;
+	for(std::vector<uint_t>::const_iterator it = delta->removed.begin(); it != delta->removed.end(); ++it)
+		res.append(*it);
+	return res;
+}
+
+bp::list vsd_get_shapes(ViewSceneDelta * delta)
+{
+	bp::list res;
+	for(ViewSceneDelta::ShapeList::const_iterator it = delta->shapes.begin(); it != delta->shapes.end(); ++it)
+		res.append(bp::make_tuple(it->first,it->second));
+	return res;
+}
+
+bp::list vsd_get_transforms(ViewSceneDelta * delta)
+{
+	bp::list res;
+	for(ViewSceneDelta::TransformList::const_iterator it = delta->transforms.begin(); it != delta->transforms.end(); ++it)
+		res.append(bp::make_tuple(it->first,it->second));
+	return res;
+}
+
+object vsd_tobytes(ViewSceneDelta * delta)
+{
+	leomstream stream;
+	delta->write(stream);
+	std::string data = stream.str();
+	return object(handle<>(PyBytes_FromStringAndSize(data.c_str(),data.size())));
+}
+
+ViewSceneDelta vsd_frombytes(object data)
+{
+	Py_buffer view;
+	if (PyObject_GetBuffer(data.ptr(),&view,PyBUF_SIMPLE) != 0) throw_error_already_set();
+	lemmapstream stream((const char *)view.buf,view.len);
+	std::stringstream errlog;
+	ViewSceneDelta delta;
+	bool ok = delta.read(stream,errlog);
+	PyBuffer_Release(&view);
+	if (!ok) throw PythonExc_ValueError(("Invalid scene delta. "+errlog.str()).c_str());
+	return delta;
+}
+
+object vss_transform(const GeometryPtr& base, const Matrix4& matrix)
+{
+	GeometryPtr res = ViewSceneStream::transform(base,matrix);
+	if (!res) return object();
+	return object(res);
+}
+
+void export_scenestream(){
+	class_<ViewSceneDelta>("ViewSceneDelta",
+        "The changes of a scene streamed to the viewer between two frames. "
+        "The removed shapes, the added or replaced shapes and the new transformations are given with the key of their shape.",
+        init<optional<bool> >(args("reset")))
+    .def_readwrite("reset",&ViewSceneDelta::reset)
+    .add_property("removed",&vsd_get_removed)
+    .add_property("shapes",&vsd_get_shapes)
+    .add_property("transforms",&vsd_get_transforms)
+    .def("empty",&ViewSceneDelta::empty)
+    .def("merge",&ViewSceneDelta::merge,args("next"),"merge(next) : merge the delta next that follows self.")
+    .def("tobytes",&vsd_tobytes,"tobytes() : return the delta in the binary format of the stream.")
+    .def("frombytes",&vsd_frombytes,args("data"),"frombytes(data) : read a delta from its binary format.")
+    .staticmethod("frombytes")
+	;
+
+	class_<ViewSceneStream, boost::noncopyable>("ViewSceneStream",
+        "The last state of a scene streamed to the viewer.",
+        init<>())
+    .def("update",&ViewSceneStream::update,args("scene"),"update(scene) : return the changes from the current state to scene, which becomes the current state.")
+    .def("apply",&ViewSceneStream::apply,args("delta"),"apply(delta) : apply delta to the current state.")
+    .def("getScene",&ViewSceneStream::getScene)
+    .def("clear",&ViewSceneStream::clear)
+    .def("__len__",&ViewSceneStream::size)
+    .def("getKey",&ViewSceneStream::getKey,args("shape"))
+    .staticmethod("getKey")
+    .def("transform",&vss_transform,args("base","matrix"),"transform(base,matrix) : return base transformed by matrix with Scaled, EulerRotated and Translated nodes, or None.")
+    .staticmethod("transform")
+	;
+}
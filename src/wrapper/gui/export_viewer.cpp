@@ -40,6 +40,8 @@
 #include <plantgl/gui/viewer/editgeomscenegl.h>
 #include <plantgl/gui/base/zbuffer.h>
 #include <plantgl/gui/base/appbuilder.h>
+#include <plantgl/gui/base/daemon.h>
+#include <plantgl/python/release_gil.h>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -771,6 +773,28 @@ void export_light(){
     .add_static_property("specular",&getLightSpecular,&setLightSpecular)
 	;
 }
+bool vsc_connect(ViewStreamClient * client, const std::string& host, quint16 port, int timeout)
+{
+    PythonInterpreterReleaser nogil;
+    return client->connectToViewer(QString(host.c_str()),port,timeout);
+}
+
+void export_streamclient(){
+	class_<ViewStreamClient, boost::noncopyable>("ViewStreamClient",
+        "Stream the successive scenes of a process to a viewer started as a daemon. "
+        "Only the changes of each scene are sent. When the viewer has not acknowledged the last 'window' frames, "
+        "the scenes are not sent and only the last one is sent when the viewer catches up.",
+        init<optional<int> >(args("window")))
+    .def("connect",&vsc_connect,(bp::arg("host")=std::string("localhost"),bp::arg("port")=7777,bp::arg("timeout")=3000),"connect(host,port,timeout) : connect to the daemon of a viewer.")
+    .def("isConnected",&ViewStreamClient::isConnected)
+    .def("send",PGL_NOGIL(&ViewStreamClient::send),args("scene"),"send(scene) : send the changes of scene since the last scene sent.")
+    .def("flush",PGL_NOGIL(&ViewStreamClient::flush),(bp::arg("timeout")=30000),"flush(timeout) : send the last scene kept and wait for the viewer to display it.")
+    .def("close",&ViewStreamClient::close)
+    .add_property("sentFrames",&ViewStreamClient::getSentFrames)
+    .add_property("droppedFrames",&ViewStreamClient::getDroppedFrames)
+	;
+}
+
 void initViewer()
 {
 	PGLViewerApplication::init();
@@ -799,6 +823,8 @@ void module_gui()
   initViewer();
 
   export_viewer();
+  export_streamclient();
+  export_scenestream();
 
   cleanViewer();
   export_icon();
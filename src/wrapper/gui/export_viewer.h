@@ -43,6 +43,8 @@ void export_framegl();
 void export_widgetgeometry();
 void export_light();
 void export_icon();
+void export_streamclient();
+void export_scenestream();
 
 void initViewer();
 void cleanViewer();
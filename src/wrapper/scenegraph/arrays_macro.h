@@ -35,9 +35,28 @@
 #include <plantgl/tool/util_array.h>
 #include <boost/python/def_visitor.hpp>
 #include <plantgl/scenegraph/container/indexarray.h>
+#include <sstream>
+#include <map>
 
 PGL_USING(Index)
 
+/// The number of buffers exported by each array (see array_buffer).
+inline std::map<const void *, size_t>& array_exports()
+{
+  static std::map<const void *, size_t> exports;
+  return exports;
+}
+
+/// Raises a BufferError if \e array cannot be resized since its storage is exported.
+inline void array_check_resizable( const void * array )
+{
+  std::map<const void *, size_t>& exports = array_exports();
+  if( !exports.empty() && exports.find(array) != exports.end() ) {
+    PyErr_SetString(PyExc_BufferError, "The array cannot be resized while its storage is exported.");
+    boost::python::throw_error_already_set();
+  }
+}
+
 
 template<class T>
 RCPtr<T> extract_array_from_list( boost::python::object l )
@@ -158,6 +177,7 @@ typename T::element_type array_popitem( T * a, int pos )
   if (a->empty()) throw PythonExc_IndexError();
   if( pos < 0 && pos >= -(int)len ) pos = len + pos;
   else if( pos >= len ) throw PythonExc_IndexError();
+  array_check_resizable( a );
   typename T::element_type elem =  a->getAt( pos );
   a->erase(a->begin() + pos);
   return elem;
@@ -180,6 +200,7 @@ void array_setitem( T * array, int pos, typename T::element_type v )
 template<class T>
 void array_insertitem( T * array, int pos, typename T::element_type v )
 {
+  array_check_resizable( array );
   size_t len = array->size();
   if( pos < 0 && pos >= -(int)len ) array->insert( array->begin() + (len + pos), v );
   else if( pos < len ) array->insert( array->begin() + pos, v );
@@ -190,6 +211,7 @@ void array_insertitem( T * array, int pos, typename T::element_type v )
 template<class T>
 void array_delitem( T * array, int pos )
 {
+  array_check_resizable( array );
   if( pos < 0 && pos >= -(int)array->size() ) array->erase( array->begin() + (array->size() + pos) );
   else if( pos < array->size() ) array->erase( array->begin() + pos );
   else throw PythonExc_IndexError();
@@ -203,6 +225,7 @@ void array_delslice( T * array, int beg, int end )
   else if( beg >= len ) throw PythonExc_IndexError(); 
   if( end >= -(int)len && end < 0  )  end += len; 
   else if( end > len ) throw PythonExc_IndexError(); 
+  array_check_resizable( array );
   array->erase( array->begin()+beg,array->begin()+end); 
 }
 
@@ -224,28 +247,33 @@ T * array_addarray( T * array, T * array2 )
 template<class T>
 T * array_iaddarray( T * array, T * array2 ) 
 { 
+	array_check_resizable( array );
 	array->insert(array->end(),array2->begin(),array2->end()); 
 	return array; 
 }
 
 template<class T>
 void array_appenditem( T * array, typename T::element_type v ) 
-{ array->push_back(v); }
+{ array_check_resizable( array ); array->push_back(v); }
 
 template<class T>
 void array_appendarray( T * array, T * array2 ) 
-{ 	array->insert(array->end(),array2->begin(),array2->end()); }
+{ 	array_check_resizable( array ); array->insert(array->end(),array2->begin(),array2->end()); }
 
 
 template<class T>
 void array_prependitem( T * array, typename T::element_type v ) 
-{ array->insert(array->begin(),v); }
+{ array_check_resizable( array ); array->insert(array->begin(),v); }
 
 template<class T>
 void array_prependarray( T * array, T * array2 ) 
-{ 	array->insert(array->begin(),array2->begin(),array2->end()); }
+{ 	array_check_resizable( array ); array->insert(array->begin(),array2->begin(),array2->end()); }
 
 
+template<class T>
+void array_clear( T * array ) 
+{ array_check_resizable( array ); array->clear(); }
+
 template<class T>
 size_t array_len( T * a )
 {  return a->size();}
@@ -458,7 +486,7 @@ class array_func : public boost::python::def_visitor<array_func<ARRAY> >
 		.def( "__iter__",     boost::python::iterator<ARRAY>() ) \
         .def( "empty",        &ARRAY::empty ) \
         .def( "reverse",      &ARRAY::reverse ) \
-        .def( "clear",        &ARRAY::clear ) \
+        .def( "clear",        &array_clear<ARRAY> ) \
         .def( "insert",       &array_insertitem<ARRAY> ) \
         .def( "append",       &array_appenditem<ARRAY> ) \
         .def( "append",       &array_appendarray<ARRAY> ) \
@@ -535,6 +563,201 @@ class_< ARRAY, ARRAY##Ptr, bases<RefCountObject> >( #ARRAY , init<size_t>(#ARRAY
   DEF_POINTEE( ARRAY ) \
   EXPORT_FUNCTION2( PREFIX, ARRAY)
 
+/* --------------------
+  Buffer protocol :
+  The arrays of tuples of C_TYPE (or of C_TYPE if NBCOMPONENTS is 0) expose their
+  storage without copy through the buffer protocol and __array_interface__.
+  The elements of Point arrays have a virtual table, so their views are strided.
+  The methods that resize an array raise a BufferError while a buffer of its storage is exported.
+  The data pointer of __array_interface__ is not tracked and is invalidated by a resize.
+   -------------------- */
+
+template<class C> struct array_buffer_type { };
+template<> struct array_buffer_type<double>   { static const char * format() { return "d"; } static char kind() { return 'f'; } };
+template<> struct array_buffer_type<float>    { static const char * format() { return "f"; } static char kind() { return 'f'; } };
+template<> struct array_buffer_type<uint32_t> { static const char * format() { return "I"; } static char kind() { return 'u'; } };
+template<> struct array_buffer_type<uchar_t>  { static const char * format() { return "B"; } static char kind() { return 'u'; } };
+
+template<class C, class T>
+struct array_buffer_component { static C * get(T& elem) { return &elem.getAt(0); } };
+
+template<class C>
+struct array_buffer_component<C,C> { static C * get(C& elem) { return &elem; } };
+
+template<class ARRAY, class C_TYPE, int NBCOMPONENTS>
+struct array_buffer
+{
+    typedef typename ARRAY::element_type element_type;
+
+    static int ndim() { return NBCOMPONENTS == 0 ? 1 : 2; }
+
+    static size_t nbcomponents() { return NBCOMPONENTS == 0 ? 1 : NBCOMPONENTS; }
+
+    /// Whether the elements are made only of their components.
+    static bool packed() { return sizeof(element_type) == nbcomponents() * sizeof(C_TYPE); }
+
+    static C_TYPE * data(ARRAY * a)
+    { return a->empty() ? NULL : array_buffer_component<C_TYPE,element_type>::get(*a->begin()); }
+
+    static std::string typestr()
+    {
+        const uint16_t one = 1;
+        std::stringstream ss;
+        ss << (sizeof(C_TYPE) == 1 ? '|' : (*(const char *)&one ? '<' : '>'))
+           << array_buffer_type<C_TYPE>::kind() << sizeof(C_TYPE);
+        return ss.str();
+    }
+
+    static int getbuffer(PyObject * obj, Py_buffer * view, int flags)
+    {
+        ARRAY * a = boost::python::extract<ARRAY *>(obj)();
+        if (!packed() && (flags & PyBUF_STRIDES) != PyBUF_STRIDES) {
+            PyErr_SetString(PyExc_BufferError, "The elements of the array are not contiguous. A strided buffer is required.");
+            view->obj = NULL;
+            return -1;
+        }
+        // shape and strides are stored in the internal field.
+        Py_ssize_t * dims = new Py_ssize_t[4];
+        dims[0] = a->size();
+        dims[1] = nbcomponents();
+        dims[2] = sizeof(element_type);
+        dims[3] = sizeof(C_TYPE);
+        if (NBCOMPONENTS == 0) dims[3] = dims[2];
+        view->obj = obj;
+        Py_INCREF(obj);
+        view->buf = data(a);
+        view->len = dims[0] * dims[1] * sizeof(C_TYPE);
+        view->readonly = 0;
+        view->itemsize = sizeof(C_TYPE);
+        view->format = (flags & PyBUF_FORMAT) ? (char *)array_buffer_type<C_TYPE>::format() : NULL;
+        view->ndim = ndim();
+        view->shape = (flags & PyBUF_ND) == PyBUF_ND ? dims : NULL;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? dims + (NBCOMPONENTS == 0 ? 3 : 2) : NULL;
+        view->suboffsets = NULL;
+        view->internal = dims;
+        ++array_exports()[a];
+        return 0;
+    }
+
+    static void releasebuffer(PyObject * obj, Py_buffer * view)
+    {
+        delete [] (Py_ssize_t *)view->internal;
+        ARRAY * a = boost::python::extract<ARRAY *>(obj)();
+        std::map<const void *, size_t>& exports = array_exports();
+        std::map<const void *, size_t>::iterator it = exports.find(a);
+        if (it != exports.end() && --it->second == 0) exports.erase(it);
+    }
+
+    static boost::python::object array_interface(ARRAY * a)
+    {
+        boost::python::dict result;
+        if (NBCOMPONENTS == 0) result["shape"] = boost::python::make_tuple(a->size());
+        else result["shape"] = boost::python::make_tuple(a->size(), NBCOMPONENTS);
+        result["typestr"] = typestr();
+        result["data"] = boost::python::make_tuple((size_t)data(a), false);
+        if (packed()) result["strides"] = boost::python::object();
+        else if (NBCOMPONENTS == 0) result["strides"] = boost::python::make_tuple(sizeof(element_type));
+        else result["strides"] = boost::python::make_tuple(sizeof(element_type), sizeof(C_TYPE));
+        result["version"] = 3;
+        return result;
+    }
+
+    /// Reads the value of format \e format at \e source. Returns false if the format is not supported.
+    static bool read_value(const char * source, char format, C_TYPE& value)
+    {
+        switch (format) {
+#define ARRAY_BUFFER_READ(FORMAT, TYPE) \
+            case FORMAT: { TYPE v; memcpy(&v, source, sizeof(TYPE)); value = C_TYPE(v); return true; }
+            ARRAY_BUFFER_READ('b', signed char)
+            ARRAY_BUFFER_READ('B', unsigned char)
+            ARRAY_BUFFER_READ('h', short)
+            ARRAY_BUFFER_READ('H', unsigned short)
+            ARRAY_BUFFER_READ('i', int)
+            ARRAY_BUFFER_READ('I', unsigned int)
+            ARRAY_BUFFER_READ('l', long)
+            ARRAY_BUFFER_READ('L', unsigned long)
+            ARRAY_BUFFER_READ('q', long long)
+            ARRAY_BUFFER_READ('Q', unsigned long long)
+            ARRAY_BUFFER_READ('f', float)
+            ARRAY_BUFFER_READ('d', double)
+#undef ARRAY_BUFFER_READ
+            default: return false;
+        }
+    }
+
+    /** Builds an array from an object with the buffer protocol, such as a numpy array, in a single pass.
+        Values of the same type are copied as blocks and others are converted.
+        Other objects are converted as sequences. */
+    static RCPtr<ARRAY> from_buffer(boost::python::object l)
+    {
+        PyObject * obj = l.ptr();
+        Py_buffer view;
+        if (!PyObject_CheckBuffer(obj) || PyObject_GetBuffer(obj, &view, PyBUF_RECORDS_RO) != 0) {
+            PyErr_Clear();
+            return extract_array_from_list<ARRAY>(l);
+        }
+        const uint16_t one = 1;
+        const char nativeorder = *(const char *)&one ? '<' : '>';
+        const char * format = view.format;
+        if (format[0] == '@' || format[0] == '=' || format[0] == nativeorder) ++format;
+        const char probe[sizeof(long long)] = { 0 };
+        C_TYPE value;
+        bool compatible = format[0] != '\0' && format[1] == '\0' && read_value(probe, format[0], value) &&
+                          view.ndim == ndim() && (NBCOMPONENTS == 0 || view.shape[1] == NBCOMPONENTS);
+        if (!compatible) {
+            PyBuffer_Release(&view);
+            return extract_array_from_list<ARRAY>(l);
+        }
+        bool sametype = view.itemsize == sizeof(C_TYPE) &&
+                        (format[0] == array_buffer_type<C_TYPE>::format()[0] ||
+                         (format[0] == 'L' && array_buffer_type<C_TYPE>::format()[0] == 'I'));
+        size_t nbelem = view.shape[0];
+        RCPtr<ARRAY> result(new ARRAY(nbelem));
+        if (nbelem > 0) {
+            C_TYPE * target = data(result.get());
+            if (sametype && packed() && PyBuffer_IsContiguous(&view, 'C'))
+                memcpy(target, view.buf, nbelem * nbcomponents() * sizeof(C_TYPE));
+            else {
+                Py_ssize_t stride0 = view.strides[0];
+                Py_ssize_t stride1 = NBCOMPONENTS == 0 ? 0 : view.strides[1];
+                const char * source = (const char *)view.buf;
+                for (size_t i = 0; i < nbelem; ++i, source += stride0) {
+                    C_TYPE * elem = (C_TYPE *)((char *)target + i * sizeof(element_type));
+                    for (size_t j = 0; j < nbcomponents(); ++j)
+                        read_value(source + j * stride1, format[0], elem[j]);
+                }
+            }
+        }
+        PyBuffer_Release(&view);
+        return result;
+    }
+};
+
+template<class ARRAY, class C_TYPE, int NBCOMPONENTS>
+class array_buffer_func : public boost::python::def_visitor<array_buffer_func<ARRAY,C_TYPE,NBCOMPONENTS> >
+{
+    friend class boost::python::def_visitor_access;
+
+    typedef array_buffer<ARRAY,C_TYPE,NBCOMPONENTS> buffer_type;
+
+    template <class classT>
+    void visit(classT& c) const
+    {
+        PyTypeObject * type = (PyTypeObject *)c.ptr();
+        static PyBufferProcs procs;
+        procs.bf_getbuffer = &buffer_type::getbuffer;
+        procs.bf_releasebuffer = &buffer_type::releasebuffer;
+        type->tp_as_buffer = &procs;
+#if PY_MAJOR_VERSION < 3
+        type->tp_flags |= Py_TPFLAGS_HAVE_NEWBUFFER;
+#endif
+        c.def( "__init__", boost::python::make_constructor( &buffer_type::from_buffer ) )
+         .add_property( "__array_interface__", &buffer_type::array_interface );
+    }
+};
+
+#define DEFINE_BUFFER( ARRAY, C_TYPE, NBCOMPONENTS ) .def( array_buffer_func<ARRAY,C_TYPE,NBCOMPONENTS>() )
+
 #ifdef USE_NUMPY
 #define PY_ARRAY_UNIQUE_SYMBOL PlantGL_NUMPY_API_SYMBOL
 #define NO_IMPORT_ARRAY
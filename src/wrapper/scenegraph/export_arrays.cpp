@@ -249,18 +249,22 @@ IndexArrayPtr py_cut(RealArray * a, RealArrayPtr bins, bool filteremptygroups =
 void export_arrays()
 {
   EXPORT_ARRAY_CT( c3a, Color3Array, "Color3Array([Index3(i,j,k),...])" )
-    DEFINE_NUMPY( c3a );
+    DEFINE_NUMPY( c3a )
+    DEFINE_BUFFER( Color3Array, uchar_t, 3 );
   EXPORT_CONVERTER(Color3Array);
   EXPORT_ARRAY_CT( c4a, Color4Array, "Color4Array([Index4(i,j,k,l),...])" )
-    DEFINE_NUMPY( c4a );
+    DEFINE_NUMPY( c4a )
+    DEFINE_BUFFER( Color4Array, uchar_t, 4 );
   EXPORT_CONVERTER(Color4Array);
 
   EXPORT_ARRAY_CT( i3a, Index3Array, "Index3Array([Index3(i,j,k),...])" )
-    DEFINE_NUMPY( i3a );
+    DEFINE_NUMPY( i3a )
+    DEFINE_BUFFER( Index3Array, uint_t, 3 );
   EXPORT_CONVERTER(Index3Array);
   EXPORT_ARRAY_CT( i4a, Index4Array, "Index4Array([Index4(i,j,k,l),...])" )
     .def( "triangulate", &Index4Array::triangulate)
-    DEFINE_NUMPY( i4a );
+    DEFINE_NUMPY( i4a )
+    DEFINE_BUFFER( Index4Array, uint_t, 4 );
   EXPORT_CONVERTER(Index4Array);
   EXPORT_ARRAY_CT( inda,IndexArray,  "IndexArray([Index([i,j,..]),...])" )
     .def( "triangulate", &IndexArray::triangulate)
@@ -293,12 +297,14 @@ void export_arrays()
     .def("isValid",&ra_is_valid)
     EXPORT_ARRAY_IO_FUNC( RealArray )
 
-    DEFINE_NUMPY( ra );
+    DEFINE_NUMPY( ra )
+    DEFINE_BUFFER( RealArray, real_t, 0 );
   EXPORT_CONVERTER(RealArray);
 
   EXPORT_ARRAY_BT( uia, UIntArray,  "UIntArray([a,b,...])" )
   // EXPORT_ARRAY_IO_FUNC( UIntArray )
-  DEFINE_NUMPY( uia );
+  DEFINE_NUMPY( uia )
+  DEFINE_BUFFER( UIntArray, uint32_t, 0 );
   EXPORT_CONVERTER(UIntArray);
 
  def("histogram",&py_histogram<RealArray>);
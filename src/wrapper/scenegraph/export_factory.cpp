@@ -236,6 +236,21 @@ SceneFormatList sf_formats( SceneFactory * f) {
     return f->formats();
 }
 
+/* A thread holding the python interpreter releases it while waiting for the
+   codecs, which may be locked by a thread reading a file with a python codec. */
+void * sf_lock_wait_begin() {
+#if PY_VERSION_HEX >= 0x03040000
+    if (!Py_IsInitialized() || !PyGILState_Check()) return NULL;
+#else
+    if (!Py_IsInitialized() || !_PyThreadState_Current || _PyThreadState_Current != PyGILState_GetThisThreadState()) return NULL;
+#endif
+    return PyEval_SaveThread();
+}
+
+void sf_lock_wait_end(void * state) {
+    if (state) PyEval_RestoreThread((PyThreadState *)state);
+}
+
 void export_SceneFactory()
 {
 
@@ -254,6 +269,8 @@ void export_SceneFactory()
       .def("write", (bool(SceneFactory::*)(const std::string&,const ScenePtr&,const std::string&))&SceneFactory::write)
   ;
 
+  SceneFactory::setLockWaitFunctions(&sf_lock_wait_begin, &sf_lock_wait_end);
+
 }
 
 
@@ -0,0 +1,89 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR Cirad/Inria/Inra Dap - Virtual Plant Team
+ *
+ *       File author(s): F. Boudon
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/base/meshsimplifier.h>
+#include <plantgl/python/exception.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+
+using namespace boost::python;
+#define bp boost::python
+
+/* ----------------------------------------------------------------------- */
+
+/// Returns the TriangleSet of \e obj. None, which is not converted to a null pointer, gives a ValueError.
+TriangleSetPtr extract_mesh(bp::object obj)
+{
+    if (obj.ptr() == Py_None) throw PythonExc_ValueError("Cannot simplify a null mesh.");
+    return extract<TriangleSetPtr>(obj)();
+}
+
+TriangleSetPtr ms_simplify(MeshSimplifier& simplifier, bp::object mesh)
+{ return simplifier.simplify(*extract_mesh(mesh)); }
+
+TriangleSetPtr simplify_mesh(bp::object mesh, uint_t targetNbFaces, real_t maxError, bool preserveBoundary)
+{
+    MeshSimplifier simplifier(targetNbFaces, maxError);
+    simplifier.setBoundaryPreserved(preserveBoundary);
+    return simplifier.simplify(*extract_mesh(mesh));
+}
+
+/* ----------------------------------------------------------------------- */
+
+void export_MeshSimplifier()
+{
+  class_< MeshSimplifier, boost::noncopyable >
+    ("MeshSimplifier", "Decimate a TriangleSet by edge collapses ordered by a quadric error metric.",
+     init<optional<uint_t,real_t> >("MeshSimplifier([targetNbFaces, maxError])",
+                                     (bp::arg("targetNbFaces") = 0,
+                                      bp::arg("maxError") = REAL_MAX)))
+    .def("simplify", &ms_simplify, bp::arg("mesh"), "simplify(mesh) : return a simplified copy of a TriangleSet.")
+    .add_property("targetNbFaces", &MeshSimplifier::getTargetNbFaces, &MeshSimplifier::setTargetNbFaces)
+    .add_property("maxError", &MeshSimplifier::getMaxError, &MeshSimplifier::setMaxError)
+    .add_property("preserveBoundary", &MeshSimplifier::isBoundaryPreserved, &MeshSimplifier::setBoundaryPreserved)
+    .add_property("boundaryWeight", &MeshSimplifier::getBoundaryWeight, &MeshSimplifier::setBoundaryWeight)
+    .add_property("nbRemovedPoints", &MeshSimplifier::getNbRemovedPoints)
+    .add_property("nbRemovedFaces", &MeshSimplifier::getNbRemovedFaces)
+    .add_property("error", &MeshSimplifier::getError)
+    ;
+
+  def("simplify_mesh", &simplify_mesh,
+      (bp::arg("mesh"), bp::arg("targetNbFaces") = 0, bp::arg("maxError") = REAL_MAX,
+       bp::arg("preserveBoundary") = false),
+      "simplify_mesh(mesh [, targetNbFaces, maxError, preserveBoundary]) : return a copy of the TriangleSet mesh "
+      "decimated down to targetNbFaces triangles or until the error of the collapses exceeds maxError.");
+}
+
+/* ----------------------------------------------------------------------- */
@@ -331,7 +331,8 @@ void export_pointarrays()
     .def( "swapCoordinates", &pa_swap_2D_coordinates,"Swap the two coordinates of the points. This is done INPLACE.")
     .def( "isValid", &Point2Array::isValid)
     .def( "filterCoordinates", &py_filter_coord<Point2Array>,"Filter array by looking at coordinate i.",args("i","coordmin","coordmax"))
-    DEFINE_NUMPY( p2a );
+    DEFINE_NUMPY( p2a )
+    DEFINE_BUFFER( Point2Array, real_t, 2 );
   EXPORT_CONVERTER(Point2Array);
 
   EXPORT_ARRAY_CT( p3a, Point3Array, "Point3Array([Vector3(x,y,z),...])")
@@ -367,7 +368,8 @@ void export_pointarrays()
     .def( "swapCoordinates", &pa_swap_coordinates<Point3Array>,"Swap the coordinate i with coordinate j of the points. This is done INPLACE.",args("i","j"))
     .def( "isValid", &Point3Array::isValid)
     .def( "filterCoordinates", &py_filter_coord<Point3Array>,"Filter array by looking at coordinate i.",args("i","coordmin","coordmax"))
-   DEFINE_NUMPY( p3a );
+   DEFINE_NUMPY( p3a )
+   DEFINE_BUFFER( Point3Array, real_t, 3 );
   EXPORT_CONVERTER(Point3Array);
 
   EXPORT_ARRAY_CT( p4a, Point4Array, "Point4Array([Vector4(x,y,z,w),...])")
@@ -407,7 +409,8 @@ void export_pointarrays()
     .def( "swapCoordinates", &pa_swap_coordinates<Point4Array>,"Swap the coordinate i with coordinate j of the points. This is done INPLACE.",args("i","j"))
     .def( "isValid", &Point4Array::isValid)
     .def( "filterCoordinates", &py_filter_coord<Point4Array>,"Filter array by looking at coordinate i.",args("i","coordmin","coordmax"))
-    DEFINE_NUMPY( p4a );
+    DEFINE_NUMPY( p4a )
+    DEFINE_BUFFER( Point4Array, real_t, 4 );
   EXPORT_CONVERTER(Point4Array);
 
 
@@ -31,6 +31,7 @@
 
 #include <plantgl/scenegraph/scene/scene.h>
 #include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/scenegraph/scene/inline.h>
 #include <plantgl/scenegraph/geometry/geometry.h>
 #include <plantgl/scenegraph/appearance/appearance.h>
 #include <plantgl/scenegraph/core/action.h>
@@ -50,6 +51,7 @@ PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
 using namespace boost::python;
 using namespace std;
+#define bp boost::python
 
 DEF_POINTEE(Scene)
 
@@ -269,4 +271,64 @@ void export_Scene()
     sc.staticmethod("pool") ;
 }
 
+/* ----------------------------------------------------------------------- */
 
+class InlineSceneCacheWrapper {};
+
+void export_InlineSceneCache()
+{
+  class_<InlineSceneCacheWrapper>("InlineSceneCache",
+      "The process wide cache of the scenes of the inlines, keyed by the absolute path of their file and its modification time.",
+      no_init)
+    .def("get", &InlineSceneCache::get, args("filename"),
+         "get(filename) : return the scene of filename, reading it if it is not in the cache or if the file was modified.")
+    .staticmethod("get")
+    .def("prefetch", &InlineSceneCache::prefetch, args("filename"),
+         "prefetch(filename) : start to read filename in a background thread.")
+    .staticmethod("prefetch")
+    .def("wait", &InlineSceneCache::wait, "wait() : wait for all the pending prefetches.")
+    .staticmethod("wait")
+    .def("setEnabled", &InlineSceneCache::setEnabled, args("enabled"))
+    .staticmethod("setEnabled")
+    .def("isEnabled", &InlineSceneCache::isEnabled)
+    .staticmethod("isEnabled")
+    .def("size", &InlineSceneCache::size, "size() : return the number of scenes in the cache.")
+    .staticmethod("size")
+    .def("purge", &InlineSceneCache::purge,
+         "purge() : remove the scenes used only by the cache and return their number.")
+    .staticmethod("purge")
+    .def("clear", &InlineSceneCache::clear, "clear() : remove all the scenes from the cache.")
+    .staticmethod("clear")
+    ;
+}
+
+/* ----------------------------------------------------------------------- */
+
+DEF_POINTEE(Inline)
+
+/// The file is read with the GIL released.
+ScenePtr inl_getScene(Inline * inl)
+{
+  PythonInterpreterReleaser nogil;
+  return inl->getScene();
+}
+
+void export_Inline()
+{
+  class_< Inline, InlinePtr, bases< Shape3D >, boost::noncopyable >("Inline",
+      "A scene read from a file, positioned by a translation and a scale. "
+      "The file is read on the first access to the scene.",
+      init< const string&, optional<const Vector3&, const Vector3&> >
+         ("Inline(filename, translation, scale)",
+          (bp::arg("filename"),
+           bp::arg("translation") = Inline::DEFAULT_TRANSLATION,
+           bp::arg("scale") = Inline::DEFAULT_SCALE)))
+    .DEF_PGLBASE(Inline)
+    .add_property("filename", make_function(&Inline::getFileName, return_value_policy<copy_const_reference>()))
+    .add_property("scene", &inl_getScene)
+    .def("isLoaded", &Inline::isLoaded, "isLoaded() : return whether the scene has already been read.")
+    .def("prefetch", &Inline::prefetch, "prefetch() : start to read the scene in a background thread.")
+    ;
+
+  implicitly_convertible<InlinePtr, Shape3DPtr >();
+}
@@ -89,8 +89,10 @@ void export_Cone();
 void export_Revolution();
 void export_SceneObject();
 void export_Scene();
+void export_InlineSceneCache();
 void export_Shape3D();
 void export_Shape();
+void export_Inline();
 void export_Swung();
 void export_Font();
 void export_Text();
@@ -113,6 +115,7 @@ void export_AxisRotated();
 void export_Oriented();
 void export_Tapered();
 void export_TriangleSet();
+void export_MeshSimplifier();
 void export_QuadSet();
 void export_FaceSet();
 void export_AmapSymbol();
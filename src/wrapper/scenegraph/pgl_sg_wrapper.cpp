@@ -117,8 +117,10 @@ void module_sg()
     export_Primitive();
 
 	export_Scene();
+	export_InlineSceneCache();
     export_Shape3D();
     export_Shape();
+    export_Inline();
 
 	export_ExplicitModel();
     export_LineicModel();
@@ -169,6 +171,7 @@ void module_sg()
     export_Text();
 
     export_TriangleSet();
+    export_MeshSimplifier();
     export_QuadSet();
     export_FaceSet();
     export_AmapSymbol();
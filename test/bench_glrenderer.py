@@ -0,0 +1,70 @@
+""" Measure the time of a frame drawn by GLRenderer with display lists,
+    with buffer objects and with instanced buffer objects, in a headless context.
+
+    usage: python bench_glrenderer.py [number of leaves]
+"""
+from openalea.plantgl.all import *
+from glcontext import headless_gl, init_view, read_image, GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT
+from math import pi, cos, sin
+import random, sys, time
+
+SIZE = 512
+
+
+def make_plant(nbleaves):
+    """ A plant made of nbleaves shared leaf meshes, a shared fruit every 10 leaves and a trunk. """
+    L = 10
+    points = [(0.08*v*sin(pi*u), 0.02*u*u+0.01*v*v, 0.15*u) for u in [i/float(L) for i in range(L+1)] for v in (-0.5, 0, 0.5)]
+    indices = []
+    for i in range(L):
+        for j in range(2):
+            a = 3*i+j
+            indices += [(a, a+1, a+4), (a, a+4, a+3)]
+    leaf = TriangleSet(points, indices)
+    fruit = Sphere(0.02, 12, 8)
+    materials = [Material((20+30*k, 120+30*k, 20), 1.5, specular=(60,60,60), shininess=0.4) for k in range(4)]
+    random.seed(1)
+    scene = Scene()
+    for k in range(nbleaves):
+        a, h, r = 2*pi*random.random(), -0.8+1.6*random.random(), 0.9*random.random()
+        g = AxisRotated((0,0,1), a, AxisRotated((1,0,0), 0.5+random.random(), leaf))
+        g = Scaled([0.7+0.6*random.random()]*3, g)
+        scene.add(Shape(Translated((r*cos(a), h, r*sin(a)), g), materials[k % 4]))
+        if k % 10 == 0:
+            scene.add(Shape(Translated((r*cos(a), h-0.05, r*sin(a)), fruit), Material((200,20,20))))
+    scene.add(Shape(AxisRotated((1,0,0), -pi/2, Cylinder(0.05, 1.8, True, 16)), Material((90,60,30))))
+    return scene
+
+
+def bench(gl, scene, mode, instancing = False, nbframes = 20):
+    """ Return the mean time of a frame and the last image. The first frame, which fills the caches, is not timed. """
+    init_view(gl, SIZE, SIZE)
+    discretizer = Discretizer()
+    renderer = GLRenderer(discretizer)
+    renderer.renderingMode = mode
+    renderer.instancing = instancing
+    for i in range(nbframes+1):
+        if i == 1:
+            gl.glFinish()
+            start = time.time()
+        gl.glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)
+        scene.apply(renderer)
+    gl.glFinish()
+    duration = (time.time() - start) / nbframes
+    return duration, read_image(gl, SIZE, SIZE)
+
+
+if __name__ == '__main__':
+    nbleaves = int(sys.argv[1]) if len(sys.argv) > 1 else 5000
+    gl = headless_gl(SIZE, SIZE)
+    if gl is None: sys.exit('No headless OpenGL context can be created.')
+    scene = make_plant(nbleaves)
+    print('%i shapes, %ix%i' % (len(scene), SIZE, SIZE))
+    reference = None
+    for name, mode, instancing in [('display list', GLRenderer.Normal, False),
+                                   ('buffer object', GLRenderer.BufferObject, False),
+                                   ('instanced', GLRenderer.BufferObject, True)]:
+        duration, image = bench(gl, scene, mode, instancing)
+        if reference is None: reference = image
+        different = sum(1 for a, b in zip(reference, image) if abs(a - b) > 1)
+        print('%-14s %8.1f ms per frame, %i components differ from display lists' % (name, 1000*duration, different))
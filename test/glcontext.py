@@ -0,0 +1,113 @@
+""" Headless OpenGL contexts, with EGL or OSMesa, to test and measure the rendering without a window. """
+import ctypes, ctypes.util
+import os
+
+W, H = 128, 128
+
+GL_UNSIGNED_BYTE = 0x1401
+GL_RGBA = 0x1908
+GL_DEPTH_TEST = 0x0B71
+GL_LIGHTING = 0x0B50
+GL_LIGHT0 = 0x4000
+GL_NORMALIZE = 0x0BA1
+GL_BLEND = 0x0BE2
+GL_SRC_ALPHA = 0x0302
+GL_ONE_MINUS_SRC_ALPHA = 0x0303
+GL_PROJECTION = 0x1701
+GL_MODELVIEW = 0x1700
+GL_COLOR_BUFFER_BIT = 0x4000
+GL_DEPTH_BUFFER_BIT = 0x0100
+
+
+def load_library(name):
+    path = ctypes.util.find_library(name)
+    if path is None: return None
+    try:
+        return ctypes.CDLL(path)
+    except OSError:
+        return None
+
+
+def egl_context(width, height):
+    """ Make current an OpenGL context on a pbuffer with EGL. """
+    if 'DISPLAY' not in os.environ and 'WAYLAND_DISPLAY' not in os.environ:
+        os.environ.setdefault('EGL_PLATFORM', 'surfaceless')
+    egl = load_library('EGL')
+    if egl is None: return None
+    EGL_NONE, EGL_SURFACE_TYPE, EGL_PBUFFER_BIT = 0x3038, 0x3033, 0x0001
+    EGL_RED_SIZE, EGL_GREEN_SIZE, EGL_BLUE_SIZE, EGL_DEPTH_SIZE = 0x3024, 0x3023, 0x3022, 0x3025
+    EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_OPENGL_API = 0x3040, 0x0008, 0x30A2
+    EGL_WIDTH, EGL_HEIGHT = 0x3057, 0x3056
+    for f in ['eglGetDisplay', 'eglCreatePbufferSurface', 'eglCreateContext']:
+        getattr(egl, f).restype = ctypes.c_void_p
+    egl.eglGetDisplay.argtypes = [ctypes.c_void_p]
+    egl.eglInitialize.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    egl.eglChooseConfig.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+    egl.eglCreatePbufferSurface.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    egl.eglCreateContext.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    egl.eglMakeCurrent.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
+    display = egl.eglGetDisplay(None)
+    if not display or not egl.eglInitialize(display, None, None): return None
+    attribs = (ctypes.c_int * 13)(EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8,
+                                  EGL_BLUE_SIZE, 8, EGL_DEPTH_SIZE, 24, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE)
+    config, nbconfig = ctypes.c_void_p(), ctypes.c_int()
+    if not egl.eglChooseConfig(display, attribs, ctypes.byref(config), 1, ctypes.byref(nbconfig)) or nbconfig.value == 0:
+        return None
+    surface = egl.eglCreatePbufferSurface(display, config, (ctypes.c_int * 5)(EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE))
+    if not surface or not egl.eglBindAPI(EGL_OPENGL_API): return None
+    context = egl.eglCreateContext(display, config, None, None)
+    if not context or not egl.eglMakeCurrent(display, surface, surface, context): return None
+    return (egl, display, surface, context)
+
+
+def osmesa_context(width, height):
+    """ Make current an OpenGL context rendering in memory with OSMesa. """
+    osmesa = load_library('OSMesa')
+    if osmesa is None: return None
+    osmesa.OSMesaCreateContextExt.restype = ctypes.c_void_p
+    osmesa.OSMesaCreateContextExt.argtypes = [ctypes.c_uint, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_void_p]
+    osmesa.OSMesaMakeCurrent.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_uint, ctypes.c_int, ctypes.c_int]
+    context = osmesa.OSMesaCreateContextExt(GL_RGBA, 24, 0, 0, None)
+    if not context: return None
+    buffer = (ctypes.c_ubyte * (width * height * 4))()
+    if not osmesa.OSMesaMakeCurrent(context, buffer, GL_UNSIGNED_BYTE, width, height): return None
+    return (osmesa, context, buffer)
+
+
+def headless_gl(width = W, height = H):
+    """ Return the GL library with a headless context of width x height made current, or None if none can be created. """
+    gl = load_library('GL')
+    if gl is None: return None
+    context = egl_context(width, height) or osmesa_context(width, height)
+    if context is None: return None
+    gl.glClearColor.argtypes = [ctypes.c_float] * 4
+    gl.glOrtho.argtypes = [ctypes.c_double] * 6
+    gl.glRotated.argtypes = [ctypes.c_double] * 4
+    gl.context = context
+    return gl
+
+
+def init_view(gl, width = W, height = H):
+    """ Set the viewport, the camera and the lighting. """
+    gl.glViewport(0, 0, width, height)
+    gl.glClearColor(1, 1, 1, 1)
+    gl.glEnable(GL_DEPTH_TEST)
+    gl.glMatrixMode(GL_PROJECTION)
+    gl.glLoadIdentity()
+    gl.glOrtho(-1.5, 1.5, -1.5, 1.5, -5, 5)
+    gl.glMatrixMode(GL_MODELVIEW)
+    gl.glLoadIdentity()
+    gl.glRotated(-30, 1, 0, 0)
+    gl.glEnable(GL_LIGHTING)
+    gl.glEnable(GL_LIGHT0)
+    gl.glEnable(GL_NORMALIZE)
+    gl.glEnable(GL_BLEND)
+    gl.glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+
+
+def read_image(gl, width = W, height = H):
+    """ Return the RGBA components of the rendered image. """
+    gl.glFinish()
+    pixels = (ctypes.c_ubyte * (width * height * 4))()
+    gl.glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels)
+    return bytearray(pixels)
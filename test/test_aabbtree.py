@@ -0,0 +1,55 @@
+from openalea.plantgl.all import *
+from random import uniform, seed
+
+pointrange = (0,10)
+
+def random_box():
+    lower = Vector3(uniform(*pointrange),uniform(*pointrange),uniform(*pointrange))
+    return lower, lower + Vector3(uniform(0,2),uniform(0,2),uniform(0,2))
+
+def random_plane():
+    """ A plane through a random point of the range, which keeps the center of the range """
+    normal = Vector3(uniform(-1,1),uniform(-1,1),uniform(-1,1))
+    point = Vector3(uniform(*pointrange),uniform(*pointrange),uniform(*pointrange))
+    center = Vector3(5,5,5)
+    if dot(normal,center-point) < 0: normal = -normal
+    return Vector4(normal.x,normal.y,normal.z,-dot(normal,point))
+
+def box_outside(lower, upper, plane):
+    """ Whether the box is entirely on the negative side of the plane, from its corner the furthest along the normal """
+    corner = [upper[i] if plane[i] >= 0 else lower[i] for i in range(3)]
+    return plane[0]*corner[0]+plane[1]*corner[1]+plane[2]*corner[2]+plane[3] < 0
+
+def brute_planes_query(boxes, planes):
+    return [i for i, (lower, upper) in enumerate(boxes) if not any(box_outside(lower, upper, p) for p in planes)]
+
+def brute_box_query(boxes, qlower, qupper):
+    return [i for i, (lower, upper) in enumerate(boxes)
+            if all(lower[k] <= qupper[k] and qlower[k] <= upper[k] for k in range(3))]
+
+def test_aabbtree_planes_query():
+    """ The items kept by planes are the ones found by brute force """
+    seed(0)
+    boxes = [random_box() for i in range(2000)]
+    for leafSize in [1, 4, 16]:
+        tree = AABBTree([l for l, u in boxes], [u for l, u in boxes], leafSize)
+        assert len(tree) == len(boxes)
+        assert tree.planesQuery([]) == list(range(len(boxes)))
+        for nbplanes in [1, 2, 6, 12]:
+            for i in range(10):
+                planes = [random_plane() for j in range(nbplanes)]
+                assert tree.planesQuery(planes) == brute_planes_query(boxes, planes)
+
+def test_aabbtree_box_query():
+    """ The items overlapping a box are the ones found by brute force """
+    seed(1)
+    boxes = [random_box() for i in range(2000)]
+    tree = AABBTree([l for l, u in boxes], [u for l, u in boxes])
+    for i in range(20):
+        qlower, qupper = random_box()
+        assert sorted(tree.boxQuery(qlower, qupper)) == brute_box_query(boxes, qlower, qupper)
+
+
+if __name__ == '__main__':
+    test_aabbtree_planes_query()
+    test_aabbtree_box_query()
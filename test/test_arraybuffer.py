@@ -0,0 +1,73 @@
+from openalea.plantgl.all import *
+
+try:
+    import numpy as np
+except ImportError:
+    np = None
+
+
+def test_point3array_view():
+    """ Test that a numpy view of a Point3Array shares its storage """
+    if np is None: return
+    pts = Point3Array([Vector3(1,2,3),Vector3(4,5,6)])
+    view = np.asarray(pts)
+    assert view.shape == (2,3)
+    assert (view == [[1,2,3],[4,5,6]]).all()
+    view[1,2] = 60
+    assert pts[1] == Vector3(4,5,60)
+    assert memoryview(pts).shape == (2,3)
+
+
+def test_arrays_from_numpy():
+    """ Test the construction of arrays from numpy arrays """
+    if np is None: return
+    values = np.random.rand(100,3)
+    assert (np.asarray(Point3Array(values)) == values).all()
+    assert (np.asarray(Point3Array(np.asfortranarray(values))) == values).all()
+    assert (np.asarray(RealArray(values[:,0])) == values[:,0]).all()
+    colors = np.array([[1,2,3],[4,5,6]],dtype=np.uint8)
+    assert (np.asarray(Color3Array(colors)) == colors).all()
+    indices = np.array([[0,1,2],[2,3,0]])
+    i3 = Index3Array(indices)
+    assert i3[1] == Index3(2,3,0)
+    assert np.asarray(i3).dtype == np.uint32
+
+
+def test_array_interface():
+    """ Test the __array_interface__ of the arrays """
+    if np is None: return
+    ra = RealArray([1,2,3])
+    interface = ra.__array_interface__
+    assert interface['shape'] == (3,)
+    assert interface['data'][0] == np.asarray(ra).__array_interface__['data'][0]
+
+
+def test_resize_exported_array():
+    """ Test that an array cannot be resized while its storage is exported """
+    pts = Point3Array([Vector3(1,2,3),Vector3(4,5,6)])
+    view = memoryview(pts)
+    for resize in [lambda : pts.append(Vector3(7,8,9)), lambda : pts.insert(0,Vector3(7,8,9)),
+                   lambda : pts.prepend(Vector3(7,8,9)), lambda : pts.pop(), lambda : pts.clear(),
+                   lambda : pts.__delitem__(0)]:
+        try:
+            resize()
+            assert False, 'The exported array has been resized'
+        except BufferError:
+            pass
+    assert len(pts) == 2
+    pts[0] = Vector3(0,0,0)
+    assert view[0,0] == 0
+    view.release()
+    pts.append(Vector3(7,8,9))
+    assert len(pts) == 3
+    if np is None: return
+    ra = RealArray([1,2,3])
+    values = np.asarray(ra)
+    try:
+        ra.append(4)
+        assert False, 'The exported array has been resized'
+    except BufferError:
+        pass
+    del values
+    ra.append(4)
+    assert len(ra) == 4
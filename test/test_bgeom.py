@@ -0,0 +1,86 @@
+from openalea.plantgl.all import *
+import os, tempfile
+
+
+def grid_scene(n = 4, radius = 0.25):
+    scene = Scene()
+    for i in range(n):
+        for j in range(n):
+            for k in range(n):
+                scene.add(Shape(Translated((i,j,k), Sphere(radius)), Material((10*i,10*j,10*k)), 1 + i + n*(j + n*k)))
+    return scene
+
+
+def tmpfile(name):
+    return os.path.join(tempfile.mkdtemp(), name)
+
+
+def ids(scene):
+    return sorted(sh.id for sh in scene)
+
+
+def check_shapes(result, scene):
+    shapes = dict((sh.id, sh) for sh in scene)
+    for sh in result:
+        assert norm(sh.geometry.translation - shapes[sh.id].geometry.translation) < 1e-5
+        assert sh.appearance.ambient == shapes[sh.id].appearance.ambient
+
+
+def test_indexed_box_query(compression = NoCompression):
+    """ The shapes read from an indexed file in a box are the ones found by brute force """
+    scene = grid_scene()
+    fname = tmpfile('grid.bgeom')
+    assert PglBinaryPrinter.printIndexed(scene, fname, compression, 512)
+    assert PglBinaryParser.isIndexedFile(fname)
+    for lower, upper in [((-0.5,-0.5,-0.5),(0.5,0.5,0.5)), ((0.5,-1,1.5),(2.5,1.5,10)), ((5,5,5),(6,6,6))]:
+        lower, upper = Vector3(*lower), Vector3(*upper)
+        expected = [sh.id for sh in scene
+                    if all(sh.geometry.translation[d] - 0.25 <= upper[d] and sh.geometry.translation[d] + 0.25 >= lower[d] for d in range(3))]
+        result = PglBinaryParser.parseShapesInBox(fname, lower, upper)
+        assert result is not None and ids(result) == sorted(expected)
+        check_shapes(result, scene)
+    assert len(Scene(fname)) == len(scene)
+
+
+def test_indexed_id_query(compression = NoCompression):
+    """ The shapes read from an indexed file by id are the requested ones """
+    scene = grid_scene()
+    fname = tmpfile('grid.bgeom')
+    assert PglBinaryPrinter.printIndexed(scene, fname, compression, 512)
+    result = PglBinaryParser.parseShapesWithIds(fname, [64, 3, 17, 1000])
+    assert result is not None and ids(result) == [3, 17, 64]
+    check_shapes(result, scene)
+
+
+def test_indexed_compression():
+    """ The compressed chunks are read back """
+    for compression in [LZ4Compression, ZstdCompression]:
+        if not isBinaryCompressionSupported(compression): continue
+        test_indexed_box_query(compression)
+        test_indexed_id_query(compression)
+
+
+def test_read_default_format():
+    """ The BGEOM files are saved in the format of the previous versions unless the indexed one is requested """
+    scene = grid_scene(2)
+    assert not PglBinaryPrinter.isIndexedByDefault()
+    fname = tmpfile('default.bgeom')
+    scene.save(fname)
+    assert not PglBinaryParser.isIndexedFile(fname)
+    assert PglBinaryParser.parseShapesWithIds(fname, [1]) is None
+    assert ids(Scene(fname)) == ids(scene)
+    PglBinaryPrinter.setIndexedByDefault(True)
+    try:
+        fname = tmpfile('indexed.bgeom')
+        scene.save(fname)
+        assert PglBinaryParser.isIndexedFile(fname)
+        assert ids(Scene(fname)) == ids(scene)
+    finally:
+        PglBinaryPrinter.setIndexedByDefault(False)
+
+
+if __name__ == '__main__':
+    test_indexed_box_query()
+    test_indexed_id_query()
+    test_indexed_compression()
+    test_read_default_format()
@@ -1,5 +1,4 @@
 from openalea.plantgl.all import *
-from openalea.plantgl.codec import obj
 
 def get_filename(fname):
     import os
@@ -56,3 +55,99 @@ def test_write_obj():
     s.clear()
     s.read(get_filename('test_trumpet.obj'))
     assert s.isValid()
+
+def test_ply():
+    s = Scene()
+    s.read(get_filename('icosahedron.obj'))
+    s.save(get_filename('test_icosahedron.ply'))
+    s2 = Scene()
+    s2.read(get_filename('test_icosahedron.ply'))
+    assert len(s2) == 1, len(s2)
+    assert s2.isValid()
+    assert len(s2[0].geometry.pointList) == len(s[0].geometry.pointList)
+
+def test_obj_material():
+    s = Scene()
+    s.read(get_filename('icosahedron.obj'))
+    s[0].appearance = Material('red', Color3(255,0,0), 1)
+    s.save(get_filename('test_icosahedron_mat.obj'))
+    s2 = Scene()
+    s2.read(get_filename('test_icosahedron_mat.obj'))
+    assert s2[0].appearance.name == 'red'
+    assert s2[0].appearance.ambient == Color3(255,0,0)
+
+def test_geom_large_arrays():
+    points = [(i * 0.5, -i, i * 1e-3) for i in range(2000)]
+    indices = [(i, i + 1, i + 2) for i in range(1998)]
+    fname = get_filename('test_large_arrays.geom')
+    with open(fname, 'w') as stream:
+        stream.write('# large arrays are parsed in bulk [ <1,2,3> ]\n')
+        stream.write('T = TriangleSet {\n  PointList [\n')
+        stream.write(',\n'.join('<%s, %s, %s>' % p for p in points))
+        stream.write(' ]\n  IndexList [ ')
+        stream.write(', '.join('[%i, %i, %i]' % i for i in indices))
+        stream.write(' ]\n}\n')
+        stream.write('P = PointSet { PointList [ ')
+        stream.write(', '.join('<%s, %s, 1+%s>' % p for p in points))
+        stream.write(' ] }\n')
+    s = Scene(fname)
+    assert len(s) == 2, len(s)
+    assert s.isValid()
+    geometries = dict((sh.geometry.name, sh.geometry) for sh in s)
+    tr = geometries['T']
+    assert len(tr.pointList) == len(points)
+    assert tr.pointList[1999] == Vector3(*points[1999])
+    assert tr.indexList[1997] == Index3(*indices[1997])
+    assert geometries['P'].pointList[10] == Vector3(5, -10, 1 + 0.01)
+
+def test_gltf():
+    import json, struct
+    s = Scene()
+    sphere = Sphere(1, 16, 16)
+    red = Material('red', Color3(255,0,0), 1)
+    s += Shape(Translated(Vector3(10, 0, 0), sphere), red)
+    s += Shape(Translated(Vector3(-10, 0, 0), sphere), red)
+    s.save(get_filename('test_instances.glb'))
+    data = open(get_filename('test_instances.glb'), 'rb').read()
+    magic, version, length = struct.unpack('<III', data[:12])
+    assert magic == 0x46546C67 and version == 2 and length == len(data)
+    jsonlength = struct.unpack('<I', data[12:16])[0]
+    description = json.loads(data[20:20 + jsonlength].decode('utf-8'))
+    assert len(description['meshes']) == 1, len(description['meshes'])
+    assert len(description['nodes']) == 3, len(description['nodes'])
+    assert 'KHR_mesh_quantization' in description['extensionsRequired']
+
+def test_tpc():
+    points = Point3Array([Vector3(i % 50, (i // 50) % 50, i // 2500) for i in range(5000)])
+    colors = Color4Array([Color4(i % 256, 0, 0, 0) for i in range(5000)])
+    s = Scene()
+    s += Shape(PointSet(points, colors))
+    s.save(get_filename('test_cloud.tpc'))
+    s2 = Scene()
+    s2.read(get_filename('test_cloud.tpc'))
+    assert len(s2) == 1, len(s2)
+    cloud = s2[0].geometry
+    assert len(cloud.pointList) == len(points)
+    assert len(cloud.colorList) == len(colors)
+    read = sorted((round(p.x), round(p.y), round(p.z), c.red) for p, c in zip(cloud.pointList, cloud.colorList))
+    expected = sorted((p.x, p.y, p.z, c.red) for p, c in zip(points, colors))
+    assert read == expected
+
+def test_tpc_box():
+    """ The points of a tpc file read in a box are the ones found by brute force """
+    points = Point3Array([Vector3(i % 50, (i // 50) % 50, i // 2500) for i in range(5000)])
+    colors = Color4Array([Color4(i % 256, 0, 0, 0) for i in range(5000)])
+    s = Scene()
+    s += Shape(PointSet(points, colors))
+    s.save(get_filename('test_cloud_box.tpc'))
+    reader = TiledPointCloudReader(get_filename('test_cloud_box.tpc'))
+    assert reader.isValid() and len(reader) == len(points)
+    for lower, upper in [((-0.5,-0.5,-0.5),(10.5,20.5,0.5)), ((12.5,30.5,-1),(40.5,49.5,5)), ((60,60,60),(70,70,70))]:
+        lower, upper = Vector3(*lower), Vector3(*upper)
+        rpoints, rcolors = reader.read(lower, upper)
+        read = sorted((round(p.x), round(p.y), round(p.z), c.red) for p, c in zip(rpoints, rcolors))
+        expected = sorted((p.x, p.y, p.z, c.red) for p, c in zip(points, colors)
+                          if all(lower[d] <= p[d] <= upper[d] for d in range(3)))
+        assert read == expected
+    rpoints, rcolors = reader.read()
+    assert len(rpoints) == len(points) and len(rcolors) == len(colors)
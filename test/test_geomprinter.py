@@ -63,6 +63,52 @@ def test_parser_already_declared_error():
             sc, dic = pgl.pgl_read(txt)
             pgl.pglParserVerbose(b)
                     
+def stream_shapes(printer, shapes):
+    assert printer.begin()
+    for sh in shapes:
+        assert printer.add(sh)
+    assert printer.end()
+    assert not printer.end()
+
+def test_stream_printer():
+    import os, tempfile
+    geom = pgl.Sphere(2)
+    shapes = [pgl.Shape(geom if i % 2 else pgl.Sphere(i+1), pgl.Material(pgl.Color3(i,0,0)), i+1) for i in range(20)]
+    fname = os.path.join(tempfile.mkdtemp(), 'stream.bgeom')
+    printer = pgl.PglBinaryPrinter(fname)
+    assert not printer.add(shapes[0])
+    stream_shapes(printer, shapes)
+    del printer
+    sc = pgl.Scene(fname)
+    assert len(sc) == len(shapes)
+    for sh, rsh in zip(shapes, sc):
+        assert rsh.id == sh.id
+        assert rsh.geometry.radius == sh.geometry.radius
+        assert rsh.appearance.ambient == sh.appearance.ambient
+    # shared geometries are written once.
+    assert sc[1].geometry.getPglId() == sc[3].geometry.getPglId()
+    os.remove(fname)
+    if 'PGL_ASCII_PARSER' in pgl.get_pgl_supported_extensions():
+        fname = os.path.join(os.path.dirname(fname), 'stream.geom')
+        printer = pgl.PglFilePrinter(fname)
+        stream_shapes(printer, shapes)
+        del printer
+        sc = pgl.Scene(fname)
+        assert len(sc) == len(shapes)
+        assert [sh.geometry.radius for sh in sc] == [sh.geometry.radius for sh in shapes]
+        os.remove(fname)
+
+def test_empty_stream_printer():
+    import os, tempfile
+    fname = os.path.join(tempfile.mkdtemp(), 'empty.bgeom')
+    printer = pgl.PglBinaryPrinter(fname)
+    assert not printer.end()
+    stream_shapes(printer, [])
+    del printer
+    sc = pgl.Scene(fname)
+    assert len(sc) == 0
+    os.remove(fname)
+
 if __name__ == '__main__':
     import traceback as tb
     test_func = [ (n,v) for n,v in globals().items() if 'test' in n]
@@ -0,0 +1,65 @@
+from openalea.plantgl.all import *
+from unittest import SkipTest
+from glcontext import headless_gl, init_view, read_image, GL_COLOR_BUFFER_BIT, GL_DEPTH_BUFFER_BIT
+
+
+def make_scene():
+    """ A scene with the meshes and primitives drawn from buffer objects """
+    colored = TriangleSet([(0,0,0),(1,0,0),(0,1,0),(1,1,0.5)], [(0,1,2),(1,3,2)],
+                          colorList=[(255,0,0,0),(0,255,0,0),(0,0,255,0),(255,255,0,0)], colorPerVertex=True)
+    return Scene([Shape(Sphere(0.5, 16, 16), Material((200,50,50))),
+                  Shape(Translated((0.8,0,0), Box(0.3,0.3,0.3)), Material((50,200,50))),
+                  Shape(Translated((-1,-1,0), Cylinder(0.3, 1, True, 12)), Material((50,50,200))),
+                  Shape(Translated((-0.5,0.2,0.5), colored))])
+
+
+def render(gl, scene, mode, instancing = False):
+    """ Render scene twice in mode, the second time from the compiled display lists or buffers. """
+    init_view(gl)
+    discretizer = Discretizer()
+    renderer = GLRenderer(discretizer)
+    renderer.renderingMode = mode
+    renderer.instancing = instancing
+    for i in range(2):
+        gl.glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT)
+        scene.apply(renderer)
+    if mode == GLRenderer.BufferObject:
+        assert renderer.getBufferObjectCount() > 0, 'No buffer object was used'
+    return read_image(gl)
+
+
+def buffer_object_gl():
+    """ Return the GL library with a headless context supporting the buffer objects or skip the test. """
+    gl = headless_gl()
+    if gl is None: raise SkipTest('No headless OpenGL context can be created')
+    if not GLRenderer.isBufferObjectSupported(): raise SkipTest('The OpenGL context does not support the buffer objects')
+    return gl
+
+
+def assert_same_image(reference, image):
+    assert reference.count(255) < len(reference) * 0.9, 'Nothing was drawn'
+    different = sum(1 for a, b in zip(reference, image) if abs(a - b) > 8)
+    assert different < len(reference) * 0.01, '%i of %i components are different' % (different, len(reference))
+
+
+def test_bufferobject_rendering():
+    """ Test that the rendering with buffer objects gives the same image as with display lists """
+    gl = buffer_object_gl()
+    scene = make_scene()
+    assert_same_image(render(gl, scene, GLRenderer.Normal), render(gl, scene, GLRenderer.BufferObject))
+
+
+def test_instanced_rendering():
+    """ Test that the instanced rendering blends the transparent shapes with the opaque shapes before them """
+    gl = buffer_object_gl()
+    scene = make_scene()
+    sphere = Sphere(0.2, 12, 12)
+    for i in range(4):
+        scene.add(Shape(Translated((0.4*i-0.6, -0.6, 0.8), sphere), Material((200,200,50))))
+    scene.add(Shape(Translated((0, -0.6, 1.2), Box(1.2, 0.5, 0.05)), Material((50,50,200), transparency=0.5)))
+    assert_same_image(render(gl, scene, GLRenderer.Normal), render(gl, scene, GLRenderer.BufferObject, True))
+
+
+if __name__ == '__main__':
+    test_bufferobject_rendering()
+    test_instanced_rendering()
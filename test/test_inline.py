@@ -0,0 +1,76 @@
+from openalea.plantgl.all import *
+import os, tempfile
+
+
+def write_scene(fname, nbshapes):
+    Scene([Shape(Sphere(i+1)) for i in range(nbshapes)]).save(fname)
+    return fname
+
+
+def test_inline_cache_get():
+    """ The scenes of a file are read once and shared """
+    InlineSceneCache.clear()
+    fname = write_scene(os.path.join(tempfile.mkdtemp(), 'a.bgeom'), 2)
+    s1 = InlineSceneCache.get(fname)
+    s2 = InlineSceneCache.get(fname)
+    assert len(s1) == 2
+    assert s1.getId() == s2.getId()
+    assert InlineSceneCache.size() == 1
+    assert InlineSceneCache.purge() == 0
+    del s1, s2
+    assert InlineSceneCache.purge() == 1
+    assert InlineSceneCache.size() == 0
+
+
+def test_inline_cache_prefetch():
+    """ The prefetched scenes are read in the background """
+    InlineSceneCache.clear()
+    dirname = tempfile.mkdtemp()
+    fnames = [write_scene(os.path.join(dirname, '%i.bgeom' % i), i+1) for i in range(5)]
+    for fname in fnames:
+        InlineSceneCache.prefetch(fname)
+    InlineSceneCache.prefetch(fnames[0])
+    InlineSceneCache.wait()
+    assert InlineSceneCache.size() == len(fnames)
+    for i, fname in enumerate(fnames):
+        assert len(InlineSceneCache.get(fname)) == i+1
+    # a scene may be got while it is prefetched.
+    InlineSceneCache.clear()
+    InlineSceneCache.prefetch(fnames[4])
+    assert len(InlineSceneCache.get(fnames[4])) == 5
+    InlineSceneCache.clear()
+    assert InlineSceneCache.size() == 0
+
+
+def test_inline_cache_reload():
+    """ A modified file is read again """
+    InlineSceneCache.clear()
+    fname = write_scene(os.path.join(tempfile.mkdtemp(), 'a.bgeom'), 2)
+    s1 = InlineSceneCache.get(fname)
+    write_scene(fname, 3)
+    mtime = os.path.getmtime(fname) + 10
+    os.utime(fname, (mtime, mtime))
+    s2 = InlineSceneCache.get(fname)
+    assert len(s1) == 2 and len(s2) == 3
+    assert s1.getId() != s2.getId()
+    assert InlineSceneCache.size() == 1
+    InlineSceneCache.setEnabled(False)
+    s3, s4 = InlineSceneCache.get(fname), InlineSceneCache.get(fname)
+    assert s3.getId() != s4.getId()
+    assert InlineSceneCache.size() == 0
+    InlineSceneCache.setEnabled(True)
+
+
+def test_inline_lazy_load():
+    """ An inline reads its file on the first access to its scene """
+    InlineSceneCache.clear()
+    fname = write_scene(os.path.join(tempfile.mkdtemp(), 'a.bgeom'), 2)
+    inl = Inline(fname)
+    assert not inl.isLoaded()
+    assert InlineSceneCache.size() == 0
+    assert inl.isValid() and not inl.isLoaded()
+    assert len(inl.scene) == 2
+    assert inl.isLoaded()
+    assert inl.scene.getId() == Inline(fname).scene.getId()
+    assert Inline(os.path.join(tempfile.mkdtemp(), 'missing.bgeom')).isValid() == False
+    InlineSceneCache.clear()
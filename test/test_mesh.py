@@ -13,3 +13,136 @@ def test_triangleset():
     assert ts.isValid()
 
 
+def test_large_triangleset_normals():
+    """ Normals of a mesh large enough to be computed in parallel """
+    n = 250
+    pts = [(i,j,0) for i in range(n) for j in range(n)]
+    ind = []
+    for i in range(n-1):
+        for j in range(n-1):
+            ind.append((i*n+j, (i+1)*n+j, i*n+j+1))
+            ind.append(((i+1)*n+j, (i+1)*n+j+1, i*n+j+1))
+    ts = TriangleSet(pts, ind)
+    ts.computeNormalList()
+    assert len(ts.normalList) == len(pts)
+    assert all(abs(nml.z - 1) < 1e-5 for nml in ts.normalList)
+    ts.normalPerVertex = False
+    ts.computeNormalList()
+    assert len(ts.normalList) == len(ind)
+    assert all(abs(nml.z - 1) < 1e-5 for nml in ts.normalList)
+
+def test_large_triangleset_normals_after_inplace_change():
+    """ Normals of a large mesh whose indices are modified in place after a first computation """
+    n = 250
+    pts = [(i,j,0) for i in range(n) for j in range(n)] + [(0,i,j) for i in range(n) for j in range(n)]
+    ind = []
+    for i in range(n-1):
+        for j in range(n-1):
+            ind.append((i*n+j, (i+1)*n+j, i*n+j+1))
+            ind.append(((i+1)*n+j, (i+1)*n+j+1, i*n+j+1))
+    ts = TriangleSet(pts, ind)
+    ts.computeNormalList()
+    # the faces are moved from the horizontal grid to the vertical one.
+    indices = ts.indexList
+    for k in range(len(indices)):
+        a, b, c = indices[k]
+        indices[k] = Index3(a+n*n, b+n*n, c+n*n)
+    ts.computeNormalList()
+    normals = ts.normalList
+    assert all(abs(abs(normals[k].x) - 1) < 1e-5 for k in range(n*n, 2*n*n))
+
+def test_optimize_mesh():
+    """ Welding of a triangle soup and removal of degenerated faces """
+    pts, ind = [], []
+    for i in range(10):
+        for j in range(10):
+            s = len(pts)
+            pts += [(i,j,0), (i+1,j,0), (i,j+1,0)]
+            ind.append((s,s+1,s+2))
+            s = len(pts)
+            pts += [(i+1,j,0), (i+1,j+1,0), (i,j+1,0)]
+            ind.append((s,s+1,s+2))
+    ind.append((0,0,1))
+    ts = TriangleSet(pts, ind)
+    optimizer = MeshOptimizer()
+    res = optimizer.optimize(ts)
+    assert res.isValid()
+    assert len(res.pointList) == 11*11
+    assert len(res.indexList) == 200
+    assert optimizer.nbRemovedFaces == 1
+    assert MeshOptimizer.averageCacheMissRatio(res) < MeshOptimizer.averageCacheMissRatio(ts)
+
+
+def test_simplify_mesh():
+    """ Decimation of a flat grid keeps its boundary and texture coordinates """
+    n = 30
+    pts = [(i,j,0) for i in range(n) for j in range(n)]
+    ind = []
+    for i in range(n-1):
+        for j in range(n-1):
+            ind.append((i*n+j, (i+1)*n+j, i*n+j+1))
+            ind.append(((i+1)*n+j, (i+1)*n+j+1, i*n+j+1))
+    ts = TriangleSet(pts, ind)
+    ts.texCoordList = [(i/float(n-1),j/float(n-1)) for i in range(n) for j in range(n)]
+    res = simplify_mesh(ts, 100)
+    assert res.isValid()
+    assert len(res.indexList) <= 100
+    assert abs(surface(res) - surface(ts)) < 1e-3
+    for p, uv in zip(res.pointList, res.texCoordList):
+        assert abs(p.x - uv.x*(n-1)) < 1e-3 and abs(p.y - uv.y*(n-1)) < 1e-3
+    simplifier = MeshSimplifier(maxError = 1e-3)
+    simplifier.preserveBoundary = True
+    res = simplifier.simplify(ts)
+    assert len(res.indexList) < len(ts.indexList)
+    assert simplifier.nbRemovedFaces == len(ts.indexList) - len(res.indexList)
+    assert len([p for p in res.pointList if p.x in (0, n-1) or p.y in (0, n-1)]) == 4*(n-1)
+
+def test_simplify_mesh_none():
+    """ Decimation of None raises a ValueError """
+    for simplify in (simplify_mesh, MeshSimplifier().simplify):
+        try:
+            simplify(None)
+            assert False, 'None was simplified'
+        except ValueError:
+            pass
+
+def test_simplify_mesh_manifold():
+    """ Decimation of a curved grid reaches the target without folding the surface """
+    from math import sin, cos
+    n = 60
+    pts = [(i,j,3*sin(i/5.)*cos(j/7.)) for i in range(n) for j in range(n)]
+    ind = []
+    for i in range(n-1):
+        for j in range(n-1):
+            ind.append((i*n+j, (i+1)*n+j, i*n+j+1))
+            ind.append(((i+1)*n+j, (i+1)*n+j+1, i*n+j+1))
+    ts = TriangleSet(pts, ind)
+    for target in (1000, 200, 50):
+        res = simplify_mesh(ts, target)
+        assert target - 2 <= len(res.indexList) <= target
+        edges = {}
+        for face in res.indexList:
+            for k in range(3):
+                edge = (min(face[k],face[(k+1)%3]), max(face[k],face[(k+1)%3]))
+                edges[edge] = edges.get(edge,0) + 1
+        assert max(edges.values()) <= 2
+        # the grid is a height field: no face may look downward.
+        for face in res.indexList:
+            a, b, c = [res.pointList[k] for k in face]
+            assert cross(b-a, c-a).z > 0
+
+def test_mesh_auto_intersection():
+    """ Neighbor triangles of a flat grid do not intersect, a crossing triangle does """
+    n = 10
+    pts = [(i,j,0) for i in range(n) for j in range(n)]
+    ind = []
+    for i in range(n-1):
+        for j in range(n-1):
+            ind.append((i*n+j, (i+1)*n+j, i*n+j+1))
+            ind.append(((i+1)*n+j, (i+1)*n+j+1, i*n+j+1))
+    pairs, geoms = auto_intersection(Point3Array(pts), Index3Array(ind))
+    assert len(pairs) == 0
+    crossing = (Point3Array([(4.2,4.2,-1),(4.4,4.2,1),(4.2,4.4,1)]), Index3Array([(0,1,2)]))
+    pairs, geoms = mesh_intersection(Point3Array(pts), Index3Array(ind), crossing[0], crossing[1])
+    assert len(pairs) > 0 and len(pairs) == len(geoms)
+    assert all(j == 0 for i,j in pairs)
@@ -0,0 +1,82 @@
+from openalea.plantgl.all import *
+import pickle
+
+
+def test_pickle_geometry():
+    """ Test the pickling of a geometry """
+    s = Sphere(3.5, 12, 6)
+    s2 = pickle.loads(pickle.dumps(s, 2))
+    assert isinstance(s2, Sphere)
+    assert s2.radius == 3.5 and s2.slices == 12
+
+
+def test_pickle_mesh():
+    """ Test the pickling of a mesh with its arrays """
+    pts = Point3Array([Vector3(i, i, i) for i in range(1000)])
+    ind = Index3Array([Index3(i, i+1, i+2) for i in range(998)])
+    ts = TriangleSet(pts, ind)
+    for protocol in range(pickle.HIGHEST_PROTOCOL+1):
+        ts2 = pickle.loads(pickle.dumps(ts, protocol))
+        assert list(ts2.pointList) == list(pts)
+        assert list(ts2.indexList) == list(ind)
+
+
+def test_pickle_shared():
+    """ Test that the objects shared in a scene are still shared after unpickling """
+    ts = TriangleSet(Point3Array([(0,0,0),(1,0,0),(0,1,0)]), Index3Array([(0,1,2)]))
+    g = pickle.loads(pickle.dumps(Group([ts, Translated((1,0,0), ts)]), 2))
+    assert g.geometryList[0].getPglId() == g.geometryList[1].geometry.getPglId()
+    sc = Scene([Shape(ts, Material((255,0,0))), Shape(ts)])
+    sc2 = pickle.loads(pickle.dumps(sc, 2))
+    assert len(sc2) == 2
+    assert sc2[0].geometry.getPglId() == sc2[1].geometry.getPglId()
+
+
+def test_pickle_shared_between_roots():
+    """ Test that the objects shared by several pickled roots are duplicated """
+    ts = TriangleSet(Point3Array([(0,0,0),(1,0,0),(0,1,0)]), Index3Array([(0,1,2)]))
+    l = pickle.loads(pickle.dumps([Shape(ts), Shape(ts)], 2))
+    assert l[0].geometry.getPglId() != l[1].geometry.getPglId()
+    assert list(l[0].geometry.pointList) == list(l[1].geometry.pointList)
+
+
+def test_pickle_outofband():
+    """ Test the pickling of the arrays out of band with protocol 5 """
+    if pickle.HIGHEST_PROTOCOL < 5: return
+    pts = Point3Array([Vector3(i, 0, 0) for i in range(10000)])
+    ps = PointSet(pts)
+    buffers = []
+    data = pickle.dumps(ps, 5, buffer_callback=buffers.append)
+    assert len(buffers) == 1
+    assert len(data) < 1000
+    ps2 = pickle.loads(data, buffers=buffers)
+    assert list(ps2.pointList) == list(pts)
+
+
+def test_pickle_outofband_process():
+    """ Test that the arrays pickled out of band can be unpickled by another process """
+    if pickle.HIGHEST_PROTOCOL < 5: return
+    import subprocess, sys
+    pts = Point3Array([Vector3(i, 2*i, 3*i) for i in range(10000)])
+    pts2 = Point2Array([Vector2(i, -i) for i in range(10000)])
+    buffers = []
+    data = pickle.dumps(Group([PointSet(pts), Polyline2D(pts2)]), 5, buffer_callback=buffers.append)
+    assert len(buffers) == 2
+    script = ("import pickle, sys\n"
+              "from openalea.plantgl.all import *\n"
+              "data, buffers = pickle.load(sys.stdin.buffer)\n"
+              "g = pickle.loads(data, buffers=buffers)\n"
+              "print(str(g.geometryList[0].pointList[-1]) + ';' + str(g.geometryList[1].pointList[-1]))\n")
+    payload = pickle.dumps((data, [bytes(b.raw()) for b in buffers]))
+    result = subprocess.run([sys.executable, '-c', script], input=payload, stdout=subprocess.PIPE)
+    assert result.returncode == 0
+    assert result.stdout.decode().strip() == str(pts[-1]) + ';' + str(pts2[-1])
+
+
+if __name__ == '__main__':
+    test_pickle_geometry()
+    test_pickle_mesh()
+    test_pickle_shared()
+    test_pickle_shared_between_roots()
+    test_pickle_outofband()
+    test_pickle_outofband_process()
@@ -1,5 +1,6 @@
 from openalea.plantgl.all import *
 from random import uniform, seed
+from unittest import SkipTest
 
 pointrange = (0,100)
 
@@ -37,6 +38,66 @@ def test_median_point():
        raise ValueError(k,j,dist_to_points(p3list[i],p3list),dist_to_points(p3list[j],p3list),p3list[i],p3list[j])
 
 
+def test_pointsets_normals():
+  """ Normals, curvatures and linearities of points on a plane and on a line """
+  seed(1)
+  plane = Point3Array([Vector3(uniform(*pointrange),uniform(*pointrange),0) for i in range(200)])
+  groups = IndexArray([list(range(i,i+10)) for i in range(190)]+[list(range(190,200)) for i in range(10)])
+  normals = pointsets_normals(plane, groups)
+  assert len(normals) == len(groups)
+  assert all(abs(abs(n.z) - 1) < 1e-5 for n in normals)
+  assert all(abs(c) < 1e-5 for c in pointsets_curvatures(plane, groups))
+  line = Point3Array([Vector3(1,2,3)*uniform(*pointrange) for i in range(200)])
+  assert all(abs(l - 1) < 1e-5 for l in pointsets_linearities(line, groups))
+  direction = Vector3(1,2,3).normed()
+  assert all(abs(abs(dot(o,direction)) - 1) < 1e-5 for o in pointsets_orientations(line, groups))
+
+def test_tiled_processing():
+  """ Neighborhoods and densities computed tile by tile on a tpc file """
+  seed(1)
+  points = Point3Array([random_point() for i in range(2000)])
+  s = Scene([Shape(PointSet(points))])
+  s.save('test_tiled.tpc')
+  cloud = Scene('test_tiled.tpc')[0].geometry.pointList
+  radius = 10
+  neighborhoods = tiled_r_neighborhoods('test_tiled.tpc', 30, radius)
+  assert len(neighborhoods) == len(cloud)
+  for i in range(0, len(cloud), 97):
+    expected = [j for j, q in enumerate(cloud) if norm(q - cloud[i]) <= radius]
+    assert list(neighborhoods[i]) == expected
+  densities = tiled_densities_from_r_neighborhood('test_tiled.tpc', 30, radius)
+  assert all(abs(d - len(n) / float(radius * radius)) < 1e-5 for d, n in zip(densities, neighborhoods))
+  assert tiled_voxel_downsampling('test_tiled.tpc', 'test_tiled_sampled.tpc', 30, 25)
+  assert len(Scene('test_tiled_sampled.tpc')[0].geometry.pointList) <= 64
+
+def as_list(result):
+  """ The values of an array of vectors or of indices, as nested lists. """
+  return [list(v) if hasattr(v, '__len__') else v for v in result]
+
+def test_threaded_calls():
+  """ The point manipulations and the kd-tree queries called from several threads give the results of the serial calls """
+  try:
+    from concurrent.futures import ThreadPoolExecutor
+  except ImportError:
+    raise SkipTest('concurrent.futures is not available')
+  seed(1)
+  points = Point3Array([random_point() for i in range(2000)])
+  groups = IndexArray([list(range(i,i+10)) for i in range(0,2000,10)])
+  tasks = [lambda : contract_point3(points, 10),
+           lambda : pointsets_normals(points, groups),
+           lambda : pointset_mean_distances(points, groups)]
+  if 'KDTree3' in globals():
+    kdtree = KDTree3(points)
+    tasks += [lambda : kdtree.k_nearest_neighbors(8),
+              lambda : kdtree.r_nearest_neighbors(10),
+              lambda : [kdtree.k_closest_points(p, 5) for p in points]]
+  expected = [as_list(task()) for task in tasks]
+  with ThreadPoolExecutor(max_workers = 4) as executor:
+    futures = [(i, executor.submit(task)) for k in range(4) for i, task in enumerate(tasks)]
+    for i, future in futures:
+      assert as_list(future.result()) == expected[i]
+
+
 
 if __name__ == '__main__':
     for i in xrange(50):
@@ -0,0 +1,143 @@
+from openalea.plantgl.all import *
+
+
+def stream_support():
+    return not pgl_support_extension('PGL_NO_QT_GUI')
+
+
+def make_scene():
+    scene = Scene()
+    scene.add(Shape(Sphere(0.5), Material((200,50,50)), 1))
+    scene.add(Shape(Translated((1,0,0), Box(0.3,0.3,0.3)), Material((50,200,50)), 2))
+    scene.add(Shape(Translated((-1,0,0), Cylinder(0.3,1)), Material((50,50,200)), 3))
+    scene[1].name = 'box'
+    return scene
+
+
+def transmit(delta):
+    """ Return delta as read by the viewer. """
+    return ViewSceneDelta.frombytes(delta.tobytes())
+
+
+def keys(scene):
+    return [ViewSceneStream.getKey(sh) for sh in scene]
+
+
+def test_stream_roundtrip():
+    """ The scene rebuilt by the viewer follows the streamed scenes """
+    if not stream_support(): return
+    scene = make_scene()
+    sender, viewer = ViewSceneStream(), ViewSceneStream()
+    delta = sender.update(scene)
+    assert delta.reset and len(delta.shapes) == 3
+    viewer.apply(transmit(delta))
+    assert keys(viewer.getScene()) == [1,2,3]
+    assert sender.update(scene).empty()
+    # a transformation modified in place is streamed as a transformation.
+    scene[1].geometry.translation = Vector3(0,2,0)
+    delta = transmit(sender.update(scene))
+    assert len(delta.shapes) == 0 and [k for k, m in delta.transforms] == [2]
+    viewer.apply(delta)
+    box = viewer.getScene()[1]
+    assert box.name == 'box' and box.id == 2
+    assert isinstance(box.geometry, Translated) and isinstance(box.geometry.geometry, Box)
+    assert norm(box.geometry.translation - Vector3(0,2,0)) < 1e-5
+    # a replaced geometry is streamed as a whole shape and removed shapes are removed.
+    scene[0].geometry = Sphere(1)
+    del scene[2]
+    delta = transmit(sender.update(scene))
+    assert [k for k, sh in delta.shapes] == [1] and delta.removed == [3]
+    viewer.apply(delta)
+    assert keys(viewer.getScene()) == [1,2]
+    assert abs(viewer.getScene()[0].geometry.radius - 1) < 1e-5
+
+
+def merged_frames(scenes):
+    """ Stream the scenes and apply the merge of their deltas after the first one. """
+    sender, viewer = ViewSceneStream(), ViewSceneStream()
+    viewer.apply(transmit(sender.update(scenes[0])))
+    delta = transmit(sender.update(scenes[1]))
+    for scene in scenes[2:]:
+        delta.merge(transmit(sender.update(scene)))
+    viewer.apply(delta)
+    return viewer.getScene()
+
+
+def copy(scene, indices):
+    result = Scene()
+    for i in indices: result.add(scene[i])
+    return result
+
+
+def test_stream_merge():
+    """ The merge of the deltas of several frames gives the last scene """
+    if not stream_support(): return
+    scene = make_scene()
+    added = copy(scene,[0,1,2])
+    added.add(Shape(Sphere(2), Material((0,0,0)), 4))
+    # add then remove
+    assert keys(merged_frames([scene, added, copy(scene,[0,1,2])])) == [1,2,3]
+    # remove then re-add
+    result = merged_frames([scene, copy(scene,[0,2]), copy(scene,[0,1,2])])
+    assert sorted(keys(result)) == [1,2,3]
+    # transform after replace
+    replaced = copy(scene,[0,2])
+    replaced.add(Shape(Translated((1,0,0), Cone(1,1)), Material((50,200,50)), 2))
+    sender, viewer = ViewSceneStream(), ViewSceneStream()
+    viewer.apply(transmit(sender.update(scene)))
+    delta = transmit(sender.update(replaced))
+    replaced[2].geometry.translation = Vector3(0,0,3)
+    delta.merge(transmit(sender.update(replaced)))
+    viewer.apply(delta)
+    cone = [sh for sh in viewer.getScene() if sh.id == 2][0]
+    assert isinstance(cone.geometry.geometry, Cone)
+    assert norm(cone.geometry.translation - Vector3(0,0,3)) < 1e-5
+
+
+def test_stream_duplicate_ids():
+    """ The shapes sharing an id are all streamed """
+    if not stream_support(): return
+    def module_shapes():
+        scene = Scene()
+        for i in range(3): scene.add(Shape(Translated((i,0,0), Sphere(0.2)), Material(), 5))
+        return scene
+    scene = module_shapes()
+    sender, viewer = ViewSceneStream(), ViewSceneStream()
+    delta = transmit(sender.update(scene))
+    assert len(delta.shapes) == 3
+    viewer.apply(delta)
+    assert len(viewer.getScene()) == 3
+    scene[1].geometry.translation = Vector3(0,1,0)
+    delta = transmit(sender.update(scene))
+    assert len(delta.shapes) == 0 and len(delta.transforms) == 1
+    viewer.apply(delta)
+    assert norm(viewer.getScene()[1].geometry.translation - Vector3(0,1,0)) < 1e-5
+    # the shapes produced again by the module replace the previous ones.
+    viewer.apply(transmit(sender.update(module_shapes())))
+    result = viewer.getScene()
+    assert len(result) == 3 and [sh.id for sh in result] == [5,5,5]
+    assert sorted(sh.geometry.translation.x for sh in result) == [0,1,2]
+
+
+def test_stream_shear():
+    """ The transformations with a shear are streamed as whole shapes """
+    if not stream_support(): return
+    assert ViewSceneStream.transform(Box(), Matrix4.translation(Vector3(1,2,3))) is not None
+    assert ViewSceneStream.transform(Box(), Matrix4(Matrix3(1,0.5,0,0,1,0,0,0,1))) is None
+    scene = Scene()
+    scene.add(Shape(Scaled((2,1,1), AxisRotated((0,0,1), 0.5, Box())), Material(), 1))
+    sender, viewer = ViewSceneStream(), ViewSceneStream()
+    viewer.apply(transmit(sender.update(scene)))
+    scene[0].geometry.scale = Vector3(3,1,1)
+    delta = transmit(sender.update(scene))
+    assert len(delta.transforms) == 0 and [k for k, sh in delta.shapes] == [1]
+    viewer.apply(delta)
+    assert isinstance(viewer.getScene()[0].geometry, Scaled)
+    assert norm(viewer.getScene()[0].geometry.scale - Vector3(3,1,1)) < 1e-5
+
+
+if __name__ == '__main__':
+    test_stream_roundtrip()
+    test_stream_merge()
+    test_stream_duplicate_ids()
+    test_stream_shear()